@@ -4,6 +4,7 @@
 #include "gui_element_cyberdeck.h"
 #include "gui_menu.h"
 #include "gui_style.h"
+#include "gui_text.h"
 #include "pax_gfx.h"
 #include "pax_matrix.h"
 #include "pax_text.h"
@@ -27,7 +28,7 @@ void chat_render_message(pax_buf_t* pax_buffer, menu_item_t* item, gui_theme_t*
     float h              = theme->chat.list_entry_height - theme->chat.vertical_padding - 18.0f;
     float contact_name_h = theme->chat.list_entry_height - theme->chat.vertical_padding;
 
-    pax_vec2f text_size   = pax_text_size(theme->chat.text_font, theme->chat.text_height, item->label);
+    pax_vec2f text_size   = gui_text_size(theme->chat.text_font, theme->chat.text_height, item->label);
     float     text_offset = ((h - text_size.y) / 2) + 1;
 
     pax_simple_rect(pax_buffer, theme->chat.palette.color_background, x, contact_name_y, w, contact_name_h);
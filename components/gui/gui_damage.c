@@ -0,0 +1,94 @@
+#include "gui_damage.h"
+#include <math.h>
+#include <stdint.h>
+
+static gui_damage_rect_t damage_rects[GUI_DAMAGE_MAX_RECTS];
+static size_t            damage_count = 0;
+static bool              damage_all   = false;
+
+static int64_t rect_area(const gui_damage_rect_t* rect) {
+    return (int64_t)rect->w * rect->h;
+}
+
+static gui_damage_rect_t rect_union(const gui_damage_rect_t* a, const gui_damage_rect_t* b) {
+    int x0 = (a->x < b->x) ? a->x : b->x;
+    int y0 = (a->y < b->y) ? a->y : b->y;
+    int x1 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+    int y1 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+    return (gui_damage_rect_t){x0, y0, x1 - x0, y1 - y0};
+}
+
+static bool rect_touches(const gui_damage_rect_t* a, const gui_damage_rect_t* b) {
+    return a->x <= b->x + b->w && b->x <= a->x + a->w && a->y <= b->y + b->h && b->y <= a->y + a->h;
+}
+
+// Merges rectangles that overlap or touch, so consecutive menu rows end up as one transfer
+static void merge_touching(void) {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < damage_count && !merged; i++) {
+            for (size_t j = i + 1; j < damage_count; j++) {
+                if (rect_touches(&damage_rects[i], &damage_rects[j])) {
+                    damage_rects[i] = rect_union(&damage_rects[i], &damage_rects[j]);
+                    damage_rects[j] = damage_rects[--damage_count];
+                    merged          = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void gui_damage_add(float x, float y, float w, float h) {
+    if (damage_all || w <= 0 || h <= 0) {
+        return;
+    }
+
+    // Round outwards to whole pixels
+    int               x0   = (int)floorf(x);
+    int               y0   = (int)floorf(y);
+    gui_damage_rect_t rect = {x0, y0, (int)ceilf(x + w) - x0, (int)ceilf(y + h) - y0};
+
+    if (damage_count < GUI_DAMAGE_MAX_RECTS) {
+        damage_rects[damage_count++] = rect;
+        merge_touching();
+        return;
+    }
+
+    // Out of slots: grow the rectangle that needs the least extra area to cover the new one
+    size_t  best_index = 0;
+    int64_t best_cost  = INT64_MAX;
+    for (size_t i = 0; i < damage_count; i++) {
+        gui_damage_rect_t combined = rect_union(&damage_rects[i], &rect);
+        int64_t           cost     = rect_area(&combined) - rect_area(&damage_rects[i]);
+        if (cost < best_cost) {
+            best_cost  = cost;
+            best_index = i;
+        }
+    }
+    damage_rects[best_index] = rect_union(&damage_rects[best_index], &rect);
+    merge_touching();
+}
+
+void gui_damage_add_all(void) {
+    damage_all   = true;
+    damage_count = 0;
+}
+
+size_t gui_damage_take(gui_damage_rect_t* out_rects, size_t max_rects, bool* out_all) {
+    size_t count = (damage_count < max_rects) ? damage_count : max_rects;
+    for (size_t i = 0; i < count; i++) {
+        out_rects[i] = damage_rects[i];
+    }
+    if (out_all != NULL) {
+        *out_all = damage_all || (damage_count > max_rects);
+    }
+    gui_damage_clear();
+    return count;
+}
+
+void gui_damage_clear(void) {
+    damage_count = 0;
+    damage_all   = false;
+}
@@ -28,6 +28,7 @@
 #include <string.h>
 #include "bsp/input.h"
 #include "esp_timer.h"
+#include "gui_text.h"
 
 void gui_edit_init(pax_buf_t* pax_buffer, gui_edit_context_t* context, float aPosX, float aPosY, float aWidth,
                    float aHeight, char* text, size_t buffer_cap) {
@@ -91,25 +92,26 @@ static void gui_edit_render_text(pax_buf_t* buf, gui_edit_context_t* context, bo
     char  tmp[2] = {0, 0};
 
     // Draw everything.
-    for (int i = 0; i < strlen(context->content); i++) {
+    size_t length = strlen(context->content);
+    for (int i = 0; i < length; i++) {
         if (context->cursor == i) {
             // The cursor in between the input.
             pax_draw_line(buf, context->sel_col, x, y, x, y + context->text_font_size - 1);
         }
 
         // The character of the input.
-        tmp[0]          = context->content[i];
-        pax_vec1_t dims = pax_text_size(context->text_font, context->text_font_size, tmp);
+        tmp[0]      = context->content[i];
+        float width = gui_text_char_width(context->text_font, context->text_font_size, tmp[0]);
 
-        if (x + dims.x > context->x + context->width - 4) {
+        if (x + width > context->x + context->width - 4) {
             // Word wrap.
             x  = context->x + 2;
             y += context->text_font_size;
         }
         pax_draw_text(buf, context->text_col, context->text_font, context->text_font_size, x, y, tmp);
-        x += dims.x;
+        x += width;
     }
-    if (context->cursor == strlen(context->content)) {
+    if (context->cursor == length) {
         // The cursor after the input.
         pax_draw_line(buf, context->sel_col, x, y, x, y + context->text_font_size - 1);
     }
@@ -4,8 +4,11 @@
 #include <string.h>
 #include "gui_style.h"
 
+#define MENU_INITIAL_CAPACITY 16
+
 void menu_initialize(menu_t* menu) {
-    menu->firstItem         = NULL;
+    menu->items             = NULL;
+    menu->capacity          = 0;
     menu->length            = 0;
     menu->position          = 0;
     menu->previous_position = 0;
@@ -23,42 +26,46 @@ void _menu_free_item(menu_item_t* menu_item) {
 }
 
 void menu_free(menu_t* menu) {
-    menu_item_t* currentItem = menu->firstItem;
-    while (currentItem != NULL) {
-        menu_item_t* nextItem = currentItem->nextItem;
-        _menu_free_item(currentItem);
-        currentItem = nextItem;
+    for (size_t index = 0; index < menu->length; index++) {
+        _menu_free_item(menu->items[index]);
     }
-    menu->firstItem         = NULL;
+    free(menu->items);
+    menu->items             = NULL;
+    menu->capacity          = 0;
     menu->length            = 0;
     menu->position          = 0;
     menu->previous_position = 0;
 }
 
+// Positions past the end of the menu resolve to the last item
 menu_item_t* menu_find_item(menu_t* menu, size_t position) {
-    menu_item_t* currentItem = menu->firstItem;
-    if (currentItem == NULL) return NULL;
-    size_t index = 0;
-    while (index < position) {
-        if (currentItem->nextItem == NULL) break;
-        currentItem = currentItem->nextItem;
-        index++;
-    }
-    return currentItem;
+    if (menu->length < 1) return NULL;
+    if (position >= menu->length) position = menu->length - 1;
+    return menu->items[position];
 }
 
 menu_item_t* menu_find_last_item(menu_t* menu) {
-    menu_item_t* lastItem = menu->firstItem;
-    if (lastItem == NULL) return NULL;
-    while (lastItem->nextItem != NULL) {
-        lastItem = lastItem->nextItem;
+    if (menu->length < 1) return NULL;
+    return menu->items[menu->length - 1];
+}
+
+static bool _menu_reserve(menu_t* menu, size_t required) {
+    if (required <= menu->capacity) return true;
+    size_t new_capacity = menu->capacity ? menu->capacity : MENU_INITIAL_CAPACITY;
+    while (new_capacity < required) {
+        new_capacity *= 2;
     }
-    return lastItem;
+    menu_item_t** new_items = realloc(menu->items, new_capacity * sizeof(menu_item_t*));
+    if (new_items == NULL) return false;
+    menu->items    = new_items;
+    menu->capacity = new_capacity;
+    return true;
 }
 
 ssize_t menu_insert_item_value(menu_t* menu, const char* label, const char* value, menu_callback_t callback,
                                void* callback_arguments, size_t position) {
     if (menu == NULL) return -1;
+    if (!_menu_reserve(menu, menu->length + 1)) return -1;
     menu_item_t* newItem = calloc(1, sizeof(menu_item_t));
     if (newItem == NULL) return -1;
     size_t label_size = strlen(label) + 1;
@@ -81,27 +88,13 @@ ssize_t menu_insert_item_value(menu_t* menu, const char* label, const char* valu
     newItem->callback           = callback;
     newItem->callback_arguments = callback_arguments;
     newItem->icon               = NULL;
-    if (menu->firstItem == NULL) {
-        newItem->nextItem     = NULL;
-        newItem->previousItem = NULL;
-        menu->firstItem       = newItem;
-    } else {
-        if (position >= menu->length) {
-            newItem->previousItem           = menu_find_last_item(menu);
-            newItem->nextItem               = NULL;
-            newItem->previousItem->nextItem = newItem;
-        } else {
-            newItem->nextItem     = menu_find_item(menu, position);
-            newItem->previousItem = newItem->nextItem->previousItem;  // Copy pointer to previous item to new item
-            if (newItem->nextItem != NULL)
-                newItem->nextItem->previousItem = newItem;  // Replace pointer to previous item with new item
-            if (newItem->previousItem != NULL)
-                newItem->previousItem->nextItem = newItem;  // Replace pointer to next item in previous item
-        }
-    }
     if (position > menu->length) {
         position = menu->length;
     }
+    if (position < menu->length) {
+        memmove(&menu->items[position + 1], &menu->items[position], (menu->length - position) * sizeof(menu_item_t*));
+    }
+    menu->items[position] = newItem;
     menu->length++;
     return position;
 }
@@ -117,14 +110,7 @@ ssize_t menu_insert_item_icon(menu_t* menu, const char* label, menu_callback_t c
     if (new_position < 0) {
         return -1;
     }
-    menu_item_t* item;
-    if (position >= menu->length - 1) {
-        item = menu_find_last_item(menu);
-    } else {
-        item = menu_find_item(menu, position);
-    }
-
-    item->icon = icon;
+    menu->items[new_position]->icon = icon;
     return new_position;
 }
 
@@ -134,45 +120,15 @@ ssize_t menu_insert_item_value_icon(menu_t* menu, const char* label, const char*
     if (new_position < 0) {
         return -1;
     }
-    menu_item_t* item;
-    if (position >= menu->length - 1) {
-        item = menu_find_last_item(menu);
-    } else {
-        item = menu_find_item(menu, position);
-    }
-
-    item->icon = icon;
+    menu->items[new_position]->icon = icon;
     return new_position;
 }
 
 bool menu_remove_item(menu_t* menu, size_t position) {
     if (menu == NULL) return false;              // Can't delete an item from a menu that doesn't exist
     if (menu->length <= position) return false;  // Can't delete an item that doesn't exist
-    menu_item_t* item;
-
-    if (position == 0) {
-        item = menu->firstItem;
-        if (item == NULL) return false;  // Can't delete if no linked list is allocated
-        if (item->nextItem != NULL) {
-            menu->firstItem               = item->nextItem;
-            menu->firstItem->previousItem = NULL;
-        } else {
-            menu->firstItem = NULL;
-        }
-    } else {
-        item = menu_find_item(menu, position);
-        if (item == NULL) return false;
-        if (item->previousItem != NULL) item->previousItem->nextItem = item->nextItem;
-        if (item->nextItem != NULL) item->nextItem->previousItem = item->previousItem;
-    }
-    free(item->label);
-    if (item->value) {
-        free(item->value);
-    }
-    if (item->right_aligned_text) {
-        free(item->right_aligned_text);
-    }
-    free(item);
+    _menu_free_item(menu->items[position]);
+    memmove(&menu->items[position], &menu->items[position + 1], (menu->length - position - 1) * sizeof(menu_item_t*));
     menu->length--;
     if (menu->length < 1) {
         menu->position = 0;
@@ -256,6 +212,12 @@ pax_buf_t* menu_get_icon(menu_t* menu, size_t position) {
     return item->icon;
 }
 
+void menu_set_icon(menu_t* menu, size_t position, pax_buf_t* icon) {
+    menu_item_t* item = menu_find_item(menu, position);
+    if (item == NULL) return;
+    item->icon = icon;
+}
+
 const char* menu_get_label(menu_t* menu, size_t position) {
     menu_item_t* item = menu_find_item(menu, position);
     if (item == NULL) return NULL;
@@ -1,8 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "gui_damage.h"
 #include "gui_menu.h"
 #include "gui_style.h"
+#include "gui_text.h"
 #include "pax_gfx.h"
 #include "pax_matrix.h"
 // #include "shapes/pax_rects.h"
@@ -116,6 +118,8 @@ void menu_render(pax_buf_t* pax_buffer, menu_t* menu, pax_vec2_t position, gui_t
         menu_item_t* item               = menu_find_item(menu, index);
         if (item == NULL) continue;
         menu_render_item(pax_buffer, item, theme, position_item, current_position_y, index == menu->position);
+        gui_damage_add(position_item.x0, current_position_y, position_item.x1 - position_item.x0,
+                       theme->menu.list_entry_height);
     }
 
     if (menu->length > max_items) {
@@ -131,6 +135,7 @@ void menu_render(pax_buf_t* pax_buffer, menu_t* menu, pax_vec2_t position, gui_t
                         scrollbarHeight);
         pax_simple_rect(pax_buffer, theme->menu.palette.color_highlight_primary, position.x1 - 5,
                         position.y0 + 1 + scrollbarStart, 4, scrollbarEnd - scrollbarStart);
+        gui_damage_add(position.x1 - 5, position.y0 + 1, 4, scrollbarHeight);
         // pax_noclip(pax_buffer);
     }
 }
@@ -194,7 +199,7 @@ void menu_render_grid(pax_buf_t* pax_buffer, menu_t* menu, pax_vec2_t position,
         float icon_size   = (item->icon != NULL) ? 33 : 0;
         float text_offset = ((entry_height - theme->menu.text_height - icon_size) / 2) + icon_size + 1;
 
-        pax_vec1_t text_size = pax_text_size(theme->menu.text_font, theme->menu.text_height, item->label);
+        pax_vec1_t text_size = gui_text_size(theme->menu.text_font, theme->menu.text_height, item->label);
         if (index == menu->position) {
             pax_simple_rect(pax_buffer, theme->menu.palette.color_active_background, item_position_x, item_position_y,
                             entry_width, entry_height);
@@ -220,6 +225,8 @@ void menu_render_grid(pax_buf_t* pax_buffer, menu_t* menu, pax_vec2_t position,
                            item_position_y + ((text_offset - icon_size - 1) / 2));
         }
 
+        gui_damage_add(item_position_x, item_position_y, entry_width, entry_height);
+
         // pax_noclip(pax_buffer);
     }
 
@@ -237,6 +244,7 @@ void menu_render_grid(pax_buf_t* pax_buffer, menu_t* menu, pax_vec2_t position,
 
         pax_simple_rect(pax_buffer, theme->menu.palette.color_background, item_position_x, item_position_y,
                         entry_width, entry_height);
+        gui_damage_add(item_position_x, item_position_y, entry_width, entry_height);
     }
 
     if (menu->length > max_items) {
@@ -250,6 +258,7 @@ void menu_render_grid(pax_buf_t* pax_buffer, menu_t* menu, pax_vec2_t position,
                         scrollbarHeight);
         pax_simple_rect(pax_buffer, theme->menu.palette.color_highlight_primary, position.x1 - 5,
                         position.y0 + 1 + scrollbarStart, 4, scrollbarEnd - scrollbarStart);
+        gui_damage_add(position.x1 - 5, position.y0 + 1, 4, scrollbarHeight);
     }
 
     // pax_noclip(pax_buffer);
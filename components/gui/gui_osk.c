@@ -26,6 +26,7 @@
 #include <malloc.h>
 #include <string.h>
 #include "esp_timer.h"
+#include "gui_text.h"
 #include "pax_fonts.h"
 #include "pax_gfx.h"
 #include "pax_shapes.h"
@@ -235,14 +236,14 @@ static void gui_osk_art_select(pax_buf_t* buf, gui_osk_ctx_t* ctx, float x, floa
 
     // Calculate font size.
     char*      str       = long_str;
-    pax_vec1_t dims      = pax_text_size(ctx->kb_font, 0, str);
+    pax_vec1_t dims      = gui_text_size(ctx->kb_font, 0, str);
     int        font_size = 9;  //(dx - 4) / dims.x * dims.y;
     if (font_size < dims.y) {
         str       = short_str;
-        dims      = pax_text_size(ctx->kb_font, 0, str);
+        dims      = gui_text_size(ctx->kb_font, 0, str);
         font_size = 9;  //(dx - 4) / dims.x * dims.y;
     }
-    dims = pax_text_size(ctx->kb_font, font_size, str);
+    dims = gui_text_size(ctx->kb_font, font_size, str);
 
     // Now draw it.
     pax_push_2d(buf);
@@ -257,7 +258,7 @@ static void gui_osk_art_select(pax_buf_t* buf, gui_osk_ctx_t* ctx, float x, floa
 // Expects x to be the horizontal center of the key.
 static void gui_osk_char(pax_buf_t* buf, gui_osk_ctx_t* ctx, float x, float y, float dx, const char* text,
                          bool selected) {
-    pax_vec1_t dims = pax_text_size(ctx->kb_font, ctx->kb_font_size, text);
+    pax_vec1_t dims = gui_text_size(ctx->kb_font, ctx->kb_font_size, text);
 
     if (selected && ctx->held == GUI_OSK_CHARSELECT) {
         // Infilll!
@@ -408,25 +409,26 @@ static void gui_osk_render_text(pax_buf_t* buf, gui_osk_ctx_t* ctx, bool do_bg)
     char  tmp[2] = {0, 0};
 
     // Draw everything.
-    for (int i = 0; i < strlen(ctx->content); i++) {
+    size_t length = strlen(ctx->content);
+    for (int i = 0; i < length; i++) {
         if (ctx->cursor == i) {
             // The cursor in between the input.
             pax_draw_line(buf, ctx->sel_col, x, y, x, y + ctx->text_font_size - 1);
         }
 
         // The character of the input.
-        tmp[0]          = ctx->content[i];
-        pax_vec1_t dims = pax_text_size(ctx->text_font, ctx->text_font_size, tmp);
+        tmp[0]      = ctx->content[i];
+        float width = gui_text_char_width(ctx->text_font, ctx->text_font_size, tmp[0]);
 
-        if (x + dims.x > ctx->x + ctx->width - 4) {
+        if (x + width > ctx->x + ctx->width - 4) {
             // Word wrap.
             x  = ctx->x + 2;
             y += ctx->text_font_size;
         }
         pax_draw_text(buf, ctx->text_col, ctx->text_font, ctx->text_font_size, x, y, tmp);
-        x += dims.x;
+        x += width;
     }
-    if (ctx->cursor == strlen(ctx->content)) {
+    if (ctx->cursor == length) {
         // The cursor after the input.
         pax_draw_line(buf, ctx->sel_col, x, y, x, y + ctx->text_font_size - 1);
     }
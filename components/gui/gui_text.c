@@ -0,0 +1,114 @@
+#include "gui_text.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "pax_gfx.h"
+#include "pax_types.h"
+
+#define GLYPH_FIRST ' '
+#define GLYPH_LAST  '~'
+#define GLYPH_COUNT (GLYPH_LAST - GLYPH_FIRST + 1)
+#define CACHE_WAYS  2  // Entries a string can be kept in, so labels drawn in the same frame rarely evict each other
+#define CACHE_SETS  (GUI_TEXT_CACHE_ENTRIES / CACHE_WAYS)
+
+typedef struct {
+    const pax_font_t* font;  // NULL when the entry is unused
+    float             font_size;
+    uint32_t          hash;
+    pax_vec2f         size;
+    char              text[GUI_TEXT_CACHE_KEY_SIZE];
+} gui_text_entry_t;
+
+typedef struct {
+    const pax_font_t* font;  // NULL when the slot is unused
+    float             font_size;
+    float             widths[GLYPH_COUNT];  // Negative until measured
+} gui_text_glyphs_t;
+
+static gui_text_entry_t  entries[CACHE_SETS][CACHE_WAYS];
+static uint8_t           recent_way[CACHE_SETS];  // Way of every set that was used last, the other one is replaced
+static gui_text_glyphs_t glyphs[GUI_TEXT_GLYPH_FONTS];
+static size_t            glyphs_next = 0;  // Slot replaced when a new font and size combination is used
+
+// FNV-1a over the string, mixed with the font and size so equal labels in other fonts use other entries
+static uint32_t hash_key(const pax_font_t* font, float font_size, const char* text, size_t* out_length) {
+    uint32_t hash   = 2166136261u;
+    size_t   length = 0;
+    for (const char* c = text; *c != '\0'; c++) {
+        hash ^= (uint8_t)*c;
+        hash *= 16777619u;
+        length++;
+    }
+    uint32_t size_bits;
+    memcpy(&size_bits, &font_size, sizeof(size_bits));
+    hash       ^= (uint32_t)(uintptr_t)font ^ (size_bits * 2654435761u);
+    *out_length = length;
+    return hash;
+}
+
+pax_vec2f gui_text_size(const pax_font_t* font, float font_size, const char* text) {
+    size_t   length;
+    uint32_t hash = hash_key(font, font_size, text, &length);
+    if (length >= GUI_TEXT_CACHE_KEY_SIZE) {
+        return pax_text_size(font, font_size, text);
+    }
+
+    size_t set = hash % CACHE_SETS;
+    for (uint8_t way = 0; way < CACHE_WAYS; way++) {
+        gui_text_entry_t* entry = &entries[set][way];
+        if (entry->font == font && entry->font_size == font_size && entry->hash == hash &&
+            strcmp(entry->text, text) == 0) {
+            recent_way[set] = way;
+            return entry->size;
+        }
+    }
+
+    uint8_t           way   = (recent_way[set] + 1) % CACHE_WAYS;
+    gui_text_entry_t* entry = &entries[set][way];
+
+    recent_way[set]  = way;
+    entry->font      = font;
+    entry->font_size = font_size;
+    entry->hash      = hash;
+    entry->size      = pax_text_size(font, font_size, text);
+    memcpy(entry->text, text, length + 1);
+    return entry->size;
+}
+
+static gui_text_glyphs_t* find_glyphs(const pax_font_t* font, float font_size) {
+    for (size_t i = 0; i < GUI_TEXT_GLYPH_FONTS; i++) {
+        if (glyphs[i].font == font && glyphs[i].font_size == font_size) {
+            return &glyphs[i];
+        }
+    }
+
+    gui_text_glyphs_t* slot = &glyphs[glyphs_next];
+    glyphs_next             = (glyphs_next + 1) % GUI_TEXT_GLYPH_FONTS;
+    slot->font              = font;
+    slot->font_size         = font_size;
+    for (size_t i = 0; i < GLYPH_COUNT; i++) {
+        slot->widths[i] = -1;
+    }
+    return slot;
+}
+
+float gui_text_char_width(const pax_font_t* font, float font_size, char character) {
+    char text[2] = {character, '\0'};
+    if (character < GLYPH_FIRST || character > GLYPH_LAST) {
+        return pax_text_size(font, font_size, text).x;
+    }
+
+    gui_text_glyphs_t* slot  = find_glyphs(font, font_size);
+    float*             width = &slot->widths[character - GLYPH_FIRST];
+    if (*width < 0) {
+        *width = pax_text_size(font, font_size, text).x;
+    }
+    return *width;
+}
+
+void gui_text_cache_clear(void) {
+    memset(entries, 0, sizeof(entries));
+    memset(recent_way, 0, sizeof(recent_way));
+    memset(glyphs, 0, sizeof(glyphs));
+    glyphs_next = 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif  //__cplusplus
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Damage tracking: renderers mark the screen regions they changed so the display
+// layer can transfer only those regions instead of the whole framebuffer.
+
+#define GUI_DAMAGE_MAX_RECTS 8
+
+typedef struct {
+    int x;
+    int y;
+    int w;
+    int h;
+} gui_damage_rect_t;
+
+void   gui_damage_add(float x, float y, float w, float h);
+void   gui_damage_add_all(void);
+size_t gui_damage_take(gui_damage_rect_t* out_rects, size_t max_rects, bool* out_all);
+void   gui_damage_clear(void);
+
+#ifdef __cplusplus
+}
+#endif  //__cplusplus
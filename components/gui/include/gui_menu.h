@@ -19,18 +19,15 @@ typedef struct _menu_item {
     pax_buf_t*      icon;
     char*           value;
     char*           right_aligned_text;
-
-    // Linked list
-    struct _menu_item* previousItem;
-    struct _menu_item* nextItem;
 } menu_item_t;
 
 typedef struct menu {
-    menu_item_t* firstItem;
-    size_t       length;
-    size_t       navigation_position;
-    size_t       position;
-    size_t       previous_position;
+    menu_item_t** items;     // Item pointers in display order, indexed by position
+    size_t        capacity;  // Number of slots allocated in items
+    size_t        length;
+    size_t        navigation_position;
+    size_t        position;
+    size_t        previous_position;
 } menu_t;
 
 void         menu_initialize(menu_t* menu);
@@ -56,6 +53,7 @@ void         menu_set_position(menu_t* menu, size_t position);
 size_t       menu_get_length(menu_t* menu);
 void*        menu_get_callback_args(menu_t* menu, size_t position);
 pax_buf_t*   menu_get_icon(menu_t* menu, size_t position);
+void         menu_set_icon(menu_t* menu, size_t position, pax_buf_t* icon);
 const char*  menu_get_value(menu_t* menu, size_t position);
 void         menu_set_value(menu_t* menu, size_t position, const char* value);
 const char*  menu_get_right_aligned_text(menu_t* menu, size_t position);
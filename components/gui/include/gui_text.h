@@ -0,0 +1,26 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif  //__cplusplus
+
+#include "pax_types.h"
+
+// Text measurement cache: menus, headers and footers measure the same labels on every render. Sizes of strings
+// are memoized keyed by font, font size and string, and the advance widths of the printable ASCII characters are
+// kept per font and size for code that lays out text one character at a time. Like the renderers, the cache is
+// meant to be used from the task that draws the user interface.
+
+#define GUI_TEXT_CACHE_ENTRIES  128  // Memoized string sizes, in sets of two
+#define GUI_TEXT_CACHE_KEY_SIZE 64   // Longer strings are measured every time
+#define GUI_TEXT_GLYPH_FONTS    4    // Font and size combinations with cached character widths
+
+// Same result as pax_text_size
+pax_vec2f gui_text_size(const pax_font_t* font, float font_size, const char* text);
+// Width of a single character, same result as pax_text_size on a one character string
+float     gui_text_char_width(const pax_font_t* font, float font_size, char character);
+void      gui_text_cache_clear(void);
+
+#ifdef __cplusplus
+}
+#endif  //__cplusplus
@@ -24,7 +24,7 @@ struct plugin_context {
     plugin_state_t state;
 
     // Loaded ELF info (kbelf handles)
-    void* elf_handle;           // kbelf_dyn handle
+    void* elf_handle;           // plugin_image_t handle (plugin_loader.h)
     void* entrypoint;           // Resolved entry point address
 
     // Plugin registration data (from loaded ELF)
@@ -53,6 +53,16 @@ struct plugin_context {
 
     // Private data for plugin use
     void* user_data;
+
+    // Settings cache (plugin_settings.c), loaded on first use
+    struct plugin_settings* settings_cache;
+
+    // Callback timings and service task samples (plugin_profile.c)
+    struct plugin_profile* profile;
+
+    // Service task limits, from plugin.json or the defaults
+    uint32_t service_stack_size;  // Bytes
+    uint8_t  service_priority;
 };
 
 // Helper macros for plugin context access
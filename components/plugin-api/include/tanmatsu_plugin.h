@@ -18,6 +18,8 @@ extern "C" {
 // ============================================
 // Plugin API Version
 // ============================================
+// The minor version only goes up once the badge-elf export table lists the
+// functions it adds.
 
 #define TANMATSU_PLUGIN_API_VERSION_MAJOR 3
 #define TANMATSU_PLUGIN_API_VERSION_MINOR 0
@@ -182,10 +184,11 @@ void asp_plugin_status_widget_unregister(int widget_id);
 // ============================================
 // Plugins observe and inject events through the unified input event queue.
 // All event types — keyboard, navigation, scancode, and action — flow through
-// the same pipeline. There is no separate "lifecycle event" subsystem; system
-// signals (SD card insert/remove, WiFi state, USB connect/disconnect, etc.)
-// are dispatched as INPUT_EVENT_TYPE_ACTION events with a subtype identifying
-// the source. See asp/input.h and asp/input_types.h for the event structure.
+// the same pipeline. System signals (SD card insert/remove, WiFi state, USB
+// connect/disconnect, etc.) may also appear as INPUT_EVENT_TYPE_ACTION events
+// with a subtype identifying the source; plugins that only care about such
+// state changes should use the event bus below instead of a hook. See
+// asp/input.h and asp/input_types.h for the event structure.
 
 // Launcher-extended action subtypes. These augment asp_input_action_type_t
 // (defined in asp/input_types.h) with values the launcher synthesizes for
@@ -226,6 +229,53 @@ bool asp_plugin_input_inject(asp_input_event_t* event);
 // instantaneous state of an action or navigation key, use asp_input_get_action()
 // or asp_input_get_nav() from the same header.
 
+// ============================================
+// Host API: Events
+// ============================================
+// The launcher publishes system state changes on an event bus. Handlers are
+// called from the launcher's event dispatcher task, in publish order, shortly
+// after the change is noticed. Handlers must return quickly: every event
+// waits for all handlers of the events before it.
+
+// Event types
+typedef enum {
+    PLUGIN_EVENT_APP_LAUNCH = 1,        // text: slug of the app
+    PLUGIN_EVENT_WIFI_CONNECTED = 3,    // text: SSID
+    PLUGIN_EVENT_WIFI_DISCONNECTED = 4,
+    PLUGIN_EVENT_SD_INSERTED = 5,
+    PLUGIN_EVENT_SD_REMOVED = 6,
+    PLUGIN_EVENT_POWER_LOW = 7,         // value: battery percentage
+    PLUGIN_EVENT_USB_CONNECTED = 8,     // USB power connected
+    PLUGIN_EVENT_USB_DISCONNECTED = 9,  // USB power disconnected
+    PLUGIN_EVENT_AUDIO_JACK_INSERTED = 10,
+    PLUGIN_EVENT_AUDIO_JACK_REMOVED = 11,
+    PLUGIN_EVENT_BATTERY_CHANGED = 12,  // value: battery percentage, text: "charging" while charging
+    PLUGIN_EVENT_COUNT,
+} plugin_event_t;
+
+// Filter mask bit of an event type, OR these together for asp_plugin_event_register
+#define PLUGIN_EVENT_MASK(event) (1UL << (event))
+#define PLUGIN_EVENT_MASK_ALL    (((1UL << PLUGIN_EVENT_COUNT) - 1) & ~1UL)
+
+// Event passed to handlers, only valid during the call
+typedef struct {
+    plugin_event_t event;
+    uint32_t       timestamp_ms;  // asp_plugin_get_tick_ms() when the event was published
+    int32_t        value;         // Event specific, see plugin_event_t
+    char           text[33];      // Event specific, see plugin_event_t, empty if unused
+} plugin_event_data_t;
+
+// Event handler callback
+// Return 0 if not handled, positive if handled
+typedef int (*plugin_event_handler_t)(uint32_t event, const plugin_event_data_t* data, void* arg);
+
+// Register a handler for the events in event_mask
+// Returns: handler_id (>=0) on success, -1 on error
+int asp_plugin_event_register(plugin_context_t* ctx, uint32_t event_mask, plugin_event_handler_t handler, void* arg);
+
+// Unregister an event handler, it is not called anymore once this returns
+void asp_plugin_event_unregister(int handler_id);
+
 // ============================================
 // Host API: RGB LEDs
 // ============================================
@@ -365,6 +415,9 @@ asp_err_t asp_http_post(const char* url, const char* body, char* response, size_
 // ============================================
 // Host API: Settings Storage
 // ============================================
+// Settings are kept in RAM and written to flash in batches: a changed value
+// reaches NVS within a few seconds, when the plugin is unloaded or when the
+// device shuts down. Keys are at most 15 characters, strings at most 3999.
 
 // Get string setting (settings are namespaced per plugin)
 bool asp_plugin_settings_get_string(plugin_context_t* ctx, const char* key,
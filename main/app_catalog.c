@@ -0,0 +1,486 @@
+#include "app_catalog.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "bsp/device.h"
+#include "esp_log.h"
+#include "fastopen.h"
+#include "pax_gfx.h"
+#include "pax_types.h"
+#include "sys/unistd.h"
+
+static const char* TAG = "App catalog";
+
+#ifndef CATALOG_PATH  // The host benchmark keeps the catalog in its build directory
+#define CATALOG_PATH      "/int/app_catalog.bin"
+#define CATALOG_TEMP_PATH "/int/app_catalog.tmp"
+#endif
+
+#define CATALOG_MAGIC         0x54434154  // "TCAT"
+#define CATALOG_VERSION       2
+#define CATALOG_DEVICE_LENGTH 32
+#define CATALOG_STRING_NULL   0xFFFF
+#define CATALOG_NO_TIME       (-1)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    char     device[CATALOG_DEVICE_LENGTH];
+} app_catalog_header_t;
+
+typedef struct {
+    app_t*   app;  // Template copy, cloned for every hit
+    int64_t  dir_mtime;
+    int64_t  metadata_mtime;
+    uint32_t metadata_size;
+    int64_t  icon_mtime;
+    uint32_t icon_size;
+    bool     seen;
+} app_catalog_entry_t;
+
+static app_catalog_entry_t* entries          = NULL;
+static size_t               entries_count    = 0;
+static size_t               entries_capacity = 0;
+static bool                 loaded           = false;
+static bool                 dirty            = false;
+static app_catalog_stats_t  stats            = {0};
+
+// Helpers
+
+static char* strdup_or_null(const char* value) {
+    return (value != NULL) ? strdup(value) : NULL;
+}
+
+static void stat_or_empty(const char* path, int64_t* out_mtime, uint32_t* out_size) {
+    struct stat st;
+    if (path != NULL && stat(path, &st) == 0) {
+        *out_mtime = (int64_t)st.st_mtime;
+        if (out_size != NULL) *out_size = (uint32_t)st.st_size;
+    } else {
+        *out_mtime = CATALOG_NO_TIME;
+        if (out_size != NULL) *out_size = 0;
+    }
+}
+
+static void stat_app(const char* path, const char* slug, const char* icon_path, app_catalog_entry_t* out_entry) {
+    char path_buffer[256] = {0};
+    snprintf(path_buffer, sizeof(path_buffer), "%s/%s", path, slug);
+    stat_or_empty(path_buffer, &out_entry->dir_mtime, NULL);
+    snprintf(path_buffer, sizeof(path_buffer), "%s/%s/metadata.json", path, slug);
+    stat_or_empty(path_buffer, &out_entry->metadata_mtime, &out_entry->metadata_size);
+    stat_or_empty(icon_path, &out_entry->icon_mtime, &out_entry->icon_size);
+}
+
+static pax_buf_t* create_icon(uint16_t width, uint16_t height) {
+    pax_buf_t* icon = calloc(1, sizeof(pax_buf_t));
+    if (icon == NULL) return NULL;
+    pax_buf_init(icon, NULL, width, height, PAX_BUF_32_8888ARGB);
+    if (pax_buf_get_pixels(icon) == NULL) {
+        free(icon);
+        return NULL;
+    }
+    return icon;
+}
+
+static app_t* clone_app(const app_t* src) {
+    app_t* app = calloc(1, sizeof(app_t));
+    if (app == NULL) return NULL;
+    app->path         = strdup_or_null(src->path);
+    app->slug         = strdup_or_null(src->slug);
+    app->name         = strdup_or_null(src->name);
+    app->description  = strdup_or_null(src->description);
+    app->version      = strdup_or_null(src->version);
+    app->author       = strdup_or_null(src->author);
+    app->license_type = strdup_or_null(src->license_type);
+    app->license_file = strdup_or_null(src->license_file);
+    app->repository   = strdup_or_null(src->repository);
+    app->icon_path    = strdup_or_null(src->icon_path);
+    for (int i = 0; i < APP_MAX_NUM_CATEGORIES; i++) {
+        app->categories[i] = strdup_or_null(src->categories[i]);
+    }
+    app->executable_type             = src->executable_type;
+    app->executable_revision         = src->executable_revision;
+    app->executable_filename         = strdup_or_null(src->executable_filename);
+    app->executable_interpreter_slug = strdup_or_null(src->executable_interpreter_slug);
+    app->executable_appfs_fd         = APPFS_INVALID_FD;
+
+    if (src->icon != NULL) {
+        uint16_t width  = pax_buf_get_width(src->icon);
+        uint16_t height = pax_buf_get_height(src->icon);
+        app->icon       = create_icon(width, height);
+        if (app->icon != NULL) {
+            memcpy(pax_buf_get_pixels_rw(app->icon), pax_buf_get_pixels(src->icon), (size_t)width * height * 4);
+        }
+    }
+    return app;
+}
+
+static void remove_entry(size_t index) {
+    free_app(entries[index].app);
+    entries[index] = entries[entries_count - 1];
+    entries_count--;
+    dirty = true;
+}
+
+static app_catalog_entry_t* find_entry(const char* path, const char* slug, size_t* out_index) {
+    for (size_t i = 0; i < entries_count; i++) {
+        app_t* app = entries[i].app;
+        if (strcmp(app->slug, slug) == 0 && strcmp(app->path, path) == 0) {
+            if (out_index != NULL) *out_index = i;
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+static app_catalog_entry_t* append_entry(void) {
+    if (entries_count >= entries_capacity) {
+        size_t               new_capacity = (entries_capacity > 0) ? entries_capacity * 2 : 32;
+        app_catalog_entry_t* new_entries  = realloc(entries, new_capacity * sizeof(app_catalog_entry_t));
+        if (new_entries == NULL) return NULL;
+        entries          = new_entries;
+        entries_capacity = new_capacity;
+    }
+    app_catalog_entry_t* entry = &entries[entries_count++];
+    memset(entry, 0, sizeof(app_catalog_entry_t));
+    return entry;
+}
+
+static void clear_entries(void) {
+    for (size_t i = 0; i < entries_count; i++) {
+        free_app(entries[i].app);
+    }
+    free(entries);
+    entries          = NULL;
+    entries_count    = 0;
+    entries_capacity = 0;
+}
+
+// Serialization
+
+static bool write_value(FILE* fd, const void* value, size_t size) {
+    return fwrite(value, size, 1, fd) == 1;
+}
+
+static bool read_value(FILE* fd, void* value, size_t size) {
+    return fread(value, size, 1, fd) == 1;
+}
+
+static bool write_string(FILE* fd, const char* value) {
+    uint16_t length = (value != NULL) ? (uint16_t)strnlen(value, CATALOG_STRING_NULL - 1) : CATALOG_STRING_NULL;
+    if (!write_value(fd, &length, sizeof(length))) return false;
+    return (length == CATALOG_STRING_NULL || length == 0) ? true : write_value(fd, value, length);
+}
+
+static bool read_string(FILE* fd, char** out_value) {
+    uint16_t length = 0;
+    if (!read_value(fd, &length, sizeof(length))) return false;
+    if (length == CATALOG_STRING_NULL) {
+        *out_value = NULL;
+        return true;
+    }
+    *out_value = malloc(length + 1);
+    if (*out_value == NULL) return false;
+    if (length > 0 && !read_value(fd, *out_value, length)) {
+        free(*out_value);
+        *out_value = NULL;
+        return false;
+    }
+    (*out_value)[length] = '\0';
+    return true;
+}
+
+static bool write_entry(FILE* fd, const app_catalog_entry_t* entry) {
+    const app_t* app = entry->app;
+    bool         ok  = true;
+    ok &= write_string(fd, app->path);
+    ok &= write_string(fd, app->slug);
+    ok &= write_string(fd, app->name);
+    ok &= write_string(fd, app->description);
+    for (int i = 0; i < APP_MAX_NUM_CATEGORIES; i++) {
+        ok &= write_string(fd, app->categories[i]);
+    }
+    ok &= write_string(fd, app->version);
+    ok &= write_string(fd, app->author);
+    ok &= write_string(fd, app->license_type);
+    ok &= write_string(fd, app->license_file);
+    ok &= write_string(fd, app->repository);
+    ok &= write_string(fd, app->icon_path);
+    ok &= write_string(fd, app->executable_filename);
+    ok &= write_string(fd, app->executable_interpreter_slug);
+
+    uint8_t executable_type = (uint8_t)app->executable_type;
+    ok &= write_value(fd, &executable_type, sizeof(executable_type));
+    ok &= write_value(fd, &app->executable_revision, sizeof(app->executable_revision));
+    ok &= write_value(fd, &entry->dir_mtime, sizeof(entry->dir_mtime));
+    ok &= write_value(fd, &entry->metadata_mtime, sizeof(entry->metadata_mtime));
+    ok &= write_value(fd, &entry->metadata_size, sizeof(entry->metadata_size));
+    ok &= write_value(fd, &entry->icon_mtime, sizeof(entry->icon_mtime));
+    ok &= write_value(fd, &entry->icon_size, sizeof(entry->icon_size));
+
+    // Decoded icon pixels, so a catalog hit needs no PNG decoding
+    uint16_t width  = (app->icon != NULL) ? pax_buf_get_width(app->icon) : 0;
+    uint16_t height = (app->icon != NULL) ? pax_buf_get_height(app->icon) : 0;
+    ok &= write_value(fd, &width, sizeof(width));
+    ok &= write_value(fd, &height, sizeof(height));
+    if (width > 0 && height > 0) {
+        ok &= write_value(fd, pax_buf_get_pixels(app->icon), (size_t)width * height * 4);
+    }
+    return ok;
+}
+
+static bool read_entry(FILE* fd, app_catalog_entry_t* entry) {
+    app_t* app = calloc(1, sizeof(app_t));
+    if (app == NULL) return false;
+    entry->app = app;
+
+    bool ok = read_string(fd, &app->path);
+    ok = ok && read_string(fd, &app->slug);
+    ok = ok && read_string(fd, &app->name);
+    ok = ok && read_string(fd, &app->description);
+    for (int i = 0; i < APP_MAX_NUM_CATEGORIES; i++) {
+        ok = ok && read_string(fd, &app->categories[i]);
+    }
+    ok = ok && read_string(fd, &app->version);
+    ok = ok && read_string(fd, &app->author);
+    ok = ok && read_string(fd, &app->license_type);
+    ok = ok && read_string(fd, &app->license_file);
+    ok = ok && read_string(fd, &app->repository);
+    ok = ok && read_string(fd, &app->icon_path);
+    ok = ok && read_string(fd, &app->executable_filename);
+    ok = ok && read_string(fd, &app->executable_interpreter_slug);
+
+    uint8_t executable_type = 0;
+    ok = ok && read_value(fd, &executable_type, sizeof(executable_type));
+    ok = ok && read_value(fd, &app->executable_revision, sizeof(app->executable_revision));
+    ok = ok && read_value(fd, &entry->dir_mtime, sizeof(entry->dir_mtime));
+    ok = ok && read_value(fd, &entry->metadata_mtime, sizeof(entry->metadata_mtime));
+    ok = ok && read_value(fd, &entry->metadata_size, sizeof(entry->metadata_size));
+    ok = ok && read_value(fd, &entry->icon_mtime, sizeof(entry->icon_mtime));
+    ok = ok && read_value(fd, &entry->icon_size, sizeof(entry->icon_size));
+
+    app->executable_type     = (executable_type_t)executable_type;
+    app->executable_appfs_fd = APPFS_INVALID_FD;
+
+    uint16_t width  = 0;
+    uint16_t height = 0;
+    ok = ok && read_value(fd, &width, sizeof(width));
+    ok = ok && read_value(fd, &height, sizeof(height));
+    if (ok && width > 0 && height > 0) {
+        app->icon = create_icon(width, height);
+        ok        = (app->icon != NULL) && read_value(fd, pax_buf_get_pixels_rw(app->icon), (size_t)width * height * 4);
+    }
+
+    if (!ok || app->path == NULL || app->slug == NULL) {
+        free_app(app);
+        entry->app = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void load_catalog(void) {
+    loaded = true;
+
+    FILE* fd = fastopen(CATALOG_PATH, "rb");
+    if (fd == NULL) {
+        ESP_LOGI(TAG, "No app catalog found, a full scan will be performed");
+        return;
+    }
+
+    char device_name[CATALOG_DEVICE_LENGTH] = {0};
+    bsp_device_get_name(device_name, sizeof(device_name));
+
+    app_catalog_header_t header = {0};
+    if (!read_value(fd, &header, sizeof(header)) || header.magic != CATALOG_MAGIC ||
+        header.version != CATALOG_VERSION || strncmp(header.device, device_name, CATALOG_DEVICE_LENGTH) != 0) {
+        fastclose(fd);
+        ESP_LOGW(TAG, "App catalog is invalid or outdated, discarding");
+        dirty = true;
+        return;
+    }
+
+    for (uint16_t i = 0; i < header.count; i++) {
+        app_catalog_entry_t* entry = append_entry();
+        if (entry == NULL || !read_entry(fd, entry)) {
+            ESP_LOGW(TAG, "App catalog is truncated or corrupt, discarding");
+            if (entry != NULL) entries_count--;
+            clear_entries();
+            dirty = true;
+            break;
+        }
+    }
+
+    fastclose(fd);
+    ESP_LOGI(TAG, "Loaded %u records from app catalog", entries_count);
+}
+
+static esp_err_t save_catalog(void) {
+    FILE* fd = fastopen(CATALOG_TEMP_PATH, "wb");
+    if (fd == NULL) {
+        ESP_LOGE(TAG, "Failed to open app catalog for writing");
+        return ESP_FAIL;
+    }
+
+    app_catalog_header_t header = {
+        .magic   = CATALOG_MAGIC,
+        .version = CATALOG_VERSION,
+        .count   = (uint16_t)entries_count,
+    };
+    bsp_device_get_name(header.device, sizeof(header.device));
+
+    bool ok = write_value(fd, &header, sizeof(header));
+    for (size_t i = 0; ok && i < entries_count; i++) {
+        ok = write_entry(fd, &entries[i]);
+    }
+    fastclose(fd);
+
+    if (!ok) {
+        remove(CATALOG_TEMP_PATH);
+        ESP_LOGE(TAG, "Failed to write app catalog");
+        return ESP_FAIL;
+    }
+
+    // FAT can not rename over an existing file
+    remove(CATALOG_PATH);
+    if (rename(CATALOG_TEMP_PATH, CATALOG_PATH) != 0) {
+        ESP_LOGE(TAG, "Failed to replace app catalog");
+        return ESP_FAIL;
+    }
+
+    dirty = false;
+    return ESP_OK;
+}
+
+// Public API
+
+void app_catalog_begin_scan(void) {
+    if (!loaded) {
+        load_catalog();
+    }
+    for (size_t i = 0; i < entries_count; i++) {
+        entries[i].seen = false;
+    }
+    stats.hits   = 0;
+    stats.misses = 0;
+}
+
+esp_err_t app_catalog_end_scan(void) {
+    // Drop records for apps that were not found during this scan
+    for (size_t i = 0; i < entries_count;) {
+        if (!entries[i].seen) {
+            remove_entry(i);
+        } else {
+            i++;
+        }
+    }
+    stats.records = entries_count;
+    return dirty ? save_catalog() : ESP_OK;
+}
+
+app_t* app_catalog_get(const char* path, const char* slug) {
+    size_t               index = 0;
+    app_catalog_entry_t* entry = find_entry(path, slug, &index);
+    if (entry == NULL) {
+        stats.misses++;
+        return NULL;
+    }
+
+    app_catalog_entry_t current = {0};
+    stat_app(path, slug, entry->app->icon_path, &current);
+    if (current.dir_mtime != entry->dir_mtime || current.metadata_mtime != entry->metadata_mtime ||
+        current.metadata_size != entry->metadata_size || current.icon_mtime != entry->icon_mtime ||
+        current.icon_size != entry->icon_size) {
+        ESP_LOGI(TAG, "App %s/%s changed, parsing metadata again", path, slug);
+        remove_entry(index);
+        stats.misses++;
+        return NULL;
+    }
+
+    app_t* app = clone_app(entry->app);
+    if (app == NULL) {
+        stats.misses++;
+        return NULL;
+    }
+    entry->seen = true;
+    stats.hits++;
+
+    app_set_default_icon(app);
+
+    // AppFS contents and executables on the filesystem change independently of the
+    // metadata, so these are always looked up again
+    if (app->executable_type == EXECUTABLE_TYPE_APPFS || app->executable_type == EXECUTABLE_TYPE_UNKNOWN) {
+        app->executable_appfs_fd = find_appfs_handle_for_slug(app->slug);
+    }
+
+    if (app->executable_type == EXECUTABLE_TYPE_APPFS && app->executable_filename != NULL) {
+        size_t length  = snprintf(NULL, 0, "%s/%s/%s", path, slug, app->executable_filename);
+        char*  fs_path = malloc(length + 1);
+        if (fs_path != NULL) {
+            snprintf(fs_path, length + 1, "%s/%s/%s", path, slug, app->executable_filename);
+            struct stat fs_stat;
+            if (stat(fs_path, &fs_stat) == 0) {
+                app->executable_on_fs_filename  = fs_path;
+                app->executable_on_fs_revision  = app->executable_revision;
+                app->executable_on_fs_filesize  = (int)fs_stat.st_size;
+                app->executable_on_fs_available = true;
+            } else {
+                free(fs_path);
+            }
+        }
+    }
+
+    return app;
+}
+
+void app_catalog_put(const app_t* app) {
+    if (app == NULL || app->path == NULL || app->slug == NULL) {
+        return;
+    }
+
+    size_t               index    = 0;
+    app_catalog_entry_t* existing = find_entry(app->path, app->slug, &index);
+    if (existing != NULL) {
+        remove_entry(index);
+    }
+
+    app_catalog_entry_t* entry = append_entry();
+    if (entry == NULL) {
+        return;
+    }
+
+    stat_app(app->path, app->slug, app->icon_path, entry);
+
+    // Only icons that were decoded from a file are stored, the default icon depends on the theme and is
+    // set when the entry is read
+    entry->app = clone_app(app);
+    if (entry->app == NULL) {
+        entries_count--;
+        return;
+    }
+    entry->seen = true;
+    dirty       = true;
+}
+
+void app_catalog_invalidate(const char* slug) {
+    if (!loaded || slug == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < entries_count;) {
+        if (strcmp(entries[i].app->slug, slug) == 0) {
+            remove_entry(i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void app_catalog_get_stats(app_catalog_stats_t* out_stats) {
+    if (out_stats != NULL) {
+        *out_stats         = stats;
+        out_stats->records = entries_count;
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdbool.h>
+#include "app_metadata_parser.h"
+#include "esp_err.h"
+
+// Persistent index of parsed app metadata, stored on the internal filesystem.
+// Records are keyed by install path and slug and are validated against the
+// modification time and size of the app directory, metadata.json and icon, so
+// only apps that changed since the previous scan have to be parsed again.
+
+typedef struct {
+    size_t hits;     // Apps restored from the catalog
+    size_t misses;   // Apps that had to be parsed from metadata.json
+    size_t records;  // Records currently held in the catalog
+} app_catalog_stats_t;
+
+void      app_catalog_begin_scan(void);
+esp_err_t app_catalog_end_scan(void);
+
+app_t* app_catalog_get(const char* path, const char* slug);
+void   app_catalog_put(const app_t* app);
+void   app_catalog_invalidate(const char* slug);
+
+void app_catalog_get_stats(app_catalog_stats_t* out_stats);
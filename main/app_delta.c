@@ -0,0 +1,334 @@
+#include "app_delta.h"
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_metadata_parser.h"
+#include "appfs.h"
+#include "esp_log.h"
+#include "mbedtls/sha256.h"
+
+static const char* TAG = "App delta";
+
+#define APP_DELTA_BLOCK_SIZE  (32 * 1024)  // Multiple of the flash sector size
+#define APP_DELTA_SECTOR_SIZE 4096
+#define APP_DELTA_SUFFIX      "~delta"  // Name of the AppFS file the new executable is built in
+#define APP_DELTA_OP_COPY     'C'
+#define APP_DELTA_OP_INSERT   'I'
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t old_size;
+    uint32_t new_size;
+    uint32_t reserved;
+    uint8_t  new_sha256[HTTP_SHA256_SIZE];
+} app_delta_header_t;
+
+typedef enum {
+    APP_DELTA_STATE_HEADER = 0,
+    APP_DELTA_STATE_COMMAND,
+    APP_DELTA_STATE_INSERT,
+} app_delta_state_t;
+
+typedef struct {
+    const char*    slug;
+    const char*    name;
+    uint32_t       revision;
+    char           new_slug[APP_MAX_SLUG_SIZE + sizeof(APP_DELTA_SUFFIX)];
+    appfs_handle_t old_fd;
+    size_t         old_size;
+    appfs_handle_t new_fd;
+
+    // Patch parser
+    app_delta_state_t  state;
+    app_delta_header_t header;
+    uint8_t            pending[sizeof(app_delta_header_t)];  // Header or command received so far
+    size_t             pending_length;
+    size_t             insert_remaining;
+    size_t             received;  // Size of the patch
+
+    // Output
+    uint8_t*               block;   // New data waiting to be written to flash
+    size_t                 length;  // Amount of data in block
+    size_t                 written;
+    mbedtls_sha256_context sha256;
+    bool                   complete;  // The new executable was built and matched its digest
+    esp_err_t              error;
+} app_delta_t;
+
+static bool app_delta_fail(app_delta_t* delta, esp_err_t error, const char* message) {
+    if (delta->error == ESP_OK) {
+        ESP_LOGE(TAG, "%s (%s)", message, delta->slug);
+        delta->error = error;
+    }
+    return false;
+}
+
+static bool app_delta_flush(app_delta_t* delta) {
+    if (delta->length == 0) return true;
+    size_t erase_length = (delta->length + (APP_DELTA_SECTOR_SIZE - 1)) & (~(APP_DELTA_SECTOR_SIZE - 1));
+    if (appfsErase(delta->new_fd, delta->written, erase_length) != ESP_OK ||
+        appfsWrite(delta->new_fd, delta->written, delta->block, delta->length) != ESP_OK) {
+        return app_delta_fail(delta, ESP_FAIL, "Failed to write patched executable");
+    }
+    delta->written += delta->length;
+    delta->length   = 0;
+    return true;
+}
+
+// Reserves room for length bytes of new data in the block, returns the amount that fits
+static size_t app_delta_reserve(app_delta_t* delta, size_t length) {
+    if (delta->length == APP_DELTA_BLOCK_SIZE && !app_delta_flush(delta)) return 0;
+    size_t available = APP_DELTA_BLOCK_SIZE - delta->length;
+    return (length < available) ? length : available;
+}
+
+static bool app_delta_check_output(app_delta_t* delta, size_t length) {
+    if (length > delta->header.new_size - (delta->written + delta->length)) {
+        return app_delta_fail(delta, ESP_ERR_INVALID_RESPONSE, "Patch produces more data than announced");
+    }
+    return true;
+}
+
+static bool app_delta_insert(app_delta_t* delta, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        size_t chunk = app_delta_reserve(delta, length);
+        if (chunk == 0) return false;
+        memcpy(&delta->block[delta->length], data, chunk);
+        mbedtls_sha256_update(&delta->sha256, data, chunk);
+        delta->length += chunk;
+        data          += chunk;
+        length        -= chunk;
+    }
+    return true;
+}
+
+static bool app_delta_copy(app_delta_t* delta, uint32_t offset, uint32_t length) {
+    // Written so it cannot wrap around, size_t is 32 bits wide on the device
+    if (offset > delta->old_size || length > delta->old_size - offset) {
+        return app_delta_fail(delta, ESP_ERR_INVALID_RESPONSE, "Patch copies beyond the old executable");
+    }
+    if (!app_delta_check_output(delta, length)) return false;
+
+    while (length > 0) {
+        size_t chunk = app_delta_reserve(delta, length);
+        if (chunk == 0) return false;
+        uint8_t* destination = &delta->block[delta->length];
+        if (appfsRead(delta->old_fd, offset, destination, chunk) != ESP_OK) {
+            return app_delta_fail(delta, ESP_FAIL, "Failed to read old executable");
+        }
+        mbedtls_sha256_update(&delta->sha256, destination, chunk);
+        delta->length += chunk;
+        offset        += chunk;
+        length        -= chunk;
+    }
+    return true;
+}
+
+static bool app_delta_start(app_delta_t* delta) {
+    memcpy(&delta->header, delta->pending, sizeof(app_delta_header_t));
+    if (delta->header.magic != APP_DELTA_MAGIC) {
+        return app_delta_fail(delta, ESP_ERR_INVALID_RESPONSE, "Not a delta patch");
+    }
+    if (delta->header.old_size != delta->old_size) {
+        return app_delta_fail(delta, ESP_ERR_INVALID_STATE, "Patch does not apply to the installed executable");
+    }
+    if (delta->header.new_size == 0) {
+        return app_delta_fail(delta, ESP_ERR_INVALID_RESPONSE, "Patch produces an empty executable");
+    }
+
+    // The old executable stays in place until the new one is complete, both have to fit
+    size_t rounded_size = (delta->header.new_size + (SPI_FLASH_MMU_PAGE_SIZE - 1)) & (~(SPI_FLASH_MMU_PAGE_SIZE - 1));
+    if (appfsGetFreeMem() < rounded_size) {
+        return app_delta_fail(delta, ESP_ERR_NO_MEM, "Not enough space in AppFS for the patched executable");
+    }
+    if (appfsCreateFileExt(delta->new_slug, delta->name, delta->revision, delta->header.new_size, &delta->new_fd) !=
+        ESP_OK) {
+        delta->new_fd = APPFS_INVALID_FD;
+        return app_delta_fail(delta, ESP_FAIL, "Failed to create AppFS file for the patched executable");
+    }
+
+    if (delta->block == NULL) {
+        delta->block = malloc(APP_DELTA_BLOCK_SIZE);
+    }
+    if (delta->block == NULL) {
+        return app_delta_fail(delta, ESP_ERR_NO_MEM, "Failed to allocate patch buffer");
+    }
+    mbedtls_sha256_starts(&delta->sha256, 0);
+    return true;
+}
+
+// Executes a complete command, collected in the pending buffer
+static bool app_delta_command(app_delta_t* delta) {
+    uint32_t value_a;
+    uint32_t value_b;
+    memcpy(&value_a, &delta->pending[1], sizeof(uint32_t));
+    if (delta->pending[0] == APP_DELTA_OP_COPY) {
+        memcpy(&value_b, &delta->pending[5], sizeof(uint32_t));
+        return app_delta_copy(delta, value_a, value_b);
+    }
+    if (!app_delta_check_output(delta, value_a)) return false;
+    delta->insert_remaining = value_a;
+    delta->state            = APP_DELTA_STATE_INSERT;
+    return true;
+}
+
+static size_t app_delta_command_size(uint8_t op) {
+    switch (op) {
+        case APP_DELTA_OP_COPY:
+            return 1 + 2 * sizeof(uint32_t);
+        case APP_DELTA_OP_INSERT:
+            return 1 + sizeof(uint32_t);
+        default:
+            return 0;
+    }
+}
+
+// Called for every attempt of the download, a retry starts over with a new AppFS file
+static bool app_delta_sink_begin(size_t size, void* arg) {
+    app_delta_t* delta = (app_delta_t*)arg;
+    if (delta->new_fd != APPFS_INVALID_FD) {
+        appfsDeleteFile(delta->new_slug);
+        delta->new_fd = APPFS_INVALID_FD;
+    }
+    delta->state            = APP_DELTA_STATE_HEADER;
+    delta->pending_length   = 0;
+    delta->insert_remaining = 0;
+    delta->received         = 0;
+    delta->length           = 0;
+    delta->written          = 0;
+    return true;
+}
+
+static bool app_delta_sink_write(const uint8_t* data, size_t length, size_t offset, void* arg) {
+    app_delta_t* delta = (app_delta_t*)arg;
+
+    delta->received += length;
+
+    while (length > 0 && delta->error == ESP_OK) {
+        if (delta->state == APP_DELTA_STATE_INSERT) {
+            size_t chunk = (length < delta->insert_remaining) ? length : delta->insert_remaining;
+            if (!app_delta_insert(delta, data, chunk)) return false;
+            delta->insert_remaining -= chunk;
+            data                    += chunk;
+            length                  -= chunk;
+            if (delta->insert_remaining == 0) {
+                delta->state = APP_DELTA_STATE_COMMAND;
+            }
+            continue;
+        }
+
+        size_t required = sizeof(app_delta_header_t);
+        if (delta->state == APP_DELTA_STATE_COMMAND) {
+            required = app_delta_command_size(delta->pending_length > 0 ? delta->pending[0] : data[0]);
+            if (required == 0) {
+                return app_delta_fail(delta, ESP_ERR_INVALID_RESPONSE, "Unknown patch command");
+            }
+        }
+
+        size_t chunk = required - delta->pending_length;
+        if (chunk > length) {
+            chunk = length;
+        }
+        memcpy(&delta->pending[delta->pending_length], data, chunk);
+        delta->pending_length += chunk;
+        data                  += chunk;
+        length                -= chunk;
+        if (delta->pending_length < required) {
+            break;
+        }
+
+        delta->pending_length = 0;
+        if (delta->state == APP_DELTA_STATE_HEADER) {
+            if (!app_delta_start(delta)) return false;
+            delta->state = APP_DELTA_STATE_COMMAND;
+        } else if (!app_delta_command(delta)) {
+            return false;
+        }
+    }
+    return delta->error == ESP_OK;
+}
+
+static bool app_delta_sink_end(bool success, void* arg) {
+    app_delta_t* delta = (app_delta_t*)arg;
+    if (delta->error != ESP_OK) {
+        return false;
+    }
+    if (!success) {
+        return true;  // The attempt failed in transfer, the next one starts over in app_delta_sink_begin
+    }
+    if (delta->state != APP_DELTA_STATE_COMMAND || delta->pending_length != 0 || !app_delta_flush(delta)) {
+        return app_delta_fail(delta, ESP_ERR_INVALID_RESPONSE, "Patch ended in the middle of a command");
+    }
+    if (delta->written != delta->header.new_size) {
+        return app_delta_fail(delta, ESP_ERR_INVALID_RESPONSE, "Patch produced less data than announced");
+    }
+
+    uint8_t digest[HTTP_SHA256_SIZE];
+    mbedtls_sha256_finish(&delta->sha256, digest);
+    if (memcmp(digest, delta->header.new_sha256, HTTP_SHA256_SIZE) != 0) {
+        return app_delta_fail(delta, ESP_ERR_INVALID_CRC, "Patched executable does not match its digest");
+    }
+    delta->complete = true;
+    return true;
+}
+
+esp_err_t app_delta_install_from_http(http_session_t session, const char* url, const char* slug, const char* name,
+                                      uint32_t revision) {
+    if (session == NULL || url == NULL || slug == NULL || name == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    app_delta_t delta = {
+        .slug     = slug,
+        .name     = name,
+        .revision = revision,
+        .old_fd   = appfsOpen(slug),
+        .new_fd   = APPFS_INVALID_FD,
+        .state    = APP_DELTA_STATE_HEADER,
+        .error    = ESP_OK,
+    };
+    if (delta.old_fd == APPFS_INVALID_FD) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    int old_size = 0;
+    appfsEntryInfoExt(delta.old_fd, NULL, NULL, NULL, &old_size);
+    delta.old_size = (old_size > 0) ? old_size : 0;
+
+    snprintf(delta.new_slug, sizeof(delta.new_slug), "%s" APP_DELTA_SUFFIX, slug);
+    if (appfsExists(delta.new_slug)) {
+        appfsDeleteFile(delta.new_slug);  // Left behind by an interrupted update
+    }
+    mbedtls_sha256_init(&delta.sha256);
+
+    http_stream_sink_t sink = {
+        .begin = app_delta_sink_begin,
+        .write = app_delta_sink_write,
+        .end   = app_delta_sink_end,
+        .arg   = &delta,
+    };
+    // The sink is not started for an empty response, only a completed sink means the patch was applied
+    bool applied = http_session_download_stream(session, url, &sink) && delta.complete;
+    mbedtls_sha256_free(&delta.sha256);
+    free(delta.block);
+
+    esp_err_t res = ESP_OK;
+    if (!applied) {
+        res = (delta.error != ESP_OK) ? delta.error : ESP_FAIL;
+    } else if (appfsDeleteFile(slug) != ESP_OK || appfsRename(delta.new_slug, slug) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to replace the executable of %s", slug);
+        res = ESP_FAIL;
+    }
+
+    if (res != ESP_OK) {
+        if (appfsExists(delta.new_slug)) {
+            appfsDeleteFile(delta.new_slug);
+        }
+        return res;
+    }
+
+    ESP_LOGI(TAG, "Updated %s to revision %" PRIu32 " with a %u byte patch for a %u byte executable", slug, revision,
+             delta.received, delta.written);
+    return ESP_OK;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "http_download.h"
+
+// Delta updates of AppFS executables. A patch rebuilds a new revision of an executable from the revision that is
+// already in AppFS, so an update only downloads the parts that changed. The patch is applied while it downloads:
+// copied ranges are read from the old AppFS file and inserted data is taken from the patch, and the result is
+// written into a new AppFS file one block at a time. The old file is replaced only after the SHA-256 of the result
+// matched the digest in the patch.
+//
+// Patch format, all integers little endian:
+//   header:  uint32 magic "ADLT", uint32 old size, uint32 new size, uint32 reserved (0), uint8[32] SHA-256 of the
+//            new executable
+//   copy:    'C', uint32 offset in the old executable, uint32 length
+//   insert:  'I', uint32 length, followed by length bytes of new data
+// Commands follow the header until the new executable is complete. tools/app_delta.py creates patches.
+
+#define APP_DELTA_MAGIC 0x544C4441  // "ADLT"
+
+// Applies the patch at url to the AppFS executable of slug. On failure the installed executable is left untouched.
+esp_err_t app_delta_install_from_http(http_session_t session, const char* url, const char* slug, const char* name,
+                                      uint32_t revision);
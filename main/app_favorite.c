@@ -75,6 +75,26 @@ bool app_favorite_get(const char* slug) {
     return found;
 }
 
+size_t app_favorite_get_all(char (*out_slugs)[APP_MAX_SLUG_SIZE], size_t max_slugs) {
+    if (out_slugs == NULL) {
+        return 0;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t    res = nvs_open(NAMESPACE, NVS_READONLY, &handle);
+    if (res != ESP_OK) {
+        return 0;
+    }
+
+    size_t count = 0;
+    while (count < max_slugs && read_entry(handle, count, out_slugs[count]) == ESP_OK) {
+        count++;
+    }
+
+    nvs_close(handle);
+    return count;
+}
+
 void app_favorite_set(const char* slug, bool favorite) {
     if (slug == NULL || slug[0] == '\0') {
         return;
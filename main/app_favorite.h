@@ -1,10 +1,15 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
+#include "app_metadata_parser.h"
 #include "esp_err.h"
 
-bool app_favorite_get(const char* slug);
-void app_favorite_set(const char* slug, bool favorite);
+#define APP_MAX_FAVORITES 128
+
+bool   app_favorite_get(const char* slug);
+size_t app_favorite_get_all(char (*out_slugs)[APP_MAX_SLUG_SIZE], size_t max_slugs);
+void   app_favorite_set(const char* slug, bool favorite);
 
 esp_err_t app_autostart_get(char* out_slug);
 esp_err_t app_autostart_set(const char* slug);
@@ -2,17 +2,24 @@
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include "app_catalog.h"
+#include "app_delta.h"
 #include "app_metadata_parser.h"
 #include "app_usage.h"
 #include "appfs.h"
 #include "appfs_settings.h"
 #include "bsp/device.h"
 #include "cJSON.h"
+#include "download_pool.h"
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_vfs_fat.h"
 #include "fastopen.h"
 #include "filesystem_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "http_download.h"
 #ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
 #include "plugin_manager.h"
@@ -21,6 +28,8 @@
 
 static const char* TAG = "App management";
 
+static esp_err_t app_mgmt_remove(const char* slug, app_mgmt_location_t location, bool keep_appfs);
+
 static const char* app_mgmt_location_to_path(app_mgmt_location_t location) {
     switch (location) {
         case APP_MGMT_LOCATION_INTERNAL:
@@ -40,6 +49,58 @@ static bool app_mgmt_location_is_plugin(app_mgmt_location_t location) {
     return location == APP_MGMT_LOCATION_INTERNAL_PLUGINS || location == APP_MGMT_LOCATION_SD_PLUGINS;
 }
 
+// Optional SHA-256 digest of a file, published by the repository as a hexadecimal string. Sets out_expected to
+// out_digest when the digest is present and to NULL when it is not. Returns false when the digest is malformed.
+static bool app_mgmt_get_sha256(cJSON* object, const char* key, uint8_t* out_digest, const uint8_t** out_expected) {
+    *out_expected = NULL;
+    cJSON* sha256 = cJSON_GetObjectItem(object, key);
+    if (sha256 == NULL) {
+        return true;
+    }
+    if (!cJSON_IsString(sha256) || !http_sha256_from_hex(sha256->valuestring, out_digest)) {
+        return false;
+    }
+    *out_expected = out_digest;
+    return true;
+}
+
+// Finds a delta patch in the application metadata that updates the AppFS executable installed for slug. The
+// revision in the installed metadata and the revision of the AppFS file both have to match the patch.
+static cJSON* app_mgmt_find_delta(const char* base_path, const char* slug, cJSON* application) {
+    cJSON* deltas = cJSON_GetObjectItem(application, "executable_deltas");
+    if (deltas == NULL || !cJSON_IsArray(deltas) || !appfsExists(slug)) {
+        return NULL;
+    }
+
+    uint32_t installed_revision = 0;
+    char*    exec_path          = NULL;
+    if (!get_executable_revision(base_path, slug, &installed_revision, &exec_path)) {
+        return NULL;
+    }
+    free(exec_path);
+
+    uint16_t       appfs_revision = 0;
+    appfs_handle_t appfs_fd       = appfsOpen(slug);
+    if (appfs_fd == APPFS_INVALID_FD) {
+        return NULL;
+    }
+    appfsEntryInfoExt(appfs_fd, NULL, NULL, &appfs_revision, NULL);
+    if (appfs_revision != (uint16_t)installed_revision) {
+        return NULL;
+    }
+
+    cJSON* delta = NULL;
+    cJSON_ArrayForEach(delta, deltas) {
+        cJSON* from_revision = cJSON_GetObjectItem(delta, "from_revision");
+        cJSON* file          = cJSON_GetObjectItem(delta, "file");
+        if (from_revision != NULL && cJSON_IsNumber(from_revision) && file != NULL && cJSON_IsString(file) &&
+            (uint32_t)from_revision->valueint == installed_revision) {
+            return delta;
+        }
+    }
+    return NULL;
+}
+
 esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgmt_location_t location,
                            download_callback_t download_callback) {
     if (strlen(slug) < 1) {
@@ -135,9 +196,18 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
     char app_path[256] = {0};
     snprintf(app_path, sizeof(app_path), "%s/%s", base_path, slug);
 
+    // An AppFS executable that is already installed can be updated with a delta patch instead of downloading it
+    // again. It is kept while the previous installation is removed, the patch is applied to it further down.
+    cJSON* delta            = NULL;
+    cJSON* application_type = cJSON_GetObjectItem(application, "type");
+    if (location == APP_MGMT_LOCATION_INTERNAL && application_type != NULL && cJSON_IsString(application_type) &&
+        strcmp(application_type->valuestring, "appfs") == 0) {
+        delta = app_mgmt_find_delta(base_path, slug, application);
+    }
+
     // Remove app folder if it already exists
     if (fs_utils_exists(app_path)) {
-        esp_err_t uninstall_res = app_mgmt_uninstall(slug, location);
+        esp_err_t uninstall_res = app_mgmt_remove(slug, location, delta != NULL);
         if (uninstall_res != ESP_OK) {
             free_repository_data_json(&metadata);
             free_repository_data_json(&information);
@@ -167,18 +237,15 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
     fwrite(metadata.data, 1, metadata.size, fd);
     fastclose(fd);
 
-    // Create a download session for all file downloads (reuses TCP/TLS connection)
-    char base_data_url[256] = {0};
-    snprintf(base_data_url, sizeof(base_data_url), "%s/%s/%s", repository_url, repository_data_url, slug);
-    http_session_t session = http_session_begin(base_data_url);
-    if (session == NULL) {
+    // Assets, icons and executables stored as a plain file are collected first and then fetched concurrently
+    download_pool_t pool = download_pool_create();
+    if (pool == NULL) {
         free_repository_data_json(&metadata);
         free_repository_data_json(&information);
         app_mgmt_uninstall(slug, location);
-        ESP_LOGE(TAG, "Failed to create HTTP session");
-        return ESP_FAIL;
+        ESP_LOGE(TAG, "Failed to create download pool");
+        return ESP_ERR_NO_MEM;
     }
-    http_session_set_callback(session, download_callback, NULL);
 
     // Install assets
     cJSON* assets = cJSON_GetObjectItem(application, "assets");
@@ -186,7 +253,7 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
         cJSON* asset = NULL;
         cJSON_ArrayForEach(asset, assets) {
             if (asset == NULL || !cJSON_IsObject(asset)) {
-                http_session_end(session);
+                download_pool_free(pool);
                 free_repository_data_json(&metadata);
                 free_repository_data_json(&information);
                 app_mgmt_uninstall(slug, location);
@@ -197,7 +264,7 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
             cJSON* target_file = cJSON_GetObjectItem(asset, "target_file");
             if (source_file == NULL || target_file == NULL || !cJSON_IsString(source_file) ||
                 !cJSON_IsString(target_file)) {
-                http_session_end(session);
+                download_pool_free(pool);
                 free_repository_data_json(&metadata);
                 free_repository_data_json(&information);
                 app_mgmt_uninstall(slug, location);
@@ -205,6 +272,17 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
                 return ESP_ERR_INVALID_RESPONSE;
             }
 
+            uint8_t        asset_digest[HTTP_SHA256_SIZE];
+            const uint8_t* asset_sha256 = NULL;
+            if (!app_mgmt_get_sha256(asset, "sha256", asset_digest, &asset_sha256)) {
+                download_pool_free(pool);
+                free_repository_data_json(&metadata);
+                free_repository_data_json(&information);
+                app_mgmt_uninstall(slug, location);
+                ESP_LOGE(TAG, "Invalid SHA-256 digest for asset: %s", source_file->valuestring);
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+
             char file_url[256] = {0};
             snprintf(file_url, sizeof(file_url), "%s/%s/%s/%s", repository_url, repository_data_url, slug,
                      source_file->valuestring);
@@ -216,19 +294,16 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
             // filename if the target_file value does not contain a dot
             if (fs_utils_mkdir_recursive(target_path, strchr(target_file->valuestring, '.') == NULL) != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to create directories for asset: %s", source_file->valuestring);
-                http_session_end(session);
+                download_pool_free(pool);
                 free_repository_data_json(&metadata);
                 free_repository_data_json(&information);
                 app_mgmt_uninstall(slug, location);
                 return ESP_FAIL;
             }
 
-            char status_text[64] = {0};
-            snprintf(status_text, sizeof(status_text), "Downloading asset '%s'...", target_file->valuestring);
-            http_session_set_callback(session, download_callback, status_text);
-            if (!http_session_download_file(session, file_url, target_path)) {
-                ESP_LOGE(TAG, "Failed to download asset: %s", source_file->valuestring);
-                http_session_end(session);
+            if (!download_pool_add(pool, file_url, target_path, asset_sha256)) {
+                ESP_LOGE(TAG, "Failed to queue asset: %s", source_file->valuestring);
+                download_pool_free(pool);
                 free_repository_data_json(&metadata);
                 free_repository_data_json(&information);
                 app_mgmt_uninstall(slug, location);
@@ -239,9 +314,7 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
         ESP_LOGI(TAG, "No assets found in application metadata");
     }
 
-    // Download icons before the executable. The executable download for /int+appfs
-    // ends with a multi-second AppFS flash write that would otherwise let the
-    // keep-alive TLS session time out before the icons could be fetched.
+    // Icons
     cJSON* icon_obj = cJSON_GetObjectItem(metadata.json, "icon");
     if (icon_obj != NULL && cJSON_IsObject(icon_obj)) {
         const char* icon_keys[] = {"32x32", "64x64"};
@@ -255,12 +328,9 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
                          icon_entry->valuestring);
                 char icon_path[512];
                 snprintf(icon_path, sizeof(icon_path), "%s/%s", app_path, icon_entry->valuestring);
-                char status_text[64] = {0};
-                snprintf(status_text, sizeof(status_text), "Downloading icon '%s'...", icon_entry->valuestring);
-                http_session_set_callback(session, download_callback, status_text);
-                if (!http_session_download_file(session, icon_url, icon_path)) {
-                    ESP_LOGE(TAG, "Failed to download icon %s", icon_keys[i]);
-                    http_session_end(session);
+                if (!download_pool_add(pool, icon_url, icon_path, NULL)) {
+                    ESP_LOGE(TAG, "Failed to queue icon %s", icon_keys[i]);
+                    download_pool_free(pool);
                     free_repository_data_json(&metadata);
                     free_repository_data_json(&information);
                     app_mgmt_uninstall(slug, location);
@@ -285,19 +355,35 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
 
         bool install_to_appfs = (location == APP_MGMT_LOCATION_INTERNAL) && (strcmp(type->valuestring, "appfs") == 0);
 
+        // Verified while the executable downloads, so a corrupted binary is never committed to AppFS or disk
+        uint8_t        executable_digest[HTTP_SHA256_SIZE];
+        const uint8_t* executable_sha256 = NULL;
+        if (!app_mgmt_get_sha256(application, "executable_sha256", executable_digest, &executable_sha256)) {
+            download_pool_free(pool);
+            free_repository_data_json(&metadata);
+            free_repository_data_json(&information);
+            app_mgmt_uninstall(slug, location);
+            ESP_LOGE(TAG, "Invalid SHA-256 digest for executable");
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+
         if (executable != NULL && strlen(executable) > 0) {
             char file_url[256] = {0};
             snprintf(file_url, sizeof(file_url), "%s/%s/%s/%s", repository_url, repository_data_url, slug, executable);
 
-            char status_text[64] = {0};
-            snprintf(status_text, sizeof(status_text), "Downloading executable '%s'...", executable);
-            http_session_set_callback(session, download_callback, status_text);
-
             if (install_to_appfs) {
-                // Clear any stale AppFS entry so a failed download doesn't leave a half-populated one behind.
-                if (appfsExists(slug)) {
-                    appfsDeleteFile(slug);
+                http_session_t session = http_session_begin(file_url);
+                if (session == NULL) {
+                    download_pool_free(pool);
+                    free_repository_data_json(&metadata);
+                    free_repository_data_json(&information);
+                    app_mgmt_uninstall(slug, location);
+                    ESP_LOGE(TAG, "Failed to create HTTP session");
+                    return ESP_FAIL;
                 }
+                char status_text[64] = {0};
+                snprintf(status_text, sizeof(status_text), "Downloading executable '%s'...", executable);
+                http_session_set_callback(session, download_callback, status_text);
 
                 const char* app_name     = (cJSON_GetObjectItem(metadata.json, "name") &&
                                             cJSON_IsString(cJSON_GetObjectItem(metadata.json, "name")))
@@ -309,34 +395,67 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
                     app_revision = (uint32_t)revision_obj->valueint;
                 }
 
-                uint8_t* buf      = NULL;
-                size_t   buf_size = 0;
-                if (!http_session_download_ram(session, file_url, &buf, &buf_size)) {
-                    ESP_LOGE(TAG, "Failed to download executable: %s", executable);
-                    http_session_end(session);
-                    free_repository_data_json(&metadata);
-                    free_repository_data_json(&information);
-                    app_mgmt_uninstall(slug, location);
-                    return ESP_FAIL;
+                // Patch the installed executable when the repository offers a delta for its revision
+                esp_err_t appfs_res = ESP_ERR_NOT_FOUND;
+                if (delta != NULL) {
+                    char delta_url[256] = {0};
+                    snprintf(delta_url, sizeof(delta_url), "%s/%s/%s/%s", repository_url, repository_data_url, slug,
+                             cJSON_GetObjectItem(delta, "file")->valuestring);
+                    uint8_t        delta_digest[HTTP_SHA256_SIZE];
+                    const uint8_t* delta_sha256 = NULL;
+                    if (app_mgmt_get_sha256(delta, "sha256", delta_digest, &delta_sha256)) {
+                        http_session_set_expected_sha256(session, delta_sha256);
+                        appfs_res = app_delta_install_from_http(session, delta_url, slug, app_name, app_revision);
+                    }
+                    if (appfs_res != ESP_OK) {
+                        ESP_LOGW(TAG, "Delta update of %s failed (%s), downloading the full executable", slug,
+                                 esp_err_to_name(appfs_res));
+                    }
                 }
 
-                esp_err_t appfs_res = app_mgmt_install_from_buffer(slug, app_name, app_revision, buf, buf_size);
-                if (appfs_res == ESP_ERR_NO_MEM) {
-                    uint8_t auto_cleanup = 0;
-                    appfs_settings_get_auto_cleanup(&auto_cleanup);
-                    if (auto_cleanup) {
-                        size_t rounded_size =
-                            (buf_size + (SPI_FLASH_MMU_PAGE_SIZE - 1)) & (~(SPI_FLASH_MMU_PAGE_SIZE - 1));
-                        app_mgmt_appfs_evict_lru(rounded_size);
-                        appfs_res = app_mgmt_install_from_buffer(slug, app_name, app_revision, buf, buf_size);
+                // Stream the executable straight into AppFS. Servers that do not announce the size
+                // fall back to downloading the whole executable into RAM first.
+                if (appfs_res != ESP_OK) {
+                    // Clear any stale AppFS entry so a failed download doesn't leave a half-populated one behind.
+                    if (appfsExists(slug)) {
+                        appfsDeleteFile(slug);
+                    }
+                    http_session_set_expected_sha256(session, executable_sha256);
+                    appfs_res = app_mgmt_install_from_http(session, file_url, slug, app_name, app_revision);
+                }
+                if (appfs_res == ESP_ERR_NOT_SUPPORTED) {
+                    uint8_t* buf      = NULL;
+                    size_t   buf_size = 0;
+                    http_session_set_expected_sha256(session, executable_sha256);
+                    if (!http_session_download_ram(session, file_url, &buf, &buf_size)) {
+                        ESP_LOGE(TAG, "Failed to download executable: %s", executable);
+                        http_session_end(session);
+                        download_pool_free(pool);
+                        free_repository_data_json(&metadata);
+                        free_repository_data_json(&information);
+                        app_mgmt_uninstall(slug, location);
+                        return ESP_FAIL;
+                    }
+
+                    appfs_res = app_mgmt_install_from_buffer(slug, app_name, app_revision, buf, buf_size);
+                    if (appfs_res == ESP_ERR_NO_MEM) {
+                        uint8_t auto_cleanup = 0;
+                        appfs_settings_get_auto_cleanup(&auto_cleanup);
+                        if (auto_cleanup) {
+                            size_t rounded_size =
+                                (buf_size + (SPI_FLASH_MMU_PAGE_SIZE - 1)) & (~(SPI_FLASH_MMU_PAGE_SIZE - 1));
+                            app_mgmt_appfs_evict_lru(rounded_size);
+                            appfs_res = app_mgmt_install_from_buffer(slug, app_name, app_revision, buf, buf_size);
+                        }
                     }
+                    free(buf);
                 }
-                free(buf);
+                http_session_end(session);
 
                 if (appfs_res != ESP_OK) {
                     ESP_LOGE(TAG, "Failed to write executable to AppFS: %s (%s)", executable,
                              esp_err_to_name(appfs_res));
-                    http_session_end(session);
+                    download_pool_free(pool);
                     free_repository_data_json(&metadata);
                     free_repository_data_json(&information);
                     app_mgmt_uninstall(slug, location);
@@ -346,9 +465,9 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
                 char target_path[512] = {0};
                 snprintf(target_path, sizeof(target_path), "%s/%s", app_path, executable);
 
-                if (!http_session_download_file(session, file_url, target_path)) {
-                    ESP_LOGE(TAG, "Failed to download executable: %s", executable);
-                    http_session_end(session);
+                if (!download_pool_add(pool, file_url, target_path, executable_sha256)) {
+                    ESP_LOGE(TAG, "Failed to queue executable: %s", executable);
+                    download_pool_free(pool);
                     free_repository_data_json(&metadata);
                     free_repository_data_json(&information);
                     app_mgmt_uninstall(slug, location);
@@ -358,7 +477,19 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
         }
     }
 
-    http_session_end(session);
+    // Fetch all queued files concurrently
+    char status_text[64] = {0};
+    snprintf(status_text, sizeof(status_text), "Downloading %u files...", download_pool_get_count(pool));
+    esp_err_t pool_res = download_pool_run(pool, CONFIG_DOWNLOAD_POOL_WORKERS, CONFIG_DOWNLOAD_POOL_RAM_BUDGET * 1024,
+                                           download_callback, status_text);
+    download_pool_free(pool);
+    if (pool_res != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to download app files: %s", esp_err_to_name(pool_res));
+        free_repository_data_json(&metadata);
+        free_repository_data_json(&information);
+        app_mgmt_uninstall(slug, location);
+        return pool_res;
+    }
 
     // Remove stale AppFS cache if present so the newly-installed /sd copy becomes the source of truth
     // on next launch. The int/appfs path writes directly to AppFS and is handled before the download;
@@ -391,6 +522,11 @@ esp_err_t app_mgmt_install(const char* repository_url, const char* slug, app_mgm
 }
 
 esp_err_t app_mgmt_uninstall(const char* slug, app_mgmt_location_t location) {
+    return app_mgmt_remove(slug, location, false);
+}
+
+// Removes an installed app. keep_appfs leaves the AppFS executable in place, for an update that patches it.
+static esp_err_t app_mgmt_remove(const char* slug, app_mgmt_location_t location, bool keep_appfs) {
     const char* base_path = app_mgmt_location_to_path(location);
     if (base_path == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -418,7 +554,7 @@ esp_err_t app_mgmt_uninstall(const char* slug, app_mgmt_location_t location) {
         res = fs_utils_remove(app_path);
     }
 
-    if (!is_plugin) {
+    if (!is_plugin && !keep_appfs) {
         // If app is installed on SD, check if the app is also installed to the internal storage
         // if it is, do not remove the binary from appfs
         if (location == APP_MGMT_LOCATION_SD) {
@@ -439,6 +575,9 @@ esp_err_t app_mgmt_uninstall(const char* slug, app_mgmt_location_t location) {
     // Clean up last-used timestamp from NVS
     app_usage_remove_last_used(slug);
 
+    // Force the metadata to be parsed again on the next scan
+    app_catalog_invalidate(slug);
+
     return res;
 }
 
@@ -500,6 +639,257 @@ esp_err_t app_mgmt_install_from_file(const char* slug, const char* name, uint32_
     return res;
 }
 
+// --- Streaming AppFS installation ---
+
+#define APPFS_STREAM_BLOCK_SIZE  (32 * 1024)  // Multiple of the flash sector size
+#define APPFS_STREAM_BLOCK_COUNT 2
+#define APPFS_STREAM_SYNC        (-1)
+#define APPFS_STREAM_STOP        (-2)
+#define APPFS_STREAM_TIMEOUT     pdMS_TO_TICKS(30000)
+#define APPFS_SECTOR_SIZE        4096
+
+typedef struct {
+    uint8_t* data;
+    size_t   length;
+    size_t   offset;
+} appfs_stream_block_t;
+
+typedef struct {
+    const char*          slug;
+    const char*          name;
+    uint32_t             revision;
+    appfs_handle_t       fd;
+    size_t               size;
+    size_t               written;
+    bool                 no_content_length;
+    appfs_stream_block_t blocks[APPFS_STREAM_BLOCK_COUNT];
+    int                  current;       // Block being filled by the network side, -1 if none
+    QueueHandle_t        filled_queue;  // Blocks waiting to be written to flash
+    QueueHandle_t        free_queue;    // Blocks available to the network side
+    SemaphoreHandle_t    synced;
+    volatile esp_err_t   error;
+} appfs_stream_t;
+
+// Erases and writes filled blocks while the HTTP client keeps receiving into the other block
+static void appfs_stream_writer_task(void* arg) {
+    appfs_stream_t* stream = (appfs_stream_t*)arg;
+    while (true) {
+        int index = 0;
+        xQueueReceive(stream->filled_queue, &index, portMAX_DELAY);
+        if (index == APPFS_STREAM_STOP) {
+            break;
+        }
+        if (index == APPFS_STREAM_SYNC) {
+            xSemaphoreGive(stream->synced);
+            continue;
+        }
+
+        appfs_stream_block_t* block = &stream->blocks[index];
+        if (stream->error == ESP_OK) {
+            size_t erase_length = (block->length + (APPFS_SECTOR_SIZE - 1)) & (~(APPFS_SECTOR_SIZE - 1));
+            if (appfsErase(stream->fd, block->offset, erase_length) != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to erase appfs file %s at %u", stream->slug, block->offset);
+                stream->error = ESP_FAIL;
+            } else if (appfsWrite(stream->fd, block->offset, block->data, block->length) != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to write appfs file %s at %u", stream->slug, block->offset);
+                stream->error = ESP_FAIL;
+            }
+        }
+        block->length = 0;
+        xQueueSend(stream->free_queue, &index, portMAX_DELAY);
+    }
+    xSemaphoreGive(stream->synced);
+    vTaskDelete(NULL);
+}
+
+static bool appfs_stream_take_block(appfs_stream_t* stream, size_t offset) {
+    if (xQueueReceive(stream->free_queue, &stream->current, APPFS_STREAM_TIMEOUT) != pdTRUE) {
+        ESP_LOGE(TAG, "Timeout waiting for flash write of %s", stream->slug);
+        stream->current = -1;
+        return false;
+    }
+    stream->blocks[stream->current].length = 0;
+    stream->blocks[stream->current].offset = offset;
+    return true;
+}
+
+static void appfs_stream_sync(appfs_stream_t* stream) {
+    int marker = APPFS_STREAM_SYNC;
+    xQueueSend(stream->filled_queue, &marker, portMAX_DELAY);
+    xSemaphoreTake(stream->synced, portMAX_DELAY);
+}
+
+static bool appfs_stream_begin(size_t size, void* arg) {
+    appfs_stream_t* stream = (appfs_stream_t*)arg;
+
+    if (size == 0) {
+        ESP_LOGW(TAG, "No content length for %s, can not stream into AppFS", stream->slug);
+        stream->no_content_length = true;
+        return false;
+    }
+
+    // A previous attempt may have left a partial file behind
+    if (appfsExists(stream->slug)) {
+        appfsDeleteFile(stream->slug);
+    }
+
+    size_t rounded_size = (size + (SPI_FLASH_MMU_PAGE_SIZE - 1)) & (~(SPI_FLASH_MMU_PAGE_SIZE - 1));
+    if (appfsGetFreeMem() < rounded_size) {
+        uint8_t auto_cleanup = 0;
+        appfs_settings_get_auto_cleanup(&auto_cleanup);
+        if (auto_cleanup) {
+            app_mgmt_appfs_evict_lru(rounded_size);
+        }
+    }
+    if (appfsGetFreeMem() < rounded_size) {
+        ESP_LOGW(TAG, "Not enough space in AppFS for %s (need %u, have %u)", stream->slug, rounded_size,
+                 appfsGetFreeMem());
+        stream->error = ESP_ERR_NO_MEM;
+        return false;
+    }
+
+    if (appfsCreateFileExt(stream->slug, stream->name, stream->revision, size, &stream->fd) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create appfs file: %s", stream->slug);
+        stream->fd    = APPFS_INVALID_FD;
+        stream->error = ESP_FAIL;
+        return false;
+    }
+
+    stream->size    = size;
+    stream->written = 0;
+    stream->error   = ESP_OK;
+    return appfs_stream_take_block(stream, 0);
+}
+
+static bool appfs_stream_write(const uint8_t* data, size_t length, size_t offset, void* arg) {
+    appfs_stream_t* stream = (appfs_stream_t*)arg;
+
+    if (offset + length > stream->size) {
+        ESP_LOGE(TAG, "Server sent more data than announced for %s", stream->slug);
+        return false;
+    }
+
+    while (length > 0) {
+        if (stream->error != ESP_OK || stream->current < 0) {
+            return false;
+        }
+
+        appfs_stream_block_t* block = &stream->blocks[stream->current];
+        size_t                chunk = APPFS_STREAM_BLOCK_SIZE - block->length;
+        if (chunk > length) {
+            chunk = length;
+        }
+        memcpy(&block->data[block->length], data, chunk);
+        block->length   += chunk;
+        stream->written += chunk;
+        data            += chunk;
+        length          -= chunk;
+
+        if (block->length == APPFS_STREAM_BLOCK_SIZE) {
+            xQueueSend(stream->filled_queue, &stream->current, portMAX_DELAY);
+            stream->current = -1;
+            if (!appfs_stream_take_block(stream, stream->written)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool appfs_stream_end(bool success, void* arg) {
+    appfs_stream_t* stream = (appfs_stream_t*)arg;
+
+    if (stream->current >= 0) {
+        if (success && stream->blocks[stream->current].length > 0) {
+            xQueueSend(stream->filled_queue, &stream->current, portMAX_DELAY);
+        } else {
+            xQueueSend(stream->free_queue, &stream->current, portMAX_DELAY);
+        }
+        stream->current = -1;
+    }
+
+    // Wait until every block has been written to flash
+    appfs_stream_sync(stream);
+
+    if (!success || stream->error != ESP_OK || stream->written != stream->size) {
+        if (stream->fd != APPFS_INVALID_FD) {
+            appfsDeleteFile(stream->slug);
+            stream->fd = APPFS_INVALID_FD;
+        }
+        return false;
+    }
+    return true;
+}
+
+esp_err_t app_mgmt_install_from_http(http_session_t session, const char* url, const char* slug, const char* name,
+                                     uint32_t revision) {
+    if (session == NULL || url == NULL || slug == NULL || name == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    appfs_stream_t stream = {
+        .slug     = slug,
+        .name     = name,
+        .revision = revision,
+        .fd       = APPFS_INVALID_FD,
+        .current  = -1,
+        .error    = ESP_OK,
+    };
+
+    esp_err_t res = ESP_OK;
+
+    stream.filled_queue = xQueueCreate(APPFS_STREAM_BLOCK_COUNT + 2, sizeof(int));
+    stream.free_queue   = xQueueCreate(APPFS_STREAM_BLOCK_COUNT, sizeof(int));
+    stream.synced       = xSemaphoreCreateBinary();
+    if (stream.filled_queue == NULL || stream.free_queue == NULL || stream.synced == NULL) {
+        res = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    for (int i = 0; i < APPFS_STREAM_BLOCK_COUNT; i++) {
+        stream.blocks[i].data = malloc(APPFS_STREAM_BLOCK_SIZE);
+        if (stream.blocks[i].data == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate stream buffer for %s", slug);
+            res = ESP_ERR_NO_MEM;
+            goto cleanup;
+        }
+        xQueueSend(stream.free_queue, &i, 0);
+    }
+
+    if (xTaskCreate(appfs_stream_writer_task, "appfs_writer", 4096, &stream, 5, NULL) != pdPASS) {
+        res = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    http_stream_sink_t sink = {
+        .begin = appfs_stream_begin,
+        .write = appfs_stream_write,
+        .end   = appfs_stream_end,
+        .arg   = &stream,
+    };
+
+    bool downloaded = http_session_download_stream(session, url, &sink);
+
+    int stop = APPFS_STREAM_STOP;
+    xQueueSend(stream.filled_queue, &stop, portMAX_DELAY);
+    xSemaphoreTake(stream.synced, portMAX_DELAY);
+
+    if (stream.no_content_length) {
+        res = ESP_ERR_NOT_SUPPORTED;
+    } else if (!downloaded || stream.fd == APPFS_INVALID_FD) {
+        res = (stream.error != ESP_OK) ? stream.error : ESP_FAIL;
+    }
+
+cleanup:
+    for (int i = 0; i < APPFS_STREAM_BLOCK_COUNT; i++) {
+        free(stream.blocks[i].data);
+    }
+    if (stream.synced != NULL) vSemaphoreDelete(stream.synced);
+    if (stream.free_queue != NULL) vQueueDelete(stream.free_queue);
+    if (stream.filled_queue != NULL) vQueueDelete(stream.filled_queue);
+    return res;
+}
+
 // --- AppFS cache management ---
 
 bool app_mgmt_has_binary_in_install_dir(const char* slug) {
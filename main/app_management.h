@@ -20,6 +20,8 @@ esp_err_t app_mgmt_uninstall(const char* slug, app_mgmt_location_t location);
 esp_err_t app_mgmt_install_from_file(const char* slug, const char* name, uint32_t revision, char* firmware_path);
 esp_err_t app_mgmt_install_from_buffer(const char* slug, const char* name, uint32_t revision, uint8_t* data,
                                        size_t size);
+esp_err_t app_mgmt_install_from_http(http_session_t session, const char* url, const char* slug, const char* name,
+                                     uint32_t revision);
 
 // AppFS cache management
 bool      app_mgmt_has_binary_in_install_dir(const char* slug);
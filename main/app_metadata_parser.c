@@ -4,10 +4,12 @@
 #include <string.h>
 #include <strings.h>
 #include <sys/stat.h>
+#include "app_catalog.h"
 #include "app_favorite.h"
 #include "bsp/device.h"
 #include "cJSON.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_vfs.h"
 #include "esp_vfs_fat.h"
 #include "fastopen.h"
@@ -19,13 +21,19 @@
 
 static const char* TAG = "App metadata";
 
+#ifndef APPS_INT_DIR  // The host benchmark scans an app tree it generates
+#define APPS_INT_DIR "/int/apps"
+#define APPS_SD_DIR  "/sd/apps"
+#endif
+
 static uint8_t* load_file_to_ram(FILE* fd) {
     fseek(fd, 0, SEEK_END);
     size_t fsize = ftell(fd);
     fseek(fd, 0, SEEK_SET);
-    uint8_t* file = malloc(fsize);
+    uint8_t* file = malloc(fsize + 1);
     if (file == NULL) return NULL;
     fread(file, fsize, 1, fd);
+    file[fsize] = '\0';  // Parsed as a string by cJSON
     return file;
 }
 
@@ -128,9 +136,10 @@ bool get_executable_revision(const char* path, const char* slug, uint32_t* out_r
 }
 
 app_t* create_app(const char* path, const char* slug) {
-    app_t* app = calloc(1, sizeof(app_t));
-    app->path  = strdup(path);
-    app->slug  = strdup(slug);
+    app_t* app               = calloc(1, sizeof(app_t));
+    app->path                = strdup(path);
+    app->slug                = strdup(slug);
+    app->executable_appfs_fd = APPFS_INVALID_FD;  // Handle 0 is the first AppFS file
 
     char path_buffer[256] = {0};
     snprintf(path_buffer, sizeof(path_buffer), "%s/%s/metadata.json", path, slug);
@@ -198,8 +207,9 @@ app_t* create_app(const char* path, const char* slug) {
         cJSON* icon32_obj = cJSON_GetObjectItem(icon_obj, "32x32");
         if (icon32_obj && cJSON_IsString(icon32_obj)) {
             snprintf(path_buffer, sizeof(path_buffer), "%s/%s/%s", path, slug, icon32_obj->valuestring);
-            FILE* icon_fd = fastopen(path_buffer, "rb");
-            app->icon     = calloc(1, sizeof(pax_buf_t));
+            app->icon_path = strdup(path_buffer);
+            FILE* icon_fd  = fastopen(path_buffer, "rb");
+            app->icon      = calloc(1, sizeof(pax_buf_t));
             if (app->icon != NULL && icon_fd != NULL) {
                 if (!pax_decode_png_fd(app->icon, icon_fd, PAX_BUF_32_8888ARGB, 0)) {
                     free(app->icon);
@@ -328,17 +338,23 @@ app_t* create_app(const char* path, const char* slug) {
     free(json_data);
 
     if (app->icon == NULL) {
-        ESP_LOGE(TAG, "No icon found for app %s, using default icon", slug);
-        app->icon = calloc(1, sizeof(pax_buf_t));
-        if (app->icon != NULL) {
-            pax_buf_init(app->icon, NULL, 32, 32, PAX_BUF_32_8888ARGB);
-            pax_draw_image(app->icon, get_icon(ICON_HELP), 0, 0);
-        }
+        ESP_LOGE(TAG, "No icon found for app %s", slug);
     }
 
     return app;
 }
 
+void app_set_default_icon(app_t* app) {
+    if (app == NULL || app->icon != NULL) {
+        return;
+    }
+    app->icon = calloc(1, sizeof(pax_buf_t));
+    if (app->icon != NULL) {
+        pax_buf_init(app->icon, NULL, 32, 32, PAX_BUF_32_8888ARGB);
+        pax_draw_image(app->icon, get_icon(ICON_HELP), 0, 0);
+    }
+}
+
 void free_app(app_t* app) {
     if (app == NULL) return;
     if (app->path != NULL) free(app->path);
@@ -361,6 +377,7 @@ void free_app(app_t* app) {
         pax_buf_destroy(app->icon);
         free(app->icon);
     }
+    if (app->icon_path != NULL) free(app->icon_path);
     if (app->executable_on_fs_filename != NULL) free(app->executable_on_fs_filename);
     free(app);
 }
@@ -377,6 +394,9 @@ size_t create_list_of_apps_from_directory(app_t** out_list, size_t list_size, co
         if (count >= list_size) {
             break;
         }
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
         if (entry->d_type == DT_DIR) {
             bool already_in_list = false;
             for (size_t i = 0; i < full_list_size; i++) {
@@ -405,7 +425,13 @@ size_t create_list_of_apps_from_directory(app_t** out_list, size_t list_size, co
                 }
             }
             if (!already_in_list) {
-                app_t* app = create_app(path, entry->d_name);
+                app_t* app = app_catalog_get(path, entry->d_name);
+                if (app == NULL) {
+                    app = create_app(path, entry->d_name);
+                    // Stored before the default icon is set, that one depends on the theme
+                    app_catalog_put(app);
+                    app_set_default_icon(app);
+                }
                 if (app != NULL && count < list_size) {
                     out_list[count++] = app;
                 }
@@ -460,16 +486,30 @@ size_t create_list_of_apps_from_other_appfs_entries(app_t** out_list, size_t lis
 }
 
 size_t create_list_of_apps(app_t** out_list, size_t list_size) {
-    size_t count = 0;
+    size_t  count      = 0;
+    int64_t start_time = esp_timer_get_time();
+
+    app_catalog_begin_scan();
 
-    count += create_list_of_apps_from_directory(&out_list[count], list_size - count, "/int/apps", out_list, list_size);
-    count += create_list_of_apps_from_directory(&out_list[count], list_size - count, "/sd/apps", out_list, list_size);
+    count += create_list_of_apps_from_directory(&out_list[count], list_size - count, APPS_INT_DIR, out_list, list_size);
+    count += create_list_of_apps_from_directory(&out_list[count], list_size - count, APPS_SD_DIR, out_list, list_size);
     count += create_list_of_apps_from_other_appfs_entries(&out_list[count], list_size - count, out_list, list_size);
 
-    for (size_t position = 0; position < count; position++) {
-        if (app_favorite_get(out_list[position]->slug)) {
-            out_list[position]->favorite = true;
+    app_catalog_end_scan();
+
+    // Read the favorites from NVS once instead of once per app
+    char (*favorites)[APP_MAX_SLUG_SIZE] = calloc(APP_MAX_FAVORITES, APP_MAX_SLUG_SIZE);
+    if (favorites != NULL) {
+        size_t number_of_favorites = app_favorite_get_all(favorites, APP_MAX_FAVORITES);
+        for (size_t position = 0; position < count; position++) {
+            for (size_t i = 0; i < number_of_favorites; i++) {
+                if (strncmp(out_list[position]->slug, favorites[i], APP_MAX_SLUG_SIZE) == 0) {
+                    out_list[position]->favorite = true;
+                    break;
+                }
+            }
         }
+        free(favorites);
     }
 
     char autostart_slug[APP_MAX_SLUG_SIZE] = {0};
@@ -482,6 +522,11 @@ size_t create_list_of_apps(app_t** out_list, size_t list_size) {
         }
     }
 
+    app_catalog_stats_t stats = {0};
+    app_catalog_get_stats(&stats);
+    ESP_LOGI(TAG, "Listed %u apps in %lld ms (%u from catalog, %u parsed)", count,
+             (esp_timer_get_time() - start_time) / 1000, stats.hits, stats.misses);
+
     return count;
 }
 
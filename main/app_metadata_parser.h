@@ -24,6 +24,7 @@ typedef struct {
     char*      categories[APP_MAX_NUM_CATEGORIES];
     char*      version;
     pax_buf_t* icon;
+    char*      icon_path;
     char*      author;
     char*      license_type;
     char*      license_file;
@@ -47,6 +48,7 @@ typedef struct {
 appfs_handle_t find_appfs_handle_for_slug(const char* search_slug);
 bool   get_executable_revision(const char* path, const char* slug, uint32_t* out_revision, char** out_executable);
 app_t* create_app(const char* path, const char* slug);
+void   app_set_default_icon(app_t* app);
 void   free_app(app_t* app);
 
 size_t create_list_of_apps_from_directory(app_t** out_list, size_t list_size, const char* path, app_t** full_list,
@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: MIT
+
+#include "audio_convert.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RESAMPLER_TAPS        16  // Input frames the filter is applied to, even
+#define RESAMPLER_PHASE_BITS  7
+#define RESAMPLER_PHASES      (1 << RESAMPLER_PHASE_BITS)
+#define RESAMPLER_COEFF_SHIFT 14  // Coefficients are Q14, the center tap of a phase can be 1.0
+#define RESAMPLER_CENTER      (RESAMPLER_TAPS / 2 - 1)  // Tap at or just before the output position
+#define CONVERTER_FRAMES      (256 + RESAMPLER_TAPS)    // Decoded input frames kept, including the history
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Positions are Q32.32 input frames relative to frames[0], fine enough that
+// rounding the step does not shift the pitch audibly. The output frame
+// at a position is computed from the RESAMPLER_TAPS frames starting at its
+// integer part, centered between taps RESAMPLER_CENTER and
+// RESAMPLER_CENTER + 1, so both resamplers have the same delay.
+struct audio_converter {
+    audio_format_t format;
+    size_t         frame_bytes;
+    uint64_t       step;          // Input frames per output frame
+    uint64_t       position;      // Position of the next output frame
+    size_t         count;         // Decoded frames in frames
+    int16_t*       coefficients;  // RESAMPLER_PHASES rows of RESAMPLER_TAPS, NULL without the sinc filter
+    int16_t        frames[CONVERTER_FRAMES * 2];
+};
+
+bool audio_format_is_valid(const audio_format_t* format) {
+    return format->rate >= AUDIO_CONVERT_MIN_RATE && format->rate <= AUDIO_CONVERT_MAX_RATE &&
+           (format->channels == 1 || format->channels == 2) && format->sample_format <= AUDIO_SAMPLE_U8 &&
+           format->resampler <= AUDIO_RESAMPLER_LINEAR;
+}
+
+size_t audio_format_frame_bytes(const audio_format_t* format) {
+    return format->channels * (format->sample_format == AUDIO_SAMPLE_S16 ? sizeof(int16_t) : sizeof(int8_t));
+}
+
+// Blackman window over the length of the filter, 0 at both ends
+static double window(double offset) {
+    double x = (offset + RESAMPLER_TAPS / 2.0) / RESAMPLER_TAPS;
+    if (x <= 0.0 || x >= 1.0) return 0.0;
+    return 0.42 - 0.5 * cos(2.0 * M_PI * x) + 0.08 * cos(4.0 * M_PI * x);
+}
+
+// When converting down the cutoff follows the output Nyquist frequency, so
+// content above it is removed instead of folding back as aliasing. Every
+// phase is normalized to unity gain at DC.
+static bool create_coefficients(audio_converter_t converter, uint32_t output_rate) {
+    converter->coefficients = malloc(RESAMPLER_PHASES * RESAMPLER_TAPS * sizeof(int16_t));
+    if (converter->coefficients == NULL) return false;
+
+    double cutoff = converter->format.rate > output_rate ? (double)output_rate / converter->format.rate : 1.0;
+    cutoff       *= 0.95;  // Leaves room for the transition band below Nyquist
+    for (int phase = 0; phase < RESAMPLER_PHASES; phase++) {
+        double taps[RESAMPLER_TAPS];
+        double sum = 0.0;
+        for (int tap = 0; tap < RESAMPLER_TAPS; tap++) {
+            double offset = (tap - RESAMPLER_CENTER) - (double)phase / RESAMPLER_PHASES;
+            double x      = M_PI * cutoff * offset;
+            taps[tap]     = (offset == 0.0 ? 1.0 : sin(x) / x) * window(offset);
+            sum          += taps[tap];
+        }
+        int16_t* row = &converter->coefficients[phase * RESAMPLER_TAPS];
+        for (int tap = 0; tap < RESAMPLER_TAPS; tap++) {
+            row[tap] = (int16_t)lround(taps[tap] / sum * (1 << RESAMPLER_COEFF_SHIFT));
+        }
+    }
+    return true;
+}
+
+audio_converter_t audio_converter_create(const audio_format_t* format, uint32_t output_rate) {
+    if (!audio_format_is_valid(format)) return NULL;
+
+    audio_converter_t converter = calloc(1, sizeof(struct audio_converter));
+    if (converter == NULL) return NULL;
+    converter->format      = *format;
+    converter->frame_bytes = audio_format_frame_bytes(format);
+    converter->step        = ((uint64_t)format->rate << 32) / output_rate;
+    // Silent history, the first input frame lands on the center tap
+    converter->count = RESAMPLER_CENTER;
+
+    if (format->rate != output_rate && format->resampler == AUDIO_RESAMPLER_SINC &&
+        !create_coefficients(converter, output_rate)) {
+        free(converter);
+        return NULL;
+    }
+    return converter;
+}
+
+void audio_converter_free(audio_converter_t converter) {
+    if (converter == NULL) return;
+    free(converter->coefficients);
+    free(converter);
+}
+
+size_t audio_converter_push(audio_converter_t converter, const void* data, size_t size) {
+    size_t frames = size / converter->frame_bytes;
+    if (frames > CONVERTER_FRAMES - converter->count) frames = CONVERTER_FRAMES - converter->count;
+
+    int16_t* out = &converter->frames[converter->count * 2];
+    size_t   n   = frames * converter->format.channels;
+    switch (converter->format.sample_format) {
+        case AUDIO_SAMPLE_S16: {
+            const int16_t* in = data;
+            if (converter->format.channels == 2) {
+                memcpy(out, in, n * sizeof(int16_t));
+            } else {
+                for (size_t i = 0; i < n; i++) {
+                    out[i * 2] = out[i * 2 + 1] = in[i];
+                }
+            }
+            break;
+        }
+        case AUDIO_SAMPLE_S8: {
+            const int8_t* in = data;
+            for (size_t i = 0; i < n; i++) {
+                int16_t sample = (int16_t)(in[i] * 256);
+                if (converter->format.channels == 2) {
+                    out[i] = sample;
+                } else {
+                    out[i * 2] = out[i * 2 + 1] = sample;
+                }
+            }
+            break;
+        }
+        case AUDIO_SAMPLE_U8: {
+            const uint8_t* in = data;
+            for (size_t i = 0; i < n; i++) {
+                int16_t sample = (int16_t)((in[i] - 128) * 256);
+                if (converter->format.channels == 2) {
+                    out[i] = sample;
+                } else {
+                    out[i * 2] = out[i * 2 + 1] = sample;
+                }
+            }
+            break;
+        }
+    }
+    converter->count += frames;
+    return frames * converter->frame_bytes;
+}
+
+static inline int16_t saturate(int32_t s) {
+    if (s > INT16_MAX) return INT16_MAX;
+    if (s < INT16_MIN) return INT16_MIN;
+    return (int16_t)s;
+}
+
+size_t audio_converter_pull(audio_converter_t converter, int16_t* out, size_t frames) {
+    size_t   produced = 0;
+    uint64_t position = converter->position;
+    while (produced < frames && (position >> 32) + RESAMPLER_TAPS <= converter->count) {
+        const int16_t* in       = &converter->frames[(position >> 32) * 2];
+        uint32_t       fraction = (uint32_t)position >> 16;  // Q16
+        if (fraction == 0 && converter->step == 1ULL << 32) {
+            out[produced * 2]     = in[RESAMPLER_CENTER * 2];
+            out[produced * 2 + 1] = in[RESAMPLER_CENTER * 2 + 1];
+        } else if (converter->coefficients == NULL) {
+            // Q15, a difference of two full scale samples times a Q16 fraction does not fit 32 bits
+            const int16_t* a      = &in[RESAMPLER_CENTER * 2];
+            int32_t        weight = fraction >> 1;
+            out[produced * 2]     = (int16_t)(a[0] + (((a[2] - a[0]) * weight) >> 15));
+            out[produced * 2 + 1] = (int16_t)(a[1] + (((a[3] - a[1]) * weight) >> 15));
+        } else {
+            const int16_t* row   = &converter->coefficients[(fraction >> (16 - RESAMPLER_PHASE_BITS)) * RESAMPLER_TAPS];
+            int32_t        left  = 0;
+            int32_t        right = 0;
+            for (int tap = 0; tap < RESAMPLER_TAPS; tap++) {
+                left  += in[tap * 2] * row[tap];
+                right += in[tap * 2 + 1] * row[tap];
+            }
+            // Rounded, the filter can overshoot on full scale input
+            out[produced * 2]     = saturate((left + (1 << (RESAMPLER_COEFF_SHIFT - 1))) >> RESAMPLER_COEFF_SHIFT);
+            out[produced * 2 + 1] = saturate((right + (1 << (RESAMPLER_COEFF_SHIFT - 1))) >> RESAMPLER_COEFF_SHIFT);
+        }
+        produced++;
+        position += converter->step;
+    }
+
+    // Drop the frames no future output frame needs, keeping the history
+    size_t consumed = position >> 32;
+    if (consumed > converter->count) consumed = converter->count;
+    memmove(converter->frames, &converter->frames[consumed * 2], (converter->count - consumed) * 2 * sizeof(int16_t));
+    converter->count    -= consumed;
+    converter->position  = position - ((uint64_t)consumed << 32);
+    return produced;
+}
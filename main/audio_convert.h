@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: MIT
+// Sample format and sample rate conversion for audio mixer streams.
+//
+// A converter turns the samples of one producer, in whatever format and at
+// whatever rate it delivers them, into 16-bit signed stereo at the rate of
+// the mixer. 8-bit signed and unsigned samples are widened to 16 bits and
+// mono is duplicated to both channels. The rate is converted with a
+// windowed-sinc polyphase filter, or with linear interpolation when CPU
+// time matters more than quality.
+//
+// Input is pushed in whole frames and output is pulled in stereo frames.
+// Besides the frames waiting to be converted the converter only keeps a
+// short history for the filter. A converter is used by a single task.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AUDIO_CONVERT_MIN_RATE 8000
+#define AUDIO_CONVERT_MAX_RATE 96000
+
+typedef enum {
+    AUDIO_SAMPLE_S16,  // Native endian signed 16-bit
+    AUDIO_SAMPLE_S8,
+    AUDIO_SAMPLE_U8,  // Unsigned with 128 as silence
+} audio_sample_format_t;
+
+typedef enum {
+    AUDIO_RESAMPLER_SINC,    // 16 tap windowed-sinc, 128 phases
+    AUDIO_RESAMPLER_LINEAR,  // Linear interpolation between two frames
+} audio_resampler_t;
+
+typedef struct {
+    uint32_t              rate;
+    uint8_t               channels;  // 1 or 2, stereo is interleaved L/R
+    audio_sample_format_t sample_format;
+    audio_resampler_t     resampler;
+} audio_format_t;
+
+typedef struct audio_converter* audio_converter_t;
+
+// Returns NULL when the format is not supported or out of memory
+audio_converter_t audio_converter_create(const audio_format_t* format, uint32_t output_rate);
+void              audio_converter_free(audio_converter_t converter);
+
+bool   audio_format_is_valid(const audio_format_t* format);
+size_t audio_format_frame_bytes(const audio_format_t* format);
+
+// Decodes input frames into the converter. Returns the number of bytes
+// accepted, always whole frames, 0 when the converter has no room left.
+size_t audio_converter_push(audio_converter_t converter, const void* data, size_t size);
+// Produces up to `frames` stereo frames at the output rate into `out`.
+// Returns fewer when more input is needed.
+size_t audio_converter_pull(audio_converter_t converter, int16_t* out, size_t frames);
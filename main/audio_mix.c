@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: MIT
+
+#include "audio_mix.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLOCK_SAMPLES (AUDIO_LIMITER_BLOCK_FRAMES * 2)  // L+R
+
+static inline int16_t saturate_s16(int32_t s) {
+    if (s > INT16_MAX) return INT16_MAX;
+    if (s < INT16_MIN) return INT16_MIN;
+    return (int16_t)s;
+}
+
+// The gain that keeps the peak of a block at or below the threshold
+static int32_t required_gain(const int32_t* block) {
+    int32_t peak = 0;
+    for (int j = 0; j < BLOCK_SAMPLES; j++) {
+        int32_t v = block[j] < 0 ? -block[j] : block[j];
+        if (v > peak) peak = v;
+    }
+    if (peak <= AUDIO_LIMITER_THRESHOLD) {
+        return AUDIO_MIX_GAIN_UNITY;
+    }
+    return (int32_t)(((int64_t)AUDIO_LIMITER_THRESHOLD << 15) / peak);
+}
+
+void audio_mix_accumulate(int32_t* accum, const int16_t* samples, size_t count, int32_t gain) {
+    if (gain == AUDIO_MIX_GAIN_UNITY) {
+        for (size_t j = 0; j < count; j++) {
+            accum[j] += samples[j];
+        }
+    } else {
+        for (size_t j = 0; j < count; j++) {
+            accum[j] += (samples[j] * gain) >> 15;
+        }
+    }
+}
+
+void audio_limiter_reset(audio_limiter_t* limiter) {
+    limiter->gain = AUDIO_MIX_GAIN_UNITY;
+}
+
+void audio_limiter_process(audio_limiter_t* limiter, const int32_t* in, int16_t* out, size_t frames) {
+    size_t blocks = frames / AUDIO_LIMITER_BLOCK_FRAMES;
+    if (blocks == 0) return;
+
+    // Both ends of the ramp across a block are at or below the gain that
+    // block requires, so no sample inside it exceeds the threshold. Only the
+    // start of the call can step down, when a peak lands right at its start.
+    int32_t required = required_gain(in);
+    int32_t start    = limiter->gain < required ? limiter->gain : required;
+    for (size_t b = 0; b < blocks; b++) {
+        const int32_t* src = &in[b * BLOCK_SAMPLES];
+        int16_t*       dst = &out[b * BLOCK_SAMPLES];
+
+        int32_t next = b + 1 < blocks ? required_gain(&in[(b + 1) * BLOCK_SAMPLES]) : AUDIO_MIX_GAIN_UNITY;
+        int32_t end  = required < next ? required : next;
+        if (end > start + AUDIO_LIMITER_RELEASE_STEP) end = start + AUDIO_LIMITER_RELEASE_STEP;
+
+        if (start >= AUDIO_MIX_GAIN_UNITY && end >= AUDIO_MIX_GAIN_UNITY) {
+            for (int j = 0; j < BLOCK_SAMPLES; j++) {
+                dst[j] = saturate_s16(src[j]);
+            }
+        } else {
+            for (int f = 0; f < AUDIO_LIMITER_BLOCK_FRAMES; f++) {
+                int32_t gain   = start + ((end - start) * f) / AUDIO_LIMITER_BLOCK_FRAMES;
+                dst[f * 2]     = saturate_s16((int32_t)(((int64_t)src[f * 2] * gain) >> 15));
+                dst[f * 2 + 1] = saturate_s16((int32_t)(((int64_t)src[f * 2 + 1] * gain) >> 15));
+            }
+        }
+        start    = end;
+        required = next;
+    }
+    limiter->gain = start > AUDIO_MIX_GAIN_UNITY ? AUDIO_MIX_GAIN_UNITY : start;
+}
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: MIT
+// Summing and limiting for the audio mixer.
+//
+// Streams are added into an int32 accumulator, each scaled by its own Q15
+// gain, and the sum is brought back to 16-bit by a look-ahead peak limiter
+// instead of being divided by the number of streams.
+//
+// The limiter splits its input into short blocks and computes the gain every
+// block needs to stay below the threshold before any of it is output. The
+// gain is then ramped linearly from block boundary to block boundary, so it
+// has already come down by the time a peak arrives instead of clamping the
+// peak itself. Recovery is limited to a fixed step per block to avoid
+// audible pumping.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Gains are unsigned Q15 fixed point, AUDIO_MIX_GAIN_UNITY is 1.0
+#define AUDIO_MIX_GAIN_UNITY 32768
+
+#define AUDIO_LIMITER_BLOCK_FRAMES 16
+#define AUDIO_LIMITER_THRESHOLD    29204  // -1 dBFS
+#define AUDIO_LIMITER_RELEASE_STEP 128    // Q15 per block, ~90 ms from silence to unity at 44.1 kHz
+
+typedef struct {
+    int32_t gain;  // Gain reached at the end of the previous call, Q15
+} audio_limiter_t;
+
+// Adds `count` samples scaled by `gain` (Q15, at most 65535) to `accum`
+void audio_mix_accumulate(int32_t* accum, const int16_t* samples, size_t count, int32_t gain);
+
+// Returns the limiter to unity gain, for a new start after silence
+void audio_limiter_reset(audio_limiter_t* limiter);
+
+// Limits `frames` stereo frames from `in` into `out`. `frames` must be a
+// multiple of AUDIO_LIMITER_BLOCK_FRAMES.
+void audio_limiter_process(audio_limiter_t* limiter, const int32_t* in, int16_t* out, size_t frames);
@@ -1,17 +1,24 @@
 // SPDX-License-Identifier: MIT
 
 #include "audio_mixer.h"
+#include <inttypes.h>
+#include <stdatomic.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include "audio_convert.h"
+#include "audio_mix.h"
+#include "audio_ring.h"
 #include "bsp/audio.h"
 #include "bsp/input.h"
 #include "driver/i2s_common.h"
 #include "driver/i2s_types.h"
+#include "esp_cpu.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
-#include "freertos/stream_buffer.h"
 #include "freertos/task.h"
+#include "sdkconfig.h"
 
 static char const* TAG = "audio_mixer";
 
@@ -19,7 +26,15 @@ static char const* TAG = "audio_mixer";
 #define MIXER_CHUNK_FRAMES  256                       // ~5.8 ms @ 44.1 kHz
 #define MIXER_CHUNK_SAMPLES (MIXER_CHUNK_FRAMES * 2)  // L+R
 #define MIXER_CHUNK_BYTES   (MIXER_CHUNK_FRAMES * MIXER_FRAME_BYTES)
-#define MIXER_STREAM_BYTES  (8 * 1024)  // ~46 ms of headroom per plugin
+#define MIXER_STREAM_BYTES  (8 * 1024)  // ~46 ms of headroom per plugin, a power of two
+
+_Static_assert(MIXER_STREAM_BYTES % AUDIO_MIXER_WRITE_ALIGN == 0, "Frames must not wrap around the ring");
+
+#if defined(CONFIG_AUDIO_MIXER_STREAMS_IN_PSRAM)
+#define MIXER_STREAM_PSRAM true
+#else
+#define MIXER_STREAM_PSRAM false
+#endif
 
 #define MIXER_TASK_STACK    3072
 #define MIXER_TASK_PRIORITY 7  // above plugin tasks (which run at 5)
@@ -32,28 +47,48 @@ static char const* TAG = "audio_mixer";
 // over-shoot to leave headroom for jitter and codec latency.
 #define MIXER_DRAIN_CHUNKS 8  // 8 * 256 frames ≈ 46 ms @ 44.1 kHz
 
+_Static_assert(MIXER_CHUNK_FRAMES % AUDIO_LIMITER_BLOCK_FRAMES == 0, "The limiter works on whole blocks");
+
+// Streams are published in g_slots. The mixer task reads the table without
+// taking a lock; adding and removing streams is serialized by
+// g_control_mutex. A removed stream is only freed after the mixer has
+// finished any pass that could still be using it (see wait_for_mixer_pass),
+// a replaced converter the same way.
 typedef struct {
-    bool                 active;  // slot is allocated to a plugin
-    bool                 paused;  // stream is paused (asp_audio_stop)
-    TaskHandle_t         owner;
-    StreamBufferHandle_t buf;
+    TaskHandle_t               owner;      // Only accessed with g_control_mutex held
+    audio_ring_t               ring;       // Written by the owner, read by the mixer task
+    SemaphoreHandle_t          space;      // Given by the mixer task when a waiting writer can continue
+    atomic_bool                paused;     // stream is paused (asp_audio_stop)
+    atomic_bool                waiting;    // the owner is blocked on space in audio_mixer_write
+    atomic_uint                gain;       // Q15, AUDIO_MIXER_GAIN_UNITY = 1.0
+    _Atomic(audio_converter_t) converter;  // NULL when the stream is in the mixer format
 } mixer_stream_t;
 
-static mixer_stream_t    g_streams[AUDIO_MIXER_MAX_STREAMS];
-static SemaphoreHandle_t g_streams_mutex = NULL;
-static i2s_chan_handle_t g_i2s           = NULL;
-static TaskHandle_t      g_mixer_task    = NULL;
-static bool              g_initialized   = false;
+static mixer_stream_t* _Atomic g_slots[AUDIO_MIXER_MAX_STREAMS];
+static SemaphoreHandle_t       g_control_mutex = NULL;
+static i2s_chan_handle_t       g_i2s           = NULL;
+static TaskHandle_t            g_mixer_task    = NULL;
+static bool                    g_initialized   = false;
+// Set while the mixer task walks g_slots, the epoch is incremented at the
+// end of every pass.
+static atomic_bool             g_mix_in_pass   = false;
+static atomic_uint             g_mix_epoch     = 0;
 // I2S/amplifier are enabled by bsp_audio_initialize before the mixer task
 // starts, so the initial state is "powered on". The mixer task drops it
 // to "powered off" after its first idle drain pass. Only the mixer task
 // reads or writes this, so no synchronization is needed.
-static bool              g_powered_on    = true;
+static bool                    g_powered_on    = true;
+static atomic_uint             g_master_gain   = AUDIO_MIXER_GAIN_UNITY;
+// Look-ahead limiter state (audio_mix.h). Mixer task only.
+static audio_limiter_t         g_limiter       = {.gain = AUDIO_MIXER_GAIN_UNITY};
+// Worst-case CPU cycles spent mixing and limiting one chunk since the last
+// power-down, reported when the mixer goes idle. Mixer task only.
+static uint32_t                g_peak_cycles   = 0;
 
 // Scratch buffers for the mixer task. Static to keep them out of the task stack.
-static int16_t g_in_buf[MIXER_CHUNK_SAMPLES];
 static int32_t g_accum[MIXER_CHUNK_SAMPLES];
 static int16_t g_out_buf[MIXER_CHUNK_SAMPLES];
+static int16_t g_convert_buf[MIXER_CHUNK_SAMPLES];
 
 // Re-enable the I2S DMA channel and turn the speaker amplifier back on
 // before resuming mixing. The amplifier follows the current jack state so
@@ -89,6 +124,8 @@ static void power_down(void) {
     if (!g_powered_on) return;
 
     ESP_LOGI(TAG, "Audio idle and DMA drained — entering power-saving state, disabling amplifier and I2S");
+    ESP_LOGI(TAG, "Peak mixing cost: %" PRIu32 " cycles per %d frame chunk", g_peak_cycles, MIXER_CHUNK_FRAMES);
+    g_peak_cycles = 0;
 
     bsp_audio_set_amplifier(false);
 
@@ -100,6 +137,55 @@ static void power_down(void) {
     g_powered_on = false;
 }
 
+// Convert up to one chunk of a stream into g_convert_buf, feeding the
+// converter from the ring in place. Returns the number of frames. Only
+// called from the mixer task.
+static size_t convert_stream(mixer_stream_t* stream, audio_converter_t converter) {
+    size_t frames = 0;
+    while (1) {
+        frames += audio_converter_pull(converter, &g_convert_buf[frames * 2], MIXER_CHUNK_FRAMES - frames);
+        if (frames == MIXER_CHUNK_FRAMES) break;
+
+        const void* data = NULL;
+        size_t      size = audio_ring_acquire_read(stream->ring, &data);
+        if (size == 0) break;
+        size_t accepted = audio_converter_push(converter, data, size);
+        if (accepted == 0) break;
+        audio_ring_release(stream->ring, accepted);
+    }
+    return frames;
+}
+
+// Add up to one chunk of a stream to g_accum, reading the samples in place
+// from its ring. Returns false when the stream had no samples. Only called
+// from the mixer task.
+static bool mix_stream(mixer_stream_t* stream, uint32_t master_gain) {
+    int32_t gain = ((int32_t)atomic_load_explicit(&stream->gain, memory_order_relaxed) * (int32_t)master_gain) >> 15;
+    if (gain > UINT16_MAX) gain = UINT16_MAX;
+
+    size_t            mixed     = 0;
+    audio_converter_t converter = atomic_load_explicit(&stream->converter, memory_order_acquire);
+    if (converter != NULL) {
+        mixed = convert_stream(stream, converter) * 2;
+        audio_mix_accumulate(g_accum, g_convert_buf, mixed, gain);
+    }
+    while (converter == NULL && mixed < MIXER_CHUNK_SAMPLES) {
+        const void* data  = NULL;
+        size_t      count = audio_ring_acquire_read(stream->ring, &data) / sizeof(int16_t);
+        if (count == 0) break;
+        if (count > MIXER_CHUNK_SAMPLES - mixed) count = MIXER_CHUNK_SAMPLES - mixed;
+
+        audio_mix_accumulate(&g_accum[mixed], data, count, gain);
+        audio_ring_release(stream->ring, count * sizeof(int16_t));
+        mixed += count;
+    }
+
+    if (mixed > 0 && atomic_exchange(&stream->waiting, false)) {
+        xSemaphoreGive(stream->space);
+    }
+    return mixed > 0;
+}
+
 static void mixer_task_fn(void* arg) {
     (void)arg;
     // Number of consecutive silent chunks pushed into the DMA queue since
@@ -111,22 +197,21 @@ static void mixer_task_fn(void* arg) {
     while (1) {
         memset(g_accum, 0, sizeof(g_accum));
 
-        // Sum samples from every stream that produced data this chunk and
-        // count how many sources contributed, so we can divide the mix down
-        // to avoid clipping when multiple plugins play simultaneously.
-        int active_count = 0;
-        xSemaphoreTake(g_streams_mutex, portMAX_DELAY);
+        // Sum samples from every stream that produced data this chunk, each
+        // scaled by its own gain with the master gain folded in. Clipping is
+        // left to the limiter below rather than dividing by the number of
+        // sources, so levels don't jump when a stream starts or stops.
+        int      active_count = 0;
+        uint32_t mix_start    = esp_cpu_get_cycle_count();
+        uint32_t master_gain  = atomic_load_explicit(&g_master_gain, memory_order_relaxed);
+        atomic_store(&g_mix_in_pass, true);
         for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++) {
-            if (!g_streams[i].active || g_streams[i].paused || g_streams[i].buf == NULL) continue;
-            size_t got = xStreamBufferReceive(g_streams[i].buf, g_in_buf, sizeof(g_in_buf), 0);
-            if (got == 0) continue;
-            active_count++;
-            size_t n = got / sizeof(int16_t);
-            for (size_t j = 0; j < n; j++) {
-                g_accum[j] += g_in_buf[j];
-            }
+            mixer_stream_t* stream = atomic_load_explicit(&g_slots[i], memory_order_acquire);
+            if (stream == NULL || atomic_load_explicit(&stream->paused, memory_order_relaxed)) continue;
+            if (mix_stream(stream, master_gain)) active_count++;
         }
-        xSemaphoreGive(g_streams_mutex);
+        atomic_fetch_add(&g_mix_epoch, 1);
+        atomic_store(&g_mix_in_pass, false);
 
         if (active_count == 0) {
             // No producer had samples this round. If we're still powered
@@ -134,6 +219,7 @@ static void mixer_task_fn(void* arg) {
             // DMA queue until any previously-mixed audio has fully drained;
             // only then is it safe to disable the amp/I2S without chopping
             // off the tail of the last sound.
+            audio_limiter_reset(&g_limiter);
             if (!g_powered_on) {
                 // Already idle: just block until a producer wakes us.
                 ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
@@ -162,17 +248,10 @@ static void mixer_task_fn(void* arg) {
         }
         silence_chunks = 0;
 
-        // Per-source volume = total / N. Saturate as a safety net in case
-        // a single source is already at the int16 boundary.
-        int divisor = active_count;
-        for (size_t j = 0; j < MIXER_CHUNK_SAMPLES; j++) {
-            int32_t s = g_accum[j] / divisor;
-            if (s > INT16_MAX)
-                s = INT16_MAX;
-            else if (s < INT16_MIN)
-                s = INT16_MIN;
-            g_out_buf[j] = (int16_t)s;
-        }
+        audio_limiter_process(&g_limiter, g_accum, g_out_buf, MIXER_CHUNK_FRAMES);
+
+        uint32_t mix_cycles = esp_cpu_get_cycle_count() - mix_start;
+        if (mix_cycles > g_peak_cycles) g_peak_cycles = mix_cycles;
 
         size_t written = 0;
         // Blocks until DMA has room — paces the whole mixer to the I2S rate.
@@ -193,8 +272,8 @@ esp_err_t audio_mixer_init(void) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    g_streams_mutex = xSemaphoreCreateMutex();
-    if (g_streams_mutex == NULL) {
+    g_control_mutex = xSemaphoreCreateMutex();
+    if (g_control_mutex == NULL) {
         ESP_LOGE(TAG, "Failed to create mutex");
         return ESP_ERR_NO_MEM;
     }
@@ -202,8 +281,8 @@ esp_err_t audio_mixer_init(void) {
     BaseType_t ok =
         xTaskCreate(mixer_task_fn, "audio_mixer", MIXER_TASK_STACK, NULL, MIXER_TASK_PRIORITY, &g_mixer_task);
     if (ok != pdPASS) {
-        vSemaphoreDelete(g_streams_mutex);
-        g_streams_mutex = NULL;
+        vSemaphoreDelete(g_control_mutex);
+        g_control_mutex = NULL;
         ESP_LOGE(TAG, "Failed to create mixer task");
         return ESP_ERR_NO_MEM;
     }
@@ -213,60 +292,93 @@ esp_err_t audio_mixer_init(void) {
     return ESP_OK;
 }
 
-// Find an existing slot for `task`. Caller must hold g_streams_mutex.
-// Returns slot index or -1.
-static int find_slot_locked(TaskHandle_t task) {
+// Block until the mixer task is no longer in a pass that started before
+// the caller unpublished a stream, after which nothing references it.
+static void wait_for_mixer_pass(void) {
+    unsigned int epoch = atomic_load(&g_mix_epoch);
+    while (atomic_load(&g_mix_in_pass) && atomic_load(&g_mix_epoch) == epoch) {
+        vTaskDelay(1);
+    }
+}
+
+static void free_stream(mixer_stream_t* stream) {
+    audio_converter_free(atomic_load(&stream->converter));
+    audio_ring_free(stream->ring);
+    if (stream->space != NULL) vSemaphoreDelete(stream->space);
+    free(stream);
+}
+
+// Find the stream of `task`. Caller must hold g_control_mutex.
+// Returns NULL when the task has no stream.
+static mixer_stream_t* find_stream_locked(TaskHandle_t task) {
     for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++) {
-        if (g_streams[i].active && g_streams[i].owner == task) return i;
+        mixer_stream_t* stream = atomic_load_explicit(&g_slots[i], memory_order_relaxed);
+        if (stream != NULL && stream->owner == task) return stream;
     }
-    return -1;
+    return NULL;
 }
 
-// Free any slots whose owner task no longer exists. Caller must hold the mutex.
+// Free any streams whose owner task no longer exists. Caller must hold the mutex.
 static void sweep_dead_locked(void) {
     for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++) {
-        if (!g_streams[i].active) continue;
-        eTaskState s = eTaskGetState(g_streams[i].owner);
+        mixer_stream_t* stream = atomic_load_explicit(&g_slots[i], memory_order_relaxed);
+        if (stream == NULL) continue;
+        eTaskState s = eTaskGetState(stream->owner);
         if (s == eDeleted || s == eInvalid) {
-            vStreamBufferDelete(g_streams[i].buf);
-            g_streams[i].active = false;
-            g_streams[i].owner  = NULL;
-            g_streams[i].buf    = NULL;
-            g_streams[i].paused = false;
+            atomic_store(&g_slots[i], NULL);
+            wait_for_mixer_pass();
+            free_stream(stream);
         }
     }
 }
 
-// Allocate a fresh slot for `task`. Caller must hold the mutex.
-// Returns slot index or -1 on out-of-slots / out-of-memory.
-static int alloc_slot_locked(TaskHandle_t task) {
+// Allocate a fresh stream for `task`. Caller must hold the mutex.
+// Returns NULL on out-of-slots / out-of-memory.
+static mixer_stream_t* alloc_stream_locked(TaskHandle_t task) {
     for (int i = 0; i < AUDIO_MIXER_MAX_STREAMS; i++) {
-        if (!g_streams[i].active) {
-            StreamBufferHandle_t buf = xStreamBufferCreate(MIXER_STREAM_BYTES, MIXER_FRAME_BYTES);
-            if (buf == NULL) {
-                ESP_LOGE(TAG, "Failed to allocate stream buffer for task %p", task);
-                return -1;
-            }
-            g_streams[i].buf    = buf;
-            g_streams[i].owner  = task;
-            g_streams[i].paused = false;
-            g_streams[i].active = true;
-            ESP_LOGD(TAG, "Auto-registered audio stream %d for task %p", i, task);
-            return i;
+        if (atomic_load_explicit(&g_slots[i], memory_order_relaxed) != NULL) continue;
+
+        mixer_stream_t* stream = calloc(1, sizeof(mixer_stream_t));
+        if (stream == NULL) return NULL;
+        stream->owner = task;
+        stream->ring  = audio_ring_create(MIXER_STREAM_BYTES, MIXER_STREAM_PSRAM);
+        stream->space = xSemaphoreCreateBinary();
+        atomic_init(&stream->paused, false);
+        atomic_init(&stream->waiting, false);
+        atomic_init(&stream->gain, AUDIO_MIXER_GAIN_UNITY);
+        atomic_init(&stream->converter, NULL);
+        if (stream->ring == NULL || stream->space == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate stream buffer for task %p", task);
+            free_stream(stream);
+            return NULL;
         }
+
+        // Fully initialized before the mixer task can see it
+        atomic_store_explicit(&g_slots[i], stream, memory_order_release);
+        ESP_LOGD(TAG, "Auto-registered audio stream %d for task %p", i, task);
+        return stream;
     }
-    return -1;
+    return NULL;
 }
 
-// Find existing slot or allocate one (sweeping dead slots first if full).
+// Find existing stream or allocate one (sweeping dead streams first if full).
 // Caller must hold the mutex.
-static int find_or_alloc_slot_locked(TaskHandle_t task) {
-    int idx = find_slot_locked(task);
-    if (idx >= 0) return idx;
-    idx = alloc_slot_locked(task);
-    if (idx >= 0) return idx;
+static mixer_stream_t* find_or_alloc_stream_locked(TaskHandle_t task) {
+    mixer_stream_t* stream = find_stream_locked(task);
+    if (stream != NULL) return stream;
+    stream = alloc_stream_locked(task);
+    if (stream != NULL) return stream;
     sweep_dead_locked();
-    return alloc_slot_locked(task);
+    return alloc_stream_locked(task);
+}
+
+// Streams are only freed once their owner task has been deleted, so the
+// owner can keep using the pointer after the mutex has been released.
+static mixer_stream_t* get_own_stream(TaskHandle_t task, bool allocate) {
+    xSemaphoreTake(g_control_mutex, portMAX_DELAY);
+    mixer_stream_t* stream = allocate ? find_or_alloc_stream_locked(task) : find_stream_locked(task);
+    xSemaphoreGive(g_control_mutex);
+    return stream;
 }
 
 // Public API: pre-registration is now optional — writes auto-register.
@@ -274,10 +386,7 @@ static int find_or_alloc_slot_locked(TaskHandle_t task) {
 // freshly allocated.
 bool audio_mixer_register_stream(TaskHandle_t task) {
     if (!g_initialized || task == NULL) return false;
-    xSemaphoreTake(g_streams_mutex, portMAX_DELAY);
-    int idx = find_or_alloc_slot_locked(task);
-    xSemaphoreGive(g_streams_mutex);
-    return idx >= 0;
+    return get_own_stream(task, true) != NULL;
 }
 
 // Garbage-collect any slots whose owner task has been deleted. The `task`
@@ -285,67 +394,146 @@ bool audio_mixer_register_stream(TaskHandle_t task) {
 void audio_mixer_unregister_stream(TaskHandle_t task) {
     (void)task;
     if (!g_initialized) return;
-    xSemaphoreTake(g_streams_mutex, portMAX_DELAY);
+    xSemaphoreTake(g_control_mutex, portMAX_DELAY);
     sweep_dead_locked();
-    xSemaphoreGive(g_streams_mutex);
+    xSemaphoreGive(g_control_mutex);
 }
 
-size_t audio_mixer_write(TaskHandle_t task, const void* samples, size_t size_bytes, int64_t timeout_ms) {
-    if (!g_initialized || task == NULL || samples == NULL || size_bytes == 0) return 0;
-
-    StreamBufferHandle_t buf = NULL;
-
-    xSemaphoreTake(g_streams_mutex, portMAX_DELAY);
-    int idx = find_or_alloc_slot_locked(task);
-    if (idx >= 0 && !g_streams[idx].paused) {
-        buf = g_streams[idx].buf;
-    }
-    xSemaphoreGive(g_streams_mutex);
-
-    if (buf == NULL) return 0;
+size_t audio_mixer_acquire_write(TaskHandle_t task, void** out_data) {
+    if (!g_initialized || task == NULL || out_data == NULL) return 0;
+    mixer_stream_t* stream = get_own_stream(task, true);
+    if (stream == NULL || atomic_load(&stream->paused)) return 0;
+    size_t space = audio_ring_acquire_write(stream->ring, out_data);
+    return space - (space % AUDIO_MIXER_WRITE_ALIGN);
+}
 
-    TickType_t ticks = (timeout_ms < 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
-    size_t     sent  = xStreamBufferSend(buf, samples, size_bytes, ticks);
+void audio_mixer_commit(TaskHandle_t task, size_t size_bytes) {
+    if (!g_initialized || task == NULL || size_bytes == 0) return;
+    mixer_stream_t* stream = get_own_stream(task, false);
+    if (stream == NULL) return;
+    audio_ring_commit(stream->ring, size_bytes - (size_bytes % AUDIO_MIXER_WRITE_ALIGN));
 
     // If the mixer is currently parked in ulTaskNotifyTake (idle, hardware
     // powered down) it won't notice the new samples until something prods
-    // it. Notify on every successful send — it's cheap, and the mixer task
-    // ignores spurious wake-ups since it always re-checks the streams.
-    if (sent > 0 && g_mixer_task != NULL) {
+    // it. Notify on every commit — it's cheap, and the mixer task ignores
+    // spurious wake-ups since it always re-checks the streams.
+    if (g_mixer_task != NULL) {
         xTaskNotifyGive(g_mixer_task);
     }
-    return sent;
+}
+
+size_t audio_mixer_write(TaskHandle_t task, const void* samples, size_t size_bytes, int64_t timeout_ms) {
+    if (!g_initialized || task == NULL || samples == NULL) return 0;
+    size_bytes -= size_bytes % AUDIO_MIXER_WRITE_ALIGN;
+    if (size_bytes == 0) return 0;
+
+    mixer_stream_t* stream = get_own_stream(task, true);
+    if (stream == NULL) return 0;
+
+    TickType_t ticks   = (timeout_ms < 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    TickType_t start   = xTaskGetTickCount();
+    size_t     written = 0;
+    while (written < size_bytes && !atomic_load(&stream->paused)) {
+        void*  data  = NULL;
+        size_t space = audio_ring_acquire_write(stream->ring, &data);
+        if (space > 0) {
+            size_t size = size_bytes - written < space ? size_bytes - written : space;
+            memcpy(data, (const uint8_t*)samples + written, size);
+            audio_ring_commit(stream->ring, size);
+            written += size;
+            if (g_mixer_task != NULL) {
+                xTaskNotifyGive(g_mixer_task);
+            }
+            continue;
+        }
+
+        // The ring is full, wait for the mixer task to consume a chunk
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (ticks != portMAX_DELAY && elapsed >= ticks) break;
+        atomic_store(&stream->waiting, true);
+        if (audio_ring_acquire_write(stream->ring, &data) == 0) {
+            xSemaphoreTake(stream->space, ticks == portMAX_DELAY ? portMAX_DELAY : ticks - elapsed);
+        }
+        atomic_store(&stream->waiting, false);
+    }
+    return written;
 }
 
 bool audio_mixer_start(TaskHandle_t task) {
     if (!g_initialized || task == NULL) return false;
-    bool ok = false;
-    xSemaphoreTake(g_streams_mutex, portMAX_DELAY);
-    int idx = find_or_alloc_slot_locked(task);
-    if (idx >= 0) {
-        g_streams[idx].paused = false;
-        ok                    = true;
+    xSemaphoreTake(g_control_mutex, portMAX_DELAY);
+    mixer_stream_t* stream = find_or_alloc_stream_locked(task);
+    if (stream != NULL) {
+        atomic_store(&stream->paused, false);
     }
-    xSemaphoreGive(g_streams_mutex);
-    return ok;
+    xSemaphoreGive(g_control_mutex);
+    return stream != NULL;
 }
 
 bool audio_mixer_stop(TaskHandle_t task) {
     if (!g_initialized || task == NULL) return false;
+    xSemaphoreTake(g_control_mutex, portMAX_DELAY);
+    mixer_stream_t* stream = find_stream_locked(task);
+    if (stream != NULL) {
+        // Only the mixer task may move the read position, it drops the
+        // queued samples the next time it reads the stream. A writer blocked
+        // on space is woken up and returns short.
+        atomic_store(&stream->paused, true);
+        audio_ring_discard(stream->ring);
+        xSemaphoreGive(stream->space);
+    }
+    xSemaphoreGive(g_control_mutex);
+    return true;
+}
 
-    StreamBufferHandle_t buf = NULL;
-    xSemaphoreTake(g_streams_mutex, portMAX_DELAY);
-    int idx = find_slot_locked(task);
-    if (idx >= 0) {
-        g_streams[idx].paused = true;
-        buf                   = g_streams[idx].buf;
+bool audio_mixer_set_format(TaskHandle_t task, const audio_format_t* format) {
+    if (!g_initialized || task == NULL || format == NULL || !audio_format_is_valid(format)) return false;
+
+    // The mixer format needs no converter, anything else gets one that
+    // starts out with silent history
+    audio_converter_t converter = NULL;
+    if (format->rate != AUDIO_MIXER_SAMPLE_RATE || format->channels != 2 ||
+        format->sample_format != AUDIO_SAMPLE_S16) {
+        converter = audio_converter_create(format, AUDIO_MIXER_SAMPLE_RATE);
+        if (converter == NULL) {
+            ESP_LOGE(TAG, "Failed to create converter for task %p", task);
+            return false;
+        }
     }
-    xSemaphoreGive(g_streams_mutex);
 
-    // Reset outside the mutex; producer is the calling task itself, so it
-    // can't be blocked on send while also calling stop.
-    if (buf != NULL) {
-        xStreamBufferReset(buf);
+    xSemaphoreTake(g_control_mutex, portMAX_DELAY);
+    mixer_stream_t* stream = find_or_alloc_stream_locked(task);
+    if (stream != NULL) {
+        // Queued samples are in the old format. The owner is not writing, so
+        // every write position is aligned and the new frames can not wrap.
+        audio_ring_discard(stream->ring);
+        audio_converter_t old = atomic_exchange(&stream->converter, converter);
+        wait_for_mixer_pass();
+        audio_converter_free(old);
+        ESP_LOGD(TAG, "Stream of task %p now %" PRIu32 " Hz, %d channels, format %d", task, format->rate,
+                 format->channels, format->sample_format);
     }
-    return true;
+    xSemaphoreGive(g_control_mutex);
+
+    if (stream == NULL) audio_converter_free(converter);
+    return stream != NULL;
+}
+
+bool audio_mixer_set_gain(TaskHandle_t task, uint16_t gain_q15) {
+    if (!g_initialized || task == NULL) return false;
+    xSemaphoreTake(g_control_mutex, portMAX_DELAY);
+    mixer_stream_t* stream = find_stream_locked(task);
+    if (stream != NULL) {
+        atomic_store_explicit(&stream->gain, gain_q15, memory_order_relaxed);
+    }
+    xSemaphoreGive(g_control_mutex);
+    return stream != NULL;
+}
+
+void audio_mixer_set_master_gain(uint16_t gain_q15) {
+    atomic_store_explicit(&g_master_gain, gain_q15, memory_order_relaxed);
+}
+
+uint16_t audio_mixer_get_master_gain(void) {
+    return (uint16_t)atomic_load_explicit(&g_master_gain, memory_order_relaxed);
 }
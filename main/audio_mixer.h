@@ -4,15 +4,23 @@
 // The BSP exposes a single I2S output channel. Without coordination, two
 // plugins writing to it concurrently interleave their DMA buffers and produce
 // chopped audio. This module owns the I2S channel exclusively and gives each
-// plugin task its own FreeRTOS StreamBuffer; a mixer task drains every active
-// stream, sums samples in int32 (saturating to int16), and writes the result
-// to I2S.
+// plugin task its own lock-free ring buffer (audio_ring.h); a mixer task
+// drains every active stream, scales each by its own gain, sums in int32 and
+// writes the result to I2S (audio_mix.h). The mixer never takes a lock, so a producer can
+// not stall the mix and the mix can not stall a producer.
 //
-// Audio format is fixed: 16-bit signed PCM, stereo (L/R interleaved). The
-// mixer assumes the BSP's I2S channel is configured at the matching rate
-// (44.1 kHz by default). asp_audio_set_rate still passes through to the BSP
-// unchanged; if plugins disagree on rate the last writer wins and others play
-// at the wrong pitch.
+// Streams are mixed at their own level instead of being divided by the number
+// of active streams, so a second plugin starting to play does not make the
+// first one drop in volume. A master gain is applied on top, and a look-ahead
+// peak limiter pulls the mix down smoothly when it would otherwise clip.
+//
+// The mix is 16-bit signed PCM, stereo (L/R interleaved) at
+// AUDIO_MIXER_SAMPLE_RATE, the rate the BSP's I2S channel is configured at.
+// Streams default to the same format and are then mixed straight from their
+// ring. A stream can select another rate, mono and 8-bit samples with
+// audio_mixer_set_format; the mixer task then runs its samples through a
+// converter (audio_convert.h) on the way into the mix, so producers at
+// different rates play side by side at the right pitch.
 //
 // Idle power management: when every stream has been silent long enough for
 // the I2S DMA queue to drain, the mixer disables the speaker amplifier and
@@ -25,11 +33,22 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include "audio_convert.h"
+#include "audio_mix.h"
 #include "esp_err.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 #define AUDIO_MIXER_MAX_STREAMS 8
+#define AUDIO_MIXER_SAMPLE_RATE 44100
+
+// Writes are accepted in multiples of this many bytes, a whole number of
+// frames in every stream format.
+#define AUDIO_MIXER_WRITE_ALIGN 4
+
+// Gains are unsigned Q15 fixed point: AUDIO_MIXER_GAIN_UNITY is 1.0, the
+// maximum value of 65535 is just under 2.0 (+6 dB).
+#define AUDIO_MIXER_GAIN_UNITY AUDIO_MIX_GAIN_UNITY
 
 esp_err_t audio_mixer_init(void);
 
@@ -47,6 +66,29 @@ bool audio_mixer_start(TaskHandle_t task);
 // blocking writes from the plugin will unblock with a short return.
 bool audio_mixer_stop(TaskHandle_t task);
 
+// Set the format of the samples the stream owned by `task` is written in.
+// Samples still queued in the old format are discarded. Only the owner may
+// call this, not while it is writing. Returns false for an unsupported
+// format, when out of memory, or if no stream could be allocated.
+bool audio_mixer_set_format(TaskHandle_t task, const audio_format_t* format);
+
 // Returns the number of bytes accepted into the stream. 0 when the stream
 // is unknown, paused, or the timeout elapsed before the entire chunk fit.
+// Sizes are rounded down to a multiple of AUDIO_MIXER_WRITE_ALIGN.
 size_t audio_mixer_write(TaskHandle_t task, const void* samples, size_t size_bytes, int64_t timeout_ms);
+
+// Zero-copy variant of audio_mixer_write for the task owning the stream.
+// acquire_write returns the number of bytes, a multiple of
+// AUDIO_MIXER_WRITE_ALIGN, that can be written at *out_data without blocking
+// (0 when the stream is full or paused); commit hands the written samples to
+// the mixer.
+size_t audio_mixer_acquire_write(TaskHandle_t task, void** out_data);
+void   audio_mixer_commit(TaskHandle_t task, size_t size_bytes);
+
+// Set the gain of the stream owned by `task`. New streams start at unity.
+// Returns false if the task has no registered stream.
+bool audio_mixer_set_gain(TaskHandle_t task, uint16_t gain_q15);
+
+// Set the gain applied to the whole mix before limiting.
+void     audio_mixer_set_master_gain(uint16_t gain_q15);
+uint16_t audio_mixer_get_master_gain(void);
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: MIT
+
+#include "audio_ring.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_heap_caps.h"
+
+// Positions are free-running byte counters, head - tail is the amount of
+// queued data even after the counters wrap around.
+struct audio_ring {
+    // Written by the producer
+    alignas(AUDIO_RING_CACHE_LINE) atomic_size_t head;
+    atomic_size_t discard_position;
+    atomic_bool   discard_pending;
+
+    // Written by the consumer
+    alignas(AUDIO_RING_CACHE_LINE) atomic_size_t tail;
+
+    // Constant after creation
+    alignas(AUDIO_RING_CACHE_LINE) uint8_t* data;
+    size_t size;
+    size_t mask;
+};
+
+audio_ring_t audio_ring_create(size_t size, bool psram) {
+    size_t capacity = AUDIO_RING_CACHE_LINE;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+
+    audio_ring_t ring = heap_caps_aligned_calloc(AUDIO_RING_CACHE_LINE, 1, sizeof(struct audio_ring),
+                                                 MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (ring == NULL) {
+        return NULL;
+    }
+    uint32_t caps = psram ? MALLOC_CAP_SPIRAM : (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    ring->data    = heap_caps_aligned_alloc(AUDIO_RING_CACHE_LINE, capacity, caps);
+    if (ring->data == NULL) {
+        heap_caps_free(ring);
+        return NULL;
+    }
+    ring->size = capacity;
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->discard_position, 0);
+    atomic_init(&ring->discard_pending, false);
+    return ring;
+}
+
+void audio_ring_free(audio_ring_t ring) {
+    if (ring == NULL) {
+        return;
+    }
+    heap_caps_free(ring->data);
+    heap_caps_free(ring);
+}
+
+size_t audio_ring_size(audio_ring_t ring) {
+    return ring->size;
+}
+
+size_t audio_ring_acquire_write(audio_ring_t ring, void** out_data) {
+    size_t head       = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail       = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t offset     = head & ring->mask;
+    size_t space      = ring->size - (head - tail);
+    size_t contiguous = ring->size - offset;
+
+    *out_data = &ring->data[offset];
+    return space < contiguous ? space : contiguous;
+}
+
+void audio_ring_commit(audio_ring_t ring, size_t size) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + size, memory_order_release);
+}
+
+void audio_ring_discard(audio_ring_t ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->discard_position, head, memory_order_relaxed);
+    atomic_store_explicit(&ring->discard_pending, true, memory_order_release);
+}
+
+size_t audio_ring_acquire_read(audio_ring_t ring, const void** out_data) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    // The head is loaded after the discard request, so it is never behind the requested position
+    bool   discard = atomic_exchange_explicit(&ring->discard_pending, false, memory_order_acquire);
+    size_t head    = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (discard) {
+        // A position the consumer has already passed belongs to an older discard and is ignored
+        size_t position = atomic_load_explicit(&ring->discard_position, memory_order_relaxed);
+        if (position - tail <= head - tail) {
+            tail = position;
+            atomic_store_explicit(&ring->tail, tail, memory_order_release);
+        }
+    }
+
+    size_t offset     = tail & ring->mask;
+    size_t available  = head - tail;
+    size_t contiguous = ring->size - offset;
+
+    *out_data = &ring->data[offset];
+    return available < contiguous ? available : contiguous;
+}
+
+void audio_ring_release(audio_ring_t ring, size_t size) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + size, memory_order_release);
+}
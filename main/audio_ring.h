@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: MIT
+// Lock-free single-producer/single-consumer byte ring for audio streams.
+//
+// Exactly one task writes into a ring and exactly one task reads from it,
+// neither side ever takes a lock or blocks. Both sides work in place: the
+// producer asks for the contiguous free space at the write position, fills
+// it and commits the bytes; the consumer asks for the contiguous data at
+// the read position, uses it and releases the bytes. When the free space or
+// the data wraps around the end of the buffer, a second acquire returns the
+// part at the start of the buffer.
+//
+// The capacity is rounded up to a power of two so positions can be kept as
+// free-running counters and wrapped with a mask. The producer and consumer
+// counters live on separate cache lines.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define AUDIO_RING_CACHE_LINE 64
+
+typedef struct audio_ring* audio_ring_t;
+
+// Creates a ring of at least `size` bytes, with the buffer in PSRAM or in
+// internal RAM. Returns NULL when out of memory.
+audio_ring_t audio_ring_create(size_t size, bool psram);
+void         audio_ring_free(audio_ring_t ring);
+size_t       audio_ring_size(audio_ring_t ring);
+
+// Producer side. Returns the number of contiguous bytes that can be written
+// at *out_data, which may be less than the total free space.
+size_t audio_ring_acquire_write(audio_ring_t ring, void** out_data);
+void   audio_ring_commit(audio_ring_t ring, size_t size);
+// Makes the consumer skip everything committed so far, on its next acquire
+void   audio_ring_discard(audio_ring_t ring);
+
+// Consumer side. Returns the number of contiguous bytes that can be read
+// at *out_data, which may be less than the total amount of queued data.
+size_t audio_ring_acquire_read(audio_ring_t ring, const void** out_data);
+void   audio_ring_release(audio_ring_t ring, size_t size);
@@ -1,10 +1,15 @@
 #include "common/display.h"
+#include <stdlib.h>
+#include <string.h>
 #include "bsp/display.h"
 #include "esp_err.h"
+#include "esp_log.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_ops.h"
 #include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
 #include "freertos/idf_additions.h"
+#include "gui_damage.h"
 #include "hal/lcd_types.h"
 #include "pax_gfx.h"
 #include "pax_types.h"
@@ -23,6 +28,13 @@ static size_t                     display_v_res        = 0;
 static bsp_display_color_format_t display_color_format = 0;
 static bsp_display_endianness_t   display_data_endian  = 0;
 static pax_buf_t                  fb                   = {0};
+static pax_orientation_t          display_orientation  = PAX_O_UPRIGHT;
+static size_t                     display_bpp          = 0;  // Bytes per pixel, 0 for sub-byte formats
+static uint8_t*                   damage_scratch       = NULL;
+static size_t                     damage_scratch_size  = 0;
+static display_stats_t            display_stats        = {0};
+
+static const char* TAG = "display";
 
 #if defined(CONFIG_BSP_TARGET_KAMI)
 static pax_col_t palette[] = {0xffffffff, 0xff000000, 0xffff0000};  // white, black, red
@@ -126,6 +138,29 @@ esp_err_t display_init(void) {
 #endif
 
     pax_buf_set_orientation(&fb, orientation);
+    display_orientation = orientation;
+
+    switch (format) {
+        case PAX_BUF_8_PAL:
+        case PAX_BUF_8_GREY:
+        case PAX_BUF_8_332RGB:
+        case PAX_BUF_8_2222ARGB:
+            display_bpp = 1;
+            break;
+        case PAX_BUF_16_565RGB:
+        case PAX_BUF_16_4444ARGB:
+            display_bpp = 2;
+            break;
+        case PAX_BUF_24_888RGB:
+            display_bpp = 3;
+            break;
+        case PAX_BUF_32_8888ARGB:
+            display_bpp = 4;
+            break;
+        default:
+            display_bpp = 0;
+            break;
+    }
 
 #if CONFIG_ENABLE_LAUNCHERPLUGINS
     asp_disp_fb      = pax_buf_get_pixels_rw(&fb);
@@ -139,11 +174,122 @@ pax_buf_t* display_get_buffer(void) {
     return &fb;
 }
 
+static void update_stats(int64_t start_time, size_t bytes, bool partial) {
+    uint32_t duration = (uint32_t)(esp_timer_get_time() - start_time);
+    if (partial) {
+        display_stats.partial_frames++;
+    } else {
+        display_stats.full_frames++;
+    }
+    display_stats.bytes_transferred     += bytes;
+    display_stats.bytes_full_equivalent += display_h_res * display_v_res * display_bpp;
+    display_stats.last_frame_us          = duration;
+    if (duration > display_stats.max_frame_us) {
+        display_stats.max_frame_us = duration;
+    }
+}
+
 void display_blit_buffer(pax_buf_t* fb) {
+    int64_t start_time = esp_timer_get_time();
     pax_join();
     size_t display_h_res = 0, display_v_res = 0;
     ESP_ERROR_CHECK(bsp_display_get_parameters(&display_h_res, &display_v_res, NULL, NULL));
     ESP_ERROR_CHECK(bsp_display_blit(0, 0, display_h_res, display_v_res, pax_buf_get_pixels(fb)));
+    gui_damage_clear();
+    update_stats(start_time, display_h_res * display_v_res * display_bpp, false);
+}
+
+// Converts a rectangle in (rotated) PAX coordinates into panel coordinates, clipped to the panel
+static gui_damage_rect_t damage_to_panel(gui_damage_rect_t rect) {
+    int               w   = display_h_res;
+    int               h   = display_v_res;
+    gui_damage_rect_t out = rect;
+    switch (display_orientation) {
+        case PAX_O_ROT_CCW:
+            out = (gui_damage_rect_t){rect.y, h - rect.x - rect.w, rect.h, rect.w};
+            break;
+        case PAX_O_ROT_HALF:
+            out = (gui_damage_rect_t){w - rect.x - rect.w, h - rect.y - rect.h, rect.w, rect.h};
+            break;
+        case PAX_O_ROT_CW:
+            out = (gui_damage_rect_t){w - rect.y - rect.h, rect.x, rect.h, rect.w};
+            break;
+        case PAX_O_UPRIGHT:
+        default:
+            break;
+    }
+    if (out.x < 0) {
+        out.w += out.x;
+        out.x  = 0;
+    }
+    if (out.y < 0) {
+        out.h += out.y;
+        out.y  = 0;
+    }
+    if (out.x + out.w > w) out.w = w - out.x;
+    if (out.y + out.h > h) out.h = h - out.y;
+    return out;
+}
+
+void display_blit_damage(pax_buf_t* buffer) {
+    gui_damage_rect_t rects[GUI_DAMAGE_MAX_RECTS];
+    bool              all   = false;
+    size_t            count = gui_damage_take(rects, GUI_DAMAGE_MAX_RECTS, &all);
+
+    // Damage only describes the display framebuffer, and sub-byte pixel formats can not be cut into regions
+    if (buffer != &fb || all || count == 0 || display_bpp == 0 || display_is_epaper()) {
+        display_blit_buffer(buffer);
+        return;
+    }
+
+    int64_t start_time = esp_timer_get_time();
+    pax_join();
+
+    size_t scratch_needed = 0;
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = damage_to_panel(rects[i]);
+        if (rects[i].w > 0 && rects[i].h > 0 && rects[i].w < (int)display_h_res) {
+            scratch_needed += (size_t)rects[i].w * rects[i].h * display_bpp;
+        }
+    }
+
+    if (scratch_needed > damage_scratch_size) {
+        uint8_t* new_scratch = realloc(damage_scratch, scratch_needed);
+        if (new_scratch == NULL) {
+            ESP_LOGW(TAG, "Out of memory for partial blit, sending full frame");
+            display_blit_buffer(buffer);
+            return;
+        }
+        damage_scratch      = new_scratch;
+        damage_scratch_size = scratch_needed;
+    }
+
+    const uint8_t* pixels         = pax_buf_get_pixels(&fb);
+    size_t         stride         = display_h_res * display_bpp;
+    size_t         scratch_offset = 0;
+    size_t         bytes          = 0;
+    for (size_t i = 0; i < count; i++) {
+        gui_damage_rect_t* rect = &rects[i];
+        if (rect->w <= 0 || rect->h <= 0) {
+            continue;
+        }
+        size_t row_size = (size_t)rect->w * display_bpp;
+        if (rect->w == (int)display_h_res) {
+            // Full-width bands are contiguous in the framebuffer and can be sent in place
+            ESP_ERROR_CHECK(bsp_display_blit(0, rect->y, display_h_res, rect->y + rect->h, &pixels[rect->y * stride]));
+        } else {
+            uint8_t* region = &damage_scratch[scratch_offset];
+            for (int row = 0; row < rect->h; row++) {
+                memcpy(&region[row * row_size], &pixels[(rect->y + row) * stride + rect->x * display_bpp], row_size);
+            }
+            scratch_offset += row_size * rect->h;
+            ESP_ERROR_CHECK(bsp_display_blit(rect->x, rect->y, rect->x + rect->w, rect->y + rect->h, region));
+        }
+        bytes += row_size * rect->h;
+    }
+
+    update_stats(start_time, bytes, true);
+    ESP_LOGD(TAG, "Partial blit of %u regions, %u bytes", count, bytes);
 }
 
 void display_blit(void) {
@@ -161,3 +307,13 @@ bool display_is_epaper(void) {
     return false;
 #endif
 }
+
+void display_get_stats(display_stats_t* out_stats) {
+    if (out_stats != NULL) {
+        *out_stats = display_stats;
+    }
+}
+
+void display_reset_stats(void) {
+    memset(&display_stats, 0, sizeof(display_stats));
+}
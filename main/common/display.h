@@ -1,12 +1,25 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "esp_err.h"
 #include "pax_types.h"
 
+typedef struct {
+    uint32_t full_frames;            // Frames sent as a whole
+    uint32_t partial_frames;         // Frames sent as one or more damaged regions
+    uint64_t bytes_transferred;      // Bytes pushed to the display
+    uint64_t bytes_full_equivalent;  // Bytes that would have been pushed without damage tracking
+    uint32_t last_frame_us;          // Duration of the most recent blit
+    uint32_t max_frame_us;           // Longest blit since the statistics were reset
+} display_stats_t;
+
 esp_err_t  display_init(void);
 pax_buf_t* display_get_buffer(void);
 void       display_blit_buffer(pax_buf_t* fb);
+void       display_blit_damage(pax_buf_t* fb);
 void       display_blit(void);
 bool       display_is_initialized(void);
 bool       display_is_epaper(void);
+void       display_get_stats(display_stats_t* out_stats);
+void       display_reset_stats(void);
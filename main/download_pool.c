@@ -0,0 +1,258 @@
+#include "download_pool.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "fastopen.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char* TAG = "Download pool";
+
+#define DOWNLOAD_POOL_TASK_STACK        6144
+#define DOWNLOAD_POOL_WORKER_RAM        (56 * 1024)  // TLS context, HTTP buffers and task stack of one worker
+#define DOWNLOAD_POOL_MAX_WORKERS       8
+#define DOWNLOAD_POOL_PROGRESS_INTERVAL pdMS_TO_TICKS(100)
+
+typedef struct {
+    char*   url;
+    char*   path;
+    uint8_t sha256[HTTP_SHA256_SIZE];  // Expected digest of the file
+    bool    has_sha256;                // Indication that sha256 is set
+} download_pool_job_t;
+
+struct download_pool {
+    download_pool_job_t* jobs;
+    size_t               count;
+    size_t               capacity;
+    size_t               next;          // Index of the next job to hand out
+    size_t               received;      // Bytes received by all workers together
+    size_t               total;         // Sum of the sizes announced so far
+    volatile bool        cancelled;     // Set on the first failure, makes the other workers abort
+    esp_err_t            result;
+    SemaphoreHandle_t    mutex;         // Protects next, received, total and result
+    SemaphoreHandle_t    workers_done;  // Given by every worker when it exits
+};
+
+// Per-download state of a worker, used as the argument of the file sink
+typedef struct {
+    download_pool_t            pool;
+    const download_pool_job_t* job;
+    FILE*                      fd;
+    size_t                     size;
+    size_t                     received;
+} download_pool_transfer_t;
+
+static bool download_pool_sink_begin(size_t size, void* arg) {
+    download_pool_transfer_t* transfer = (download_pool_transfer_t*)arg;
+    if (transfer->pool->cancelled) return false;
+
+    transfer->fd = fastopen(transfer->job->path, "wb");
+    if (transfer->fd == NULL) {
+        ESP_LOGE(TAG, "Failed to open %s", transfer->job->path);
+        return false;
+    }
+    transfer->size     = size;
+    transfer->received = 0;
+    xSemaphoreTake(transfer->pool->mutex, portMAX_DELAY);
+    transfer->pool->total += size;
+    xSemaphoreGive(transfer->pool->mutex);
+    return true;
+}
+
+static bool download_pool_sink_write(const uint8_t* data, size_t length, size_t offset, void* arg) {
+    download_pool_transfer_t* transfer = (download_pool_transfer_t*)arg;
+    if (transfer->pool->cancelled) return false;
+
+    if (fwrite(data, 1, length, transfer->fd) != length) {
+        ESP_LOGE(TAG, "Failed to write %s", transfer->job->path);
+        return false;
+    }
+    transfer->received += length;
+    xSemaphoreTake(transfer->pool->mutex, portMAX_DELAY);
+    transfer->pool->received += length;
+    xSemaphoreGive(transfer->pool->mutex);
+    return true;
+}
+
+static bool download_pool_sink_end(bool success, void* arg) {
+    download_pool_transfer_t* transfer = (download_pool_transfer_t*)arg;
+    if (transfer->fd != NULL) {
+        fastclose(transfer->fd);
+        transfer->fd = NULL;
+    }
+
+    // Take a failed attempt back out of the totals, the session may retry from the start
+    if (!success) {
+        xSemaphoreTake(transfer->pool->mutex, portMAX_DELAY);
+        transfer->pool->received -= transfer->received;
+        transfer->pool->total    -= transfer->size;
+        xSemaphoreGive(transfer->pool->mutex);
+        transfer->received = 0;
+        transfer->size     = 0;
+        unlink(transfer->job->path);
+    }
+    return success;
+}
+
+static bool download_pool_fetch(download_pool_t pool, http_session_t session, const download_pool_job_t* job) {
+    download_pool_transfer_t transfer = {.pool = pool, .job = job};
+    http_stream_sink_t       sink     = {.begin = download_pool_sink_begin,
+                                         .write = download_pool_sink_write,
+                                         .end   = download_pool_sink_end,
+                                         .arg   = &transfer};
+    http_session_set_expected_sha256(session, job->has_sha256 ? job->sha256 : NULL);
+    if (!http_session_download_stream(session, job->url, &sink)) {
+        return false;
+    }
+
+    // The sink is only started by the first chunk of data, an empty file still has to be created
+    if (access(job->path, F_OK) != 0) {
+        FILE* fd = fastopen(job->path, "wb");
+        if (fd == NULL) return false;
+        fastclose(fd);
+    }
+    return true;
+}
+
+static void download_pool_worker_task(void* arg) {
+    download_pool_t pool    = (download_pool_t)arg;
+    http_session_t  session = NULL;
+
+    while (!pool->cancelled) {
+        xSemaphoreTake(pool->mutex, portMAX_DELAY);
+        download_pool_job_t* job = (pool->next < pool->count) ? &pool->jobs[pool->next++] : NULL;
+        xSemaphoreGive(pool->mutex);
+        if (job == NULL) break;
+
+        if (session == NULL) {
+            session = http_session_begin(job->url);
+        }
+        if (session == NULL || !download_pool_fetch(pool, session, job)) {
+            if (!pool->cancelled) {
+                ESP_LOGE(TAG, "Failed to download %s", job->url);
+            }
+            xSemaphoreTake(pool->mutex, portMAX_DELAY);
+            if (pool->result == ESP_OK) {
+                pool->result = (session == NULL) ? ESP_ERR_NO_MEM : ESP_FAIL;
+            }
+            pool->cancelled = true;
+            xSemaphoreGive(pool->mutex);
+            break;
+        }
+    }
+
+    http_session_end(session);
+    xSemaphoreGive(pool->workers_done);
+    vTaskDelete(NULL);
+}
+
+download_pool_t download_pool_create(void) {
+    return calloc(1, sizeof(struct download_pool));
+}
+
+bool download_pool_add(download_pool_t pool, const char* url, const char* path, const uint8_t* sha256) {
+    if (pool == NULL || url == NULL || path == NULL) return false;
+    if (pool->count >= pool->capacity) {
+        size_t               new_capacity = pool->capacity ? pool->capacity * 2 : 8;
+        download_pool_job_t* new_jobs     = realloc(pool->jobs, new_capacity * sizeof(download_pool_job_t));
+        if (new_jobs == NULL) return false;
+        pool->jobs     = new_jobs;
+        pool->capacity = new_capacity;
+    }
+    download_pool_job_t* job = &pool->jobs[pool->count];
+    job->url                 = strdup(url);
+    job->path                = strdup(path);
+    job->has_sha256          = sha256 != NULL;
+    if (sha256 != NULL) {
+        memcpy(job->sha256, sha256, HTTP_SHA256_SIZE);
+    }
+    if (job->url == NULL || job->path == NULL) {
+        free(job->url);
+        free(job->path);
+        return false;
+    }
+    pool->count++;
+    return true;
+}
+
+size_t download_pool_get_count(download_pool_t pool) {
+    return (pool != NULL) ? pool->count : 0;
+}
+
+esp_err_t download_pool_run(download_pool_t pool, size_t workers, size_t ram_budget, download_callback_t callback,
+                            const char* text) {
+    if (pool == NULL) return ESP_ERR_INVALID_ARG;
+    if (pool->count == 0) return ESP_OK;
+
+    if (workers > ram_budget / DOWNLOAD_POOL_WORKER_RAM) workers = ram_budget / DOWNLOAD_POOL_WORKER_RAM;
+    if (workers > DOWNLOAD_POOL_MAX_WORKERS) workers = DOWNLOAD_POOL_MAX_WORKERS;
+    if (workers > pool->count) workers = pool->count;
+    if (workers < 1) workers = 1;
+
+    pool->next         = 0;
+    pool->received     = 0;
+    pool->total        = 0;
+    pool->cancelled    = false;
+    pool->result       = ESP_OK;
+    pool->mutex        = xSemaphoreCreateMutex();
+    pool->workers_done = xSemaphoreCreateCounting(workers, 0);
+    if (pool->mutex == NULL || pool->workers_done == NULL) {
+        if (pool->mutex != NULL) vSemaphoreDelete(pool->mutex);
+        if (pool->workers_done != NULL) vSemaphoreDelete(pool->workers_done);
+        pool->mutex        = NULL;
+        pool->workers_done = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t started = 0;
+    for (size_t i = 0; i < workers; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "download_%u", i);
+        if (xTaskCreate(download_pool_worker_task, name, DOWNLOAD_POOL_TASK_STACK, pool, 5, NULL) != pdPASS) {
+            ESP_LOGW(TAG, "Failed to start download worker %u", i);
+            break;
+        }
+        started++;
+    }
+    if (started == 0) {
+        pool->result = ESP_ERR_NO_MEM;
+    } else {
+        ESP_LOGI(TAG, "Downloading %u files with %u workers", pool->count, started);
+    }
+
+    // Report progress from this task so the callback never runs concurrently with itself
+    size_t finished = 0;
+    while (finished < started) {
+        if (xSemaphoreTake(pool->workers_done, DOWNLOAD_POOL_PROGRESS_INTERVAL) == pdTRUE) {
+            finished++;
+        }
+        if (callback != NULL) {
+            xSemaphoreTake(pool->mutex, portMAX_DELAY);
+            size_t received = pool->received;
+            size_t total    = pool->total;
+            xSemaphoreGive(pool->mutex);
+            callback(received, total, text);
+        }
+    }
+
+    vSemaphoreDelete(pool->mutex);
+    vSemaphoreDelete(pool->workers_done);
+    pool->mutex        = NULL;
+    pool->workers_done = NULL;
+    return pool->result;
+}
+
+void download_pool_free(download_pool_t pool) {
+    if (pool == NULL) return;
+    for (size_t i = 0; i < pool->count; i++) {
+        free(pool->jobs[i].url);
+        free(pool->jobs[i].path);
+    }
+    free(pool->jobs);
+    free(pool);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "http_download.h"
+
+// Downloads a list of files concurrently, each worker using its own HTTP session. The number of workers is
+// limited both by the requested count and by a RAM budget, since every session holds its own TLS context and
+// buffers. Progress of all workers is aggregated and reported from the calling task. The first failed download
+// cancels the others. Files queued with a SHA-256 digest are verified while they are downloaded, a mismatch fails
+// the download and removes the file.
+
+typedef struct download_pool* download_pool_t;
+
+download_pool_t download_pool_create(void);
+bool            download_pool_add(download_pool_t pool, const char* url, const char* path, const uint8_t* sha256);
+size_t          download_pool_get_count(download_pool_t pool);
+esp_err_t       download_pool_run(download_pool_t pool, size_t workers, size_t ram_budget, download_callback_t callback,
+                                  const char* text);
+void            download_pool_free(download_pool_t pool);
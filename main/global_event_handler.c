@@ -8,6 +8,10 @@
 #include "nvs_settings_hardware.h"
 #include "sdcard.h"
 
+#ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
+#include "plugin_events.h"
+#endif
+
 static const char TAG[]               = "Event";
 static int        input_hook_id       = -1;
 static bool       power_button_latch  = false;
@@ -44,6 +48,9 @@ static void handle_sdcard(bool inserted) {
         ESP_LOGI(TAG, "SD card removed");
         sd_unmount();
     }
+#ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
+    plugin_events_publish(inserted ? PLUGIN_EVENT_SD_INSERTED : PLUGIN_EVENT_SD_REMOVED, 0, NULL);
+#endif
 }
 
 static void handle_audiojack(bool inserted) {
@@ -53,6 +60,9 @@ static void handle_audiojack(bool inserted) {
     // Re-apply the per-output volume since speaker and headphone settings
     // are stored separately.
     bsp_audio_set_volume((float)get_active_volume());
+#ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
+    plugin_events_publish(inserted ? PLUGIN_EVENT_AUDIO_JACK_INSERTED : PLUGIN_EVENT_AUDIO_JACK_REMOVED, 0, NULL);
+#endif
 }
 
 static void handle_volume(bool up, bool state) {
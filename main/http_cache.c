@@ -0,0 +1,501 @@
+#include "http_cache.h"
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "esp_log.h"
+#include "fastopen.h"
+#include "filesystem_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "http_download.h"
+#include "sys/unistd.h"
+
+static const char* TAG = "HTTP cache";
+
+#ifndef HTTP_CACHE_SD_PATH  // The host tests keep their cache in a temporary directory
+#define HTTP_CACHE_SD_PATH  "/sd/cache/http"
+#define HTTP_CACHE_INT_PATH "/int/cache/http"
+#endif
+#define HTTP_CACHE_MAGIC      0x48434348  // "HCCH"
+#define HTTP_CACHE_VERSION    1
+#define HTTP_CACHE_MAX_BYTES  ((size_t)CONFIG_HTTP_CACHE_SIZE * 1024)
+#define HTTP_CACHE_NAME_SIZE  24    // 16 hex digits of the URL hash and the extension
+#define HTTP_CACHE_CHUNK_SIZE 4096  // Piece of a stored body handed to a stream sink at once
+
+typedef struct {
+    uint32_t          magic;
+    uint16_t          version;
+    uint16_t          url_length;
+    uint32_t          body_size;
+    uint32_t          last_used;  // Time of the last use, orders entries for eviction
+    http_validators_t validators;
+} http_cache_header_t;
+
+typedef struct {
+    char     name[HTTP_CACHE_NAME_SIZE];
+    uint32_t last_used;
+    size_t   size;
+} http_cache_entry_t;
+
+// The repository icon workers download through the cache while the UI task does, cache_mutex protects the choice of
+// the directory, the stats and eviction
+static SemaphoreHandle_t  cache_mutex     = NULL;
+static const char*        cache_directory = NULL;
+static http_cache_stats_t stats           = {0};
+
+void http_cache_init(void) {
+    if (cache_mutex == NULL) {
+        cache_mutex = xSemaphoreCreateMutex();
+        if (cache_mutex == NULL) {
+            ESP_LOGE(TAG, "Failed to create mutex");
+        }
+    }
+}
+
+// NULL without a directory, and before http_cache_init, then downloads bypass the cache
+static const char* get_cache_directory(void) {
+    if (cache_mutex == NULL) {
+        return NULL;
+    }
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    if (cache_directory == NULL) {
+        if (fs_utils_exists("/sd") && fs_utils_mkdir_recursive(HTTP_CACHE_SD_PATH, false) == ESP_OK) {
+            cache_directory = HTTP_CACHE_SD_PATH;
+        } else if (fs_utils_mkdir_recursive(HTTP_CACHE_INT_PATH, false) == ESP_OK) {
+            cache_directory = HTTP_CACHE_INT_PATH;
+        } else {
+            ESP_LOGW(TAG, "No cache directory available");
+        }
+    }
+    const char* directory = cache_directory;
+    xSemaphoreGive(cache_mutex);
+    return directory;
+}
+
+static void count(size_t* counter) {
+    if (cache_mutex != NULL) {
+        xSemaphoreTake(cache_mutex, portMAX_DELAY);
+        (*counter)++;
+        xSemaphoreGive(cache_mutex);
+    }
+}
+
+// 64-bit FNV-1a hash of the URL, used as the file name of its entry
+static uint64_t hash_url(const char* url) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char* c = url; *c != '\0'; c++) {
+        hash ^= (uint8_t)*c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static bool get_entry_path(const char* url, char* out_path, size_t path_size) {
+    const char* directory = get_cache_directory();
+    if (directory == NULL) return false;
+    int res = snprintf(out_path, path_size, "%s/%016" PRIx64 ".bin", directory, hash_url(url));
+    return res > 0 && res < path_size;
+}
+
+// Reads the header of an entry and checks that the entry belongs to url, a hash collision is treated as a miss
+static bool read_header(FILE* fd, const char* url, http_cache_header_t* out_header) {
+    if (fread(out_header, sizeof(http_cache_header_t), 1, fd) != 1) return false;
+    if (out_header->magic != HTTP_CACHE_MAGIC || out_header->version != HTTP_CACHE_VERSION) return false;
+    if (url == NULL) return true;
+
+    size_t url_length = strlen(url);
+    if (out_header->url_length != url_length) return false;
+    char* stored_url = malloc(url_length);
+    if (stored_url == NULL) return false;
+    bool match = fread(stored_url, 1, url_length, fd) == url_length && memcmp(stored_url, url, url_length) == 0;
+    free(stored_url);
+    return match;
+}
+
+static bool load_header(const char* path, const char* url, http_cache_header_t* out_header) {
+    FILE* fd = fastopen(path, "rb");
+    if (fd == NULL) return false;
+    bool valid = read_header(fd, url, out_header);
+    fastclose(fd);
+    return valid;
+}
+
+// Loads the body of an entry and marks the entry as used
+static bool load_body(const char* path, const char* url, uint8_t** out_data, size_t* out_size) {
+    FILE* fd = fastopen(path, "r+b");
+    if (fd == NULL) return false;
+
+    http_cache_header_t header = {0};
+    if (!read_header(fd, url, &header)) {
+        fastclose(fd);
+        return false;
+    }
+
+    uint8_t* data = malloc(header.body_size > 0 ? header.body_size : 1);
+    if (data == NULL || fread(data, 1, header.body_size, fd) != header.body_size) {
+        free(data);
+        fastclose(fd);
+        return false;
+    }
+
+    header.last_used = (uint32_t)time(NULL);
+    fseek(fd, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, fd);
+    fastclose(fd);
+
+    *out_data = data;
+    *out_size = header.body_size;
+    return true;
+}
+
+// Hands the body of an entry to sink in chunks and marks the entry as used, the streaming counterpart of load_body.
+// Like a download the sink is not started for an empty body.
+static bool replay_body(const char* path, const char* url, const http_stream_sink_t* sink) {
+    FILE* fd = fastopen(path, "r+b");
+    if (fd == NULL) return false;
+
+    http_cache_header_t header = {0};
+    long                offset = 0;
+    uint8_t*            chunk  = malloc(HTTP_CACHE_CHUNK_SIZE);
+    if (chunk == NULL || !read_header(fd, url, &header) || (offset = ftell(fd)) < 0) {
+        free(chunk);
+        fastclose(fd);
+        return false;
+    }
+
+    header.last_used = (uint32_t)time(NULL);
+    fseek(fd, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, fd);
+    fseek(fd, offset, SEEK_SET);
+
+    bool success = true;
+    if (header.body_size > 0) {
+        success = sink->begin(header.body_size, sink->arg);
+        for (size_t position = 0; success && position < header.body_size;) {
+            size_t length = header.body_size - position;
+            if (length > HTTP_CACHE_CHUNK_SIZE) {
+                length = HTTP_CACHE_CHUNK_SIZE;
+            }
+            success   = fread(chunk, 1, length, fd) == length && sink->write(chunk, length, position, sink->arg);
+            position += length;
+        }
+        success = sink->end(success, sink->arg) && success;
+    }
+    free(chunk);
+    fastclose(fd);
+    return success;
+}
+
+static int compare_last_used(const void* a, const void* b) {
+    const http_cache_entry_t* entry_a = (const http_cache_entry_t*)a;
+    const http_cache_entry_t* entry_b = (const http_cache_entry_t*)b;
+    if (entry_a->last_used < entry_b->last_used) return -1;
+    if (entry_a->last_used > entry_b->last_used) return 1;
+    return 0;
+}
+
+// Removes the least recently used entries until the cache fits in HTTP_CACHE_MAX_BYTES, called with cache_mutex held
+static void evict(const char* directory) {
+    DIR* dir = opendir(directory);
+    if (dir == NULL) return;
+
+    http_cache_entry_t* entries  = NULL;
+    size_t              count    = 0;
+    size_t              capacity = 0;
+    size_t              total    = 0;
+    struct dirent*      dirent;
+    while ((dirent = readdir(dir)) != NULL) {
+        if (strlen(dirent->d_name) >= HTTP_CACHE_NAME_SIZE || strstr(dirent->d_name, ".bin") == NULL) continue;
+
+        char path[64];
+        snprintf(path, sizeof(path), "%s/%s", directory, dirent->d_name);
+        struct stat         st;
+        http_cache_header_t header = {0};
+        if (stat(path, &st) != 0) continue;
+        if (!load_header(path, NULL, &header)) {
+            unlink(path);  // Left behind by an older version or an interrupted write
+            continue;
+        }
+
+        if (count >= capacity) {
+            size_t              new_capacity = capacity ? capacity * 2 : 32;
+            http_cache_entry_t* new_entries  = realloc(entries, new_capacity * sizeof(http_cache_entry_t));
+            if (new_entries == NULL) break;
+            entries  = new_entries;
+            capacity = new_capacity;
+        }
+        strcpy(entries[count].name, dirent->d_name);
+        entries[count].last_used  = header.last_used;
+        entries[count].size       = st.st_size;
+        total                    += st.st_size;
+        count++;
+    }
+    closedir(dir);
+
+    if (total > HTTP_CACHE_MAX_BYTES) {
+        qsort(entries, count, sizeof(http_cache_entry_t), compare_last_used);
+        for (size_t i = 0; i < count && total > HTTP_CACHE_MAX_BYTES; i++) {
+            char path[64];
+            snprintf(path, sizeof(path), "%s/%s", directory, entries[i].name);
+            if (unlink(path) == 0) {
+                total -= entries[i].size;
+                stats.evictions++;
+            }
+        }
+    }
+    free(entries);
+}
+
+static bool fits(const char* url, size_t size) {
+    size_t url_length = strlen(url);
+    return sizeof(http_cache_header_t) + url_length + size <= HTTP_CACHE_MAX_BYTES && url_length <= UINT16_MAX;
+}
+
+// Creates the temporary file of a new entry and writes its URL. The header is written with a zero magic until the
+// entry is complete, so an interrupted write is never taken for a valid entry.
+static FILE* create_entry(const char* temp_path, const char* url) {
+    FILE* fd = fastopen(temp_path, "wb");
+    if (fd == NULL) {
+        ESP_LOGW(TAG, "Failed to create %s", temp_path);
+        return NULL;
+    }
+    http_cache_header_t header     = {0};
+    size_t              url_length = strlen(url);
+    if (fwrite(&header, sizeof(header), 1, fd) != 1 || fwrite(url, 1, url_length, fd) != url_length) {
+        fastclose(fd);
+        unlink(temp_path);
+        return NULL;
+    }
+    return fd;
+}
+
+// Completes the header of a new entry, closes it and moves it over the previous entry
+static void commit_entry(FILE* fd, const char* temp_path, const char* path, const char* url,
+                         const http_validators_t* validators, size_t size, bool ok) {
+    http_cache_header_t header = {
+        .magic      = HTTP_CACHE_MAGIC,
+        .version    = HTTP_CACHE_VERSION,
+        .url_length = strlen(url),
+        .body_size  = size,
+        .last_used  = (uint32_t)time(NULL),
+        .validators = *validators,
+    };
+    ok = ok && fseek(fd, 0, SEEK_SET) == 0;
+    ok = ok && fwrite(&header, sizeof(header), 1, fd) == 1;
+    fastclose(fd);
+
+    // An entry is only written after get_cache_directory found a directory, so the mutex exists
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    unlink(path);
+    bool stored = ok && rename(temp_path, path) == 0;
+    if (stored) {
+        evict(cache_directory);
+    }
+    xSemaphoreGive(cache_mutex);
+
+    if (!stored) {
+        ESP_LOGW(TAG, "Failed to store response for %s", url);
+        unlink(temp_path);
+    }
+}
+
+static void store(const char* path, const char* url, const http_validators_t* validators, const uint8_t* data,
+                  size_t size) {
+    if (!fits(url, size)) {
+        unlink(path);
+        return;
+    }
+
+    char temp_path[72];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE* fd = create_entry(temp_path, url);
+    if (fd == NULL) return;
+    bool ok = size == 0 || fwrite(data, 1, size, fd) == size;
+    commit_entry(fd, temp_path, path, url, validators, size, ok);
+}
+
+static bool download(const char* url, http_validators_t* validators, uint8_t** out_data, size_t* out_size,
+                     bool* out_not_modified) {
+    http_session_t session = http_session_begin(url);
+    if (session == NULL) return false;
+    bool success;
+    if (validators != NULL) {
+        success = http_session_download_ram_conditional(session, url, validators, out_data, out_size, out_not_modified);
+    } else {
+        success = http_session_download_ram(session, url, out_data, out_size);
+    }
+    http_session_end(session);
+    return success;
+}
+
+bool http_cache_download(const char* url, uint8_t** out_data, size_t* out_size) {
+    if (url == NULL || out_data == NULL || out_size == NULL) return false;
+    *out_data = NULL;
+    *out_size = 0;
+
+    char                path[64];
+    http_cache_header_t header = {0};
+    bool                usable = get_entry_path(url, path, sizeof(path));
+    bool                cached = usable && load_header(path, url, &header);
+
+    http_validators_t validators   = {0};
+    bool              not_modified = false;
+    if (cached) {
+        validators = header.validators;
+    }
+    bool success = download(url, &validators, out_data, out_size, &not_modified);
+
+    if (success && not_modified) {
+        if (cached && load_body(path, url, out_data, out_size)) {
+            count(&stats.hits);
+            return true;
+        }
+        // The entry disappeared after the request was sent, fetch the full response instead
+        memset(&validators, 0, sizeof(validators));
+        success = download(url, &validators, out_data, out_size, &not_modified) && !not_modified;
+    }
+
+    if (success) {
+        count(&stats.misses);
+        if (usable && (validators.etag[0] != '\0' || validators.last_modified[0] != '\0')) {
+            store(path, url, &validators, *out_data, *out_size);
+        } else if (cached) {
+            unlink(path);  // The server stopped sending validators, the entry can no longer be revalidated
+        }
+        return true;
+    }
+
+    if (cached && load_body(path, url, out_data, out_size)) {
+        ESP_LOGW(TAG, "Could not revalidate %s, using the cached response", url);
+        count(&stats.stale_hits);
+        return true;
+    }
+    return false;
+}
+
+// Sink between a download and the sink of the caller, copies the response into a new entry as it passes
+typedef struct {
+    const http_stream_sink_t* sink;
+    const char*               url;
+    const char*               temp_path;  // NULL when the response cannot be stored
+    FILE*                     fd;         // Entry being written, NULL when the response is not stored
+    size_t                    size;       // Body received by the current attempt
+    bool                      started;    // The begin callback of sink has been called
+} http_cache_tee_t;
+
+static void discard_tee(http_cache_tee_t* tee) {
+    if (tee->fd != NULL) {
+        fastclose(tee->fd);
+        unlink(tee->temp_path);
+        tee->fd = NULL;
+    }
+}
+
+static bool tee_begin(size_t size, void* arg) {
+    http_cache_tee_t* tee = (http_cache_tee_t*)arg;
+    discard_tee(tee);
+    tee->size    = 0;
+    tee->started = true;
+    if (tee->temp_path != NULL && fits(tee->url, size)) {
+        tee->fd = create_entry(tee->temp_path, tee->url);
+    }
+    return tee->sink->begin(size, tee->sink->arg);
+}
+
+static bool tee_write(const uint8_t* data, size_t length, size_t offset, void* arg) {
+    http_cache_tee_t* tee = (http_cache_tee_t*)arg;
+    if (tee->fd != NULL && (!fits(tee->url, tee->size + length) || fwrite(data, 1, length, tee->fd) != length)) {
+        discard_tee(tee);  // The response is still handed on, it is just not stored
+    }
+    tee->size += length;
+    return tee->sink->write(data, length, offset, tee->sink->arg);
+}
+
+static bool tee_end(bool success, void* arg) {
+    http_cache_tee_t* tee    = (http_cache_tee_t*)arg;
+    bool              result = tee->sink->end(success, tee->sink->arg);
+    if (!success || !result) {
+        discard_tee(tee);  // The entry is committed by http_cache_download_stream once the download returned
+    }
+    return result;
+}
+
+static bool download_to_sink(const char* url, http_validators_t* validators, const http_stream_sink_t* sink,
+                             bool* out_not_modified) {
+    http_session_t session = http_session_begin(url);
+    if (session == NULL) return false;
+    bool success = http_session_download_stream_conditional(session, url, validators, sink, out_not_modified);
+    http_session_end(session);
+    return success;
+}
+
+bool http_cache_download_stream(const char* url, const http_stream_sink_t* sink) {
+    if (url == NULL || sink == NULL) return false;
+
+    char                path[64];
+    char                temp_path[72];
+    http_cache_header_t header = {0};
+    bool                usable = get_entry_path(url, path, sizeof(path));
+    bool                cached = usable && load_header(path, url, &header);
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", usable ? path : "");
+
+    http_cache_tee_t   tee      = {.sink = sink, .url = url, .temp_path = usable ? temp_path : NULL};
+    http_stream_sink_t tee_sink = {.begin = tee_begin, .write = tee_write, .end = tee_end, .arg = &tee};
+
+    http_validators_t validators   = {0};
+    bool              not_modified = false;
+    if (cached) {
+        validators = header.validators;
+    }
+    bool success = download_to_sink(url, &validators, &tee_sink, &not_modified);
+
+    if (success && not_modified) {
+        if (cached && replay_body(path, url, sink)) {
+            count(&stats.hits);
+            return true;
+        }
+        // The entry disappeared or could not be read, fetch the full response instead
+        memset(&validators, 0, sizeof(validators));
+        success = download_to_sink(url, &validators, &tee_sink, &not_modified) && !not_modified;
+    }
+
+    if (success) {
+        count(&stats.misses);
+        bool storable = usable && (validators.etag[0] != '\0' || validators.last_modified[0] != '\0');
+        if (storable && !tee.started) {
+            store(path, url, &validators, NULL, 0);  // Empty body, the sink was never started
+        } else if (storable && tee.fd != NULL) {
+            commit_entry(tee.fd, temp_path, path, url, &validators, tee.size, true);
+        } else if (usable) {
+            discard_tee(&tee);
+            unlink(path);  // Too large to store or no validators, the previous entry is outdated either way
+        }
+        return true;
+    }
+
+    discard_tee(&tee);
+    if (cached && replay_body(path, url, sink)) {
+        ESP_LOGW(TAG, "Could not revalidate %s, using the cached response", url);
+        count(&stats.stale_hits);
+        return true;
+    }
+    return false;
+}
+
+void http_cache_get_stats(http_cache_stats_t* out_stats) {
+    if (out_stats == NULL) {
+        return;
+    }
+    if (cache_mutex != NULL) {
+        xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    }
+    *out_stats = stats;
+    if (cache_mutex != NULL) {
+        xSemaphoreGive(cache_mutex);
+    }
+}
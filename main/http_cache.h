@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "http_download.h"
+
+// On-disk cache for HTTP GET responses, keyed by URL. Stored responses are revalidated with a conditional request
+// on every use, so an unchanged resource costs a 304 reply instead of the full body. When revalidation fails (for
+// example while offline) the stored copy is served as is. The cache lives on the SD card when one is mounted and on
+// the internal filesystem otherwise, and the least recently used entries are removed once it grows beyond
+// CONFIG_HTTP_CACHE_SIZE KiB. Tasks can download through the cache at the same time.
+
+typedef struct {
+    size_t hits;         // Responses served from disk after a 304 Not Modified
+    size_t misses;       // Responses downloaded in full
+    size_t stale_hits;   // Responses served from disk because revalidation failed
+    size_t evictions;    // Entries removed to stay within the size limit
+} http_cache_stats_t;
+
+// Creates the lock shared by the downloading tasks, called once at startup. Until then downloads bypass the cache.
+void http_cache_init(void);
+// Downloads url into a newly allocated buffer, which the caller frees
+bool http_cache_download(const char* url, uint8_t** out_data, size_t* out_size);
+// Streams url into sink and writes the cache entry while the response arrives, so the body is never held in RAM.
+// When the stored copy is current or revalidation fails it is replayed through sink in chunks. The sink can be
+// started more than once: after an end callback with success=false it starts over with the next attempt.
+bool http_cache_download_stream(const char* url, const http_stream_sink_t* sink);
+void http_cache_get_stats(http_cache_stats_t* out_stats);
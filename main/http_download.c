@@ -1,7 +1,10 @@
 #include "http_download.h"
+#include <ctype.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include "device_settings.h"
 #include "esp_event.h"
+#include "esp_heap_caps.h"
 #include "esp_http_client.h"
 #include "esp_system.h"
 #include "esp_vfs.h"
@@ -10,15 +13,26 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "freertos/task.h"
+#include "mbedtls/sha256.h"
 #include "nvs_settings.h"
 
 static const char* TAG = "HTTP download";
 
+#define HTTP_DOWNLOAD_INITIAL_CAPACITY (16 * 1024)  // First allocation for responses of unknown size
+
+// Running SHA-256 of a download. mbedtls uses the hardware SHA engine when the target has one.
+typedef struct {
+    mbedtls_sha256_context context;
+    size_t                 length;  // Amount of data hashed so far
+} http_hash_t;
+
 typedef struct {
     FILE*     fd;      // For downloading directly to file on filesystem
     uint8_t** buffer;  // Dynamically allocated buffer for downloading to RAM (malloced in event handler, used if fd is
                        // not set)
     size_t    size;    // File size as indicated by content-length header (set in event handler)
+    size_t    capacity;       // Allocated size of the RAM buffer when the file size is not known up front
+    bool      size_known;     // Indication that the server sent a content-length header
     size_t    received;       // Amount of data received (set in event handler)
     bool      error;          // Indication that an error event happened (set in event handler)
     bool      connected;      // Indication that the HTTP client has connected to the server (set in event handler)
@@ -26,10 +40,157 @@ typedef struct {
     bool      disconnected;   // Indication that the HTTP client has disconnected from the server (set in event handler)
     bool      out_of_memory;  // Indication that malloc failed
     bool out_of_allocated;    // Indication that the server sent more data than indicated with the content-length header
+    const http_stream_sink_t* sink;          // Streaming sink (used if neither fd nor buffer is set)
+    bool                      sink_started;  // Indication that the begin callback of the sink has been called
+    bool                      sink_failed;   // Indication that a callback of the sink returned false
     download_callback_t callback;
     const char*         callback_text;
+    http_hash_t*        hash;  // Hash of the received data, owned by the session
+
+    // Status of the current response, evaluated once its headers are complete
+    bool response_checked;  // Indication that the status code has been evaluated
+    bool body_accepted;     // Indication that the body is the requested data, not an error page or a redirect
+
+    // Resuming a failed attempt with a range request
+    size_t resume_offset;                            // Offset the attempt continues from, 0 when starting over
+    size_t resume_length;                            // Content-length of the response to a resumed attempt
+    bool   restarted;                                // Indication that the server sent the whole file again
+    char   etag[HTTP_VALIDATOR_ETAG_SIZE];           // ETag response header, validates a resumed download
+    char   last_modified[HTTP_VALIDATOR_DATE_SIZE];  // Last-Modified response header, used when there is no ETag
 } http_download_info_t;
 
+// Grows the RAM buffer for responses without a content-length header, for example when the server uses chunked
+// transfer encoding. The buffer doubles in size and prefers PSRAM, up to CONFIG_HTTP_DOWNLOAD_RAM_LIMIT KiB.
+static bool grow_buffer(http_download_info_t* info, size_t required) {
+    if (required <= info->capacity) return true;
+
+    size_t limit = (size_t)CONFIG_HTTP_DOWNLOAD_RAM_LIMIT * 1024;
+    if (required > limit) {
+        ESP_LOGE(TAG, "Response exceeds the RAM download limit of %u bytes", limit);
+        info->out_of_allocated = true;
+        return false;
+    }
+
+    size_t capacity = info->capacity ? info->capacity : HTTP_DOWNLOAD_INITIAL_CAPACITY;
+    while (capacity < required) {
+        capacity *= 2;
+    }
+    if (capacity > limit) {
+        capacity = limit;
+    }
+
+    uint8_t* buffer = heap_caps_realloc_prefer(*info->buffer, capacity, 2, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+    if (buffer == NULL) {
+        info->out_of_memory = true;
+        return false;
+    }
+    *info->buffer  = buffer;
+    info->capacity = capacity;
+    return true;
+}
+
+static void hash_start(http_hash_t* hash) {
+    mbedtls_sha256_starts(&hash->context, 0);
+    hash->length = 0;
+}
+
+static void hash_update(http_hash_t* hash, const uint8_t* data, size_t length) {
+    mbedtls_sha256_update(&hash->context, data, length);
+    hash->length += length;
+}
+
+static bool allocate_buffer(http_download_info_t* info) {
+    if ((info->size > 0) && (info->buffer != NULL)) {  // Buffer poiner is set, buffer pointer points to NULL
+        *info->buffer = malloc(info->size);
+        ESP_LOGI(TAG, "Allocated buffer (%u bytes)", info->size);
+        if (*info->buffer == NULL) {
+            info->out_of_memory = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool is_redirect(int status_code) {
+    return status_code == 301 || status_code == 302 || status_code == 303 || status_code == 307 ||
+           status_code == 308;
+}
+
+// Decides whether the body of a response is the requested data. Evaluated once the headers are complete, since the
+// status code is not known while they are being parsed, and before any of the body is handed on, so an error page
+// never reaches the buffer, the file or the stream sink. The client follows redirects by itself and passes their
+// bodies to the event handler as well, those are skipped.
+//
+// A resumed attempt asks for the remainder of the file with a Range header. The server answers 206 when the file
+// is unchanged according to If-Range, 200 means the whole file follows and received data is discarded.
+static bool check_response(http_download_info_t* info, esp_http_client_handle_t client) {
+    if (info->response_checked) {
+        return info->body_accepted;
+    }
+    info->response_checked = true;
+    info->body_accepted    = false;
+
+    int status_code = esp_http_client_get_status_code(client);
+    if (is_redirect(status_code)) {
+        // The headers of the response the redirect leads to replace these
+        if (info->resume_offset > 0) {
+            info->resume_length = 0;
+        } else {
+            info->size       = 0;
+            info->size_known = false;
+        }
+        return false;
+    }
+    if (status_code == 304) {
+        return false;  // Answer to a conditional request, the caller keeps its copy
+    }
+
+    if (info->resume_offset > 0 && status_code == 206) {
+        if (info->resume_length > 0 && info->resume_offset + info->resume_length != info->size) {
+            ESP_LOGE(TAG, "Resumed response does not match the original size (%u + %u != %u)", info->resume_offset,
+                     info->resume_length, info->size);
+            info->error = true;
+            return false;
+        }
+        info->body_accepted = true;
+        return true;
+    }
+    if (status_code != 200) {
+        ESP_LOGE(TAG, "Server answered with status %d", status_code);
+        info->error = true;
+        return false;
+    }
+
+    if (info->resume_offset > 0) {
+        ESP_LOGW(TAG, "Server did not resume the download, starting over");
+        info->resume_offset = 0;
+        info->received      = 0;
+        info->size          = info->resume_length;
+        info->size_known    = info->resume_length > 0;
+        info->capacity      = 0;
+        hash_start(info->hash);
+        if (info->fd != NULL) {
+            fseek(info->fd, 0, SEEK_SET);
+            info->restarted = true;
+        }
+        if (info->buffer != NULL && *info->buffer != NULL) {
+            free(*info->buffer);
+            *info->buffer = NULL;
+        }
+    }
+    info->body_accepted = allocate_buffer(info);
+    return info->body_accepted;
+}
+
+// Stops the transfer when the response was rejected, the body of a redirect or 304 is skipped instead
+static esp_err_t rejected_response(const http_download_info_t* info) {
+    return (info->error || info->out_of_memory) ? ESP_FAIL : ESP_OK;
+}
+
+static bool header_is(esp_http_client_event_t* evt, const char* key) {
+    return strcasecmp(evt->header_key, key) == 0;
+}
+
 static esp_err_t _event_handler(esp_http_client_event_t* evt) {
     http_download_info_t* info = (http_download_info_t*)evt->user_data;
     switch (evt->event_id) {
@@ -43,35 +204,63 @@ static esp_err_t _event_handler(esp_http_client_event_t* evt) {
             break;
         case HTTP_EVENT_ON_HEADER: {
             const char content_length_key[] = "Content-Length";
-            if ((strlen(evt->header_key) == strlen(content_length_key)) &&
-                (strncasecmp(content_length_key, evt->header_key, strlen(content_length_key)) == 0)) {
-                // Header value is content length
-                info->size = atoi(evt->header_value);
-                ESP_LOGI(TAG, "Size is known: %u bytes", info->size);
-                if ((info->size > 0) &&
-                    (info->buffer != NULL)) {  // Buffer poiner is set, buffer pointer points to NULL
-                    *info->buffer = malloc(info->size);
-                    ESP_LOGI(TAG, "Allocated buffer (%u bytes)", info->size);
-                    if (*info->buffer == NULL) {
-                        info->out_of_memory = true;
-                        return ESP_ERR_NO_MEM;
-                    }
+            info->response_checked          = false;  // Headers of a new response, after a redirect
+            if (header_is(evt, "ETag")) {
+                if (strlen(evt->header_value) < sizeof(info->etag)) {
+                    strcpy(info->etag, evt->header_value);
                 }
+            } else if (header_is(evt, "Last-Modified")) {
+                if (strlen(evt->header_value) < sizeof(info->last_modified)) {
+                    strcpy(info->last_modified, evt->header_value);
+                }
+            } else if (info->resume_offset > 0 && header_is(evt, content_length_key)) {
+                // Checked against the original size once the status code is known
+                info->resume_length = atoi(evt->header_value);
+            } else if ((strlen(evt->header_key) == strlen(content_length_key)) &&
+                       (strncasecmp(content_length_key, evt->header_key, strlen(content_length_key)) == 0)) {
+                // Header value is content length, the buffer is allocated once the status code is known
+                info->size       = atoi(evt->header_value);
+                info->size_known = true;
+                ESP_LOGI(TAG, "Size is known: %u bytes", info->size);
             } else {
                 ESP_LOGD(TAG, "Header: key=%s, value=%s", evt->header_key, evt->header_value);
             }
             break;
         }
         case HTTP_EVENT_ON_HEADERS_COMPLETE:
+            if (!check_response(info, evt->client)) {
+                return rejected_response(info);
+            }
             break;
         case HTTP_EVENT_ON_STATUS_CODE:
             break;
         case HTTP_EVENT_ON_DATA:
+            // Also checked here in case the headers complete event did not arrive
+            if (!check_response(info, evt->client)) {
+                return rejected_response(info);
+            }
             if (info->callback != NULL) {
                 info->callback(info->received + evt->data_len, info->size, info->callback_text);
             }
             if (info->fd != NULL) {  // Write directly to file on filesystem
                 fwrite(evt->data, 1, evt->data_len, info->fd);
+            } else if (info->sink != NULL) {  // Hand data to the streaming sink
+                if (!info->sink_started) {
+                    info->sink_started = true;
+                    if (!info->sink->begin(info->size, info->sink->arg)) {
+                        info->sink_failed = true;
+                        return ESP_FAIL;
+                    }
+                }
+                if (!info->sink->write(evt->data, evt->data_len, info->received, info->sink->arg)) {
+                    info->sink_failed = true;
+                    return ESP_FAIL;
+                }
+            } else if (info->buffer != NULL && !info->size_known) {  // Size unknown, grow the buffer as data arrives
+                if (!grow_buffer(info, info->received + evt->data_len)) {
+                    return ESP_ERR_NO_MEM;
+                }
+                memcpy(&((*info->buffer)[info->received]), evt->data, evt->data_len);
             } else if (info->buffer != NULL && *info->buffer != NULL) {
                 if (info->received + evt->data_len <= info->size) {
                     uint8_t* dest = &((*info->buffer)[info->received]);
@@ -85,6 +274,7 @@ static esp_err_t _event_handler(esp_http_client_event_t* evt) {
             } else {
                 return ESP_FAIL;
             }
+            hash_update(info->hash, evt->data, evt->data_len);
             info->received += evt->data_len;
             break;
         case HTTP_EVENT_ON_FINISH:
@@ -101,14 +291,91 @@ static esp_err_t _event_handler(esp_http_client_event_t* evt) {
 
 static bool download_success(esp_err_t err, http_download_info_t* info) {
     return (err == ESP_OK) && (!(info->error || info->out_of_allocated || info->out_of_memory)) && info->finished &&
-           (info->received == info->size);
+           (!info->size_known || info->received == info->size);
+}
+
+static bool status_success(int status_code, const http_download_info_t* info) {
+    return (status_code == 200) || (status_code == 206 && info->resume_offset > 0);
+}
+
+// Returns the offset a failed attempt can be resumed from, or 0 when it has to start over. Resuming needs the
+// total size and a strong validator for If-Range, so a changed file on the server is never spliced together.
+static size_t resume_offset_of(const http_download_info_t* previous) {
+    if (previous->out_of_memory || previous->out_of_allocated) return 0;
+    if (!previous->size_known || previous->received == 0 || previous->received >= previous->size) return 0;
+    bool strong_etag = previous->etag[0] != '\0' && strncmp(previous->etag, "W/", 2) != 0;
+    if (!strong_etag && previous->last_modified[0] == '\0') return 0;
+    return previous->received;
+}
+
+// Carries the size and validators of a failed attempt over to the next one and asks the server for the rest
+static void prepare_resume(esp_http_client_handle_t client, http_download_info_t* info,
+                           const http_download_info_t* previous, size_t offset) {
+    info->resume_offset = offset;
+    info->received      = offset;
+    info->size          = previous->size;
+    info->size_known    = true;
+    info->capacity      = previous->capacity;
+    strcpy(info->etag, previous->etag);
+    strcpy(info->last_modified, previous->last_modified);
+
+    char range[32];
+    snprintf(range, sizeof(range), "bytes=%u-", offset);
+    bool strong_etag = info->etag[0] != '\0' && strncmp(info->etag, "W/", 2) != 0;
+    esp_http_client_set_header(client, "Range", range);
+    esp_http_client_set_header(client, "If-Range", strong_etag ? info->etag : info->last_modified);
+    ESP_LOGI(TAG, "Resuming download at %u of %u bytes", offset, info->size);
+}
+
+static void clear_resume(esp_http_client_handle_t client) {
+    esp_http_client_delete_header(client, "Range");
+    esp_http_client_delete_header(client, "If-Range");
 }
 
 struct http_session {
     esp_http_client_handle_t client;
     http_download_info_t     info;
+    http_hash_t              hash;
+    uint8_t                  digest[HTTP_SHA256_SIZE];    // Digest of the last successful download
+    bool                     digest_valid;                // Indication that digest is set
+    uint8_t                  expected[HTTP_SHA256_SIZE];  // Digest the next download has to match
+    bool                     has_expected;                // Indication that expected is set
 };
 
+// Starts hashing an attempt. A resumed attempt continues the hash of the data received before, which is only
+// possible when exactly that data has been hashed. Returns the offset the attempt can continue from.
+static size_t begin_attempt(http_session_t session, size_t resume_offset) {
+    session->info.hash = &session->hash;
+    if (resume_offset == 0 || resume_offset != session->hash.length) {
+        hash_start(&session->hash);
+        return 0;
+    }
+    return resume_offset;
+}
+
+// Takes the expected digest set for this download, so it does not carry over to the next one
+static bool take_expected(http_session_t session, uint8_t* out_expected) {
+    bool has_expected     = session->has_expected;
+    session->has_expected = false;
+    session->digest_valid = false;
+    if (has_expected) {
+        memcpy(out_expected, session->expected, HTTP_SHA256_SIZE);
+    }
+    return has_expected;
+}
+
+// Completes the hash of a successful download and compares it with the expected digest, if there is one
+static bool verify_hash(http_session_t session, const uint8_t* expected) {
+    mbedtls_sha256_finish(&session->hash.context, session->digest);
+    session->digest_valid = true;
+    if (expected != NULL && memcmp(session->digest, expected, HTTP_SHA256_SIZE) != 0) {
+        ESP_LOGE(TAG, "SHA-256 of the downloaded data (%u bytes) does not match the expected digest",
+                 session->hash.length);
+        return false;
+    }
+    return true;
+}
+
 static esp_http_client_handle_t create_http_client(const char* url, http_download_info_t* info) {
     char user_agent[128] = {0};
     device_settings_get_default_http_user_agent(user_agent, sizeof(user_agent));
@@ -133,6 +400,7 @@ http_session_t http_session_begin(const char* initial_url) {
         free(session);
         return NULL;
     }
+    mbedtls_sha256_init(&session->hash.context);
     return (http_session_t)session;
 }
 
@@ -142,9 +410,30 @@ void http_session_set_callback(http_session_t session, download_callback_t callb
     session->info.callback_text = text;
 }
 
-bool http_session_download_ram(http_session_t session, const char* url, uint8_t** ptr, size_t* size) {
+static void set_conditional(esp_http_client_handle_t client, const http_validators_t* validators) {
+    if (validators->etag[0] != '\0') {
+        esp_http_client_set_header(client, "If-None-Match", validators->etag);
+    }
+    if (validators->last_modified[0] != '\0') {
+        esp_http_client_set_header(client, "If-Modified-Since", validators->last_modified);
+    }
+}
+
+static void clear_conditional(esp_http_client_handle_t client) {
+    esp_http_client_delete_header(client, "If-None-Match");
+    esp_http_client_delete_header(client, "If-Modified-Since");
+}
+
+static bool download_ram(http_session_t session, const char* url, http_validators_t* validators, uint8_t** ptr,
+                         size_t* size, bool* not_modified) {
     if (session == NULL || ptr == NULL) return false;
     *ptr = NULL;
+    if (not_modified != NULL) {
+        *not_modified = false;
+    }
+
+    uint8_t expected[HTTP_SHA256_SIZE];
+    bool    verify = take_expected(session, expected);
 
     download_callback_t saved_callback      = session->info.callback;
     const char*         saved_callback_text = session->info.callback_text;
@@ -152,10 +441,17 @@ bool http_session_download_ram(http_session_t session, const char* url, uint8_t*
     // Two-shot reconnect: a slow caller-side operation between downloads (e.g. a
     // multi-second AppFS flash write) can let the keep-alive TLS session time
     // out server-side. If an attempt fails, drop the client, recreate it, and
-    // retry up to two more times.
+    // retry up to two more times. Data received before the failure is kept and
+    // the retry continues from there when the server supports range requests.
+    http_download_info_t previous = {0};
     for (int attempt = 0; attempt < 3; attempt++) {
+        size_t resume_offset = (attempt > 0 && *ptr != NULL) ? resume_offset_of(&previous) : 0;
+        if (resume_offset != session->hash.length) {
+            resume_offset = 0;
+        }
+
         // Free any buffer the event handler malloc'd on a previous failed attempt.
-        if (*ptr != NULL) {
+        if (resume_offset == 0 && *ptr != NULL) {
             free(*ptr);
             *ptr = NULL;
         }
@@ -164,18 +460,59 @@ bool http_session_download_ram(http_session_t session, const char* url, uint8_t*
         session->info.buffer        = ptr;
         session->info.callback      = saved_callback;
         session->info.callback_text = saved_callback_text;
+        resume_offset               = begin_attempt(session, resume_offset);
+        if (resume_offset > 0) {
+            prepare_resume(session->client, &session->info, &previous, resume_offset);
+        } else if (validators != NULL) {
+            set_conditional(session->client, validators);
+        }
 
         esp_http_client_set_url(session->client, url);
         esp_err_t err         = esp_http_client_perform(session->client);
         int       status_code = esp_http_client_get_status_code(session->client);
+        clear_resume(session->client);
+        if (validators != NULL) {
+            clear_conditional(session->client);
+        }
 
-        if (download_success(err, &session->info) && (status_code == 200)) {
+        if (err == ESP_OK && status_code == 304 && validators != NULL) {
+            // The copy the caller already has is still current
+            if (*ptr != NULL) {
+                free(*ptr);
+                *ptr = NULL;
+            }
             if (size != NULL) {
-                *size = session->info.size;
+                *size = 0;
             }
+            *not_modified = true;
             return true;
         }
 
+        if (download_success(err, &session->info) && status_success(status_code, &session->info)) {
+            if (!verify_hash(session, verify ? expected : NULL)) {
+                free(*ptr);
+                *ptr = NULL;
+                return false;
+            }
+            if (validators != NULL) {
+                strcpy(validators->etag, session->info.etag);
+                strcpy(validators->last_modified, session->info.last_modified);
+            }
+            if (!session->info.size_known && *ptr != NULL) {
+                // Release the unused tail of the geometrically grown buffer
+                uint8_t* trimmed = heap_caps_realloc_prefer(*ptr, session->info.received, 2, MALLOC_CAP_SPIRAM,
+                                                            MALLOC_CAP_DEFAULT);
+                if (trimmed != NULL) {
+                    *ptr = trimmed;
+                }
+            }
+            if (size != NULL) {
+                *size = session->info.received;
+            }
+            return true;
+        }
+
+        previous = session->info;
         if (attempt < 2) {
             ESP_LOGW(TAG, "Download failed (err=%s, status=%d), reconnecting and retrying (attempt %d/2)",
                      esp_err_to_name(err), status_code, attempt + 1);
@@ -199,37 +536,85 @@ bool http_session_download_ram(http_session_t session, const char* url, uint8_t*
     return false;
 }
 
+bool http_session_download_ram(http_session_t session, const char* url, uint8_t** ptr, size_t* size) {
+    return download_ram(session, url, NULL, ptr, size, NULL);
+}
+
+bool http_session_download_ram_conditional(http_session_t session, const char* url, http_validators_t* validators,
+                                           uint8_t** ptr, size_t* size, bool* not_modified) {
+    if (validators == NULL || not_modified == NULL) return false;
+    return download_ram(session, url, validators, ptr, size, not_modified);
+}
+
 bool http_session_download_file(http_session_t session, const char* url, const char* path) {
     if (session == NULL || path == NULL) return false;
 
+    uint8_t expected[HTTP_SHA256_SIZE];
+    bool    verify = take_expected(session, expected);
+
     download_callback_t saved_callback      = session->info.callback;
     const char*         saved_callback_text = session->info.callback_text;
 
     // Two-shot reconnect: a slow caller-side operation between downloads (e.g. a
     // multi-second AppFS flash write) can let the keep-alive TLS session time
     // out server-side. If an attempt fails, drop the client, recreate it, and
-    // retry this single file up to two more times.
+    // retry this single file up to two more times. The retry appends to the
+    // data already on disk when the server supports range requests.
+    http_download_info_t previous = {0};
     for (int attempt = 0; attempt < 3; attempt++) {
-        FILE* fd = fastopen(path, "w");
+        size_t resume_offset = (attempt > 0) ? resume_offset_of(&previous) : 0;
+        if (resume_offset > 0) {
+            struct stat st;
+            if (stat(path, &st) != 0) {
+                resume_offset = 0;
+            } else if ((size_t)st.st_size < resume_offset) {
+                resume_offset = st.st_size;
+            }
+        }
+        resume_offset = begin_attempt(session, resume_offset);
+
+        FILE* fd = fastopen(path, (resume_offset > 0) ? "r+" : "w");
         if (fd == NULL) {
             ESP_LOGE(TAG, "Failed to open file");
             return false;
         }
+        if (resume_offset > 0 && fseek(fd, resume_offset, SEEK_SET) != 0) {
+            resume_offset = begin_attempt(session, 0);
+            fseek(fd, 0, SEEK_SET);
+        }
 
+        // begin_attempt ran before the file was opened, point the new attempt at the hash it started
         memset(&session->info, 0, sizeof(http_download_info_t));
         session->info.fd            = fd;
         session->info.callback      = saved_callback;
         session->info.callback_text = saved_callback_text;
+        session->info.hash          = &session->hash;
+        if (resume_offset > 0) {
+            prepare_resume(session->client, &session->info, &previous, resume_offset);
+        }
 
         esp_http_client_set_url(session->client, url);
         esp_err_t err         = esp_http_client_perform(session->client);
         int       status_code = esp_http_client_get_status_code(session->client);
+        clear_resume(session->client);
+
+        bool success = download_success(err, &session->info) && status_success(status_code, &session->info);
+        if (success && session->info.restarted) {
+            // The file was rewritten from the start over the partial data, drop whatever is left beyond its end
+            fflush(fd);
+            ftruncate(fileno(fd), session->info.received);
+        }
         fastclose(fd);
 
-        if (download_success(err, &session->info) && (status_code == 200)) {
+        if (success) {
+            if (!verify_hash(session, verify ? expected : NULL)) {
+                unlink(path);
+                return false;
+            }
             return true;
         }
 
+        previous = session->info;
         if (attempt < 2) {
             ESP_LOGW(TAG, "Download failed (err=%s, status=%d), reconnecting and retrying (attempt %d/2)",
                      esp_err_to_name(err), status_code, attempt + 1);
@@ -249,10 +634,131 @@ bool http_session_download_file(http_session_t session, const char* url, const c
     return false;
 }
 
+static bool download_stream(http_session_t session, const char* url, http_validators_t* validators,
+                            const http_stream_sink_t* sink, bool* not_modified) {
+    if (session == NULL || sink == NULL || sink->begin == NULL || sink->write == NULL || sink->end == NULL) {
+        return false;
+    }
+    if (not_modified != NULL) {
+        *not_modified = false;
+    }
+
+    uint8_t expected[HTTP_SHA256_SIZE];
+    bool    verify = take_expected(session, expected);
+
+    download_callback_t saved_callback      = session->info.callback;
+    const char*         saved_callback_text = session->info.callback_text;
+
+    // Same reconnect strategy as the other download functions. The sink is told about
+    // every failed attempt through its end callback and restarts at offset 0 on the next.
+    for (int attempt = 0; attempt < 3; attempt++) {
+        memset(&session->info, 0, sizeof(http_download_info_t));
+        session->info.sink          = sink;
+        session->info.callback      = saved_callback;
+        session->info.callback_text = saved_callback_text;
+        begin_attempt(session, 0);
+        if (validators != NULL) {
+            set_conditional(session->client, validators);
+        }
+
+        esp_http_client_set_url(session->client, url);
+        esp_err_t err         = esp_http_client_perform(session->client);
+        int       status_code = esp_http_client_get_status_code(session->client);
+        if (validators != NULL) {
+            clear_conditional(session->client);
+        }
+
+        if (err == ESP_OK && status_code == 304 && validators != NULL) {
+            *not_modified = true;  // The sink was never started, the caller replays its own copy
+            return true;
+        }
+
+        bool success  = download_success(err, &session->info) && (status_code == 200);
+        bool mismatch = success && !verify_hash(session, verify ? expected : NULL);
+        if (mismatch) {
+            success = false;  // Makes the sink discard the data instead of committing it
+        }
+        if (success && validators != NULL) {
+            // Set before the end callback, so the sink can commit the data together with its validators
+            strcpy(validators->etag, session->info.etag);
+            strcpy(validators->last_modified, session->info.last_modified);
+        }
+        if (session->info.sink_started && !sink->end(success, sink->arg)) {
+            session->info.sink_failed = true;
+            success                   = false;
+        }
+
+        if (success) {
+            return true;
+        }
+
+        if (mismatch) {
+            return false;
+        }
+
+        if (session->info.sink_failed) {
+            // The sink rejected the data, retrying would fail the same way
+            ESP_LOGE(TAG, "Download aborted by stream sink");
+            return false;
+        }
+
+        if (attempt < 2) {
+            ESP_LOGW(TAG, "Download failed (err=%s, status=%d), reconnecting and retrying (attempt %d/2)",
+                     esp_err_to_name(err), status_code, attempt + 1);
+            esp_http_client_cleanup(session->client);
+            session->client = create_http_client(url, &session->info);
+            if (session->client == NULL) {
+                ESP_LOGE(TAG, "Failed to recreate HTTP client");
+                return false;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool http_session_download_stream(http_session_t session, const char* url, const http_stream_sink_t* sink) {
+    return download_stream(session, url, NULL, sink, NULL);
+}
+
+bool http_session_download_stream_conditional(http_session_t session, const char* url, http_validators_t* validators,
+                                              const http_stream_sink_t* sink, bool* not_modified) {
+    if (validators == NULL || not_modified == NULL) return false;
+    return download_stream(session, url, validators, sink, not_modified);
+}
+
 void http_session_end(http_session_t session) {
     if (session == NULL) return;
     if (session->client != NULL) {
         esp_http_client_cleanup(session->client);
     }
+    mbedtls_sha256_free(&session->hash.context);
     free(session);
 }
+
+void http_session_set_expected_sha256(http_session_t session, const uint8_t* digest) {
+    if (session == NULL) return;
+    session->has_expected = digest != NULL;
+    if (digest != NULL) {
+        memcpy(session->expected, digest, HTTP_SHA256_SIZE);
+    }
+}
+
+bool http_session_get_sha256(http_session_t session, uint8_t* out_digest) {
+    if (session == NULL || out_digest == NULL || !session->digest_valid) return false;
+    memcpy(out_digest, session->digest, HTTP_SHA256_SIZE);
+    return true;
+}
+
+bool http_sha256_from_hex(const char* hex, uint8_t* out_digest) {
+    if (hex == NULL || out_digest == NULL || strlen(hex) != HTTP_SHA256_SIZE * 2) return false;
+    for (size_t i = 0; i < HTTP_SHA256_SIZE; i++) {
+        unsigned int byte;
+        if (!isxdigit((unsigned char)hex[i * 2]) || !isxdigit((unsigned char)hex[i * 2 + 1]) ||
+            sscanf(&hex[i * 2], "%2x", &byte) != 1) {
+            return false;
+        }
+        out_digest[i] = byte;
+    }
+    return true;
+}
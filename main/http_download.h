@@ -4,11 +4,55 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#define HTTP_VALIDATOR_ETAG_SIZE 64
+#define HTTP_VALIDATOR_DATE_SIZE 40
+#define HTTP_SHA256_SIZE         32
+
 typedef void (*download_callback_t)(size_t download_position, size_t file_size, const char* text);
 
+// Cache validators of a response, empty strings when the server did not send them
+typedef struct {
+    char etag[HTTP_VALIDATOR_ETAG_SIZE];           // ETag header
+    char last_modified[HTTP_VALIDATOR_DATE_SIZE];  // Last-Modified header
+} http_validators_t;
+
+// Responses without a Content-Length header (chunked transfer encoding) are supported by every download function.
+// http_session_download_ram grows its buffer as data arrives, up to CONFIG_HTTP_DOWNLOAD_RAM_LIMIT KiB.
+
+// Streaming sink, receives the response body as it arrives instead of buffering it. begin is called once the
+// response size is known (0 when the server did not send a Content-Length header), write for every received
+// chunk and end after the transfer completed or failed. Any callback returning false aborts the download. The
+// sink is only started for a response with status 200, the body of an error response is never passed to it.
+typedef struct {
+    bool (*begin)(size_t size, void* arg);
+    bool (*write)(const uint8_t* data, size_t length, size_t offset, void* arg);
+    bool (*end)(bool success, void* arg);
+    void* arg;
+} http_stream_sink_t;
+
 typedef struct http_session* http_session_t;
 http_session_t               http_session_begin(const char* initial_url);
 void http_session_set_callback(http_session_t session, download_callback_t callback, const char* text);
 bool http_session_download_ram(http_session_t session, const char* url, uint8_t** ptr, size_t* size);
+// Conditional GET: sends If-None-Match and If-Modified-Since built from validators. When the server answers 304
+// Not Modified, true is returned with not_modified set and no data. Otherwise behaves like
+// http_session_download_ram and replaces validators with those of the new response.
+bool http_session_download_ram_conditional(http_session_t session, const char* url, http_validators_t* validators,
+                                           uint8_t** ptr, size_t* size, bool* not_modified);
 bool http_session_download_file(http_session_t session, const char* url, const char* path);
+bool http_session_download_stream(http_session_t session, const char* url, const http_stream_sink_t* sink);
+// Conditional GET like http_session_download_ram_conditional, the sink is not started when the server answers 304
+// Not Modified. The validators of a new response are set before the end callback of the sink is called.
+bool http_session_download_stream_conditional(http_session_t session, const char* url, http_validators_t* validators,
+                                              const http_stream_sink_t* sink, bool* not_modified);
 void http_session_end(http_session_t session);
+
+// Every download is hashed with SHA-256 as the data arrives. When an expected digest is set, the next download on
+// the session fails if the data does not match it: RAM buffers are freed, files are removed and stream sinks get
+// success=false passed to their end callback, so nothing is committed. The expectation only applies to the next
+// download, pass NULL to download without one.
+void http_session_set_expected_sha256(http_session_t session, const uint8_t* digest);
+// Digest of the last successful download on the session
+bool http_session_get_sha256(http_session_t session, uint8_t* out_digest);
+// Parses a digest written as 64 hexadecimal characters, the form used by the repository
+bool http_sha256_from_hex(const char* hex, uint8_t* out_digest);
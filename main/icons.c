@@ -1,8 +1,15 @@
 #include "icons.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 #include "bsp/power.h"
 #include "common/theme.h"
+#include "esp_app_desc.h"
 #include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "fastopen.h"
 #include "filesystem_utils.h"
 #include "http_download.h"
@@ -30,6 +37,15 @@ static char const TAG[] = "icons";
 #define ICON_BASE_PATH "/int/icons"
 #define ICON_EXT       ".png"
 
+// The decoded and recolored icons are baked into an atlas, so later boots read them back in one go instead of
+// decoding every PNG file. The atlas is rebuilt when the theme, the launcher or any of the icon files changes, and
+// removed when new icons are downloaded.
+#define ICON_ATLAS_PATH      ICON_BASE_PATH "/atlas.bin"
+#define ICON_ATLAS_TEMP_PATH ICON_BASE_PATH "/atlas.tmp"
+#define ICON_ATLAS_MAGIC     0x414E4349  // "ICNA"
+#define ICON_ATLAS_VERSION   2
+#define ICON_ATLAS_MISSING   0xFFFFFFFF  // Index entry of an icon that is not in the atlas
+
 #if defined(CONFIG_BSP_TARGET_KAMI)
 char             icon_suffix[64] = "_f_r_black_16";
 static pax_col_t palette[]       = {0xffffffff, 0xff000000, 0xffff0000};  // white, black, red
@@ -118,8 +134,22 @@ static const char* icon_paths[] = {
     [ICON_FAVORITE]            = "favorite",
 };
 
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint16_t width;
+    uint16_t height;
+    uint32_t format;
+    uint32_t theme;
+    uint32_t foreground;           // Color the icons were baked with
+    uint8_t  launcher_sha256[32];  // ELF hash of the launcher that baked the icons, it decides paths and recoloring
+    uint64_t sources;              // Fingerprint of the icon files, see fingerprint_sources
+} icon_atlas_header_t;
+
 pax_buf_t EXT_RAM_BSS_ATTR icons[ICON_LAST] = {0};
 bool                       icons_missing    = false;
+static void*               atlas_pixels     = NULL;  // Pixels of all icons when they were loaded from the atlas
 
 void get_icon_path(icon_t icon, char* out_path, size_t max_path_len) {
     const char* icon_path = icon_paths[icon];
@@ -135,10 +165,23 @@ void get_icon_path(icon_t icon, char* out_path, size_t max_path_len) {
     }
 }
 
-void load_icons(void) {
-    theme_setting_t theme_setting = THEME_BLACK;
-    nvs_settings_get_theme(&theme_setting);
+// Icons other than the keyboard keys are inverted and tinted with the foreground color of the theme
+static void recolor_icon(pax_buf_t* icon, uint32_t color) {
+    pax_col_t* pixels = (pax_col_t*)pax_buf_get_pixels(icon);
+    for (size_t i = 0; i < ICON_WIDTH * ICON_HEIGHT; i++) {
+        pax_col_t col       = pixels[i];
+        col                ^= 0x00FFFFFF;  // Invert color
+        uint8_t brightness  = ((col & 0xFF) + (col >> 8 & 0xFF) + (col >> 16 & 0xFF)) / 3;
+        col                &= 0xFF000000;  // Remove colors
+        uint8_t r           = (((color >> 16) & 0xFF) * brightness) / 255;
+        uint8_t g           = (((color >> 8) & 0xFF) * brightness) / 255;
+        uint8_t b           = (((color >> 0) & 0xFF) * brightness) / 255;
+        col                |= (r << 16) | (g << 8) | b;
+        pixels[i]           = col;
+    }
+}
 
+static void decode_icons(theme_setting_t theme_setting, uint32_t foreground) {
     for (int i = 0; i < ICON_LAST; i++) {
         char path[512] = {0};
         get_icon_path(i, path, sizeof(path));
@@ -166,31 +209,153 @@ void load_icons(void) {
             memset(&icons[i], 0, sizeof(pax_buf_t));
             ESP_LOGE(TAG, "Failed to decode icon file %s", icon_paths[i]);
             icons_missing = true;
+            fastclose(fd);
+            continue;
         }
         fastclose(fd);
 
-        if (theme_setting != THEME_BLACK) {
-            gui_theme_t* theme = get_theme();
-
-            uint32_t color = theme->palette.color_foreground;
-
-            if (i < ICON_F1 || i >= ICON_BATTERY_0) {
-                for (size_t y = 0; y < ICON_HEIGHT; y++) {
-                    for (size_t x = 0; x < ICON_WIDTH; x++) {
-                        pax_col_t col       = pax_get_pixel(&icons[i], x, y);
-                        col                ^= 0x00FFFFFF;  // Invert color
-                        uint8_t brightness  = ((col & 0xFF) + (col >> 8 & 0xFF) + (col >> 16 & 0xFF)) / 3;
-                        col                &= 0xFF000000;  // Remove colors
-                        uint8_t r           = (((color >> 16) & 0xFF) * brightness) / 255;
-                        uint8_t g           = (((color >> 8) & 0xFF) * brightness) / 255;
-                        uint8_t b           = (((color >> 0) & 0xFF) * brightness) / 255;
-                        col                |= (r << 16) | (g << 8) | b;
-                        pax_set_pixel(&icons[i], col, x, y);
-                    }
-                }
+        if (theme_setting != THEME_BLACK && (i < ICON_F1 || i >= ICON_BATTERY_0)) {
+            recolor_icon(&icons[i], foreground);
+        }
+    }
+}
+
+// 64-bit FNV-1a over the size and modification time of every icon file. Reading the directory entries costs a
+// fraction of decoding the files and catches icons replaced by other means than the launcher's download.
+static uint64_t fingerprint_sources(void) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < ICON_LAST; i++) {
+        char path[512] = {0};
+        get_icon_path(i, path, sizeof(path));
+        struct stat st;
+        int64_t     values[2] = {-1, -1};  // A missing file has its own fingerprint
+        if (stat(path, &st) == 0) {
+            values[0] = (int64_t)st.st_size;
+            values[1] = (int64_t)st.st_mtime;
+        }
+        const uint8_t* bytes = (const uint8_t*)values;
+        for (size_t j = 0; j < sizeof(values); j++) {
+            hash ^= bytes[j];
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+static bool load_icon_atlas(theme_setting_t theme_setting, uint32_t foreground, uint64_t sources) {
+    FILE* fd = fastopen(ICON_ATLAS_PATH, "rb");
+    if (fd == NULL) {
+        return false;
+    }
+
+    icon_atlas_header_t header = {0};
+    uint32_t            index[ICON_LAST];
+    if (fread(&header, sizeof(header), 1, fd) != 1 || header.magic != ICON_ATLAS_MAGIC ||
+        header.version != ICON_ATLAS_VERSION || header.count != ICON_LAST || header.width != ICON_WIDTH ||
+        header.height != ICON_HEIGHT || header.format != ICON_COLOR_FORMAT || header.theme != theme_setting ||
+        header.foreground != foreground ||
+        memcmp(header.launcher_sha256, esp_app_get_description()->app_elf_sha256, 32) != 0 ||
+        header.sources != sources || fread(index, sizeof(index), 1, fd) != 1) {
+        ESP_LOGW(TAG, "Icon atlas is outdated, rebuilding it");
+        fastclose(fd);
+        return false;
+    }
+
+    size_t stored = 0;
+    for (int i = 0; i < ICON_LAST; i++) {
+        if (index[i] != ICON_ATLAS_MISSING) {
+            if (index[i] != stored * ICON_BUFFER_SIZE) {
+                fastclose(fd);
+                return false;
             }
+            stored++;
+        }
+    }
+
+    void* pixels = heap_caps_malloc(stored * ICON_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    if (pixels == NULL || fread(pixels, ICON_BUFFER_SIZE, stored, fd) != stored) {
+        ESP_LOGE(TAG, "Failed to read icon atlas");
+        free(pixels);
+        fastclose(fd);
+        return false;
+    }
+    fastclose(fd);
+
+    atlas_pixels = pixels;
+    for (int i = 0; i < ICON_LAST; i++) {
+        if (index[i] == ICON_ATLAS_MISSING) {
+            icons_missing = true;
+            continue;
         }
+        pax_buf_init(&icons[i], (uint8_t*)pixels + index[i], ICON_WIDTH, ICON_HEIGHT, ICON_COLOR_FORMAT);
     }
+    return true;
+}
+
+static void save_icon_atlas(theme_setting_t theme_setting, uint32_t foreground, uint64_t sources) {
+    icon_atlas_header_t header = {
+        .magic      = ICON_ATLAS_MAGIC,
+        .version    = ICON_ATLAS_VERSION,
+        .count      = ICON_LAST,
+        .width      = ICON_WIDTH,
+        .height     = ICON_HEIGHT,
+        .format     = ICON_COLOR_FORMAT,
+        .theme      = theme_setting,
+        .foreground = foreground,
+        .sources    = sources,
+    };
+    memcpy(header.launcher_sha256, esp_app_get_description()->app_elf_sha256, 32);
+    uint32_t index[ICON_LAST];
+    uint32_t offset = 0;
+    for (int i = 0; i < ICON_LAST; i++) {
+        if (pax_buf_get_width(&icons[i]) == 0) {
+            index[i] = ICON_ATLAS_MISSING;
+        } else {
+            index[i]  = offset;
+            offset   += ICON_BUFFER_SIZE;
+        }
+    }
+
+    FILE* fd = fastopen(ICON_ATLAS_TEMP_PATH, "wb");
+    if (fd == NULL) {
+        ESP_LOGW(TAG, "Failed to create icon atlas");
+        return;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, fd) == 1;
+    ok      = ok && fwrite(index, sizeof(index), 1, fd) == 1;
+    for (int i = 0; ok && i < ICON_LAST; i++) {
+        if (index[i] != ICON_ATLAS_MISSING) {
+            ok = fwrite(pax_buf_get_pixels(&icons[i]), ICON_BUFFER_SIZE, 1, fd) == 1;
+        }
+    }
+    fastclose(fd);
+
+    // FAT can not rename over an existing file
+    remove(ICON_ATLAS_PATH);
+    if (!ok || rename(ICON_ATLAS_TEMP_PATH, ICON_ATLAS_PATH) != 0) {
+        ESP_LOGW(TAG, "Failed to store icon atlas");
+        remove(ICON_ATLAS_TEMP_PATH);
+    }
+}
+
+void load_icons(void) {
+    int64_t         start_time    = esp_timer_get_time();
+    theme_setting_t theme_setting = THEME_BLACK;
+    nvs_settings_get_theme(&theme_setting);
+    uint32_t foreground = (theme_setting != THEME_BLACK) ? get_theme()->palette.color_foreground : 0;
+    uint64_t sources    = fingerprint_sources();
+
+    if (load_icon_atlas(theme_setting, foreground, sources)) {
+        ESP_LOGI(TAG, "Loaded icons from atlas in %lld ms", (esp_timer_get_time() - start_time) / 1000);
+        return;
+    }
+
+    decode_icons(theme_setting, foreground);
+    // An incomplete set is not baked, so the atlas is created once the missing icons have been downloaded
+    if (!icons_missing) {
+        save_icon_atlas(theme_setting, foreground, sources);
+    }
+    ESP_LOGI(TAG, "Decoded icons in %lld ms", (esp_timer_get_time() - start_time) / 1000);
 }
 
 void unload_icons(void) {
@@ -200,9 +365,13 @@ void unload_icons(void) {
         }
         uint8_t* buffer = (uint8_t*)pax_buf_get_pixels(&icons[i]);
         pax_buf_destroy(&icons[i]);
-        free(buffer);
+        if (atlas_pixels == NULL) {
+            free(buffer);
+        }
         memset(&icons[i], 0, sizeof(pax_buf_t));
     }
+    free(atlas_pixels);
+    atlas_pixels = NULL;
 }
 
 pax_buf_t* get_icon(icon_t icon) {
@@ -282,6 +451,8 @@ esp_err_t download_icons(bool delete_old_files) {
         }
     }
 
+    remove(ICON_ATLAS_PATH);  // Baked from the new files on the next boot
+
     http_session_t session = http_session_begin("https://ota.tanmatsu.cloud/icons/");
     if (session == NULL) {
         message_dialog(icon, title, "Failed to create HTTP session", "Quit");
@@ -0,0 +1,336 @@
+#include "json_stream.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char* TAG = "JSON stream";
+
+#define TOKEN_INITIAL_CAPACITY 64
+
+typedef enum {
+    STATE_VALUE = 0,    // Expecting a value
+    STATE_VALUE_FIRST,  // Expecting the first value of an array or its end
+    STATE_KEY,          // Expecting a key
+    STATE_KEY_FIRST,    // Expecting the first key of an object or its end
+    STATE_COLON,
+    STATE_AFTER_VALUE,  // Expecting a comma or the end of the container
+    STATE_STRING,
+    STATE_LITERAL,  // Number, true, false or null
+    STATE_DONE,
+} json_stream_state_t;
+
+static bool is_whitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool is_literal_char(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' || c == 'E';
+}
+
+static bool fail(json_stream_t* stream, const char* reason) {
+    if (!stream->failed) {
+        ESP_LOGD(TAG, "Parsing stopped: %s", reason);
+    }
+    stream->failed = true;
+    return false;
+}
+
+static bool token_append(json_stream_t* stream, const char* data, size_t length) {
+    // One byte more than the content is kept for the terminator
+    if (stream->token_length + length + 1 > stream->token_capacity) {
+        size_t capacity = stream->token_capacity ? stream->token_capacity : TOKEN_INITIAL_CAPACITY;
+        while (capacity < stream->token_length + length + 1) {
+            capacity *= 2;
+        }
+        if (capacity > JSON_STREAM_MAX_TOKEN + 1) {
+            if (stream->token_length + length > JSON_STREAM_MAX_TOKEN) return fail(stream, "token too long");
+            capacity = JSON_STREAM_MAX_TOKEN + 1;
+        }
+        char* token = realloc(stream->token, capacity);
+        if (token == NULL) return fail(stream, "out of memory");
+        stream->token          = token;
+        stream->token_capacity = capacity;
+    }
+    memcpy(&stream->token[stream->token_length], data, length);
+    stream->token_length               += length;
+    stream->token[stream->token_length] = '\0';
+    return true;
+}
+
+static bool token_append_codepoint(json_stream_t* stream, uint32_t codepoint) {
+    char   utf8[4];
+    size_t length;
+    if (codepoint < 0x80) {
+        utf8[0] = codepoint;
+        length  = 1;
+    } else if (codepoint < 0x800) {
+        utf8[0] = 0xC0 | (codepoint >> 6);
+        utf8[1] = 0x80 | (codepoint & 0x3F);
+        length  = 2;
+    } else if (codepoint < 0x10000) {
+        utf8[0] = 0xE0 | (codepoint >> 12);
+        utf8[1] = 0x80 | ((codepoint >> 6) & 0x3F);
+        utf8[2] = 0x80 | (codepoint & 0x3F);
+        length  = 3;
+    } else {
+        utf8[0] = 0xF0 | (codepoint >> 18);
+        utf8[1] = 0x80 | ((codepoint >> 12) & 0x3F);
+        utf8[2] = 0x80 | ((codepoint >> 6) & 0x3F);
+        utf8[3] = 0x80 | (codepoint & 0x3F);
+        length  = 4;
+    }
+    return token_append(stream, utf8, length);
+}
+
+static bool push(json_stream_t* stream, uint8_t container) {
+    if (stream->depth >= JSON_STREAM_MAX_DEPTH) return fail(stream, "nesting too deep");
+    stream->containers[stream->depth++] = container;
+    bool (*callback)(void*) = (container == '{') ? stream->handler->object_begin : stream->handler->array_begin;
+    if (callback != NULL && !callback(stream->handler->arg)) return fail(stream, "stopped by handler");
+    stream->state = (container == '{') ? STATE_KEY_FIRST : STATE_VALUE_FIRST;
+    return true;
+}
+
+static void after_value(json_stream_t* stream) {
+    stream->state = (stream->depth == 0) ? STATE_DONE : STATE_AFTER_VALUE;
+}
+
+static bool pop(json_stream_t* stream, uint8_t container) {
+    if (stream->depth == 0 || stream->containers[stream->depth - 1] != container) {
+        return fail(stream, "unbalanced container");
+    }
+    stream->depth--;
+    bool (*callback)(void*) = (container == '{') ? stream->handler->object_end : stream->handler->array_end;
+    if (callback != NULL && !callback(stream->handler->arg)) return fail(stream, "stopped by handler");
+    after_value(stream);
+    return true;
+}
+
+static bool emit_value(json_stream_t* stream, json_stream_type_t type) {
+    if (stream->handler->value != NULL &&
+        !stream->handler->value(type, stream->token ? stream->token : "", stream->token_length, stream->handler->arg)) {
+        return fail(stream, "stopped by handler");
+    }
+    after_value(stream);
+    return true;
+}
+
+static bool end_string(json_stream_t* stream) {
+    if (stream->string_is_key) {
+        if (stream->handler->key != NULL &&
+            !stream->handler->key(stream->token ? stream->token : "", stream->token_length, stream->handler->arg)) {
+            return fail(stream, "stopped by handler");
+        }
+        stream->state = STATE_COLON;
+        return true;
+    }
+    return emit_value(stream, JSON_STREAM_STRING);
+}
+
+static bool end_literal(json_stream_t* stream) {
+    const char* token = stream->token;
+    if (strcmp(token, "true") == 0) return emit_value(stream, JSON_STREAM_TRUE);
+    if (strcmp(token, "false") == 0) return emit_value(stream, JSON_STREAM_FALSE);
+    if (strcmp(token, "null") == 0) return emit_value(stream, JSON_STREAM_NULL);
+    if (token[0] != '-' && (token[0] < '0' || token[0] > '9')) return fail(stream, "invalid literal");
+    char* end = NULL;
+    strtod(token, &end);
+    if (end == NULL || *end != '\0') return fail(stream, "invalid number");
+    return emit_value(stream, JSON_STREAM_NUMBER);
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Handles a character following a backslash, escape is 1 directly after it and 2 to 5 for the digits of \u
+static bool string_escape(json_stream_t* stream, char c) {
+    if (stream->escape == 1) {
+        const char* replacement = NULL;
+        switch (c) {
+            case '"':
+                replacement = "\"";
+                break;
+            case '\\':
+                replacement = "\\";
+                break;
+            case '/':
+                replacement = "/";
+                break;
+            case 'b':
+                replacement = "\b";
+                break;
+            case 'f':
+                replacement = "\f";
+                break;
+            case 'n':
+                replacement = "\n";
+                break;
+            case 'r':
+                replacement = "\r";
+                break;
+            case 't':
+                replacement = "\t";
+                break;
+            case 'u':
+                stream->escape    = 2;
+                stream->codepoint = 0;
+                return true;
+            default:
+                return fail(stream, "invalid escape");
+        }
+        stream->escape = 0;
+        return token_append(stream, replacement, 1);
+    }
+
+    int digit = hex_value(c);
+    if (digit < 0) return fail(stream, "invalid unicode escape");
+    stream->codepoint = (stream->codepoint << 4) | digit;
+    if (++stream->escape <= 5) return true;
+    stream->escape = 0;
+
+    uint32_t codepoint = stream->codepoint;
+    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+        stream->surrogate = codepoint;  // Combined with the low surrogate that has to follow
+        return true;
+    }
+    if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+        if (stream->surrogate == 0) return fail(stream, "unpaired surrogate");
+        codepoint         = 0x10000 + ((stream->surrogate - 0xD800) << 10) + (codepoint - 0xDC00);
+        stream->surrogate = 0;
+    }
+    return token_append_codepoint(stream, codepoint);
+}
+
+static bool begin_string(json_stream_t* stream, bool is_key) {
+    stream->string_is_key = is_key;
+    stream->token_length  = 0;
+    stream->escape        = 0;
+    stream->surrogate     = 0;
+    stream->state         = STATE_STRING;
+    return token_append(stream, "", 0);
+}
+
+static bool parse_value_start(json_stream_t* stream, char c) {
+    if (c == '{') return push(stream, '{');
+    if (c == '[') return push(stream, '[');
+    if (c == '"') return begin_string(stream, false);
+    if (c == ']' && stream->state == STATE_VALUE_FIRST) return pop(stream, '[');
+    if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+        stream->token_length = 0;
+        stream->state        = STATE_LITERAL;
+        return token_append(stream, &c, 1);
+    }
+    return fail(stream, "unexpected character");
+}
+
+void json_stream_init(json_stream_t* stream, const json_stream_handler_t* handler) {
+    memset(stream, 0, sizeof(json_stream_t));
+    stream->handler = handler;
+    stream->state   = STATE_VALUE;
+}
+
+bool json_stream_feed(json_stream_t* stream, const char* data, size_t length) {
+    if (stream->failed) return false;
+
+    size_t i = 0;
+    while (i < length) {
+        char c = data[i];
+
+        if (stream->state == STATE_STRING) {
+            // Copy runs of plain characters at once, strings make up most of a document
+            if (stream->escape == 0) {
+                size_t run = i;
+                while (run < length && data[run] != '"' && data[run] != '\\' && (uint8_t)data[run] >= 0x20) {
+                    run++;
+                }
+                if (run > i) {
+                    if (!token_append(stream, &data[i], run - i)) return false;
+                    i = run;
+                    continue;
+                }
+                if (c == '"') {
+                    if (stream->surrogate != 0) return fail(stream, "unpaired surrogate");
+                    if (!end_string(stream)) return false;
+                } else if (c == '\\') {
+                    stream->escape = 1;
+                } else {
+                    return fail(stream, "control character in string");
+                }
+            } else if (!string_escape(stream, c)) {
+                return false;
+            }
+            i++;
+            continue;
+        }
+
+        if (stream->state == STATE_LITERAL) {
+            if (is_literal_char(c)) {
+                if (!token_append(stream, &c, 1)) return false;
+                i++;
+                continue;
+            }
+            // The character after the literal is handled by the state that follows it
+            if (!end_literal(stream)) return false;
+            continue;
+        }
+
+        i++;
+        if (is_whitespace(c)) continue;
+
+        bool ok;
+        switch (stream->state) {
+            case STATE_VALUE:
+            case STATE_VALUE_FIRST:
+                ok = parse_value_start(stream, c);
+                break;
+            case STATE_KEY:
+            case STATE_KEY_FIRST:
+                if (c == '"') {
+                    ok = begin_string(stream, true);
+                } else if (c == '}' && stream->state == STATE_KEY_FIRST) {
+                    ok = pop(stream, '{');
+                } else {
+                    ok = fail(stream, "expected key");
+                }
+                break;
+            case STATE_COLON:
+                ok = (c == ':') ? true : fail(stream, "expected colon");
+                stream->state = STATE_VALUE;
+                break;
+            case STATE_AFTER_VALUE: {
+                uint8_t container = stream->containers[stream->depth - 1];
+                if (c == ',') {
+                    stream->state = (container == '{') ? STATE_KEY : STATE_VALUE;
+                    ok            = true;
+                } else if (c == '}' || c == ']') {
+                    ok = pop(stream, c == '}' ? '{' : '[');
+                } else {
+                    ok = fail(stream, "expected comma");
+                }
+                break;
+            }
+            default:
+                ok = fail(stream, "data after document");
+                break;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool json_stream_finish(json_stream_t* stream) {
+    if (stream->failed) return false;
+    if (stream->state == STATE_LITERAL && !end_literal(stream)) return false;
+    return stream->state == STATE_DONE;
+}
+
+void json_stream_free(json_stream_t* stream) {
+    free(stream->token);
+    stream->token          = NULL;
+    stream->token_length   = 0;
+    stream->token_capacity = 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Incremental (SAX style) JSON parser. The document can be fed in chunks of any size, every structural element is
+// reported to the handler as soon as it is complete, so no tree is built. Only the longest string or number of the
+// document is buffered, up to JSON_STREAM_MAX_TOKEN bytes. Strings are passed with escape sequences decoded to
+// UTF-8. Any callback returning false stops the parser.
+
+#define JSON_STREAM_MAX_DEPTH 32
+#define JSON_STREAM_MAX_TOKEN (32 * 1024)
+
+typedef enum {
+    JSON_STREAM_STRING = 0,
+    JSON_STREAM_NUMBER,  // Passed as written in the document
+    JSON_STREAM_TRUE,
+    JSON_STREAM_FALSE,
+    JSON_STREAM_NULL,
+} json_stream_type_t;
+
+typedef struct {
+    bool (*object_begin)(void* arg);
+    bool (*object_end)(void* arg);
+    bool (*array_begin)(void* arg);
+    bool (*array_end)(void* arg);
+    bool (*key)(const char* key, size_t length, void* arg);
+    bool (*value)(json_stream_type_t type, const char* value, size_t length, void* arg);
+    void* arg;
+} json_stream_handler_t;
+
+typedef struct {
+    const json_stream_handler_t* handler;
+    uint8_t                      state;
+    uint8_t                      containers[JSON_STREAM_MAX_DEPTH];  // '{' or '[' for every open container
+    size_t                       depth;
+    bool                         string_is_key;
+    uint8_t                      escape;     // Position in an escape sequence, 0 when not in one
+    uint32_t                     codepoint;  // Code point of the \u escape being decoded
+    uint32_t                     surrogate;  // High surrogate waiting for its low half
+    char*                        token;
+    size_t                       token_length;
+    size_t                       token_capacity;
+    bool                         failed;
+} json_stream_t;
+
+void json_stream_init(json_stream_t* stream, const json_stream_handler_t* handler);
+// Parses the next chunk of the document, returns false on a syntax error or when a callback stopped the parser
+bool json_stream_feed(json_stream_t* stream, const char* data, size_t length);
+// Ends the document, returns true when a complete value was parsed
+bool json_stream_finish(json_stream_t* stream);
+void json_stream_free(json_stream_t* stream);
@@ -41,6 +41,7 @@
 #include "gui_menu.h"
 #include "gui_style.h"
 #include "hal/lcd_types.h"
+#include "http_cache.h"
 #include "icons.h"
 #include "lora.h"
 #include "lora_settings_handler.h"
@@ -59,6 +60,7 @@
 #include "radio_system_protocol_client.h"
 #include "sdcard.h"
 #include "sdkconfig.h"
+#include "statusbar.h"
 #include "timezone.h"
 #include "usb_debug_listener.h"
 #include "usb_device.h"
@@ -170,7 +172,7 @@ static void wifi_task(void* pvParameters) {
             radio_information.country_code[1] != identity.region[1]) {
             radio_system_protocol_configuration_t configuration;
             configuration.board_revision = identity.revision, memcpy(configuration.country_code, identity.region, 2);
-            if (radio_system_protocol_set_configuration(&configuration) == ESP_OK) {
+            if (radio_system_protocol_apply_configuration(&configuration, &radio_information) == ESP_OK) {
                 ESP_LOGI(TAG, "Configured radio");
             } else {
                 ESP_LOGW(TAG, "Failed to configure radio");
@@ -470,6 +472,7 @@ void app_main(void) {
         startup_dialog("Loading icons...");
         load_icons();
     }
+    http_cache_init();
 
     startup_dialog("Checking I2C bus...");
     if (check_i2c_bus() != ESP_OK) {
@@ -634,6 +637,9 @@ void app_main(void) {
     startup_dialog("Initializing radio...");
 #if defined(CONFIG_BSP_TARGET_TANMATSU)
     ESP_ERROR_CHECK(lora_init_remote(&lora_handle, 32));
+#endif
+#if defined(CONFIG_BSP_TARGET_TANMATSU) || defined(CONFIG_IDF_TARGET_LINUX)
+    // On the linux target this starts the loopback stand-in for the radio
     radio_system_protocol_init();  // Return value ignored
 #endif
 
@@ -663,6 +669,11 @@ void app_main(void) {
     badgelink_start(usb_send_data);
     usb_debug_listener_initialize();
 
+    res = statusbar_start();
+    if (res != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start statusbar sampler: %s", esp_err_to_name(res));
+    }
+
     startup_dialog("Detecting Add-On boards...");
     addon_read_descriptor(ADDON_LOCATION_INTERNAL);
     addon_read_descriptor(ADDON_LOCATION_CATT);
@@ -35,7 +35,11 @@ static void render(bool partial, bool icons) {
         pax_draw_text(buffer, theme->palette.color_foreground, theme->footer.text_font, 16, position.x0,
                       position.y0 + 18 * 5, " - Jeroen Domburg");
     }
-    display_blit_buffer(buffer);
+    if (partial) {
+        display_blit_damage(buffer);
+    } else {
+        display_blit_buffer(buffer);
+    }
 }
 
 void menu_about(void) {
@@ -15,6 +15,7 @@
 #include "appfs_settings.h"
 #if CONFIG_ENABLE_LAUNCHERPLUGINS
 #include "badge_elf.h"
+#include "plugin_events.h"
 #endif
 #include "app_favorite.h"
 #include "bsp/input.h"
@@ -134,6 +135,10 @@ static appfs_handle_t ensure_interpreter_in_appfs(const char* interpreter_slug)
 // Put the device into a known state before handing control to an app:
 // switch USB to flash/monitor (debug) mode and power the radio off.
 void prepare_device_for_app_launch(void) {
+#if CONFIG_ENABLE_LAUNCHERPLUGINS
+    // Let plugins see the launch before the device restarts into the app
+    plugin_events_flush(100);
+#endif
     usb_mode_set(USB_DEBUG);
     esp_wifi_stop();
     bsp_power_set_radio_state(BSP_POWER_RADIO_STATE_OFF);
@@ -149,6 +154,10 @@ void execute_app(pax_buf_t* buffer, gui_theme_t* theme, pax_vec2_t position, app
     // Record last-used time for LRU eviction
     app_usage_set_last_used(app->slug, (uint32_t)time(NULL));
 
+#if CONFIG_ENABLE_LAUNCHERPLUGINS
+    plugin_events_publish(PLUGIN_EVENT_APP_LAUNCH, 0, app->slug);
+#endif
+
     render_base_screen_statusbar(buffer, theme, true, true, true,
                                  ((gui_element_icontext_t[]){{get_icon(ICON_APPS), "Apps"}}), 1, NULL, 0, NULL, 0);
     char message[64] = {0};
@@ -402,7 +411,11 @@ static void render(pax_buf_t* buffer, gui_theme_t* theme, menu_t* menu, pax_vec2
         pax_draw_text(buffer, theme->palette.color_foreground, theme->footer.text_font, theme->footer.text_height,
                       position.x0, position.y0, favorites_only ? "No favorite apps" : "No apps installed");
     }
-    display_blit_buffer(buffer);
+    if (partial) {
+        display_blit_damage(buffer);
+    } else {
+        display_blit_buffer(buffer);
+    }
 }
 
 void menu_apps(bool favorites_only) {
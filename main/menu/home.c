@@ -17,6 +17,7 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "gui_damage.h"
 #include "gui_menu.h"
 #include "gui_style.h"
 #include "icons.h"
@@ -39,6 +40,7 @@
 #include "sdcard.h"
 #include "sensors.h"
 #include "settings.h"
+#include "statusbar.h"
 #include "tools.h"
 #include "usb_device.h"
 
@@ -179,6 +181,9 @@ static void render(pax_buf_t* buffer, gui_theme_t* theme, menu_t* menu, pax_vec2
             pax_simple_rect(buffer, theme->menu.palette.color_background, position.x0,
                             pax_buf_get_height(buffer) - theme->footer.height - theme->footer.vertical_margin - 18 * 3,
                             pax_buf_get_width(buffer) - position.x0 * 2, 18 * 2);
+            gui_damage_add(position.x0,
+                           pax_buf_get_height(buffer) - theme->footer.height - theme->footer.vertical_margin - 18 * 3,
+                           pax_buf_get_width(buffer) - position.x0 * 2, 18 * 2);
             if (wifi_stack_get_version_mismatch()) {
                 pax_draw_text(
                     buffer, 0xFF999900, theme->footer.text_font, 16, position.x0,
@@ -220,7 +225,11 @@ static void render(pax_buf_t* buffer, gui_theme_t* theme, menu_t* menu, pax_vec2
             }
         }
     }
-    display_blit_buffer(buffer);
+    if (partial) {
+        display_blit_damage(buffer);
+    } else {
+        display_blit_buffer(buffer);
+    }
 }
 
 static void keyboard_backlight(void) {
@@ -296,7 +305,8 @@ void menu_home(void) {
 
     pax_vec2_t position = menu_calc_position(buffer, theme);
 
-    bool power_button_latch = false;
+    bool     power_button_latch = false;
+    uint32_t statusbar_version  = statusbar_get_version();
 
     render(buffer, theme, &menu, position, false, true, provisioned, name_match);
 
@@ -406,7 +416,8 @@ void menu_home(void) {
                     break;
             }
         } else {
-            render(buffer, theme, &menu, position, true, true, provisioned, name_match);
+            bool icons = statusbar_changed(&statusbar_version);
+            render(buffer, theme, &menu, position, true, icons, provisioned, name_match);
         }
     }
 }
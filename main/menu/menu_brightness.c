@@ -55,7 +55,11 @@ static void render(menu_t* menu, bool partial, bool icons) {
     menu_set_value(menu, position_index++, value_buffer);
 
     menu_render(buffer, menu, position, theme, partial);
-    display_blit_buffer(buffer);
+    if (partial) {
+        display_blit_damage(buffer);
+    } else {
+        display_blit_buffer(buffer);
+    }
 }
 
 void adjust_setting(menu_setting_t setting, int8_t direction) {
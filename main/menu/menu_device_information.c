@@ -116,7 +116,11 @@ static void render(pax_buf_t* buffer, gui_theme_t* theme, pax_vec2_t position, b
         line++;
 #endif
     }
-    display_blit_buffer(buffer);
+    if (partial) {
+        display_blit_damage(buffer);
+    } else {
+        display_blit_buffer(buffer);
+    }
 }
 
 void menu_device_information(pax_buf_t* buffer, gui_theme_t* theme) {
@@ -7,6 +7,7 @@
 #include "icons.h"
 #include "menu/message_dialog.h"
 #include "pax_gfx.h"
+#include "statusbar.h"
 
 pax_vec2_t menu_calc_position(pax_buf_t* buffer, gui_theme_t* theme) {
     int        header_height = theme->header.height + (theme->header.vertical_margin * 2);
@@ -36,8 +37,9 @@ static void menu_run_internal(menu_t* menu, gui_element_icontext_t* header, size
     QueueHandle_t input_event_queue = NULL;
     ESP_ERROR_CHECK(bsp_input_get_queue(&input_event_queue));
 
-    bool do_full_render = true;
-    bool do_icons       = true;
+    bool     do_full_render    = true;
+    bool     do_icons          = true;
+    uint32_t statusbar_version = statusbar_get_version();
 
     while (1) {
         if (do_full_render || do_icons) {
@@ -50,7 +52,11 @@ static void menu_run_internal(menu_t* menu, gui_element_icontext_t* header, size
         } else {
             menu_render(buffer, menu, position, theme, !do_full_render);
         }
-        display_blit_buffer(buffer);
+        if (do_full_render) {
+            display_blit_buffer(buffer);
+        } else {
+            display_blit_damage(buffer);
+        }
 
         do_full_render = false;
         do_icons       = false;
@@ -114,7 +120,7 @@ static void menu_run_internal(menu_t* menu, gui_element_icontext_t* header, size
                 }
             }
         } else {
-            do_icons = true;
+            do_icons = statusbar_changed(&statusbar_version);
         }
     }
 }
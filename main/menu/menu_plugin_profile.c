@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: MIT
+// Plugin profile information screen
+
+#include "menu_plugin_profile.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "bsp/input.h"
+#include "common/display.h"
+#include "common/theme.h"
+#include "gui_style.h"
+#include "icons.h"
+#include "menu/menu_helpers.h"
+#include "menu/message_dialog.h"
+#include "pax_gfx.h"
+#include "pax_text.h"
+#include "pax_types.h"
+#include "plugin_manager.h"
+#include "plugin_profile.h"
+
+#define FOOTER_LEFT  ((gui_element_icontext_t[]){{get_icon(ICON_ESC), "/"}, {get_icon(ICON_F1), "Back"}}), 2
+#define FOOTER_RIGHT NULL, 0
+#define TEXT_FONT    pax_font_sky_mono
+#define TEXT_SIZE    18
+
+static void render(const char* slug, const char* name) {
+    pax_buf_t*   buffer = display_get_buffer();
+    gui_theme_t* theme  = get_theme();
+
+    pax_vec2_t position = menu_calc_position(buffer, theme);
+
+    render_base_screen_statusbar(buffer, theme, true, true, true,
+                                 ((gui_element_icontext_t[]){{get_icon(ICON_INFO), (char*)name}}), 1, FOOTER_LEFT,
+                                 FOOTER_RIGHT);
+    char text_buffer[256];
+    int  line = 0;
+
+    // Looked up on every render, the plugin may have been unloaded in the meantime
+    plugin_profile_t profile = {0};
+    if (!plugin_manager_get_profile(slug, &profile)) {
+        pax_draw_text(buffer, theme->palette.color_foreground, TEXT_FONT, TEXT_SIZE, position.x0,
+                      position.y0 + (TEXT_SIZE + 2) * (line++), "Plugin is not loaded");
+        display_blit_buffer(buffer);
+        return;
+    }
+
+    snprintf(text_buffer, sizeof(text_buffer), "%-12s %8s %8s %8s %8s", "Callback", "Calls", "Avg us", "p95 us",
+             "Max us");
+    pax_draw_text(buffer, theme->palette.color_foreground, TEXT_FONT, TEXT_SIZE, position.x0,
+                  position.y0 + (TEXT_SIZE + 2) * (line++), text_buffer);
+    for (int type = 0; type < PLUGIN_CALLBACK_TYPE_COUNT; type++) {
+        const plugin_callback_stats_t* stats   = &profile.callbacks[type];
+        uint32_t                       average = stats->calls > 0 ? (uint32_t)(stats->total_us / stats->calls) : 0;
+        snprintf(text_buffer, sizeof(text_buffer), "%-12s %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32,
+                 plugin_profile_callback_name((plugin_callback_type_t)type), stats->calls, average, stats->p95_us,
+                 stats->max_us);
+        pax_draw_text(buffer, theme->palette.color_foreground, TEXT_FONT, TEXT_SIZE, position.x0,
+                      position.y0 + (TEXT_SIZE + 2) * (line++), text_buffer);
+    }
+
+    line++;
+    if (!profile.task_valid) {
+        pax_draw_text(buffer, theme->palette.color_foreground, TEXT_FONT, TEXT_SIZE, position.x0,
+                      position.y0 + (TEXT_SIZE + 2) * (line++), "No service task");
+        display_blit_buffer(buffer);
+        return;
+    }
+
+    snprintf(text_buffer, sizeof(text_buffer), "Service task:     %s", profile.task_running ? "Running" : "Stopped");
+    pax_draw_text(buffer, theme->palette.color_foreground, TEXT_FONT, TEXT_SIZE, position.x0,
+                  position.y0 + (TEXT_SIZE + 2) * (line++), text_buffer);
+    snprintf(text_buffer, sizeof(text_buffer), "CPU usage:        %u%% (%" PRIu64 " ms)", profile.task_cpu_percent,
+             profile.task_runtime_us / 1000);
+    pax_draw_text(buffer, theme->palette.color_foreground, TEXT_FONT, TEXT_SIZE, position.x0,
+                  position.y0 + (TEXT_SIZE + 2) * (line++), text_buffer);
+    snprintf(text_buffer, sizeof(text_buffer), "Stack free (min): %" PRIu32 " / %" PRIu32 " bytes",
+             profile.task_stack_min_free, profile.task_stack_size);
+    pax_draw_text(buffer, theme->palette.color_foreground, TEXT_FONT, TEXT_SIZE, position.x0,
+                  position.y0 + (TEXT_SIZE + 2) * (line++), text_buffer);
+    snprintf(text_buffer, sizeof(text_buffer), "Priority:         %u", profile.task_priority);
+    pax_draw_text(buffer, theme->palette.color_foreground, TEXT_FONT, TEXT_SIZE, position.x0,
+                  position.y0 + (TEXT_SIZE + 2) * (line++), text_buffer);
+
+    display_blit_buffer(buffer);
+}
+
+void menu_plugin_profile(const char* slug, const char* name) {
+    QueueHandle_t input_event_queue = NULL;
+    ESP_ERROR_CHECK(bsp_input_get_queue(&input_event_queue));
+
+    render(slug, name);
+    while (1) {
+        bsp_input_event_t event;
+        if (xQueueReceive(input_event_queue, &event, pdMS_TO_TICKS(1000)) == pdTRUE) {
+            switch (event.type) {
+                case INPUT_EVENT_TYPE_NAVIGATION: {
+                    if (event.args_navigation.state) {
+                        switch (event.args_navigation.key) {
+                            case BSP_INPUT_NAVIGATION_KEY_ESC:
+                            case BSP_INPUT_NAVIGATION_KEY_F1:
+                            case BSP_INPUT_NAVIGATION_KEY_GAMEPAD_B:
+                                return;
+                            default:
+                                break;
+                        }
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        } else {
+            render(slug, name);
+        }
+    }
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void menu_plugin_profile(const char* slug, const char* name);
@@ -15,6 +15,7 @@
 #include "gui_menu.h"
 #include "icons.h"
 #include "menu/menu_helpers.h"
+#include "menu/menu_plugin_profile.h"
 #include "menu/message_dialog.h"
 #include "pax_codecs.h"
 #include "pax_gfx.h"
@@ -64,8 +65,9 @@ static void render_footer(pax_buf_t* buffer, gui_theme_t* theme, bool has_plugin
     };
     gui_element_icontext_t footer_right[] = {
         {get_icon(ICON_F3), has_plugins ? "Auto[A]" : ""},
+        {get_icon(ICON_F4), has_plugins ? "Info" : ""},
     };
-    gui_footer_draw(buffer, theme, footer_left, has_plugins ? 2 : 1, footer_right, has_plugins ? 1 : 0);
+    gui_footer_draw(buffer, theme, footer_left, has_plugins ? 2 : 1, footer_right, has_plugins ? 2 : 0);
 }
 
 void menu_plugins(void) {
@@ -239,6 +241,25 @@ void menu_plugins(void) {
                             break;
                         }
 
+                        case BSP_INPUT_NAVIGATION_KEY_F4: {
+                            // Show the profile of the selected plugin
+                            if (plugin_count > 0) {
+                                size_t idx = (size_t)(uintptr_t)menu_get_callback_args(&menu, menu_get_position(&menu));
+
+                                if (idx < plugin_count) {
+                                    plugin_discovery_info_t* plugin = &plugins[idx];
+                                    if (plugin->is_loaded) {
+                                        menu_plugin_profile(plugin->slug, plugin->name);
+                                    } else {
+                                        message_dialog(get_icon(ICON_INFO), "Plugin info",
+                                                       "Load the plugin to see its profile", "OK");
+                                    }
+                                    refresh = true;
+                                }
+                            }
+                            break;
+                        }
+
                         default:
                             break;
                     }
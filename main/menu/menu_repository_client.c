@@ -1,11 +1,10 @@
 #include "menu_repository_client.h"
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <strings.h>
 #include "app_management.h"
 #include "app_metadata_parser.h"
-#include "bsp/device.h"
 #include "bsp/input.h"
 #include "cJSON.h"
 #include "common/display.h"
@@ -17,7 +16,6 @@
 #include "gui_style.h"
 #include "http_download.h"
 #include "icons.h"
-#include "mbedtls/base64.h"
 #include "menu/menu_helpers.h"
 #include "menu/message_dialog.h"
 #include "menu_repository_client_project.h"
@@ -29,6 +27,8 @@
 #include "pax_text.h"
 #include "pax_types.h"
 #include "repository_client.h"
+#include "repository_icons.h"
+#include "repository_list.h"
 #include "wifi_connection.h"
 
 #define FOOTER_LEFT  ((gui_element_icontext_t[]){{get_icon(ICON_ESC), "/"}, {get_icon(ICON_F1), "Back"}}), 2
@@ -38,35 +38,31 @@ extern bool wifi_stack_get_initialized(void);
 
 static const char* TAG = "Repository client";
 
-repository_json_data_t projects = {0};
+static repository_list_t projects = {0};
 
 #if defined(CONFIG_BSP_TARGET_KAMI)
 #define ICON_WIDTH        32
 #define ICON_HEIGHT       32
 #define ICON_BUFFER_SIZE  (ICON_WIDTH * ICON_HEIGHT * 4)  // 32x32 pixels, 2 bits per pixel
 #define ICON_COLOR_FORMAT PAX_BUF_2_PAL
+#define ICON_DISK_CACHE   false  // Decoded palette icons are not cached, the cache only stores 32-bit pixels
 #else
 #define ICON_WIDTH        32
 #define ICON_HEIGHT       32
 #define ICON_BUFFER_SIZE  (ICON_WIDTH * ICON_HEIGHT * 4)  // 32x32 pixels, 4 bytes per pixel (ARGB8888)
 #define ICON_COLOR_FORMAT PAX_BUF_32_8888ARGB
+#define ICON_DISK_CACHE   true
 #endif
 
+#define ICON_POLL_INTERVAL pdMS_TO_TICKS(100)  // Input timeout while icons are still being loaded
+#define WINDOW_MARGIN      4                    // Distance of the cursor to the window edge that fetches a page
+
 typedef enum {
     INSTALL_STATUS_NOT_INSTALLED = 0,
     INSTALL_STATUS_INSTALLED,
     INSTALL_STATUS_UPDATE_AVAILABLE,
 } install_status_t;
 
-typedef struct {
-    const char*         name;
-    const char*         slug;
-    int                 index;
-    pax_buf_t*          icon;
-    install_status_t    status;
-    app_mgmt_location_t install_location;  // Where the app is installed (if applicable)
-} project_sort_entry_t;
-
 typedef enum {
     VIEW_MODE_APPS = 0,
 #ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
@@ -76,31 +72,13 @@ typedef enum {
 
 static view_mode_t current_view_mode = VIEW_MODE_APPS;
 
-// Check if a project's application type for the current device is "plugin".
-// Always defined: even when plugins are disabled we use it to filter plugin
-// projects out of the apps view so they aren't shown as installable.
-static bool is_project_plugin(cJSON* project_obj) {
-    cJSON* applications = cJSON_GetObjectItem(project_obj, "application");
-    if (!applications || !cJSON_IsArray(applications)) return false;
-
-    char device_name[32] = {0};
-    bsp_device_get_name(device_name, sizeof(device_name));
-    size_t device_name_len = strlen(device_name);
-
-    cJSON* app = NULL;
-    cJSON_ArrayForEach(app, applications) {
-        cJSON* targets = cJSON_GetObjectItem(app, "targets");
-        if (!targets) continue;
-        cJSON* t = NULL;
-        cJSON_ArrayForEach(t, targets) {
-            if (cJSON_IsString(t) && strlen(t->valuestring) == device_name_len &&
-                strncasecmp(t->valuestring, device_name, device_name_len) == 0) {
-                cJSON* type = cJSON_GetObjectItem(app, "type");
-                return (type && cJSON_IsString(type) && strcmp(type->valuestring, "plugin") == 0);
-            }
-        }
-    }
+static bool viewing_plugins(void) {
+#ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
+    return current_view_mode == VIEW_MODE_PLUGINS;
+#else
+    // When plugin support is disabled, never list plugins.
     return false;
+#endif
 }
 
 // Read the "version" field from an installed app's metadata.json.
@@ -184,63 +162,32 @@ static install_status_t check_install_status(const char* slug, const char* repo_
     return INSTALL_STATUS_NOT_INSTALLED;
 }
 
-// Decode a base64-encoded PNG into a pax_buf_t. Returns NULL on failure.
-static pax_buf_t* decode_base64_icon(const char* base64_data) {
-    size_t b64_len     = strlen(base64_data);
-    size_t decoded_len = 0;
-
-    // Get decoded size
-    if (mbedtls_base64_decode(NULL, 0, &decoded_len, (const unsigned char*)base64_data, b64_len) !=
-        MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL) {
-        return NULL;
-    }
-
-    uint8_t* png_data = malloc(decoded_len);
-    if (png_data == NULL) {
-        return NULL;
-    }
-
-    size_t actual_len = 0;
-    if (mbedtls_base64_decode(png_data, decoded_len, &actual_len, (const unsigned char*)base64_data, b64_len) != 0) {
-        free(png_data);
-        return NULL;
-    }
-
-    pax_buf_t* icon = calloc(1, sizeof(pax_buf_t));
-    if (icon == NULL) {
-        free(png_data);
-        return NULL;
-    }
-
-    if (!pax_decode_png_buf(icon, png_data, actual_len, ICON_COLOR_FORMAT, 0)) {
-        free(icon);
-        free(png_data);
-        return NULL;
-    }
-
-    free(png_data);
-    return icon;
-}
-
-// Create a transparent 32x32 placeholder icon for alignment
-static pax_buf_t* create_placeholder_icon(void) {
-    pax_buf_t* icon = calloc(1, sizeof(pax_buf_t));
-    if (icon == NULL) return NULL;
-    pax_buf_init(icon, NULL, ICON_WIDTH, ICON_HEIGHT, ICON_COLOR_FORMAT);
-    pax_background(icon, 0x00000000);
-    return icon;
-}
-
-// Parallel array of install status, indexed by menu position (after sorting).
+// Parallel array of install status, indexed by menu position. Only covers the projects in the resident window.
 // Allocated in populate_project_list, freed by caller.
 static install_status_t*    project_statuses  = NULL;
 static app_mgmt_location_t* project_locations = NULL;
-static int*                 project_indices   = NULL;
+static uint32_t*            project_indices   = NULL;  // Index of the project in the complete listing
 static int                  project_count     = 0;
 static bool                 has_updates       = false;
 
-static cJSON* get_project_by_index(cJSON* json_projects, int index) {
-    return cJSON_GetArrayItem(json_projects, index);
+static repository_project_t* get_project_by_index(repository_list_t* list, uint32_t index) {
+    return repository_list_get(list, index);
+}
+
+// The listing only holds what the list shows, the project page gets the complete metadata from the server. Builds
+// a wrapper object like the entries of the listing have: {"slug": "...", "project": {...}}
+static cJSON* load_project_wrapper(const char* server, const char* slug) {
+    repository_json_data_t data = {0};
+    if (!load_project(server, &data, slug)) return NULL;
+
+    cJSON* wrapper = cJSON_CreateObject();
+    if (wrapper != NULL) {
+        cJSON_AddStringToObject(wrapper, "slug", slug);
+        cJSON_AddItemToObject(wrapper, "project", data.json);
+        data.json = NULL;  // Owned by the wrapper now
+    }
+    free_repository_data_json(&data);
+    return wrapper;
 }
 
 static void free_project_info(void) {
@@ -254,234 +201,78 @@ static void free_project_info(void) {
     has_updates       = false;
 }
 
-static int compare_projects_by_name(const void* a, const void* b) {
-    const project_sort_entry_t* ea = (const project_sort_entry_t*)a;
-    const project_sort_entry_t* eb = (const project_sort_entry_t*)b;
-    return strcasecmp(ea->name, eb->name);
-}
-
-// Icon cache: one pax_buf_t* per JSON array entry, populated once after loading projects.
-static pax_buf_t** icon_cache      = NULL;
-static int         icon_cache_size = 0;
-
-static void free_icon_cache(void) {
-    if (icon_cache == NULL) return;
-    for (int j = 0; j < icon_cache_size; j++) {
-        if (icon_cache[j] != NULL) {
-            pax_buf_destroy(icon_cache[j]);
-            free(icon_cache[j]);
-        }
-    }
-    free(icon_cache);
-    icon_cache      = NULL;
-    icon_cache_size = 0;
-}
-
 // Tear down all module-level state owned by menu_repository_client.
 // Safe to call multiple times; leaves everything in a {0} state.
 static void free_repository_menu_state(void) {
-    free_repository_data_json(&projects);
+    repository_icons_end();
     free_project_info();
-    free_icon_cache();
+    repository_list_close(&projects);
 }
 
-// Decode base64 icons and download missing ones into the icon cache.
-// Called once after loading the project list.
-static void load_all_icons(cJSON* json_projects) {
-    int total = cJSON_GetArraySize(json_projects);
-    if (total <= 0) return;
-
-    icon_cache      = calloc(total, sizeof(pax_buf_t*));
-    icon_cache_size = total;
-    if (icon_cache == NULL) return;
-
-    // First pass: decode base64 icons from the JSON
-    int    missing_count = 0;
-    int    idx           = 0;
-    cJSON* entry_obj;
-    cJSON_ArrayForEach(entry_obj, json_projects) {
-        cJSON* icon_str = cJSON_GetObjectItem(entry_obj, "icon");
-        if (icon_str != NULL && cJSON_IsString(icon_str)) {
-            icon_cache[idx] = decode_base64_icon(icon_str->valuestring);
-        }
-        if (icon_cache[idx] == NULL) {
-            // Check if this entry has an icon filename we can download
-            cJSON* project_obj = cJSON_GetObjectItem(entry_obj, "project");
-            cJSON* icon_obj    = project_obj ? cJSON_GetObjectItem(project_obj, "icon") : NULL;
-            cJSON* icon_32     = icon_obj ? cJSON_GetObjectItem(icon_obj, "32x32") : NULL;
-            if (icon_32 != NULL && cJSON_IsString(icon_32)) missing_count++;
-        }
-        idx++;
-    }
-
-    // Second pass: download missing icons using a single keepalive connection
+// Start loading icons for the resident window in the background, the list can be used while they arrive
+static void load_all_icons(repository_list_t* list) {
     uint8_t download_icons = DEFAULT_REPO_DOWNLOAD_ICONS;
     nvs_settings_get_u8(NVS_KEY_REPO_DOWNLOAD_ICONS, DEFAULT_REPO_DOWNLOAD_ICONS, &download_icons);
-    if (missing_count > 0 && download_icons) {
-        char server[128] = {0};
-        nvs_settings_get_repo_server(server, sizeof(server), DEFAULT_REPO_SERVER);
-
-        repository_json_data_t info           = {0};
-        char                   data_path[128] = {0};
-        bool                   have_data_path = false;
-        if (load_information(server, &info)) {
-            cJSON* dp = cJSON_GetObjectItem(info.json, "data_path");
-            if (dp != NULL && cJSON_IsString(dp)) {
-                snprintf(data_path, sizeof(data_path), "%s", dp->valuestring);
-                have_data_path = true;
-            }
-            free_repository_data_json(&info);
-        }
 
-        if (have_data_path) {
-            char url[384];
-            snprintf(url, sizeof(url), "%s%s", server, data_path);
-            http_session_t session = http_session_begin(url);
-            if (session != NULL) {
-                int download_num = 0;
-                idx              = 0;
-                cJSON_ArrayForEach(entry_obj, json_projects) {
-                    if (icon_cache[idx] != NULL) {
-                        idx++;
-                        continue;
-                    }
-
-                    cJSON* slug_obj    = cJSON_GetObjectItem(entry_obj, "slug");
-                    cJSON* project_obj = cJSON_GetObjectItem(entry_obj, "project");
-                    cJSON* icon_obj    = project_obj ? cJSON_GetObjectItem(project_obj, "icon") : NULL;
-                    cJSON* icon_32     = icon_obj ? cJSON_GetObjectItem(icon_obj, "32x32") : NULL;
-                    if (slug_obj == NULL || icon_32 == NULL || !cJSON_IsString(icon_32)) {
-                        idx++;
-                        continue;
-                    }
-
-                    download_num++;
-                    char busy_msg[64];
-                    snprintf(busy_msg, sizeof(busy_msg), "Downloading icons (%d/%d)...", download_num, missing_count);
-                    progress_dialog(get_icon(ICON_STOREFRONT), "Repository", busy_msg,
-                                    (download_num * 100) / missing_count, true);
-
-                    snprintf(url, sizeof(url), "%s%s/%s/%s", server, data_path, slug_obj->valuestring,
-                             icon_32->valuestring);
-                    uint8_t* png_data = NULL;
-                    size_t   png_size = 0;
-                    if (http_session_download_ram(session, url, &png_data, &png_size) && png_data != NULL) {
-                        pax_buf_t* icon = calloc(1, sizeof(pax_buf_t));
-                        if (icon != NULL && pax_decode_png_buf(icon, png_data, png_size, ICON_COLOR_FORMAT, 0)) {
-                            icon_cache[idx] = icon;
-                        } else {
-                            free(icon);
-                        }
-                        free(png_data);
-                    }
-                    idx++;
-                }
-                http_session_end(session);
-            }
-        }
-    }
-
-    // Fill remaining NULLs with placeholder icons
-    if (download_icons) {
-        for (int j = 0; j < total; j++) {
-            if (icon_cache[j] == NULL) {
-                icon_cache[j] = create_placeholder_icon();
-            }
-        }
+    // The icon loader copies what it needs from the records, it only needs to see them for the duration of the call
+    size_t                 count  = repository_list_count(list);
+    repository_project_t** window = malloc(sizeof(repository_project_t*) * count);
+    if (window == NULL) return;
+    uint32_t first = repository_list_first(list);
+    for (size_t i = 0; i < count; i++) {
+        window[i] = repository_list_get(list, first + i);
     }
+    repository_icons_begin(window, count, list->server, ICON_COLOR_FORMAT, ICON_WIDTH, ICON_HEIGHT, download_icons,
+                           ICON_DISK_CACHE);
+    free(window);
 }
 
-static void populate_project_list(menu_t* menu, cJSON* json_projects) {
-#ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
-    bool want_plugins = (current_view_mode == VIEW_MODE_PLUGINS);
-#else
-    // When plugin support is disabled, never list plugins.
-    bool want_plugins = false;
-#endif
-
-    // Count valid entries matching the current view mode
-    int    total = 0;
-    cJSON* entry_obj;
-    cJSON_ArrayForEach(entry_obj, json_projects) {
-        cJSON* project_obj = cJSON_GetObjectItem(entry_obj, "project");
-        if (project_obj != NULL && cJSON_GetObjectItem(project_obj, "name") != NULL) {
-            if (is_project_plugin(project_obj) == want_plugins) {
-                total++;
-            }
-        }
+// Point the menu items at the current icons, icons are indexed by position in the resident window
+static void apply_icons(menu_t* menu) {
+    uint32_t first = repository_list_first(&projects);
+    for (int j = 0; j < project_count && project_indices != NULL; j++) {
+        menu_set_icon(menu, j, repository_icons_get(project_indices[j] - first));
     }
+}
 
-    if (total == 0) return;
+// Point the menu at icons that finished loading since the last call
+static bool refresh_icons(menu_t* menu) {
+    if (!repository_icons_update()) return false;
+    apply_icons(menu);
+    return true;
+}
 
-    // Collect entries for sorting
-    project_sort_entry_t* sorted = malloc(sizeof(project_sort_entry_t) * total);
-    if (sorted == NULL) return;
+// The window only holds projects of the current view, every resident project is listed
+static void populate_project_list(menu_t* menu, repository_list_t* list) {
+    bool want_plugins = list->plugins;
 
-    int i   = 0;
-    int idx = 0;
-    cJSON_ArrayForEach(entry_obj, json_projects) {
-        cJSON* slug_obj = cJSON_GetObjectItem(entry_obj, "slug");
-        if (slug_obj == NULL) {
-            ESP_LOGE(TAG, "Slug object is NULL for entry %d", idx);
-            idx++;
-            continue;
-        }
-        cJSON* project_obj = cJSON_GetObjectItem(entry_obj, "project");
-        if (project_obj == NULL) {
-            ESP_LOGE(TAG, "Project object is NULL for entry %d", idx);
-            idx++;
-            continue;
-        }
-        cJSON* name_obj = cJSON_GetObjectItem(project_obj, "name");
-        if (name_obj == NULL) {
-            ESP_LOGE(TAG, "Name object is NULL for entry %d", idx);
-            idx++;
-            continue;
-        }
-        // Filter by current view mode
-        if (is_project_plugin(project_obj) != want_plugins) {
-            idx++;
-            continue;
-        }
-        sorted[i].name  = name_obj->valuestring;
-        sorted[i].slug  = slug_obj->valuestring;
-        sorted[i].index = idx;
-        sorted[i].icon  = NULL;
-
-        // Check install status by comparing version strings
-        sorted[i].install_location = want_plugins ? APP_MGMT_LOCATION_INTERNAL_PLUGINS : APP_MGMT_LOCATION_INTERNAL;
-        cJSON*      version_obj    = cJSON_GetObjectItem(project_obj, "version");
-        char        repo_version_buf[32] = {0};
-        const char* repo_version         = NULL;
-        if (version_obj != NULL && cJSON_IsString(version_obj)) {
-            repo_version = version_obj->valuestring;
-        } else if (version_obj != NULL && cJSON_IsNumber(version_obj)) {
-            snprintf(repo_version_buf, sizeof(repo_version_buf), "%d", version_obj->valueint);
-            repo_version = repo_version_buf;
-        }
-        sorted[i].status =
-            check_install_status(slug_obj->valuestring, repo_version, &sorted[i].install_location, want_plugins);
+    free_project_info();
 
-        // Look up icon from the pre-populated cache (indexed by JSON array position)
-        sorted[i].icon = (idx < icon_cache_size) ? icon_cache[idx] : NULL;
+    size_t count = repository_list_count(list);
+    if (count == 0) return;
 
-        i++;
-        idx++;
+    // Projects are listed in the order of the server, the window is bounded so these arrays are as well
+    project_statuses  = malloc(sizeof(install_status_t) * count);
+    project_locations = malloc(sizeof(app_mgmt_location_t) * count);
+    project_indices   = malloc(sizeof(uint32_t) * count);
+    if (project_statuses == NULL || project_locations == NULL || project_indices == NULL) {
+        free_project_info();
+        return;
     }
 
-    qsort(sorted, i, sizeof(project_sort_entry_t), compare_projects_by_name);
+    uint32_t first = repository_list_first(list);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t              index   = first + i;
+        repository_project_t* project = repository_list_get(list, index);
 
-    // Save status info in parallel arrays (indexed by menu position after sort)
-    free_project_info();
-    project_statuses  = malloc(sizeof(install_status_t) * i);
-    project_locations = malloc(sizeof(app_mgmt_location_t) * i);
-    project_indices   = malloc(sizeof(int) * i);
-    project_count     = i;
-    has_updates       = false;
+        // Check install status by comparing version strings
+        const char* repo_version = (project->version[0] != '\0') ? project->version : NULL;
+
+        app_mgmt_location_t location = want_plugins ? APP_MGMT_LOCATION_INTERNAL_PLUGINS : APP_MGMT_LOCATION_INTERNAL;
+        install_status_t    status   = check_install_status(project->slug, repo_version, &location, want_plugins);
 
-    for (int j = 0; j < i; j++) {
         const char* prefix;
-        switch (sorted[j].status) {
+        switch (status) {
             case INSTALL_STATUS_UPDATE_AVAILABLE:
                 prefix      = "[U]";
                 has_updates = true;
@@ -494,19 +285,72 @@ static void populate_project_list(menu_t* menu, cJSON* json_projects) {
                 break;
         }
         char label[128];
-        snprintf(label, sizeof(label), "%s %s", prefix, sorted[j].name);
-        if (sorted[j].icon != NULL) {
-            menu_insert_item_icon(menu, label, NULL, (void*)sorted[j].index, -1, sorted[j].icon);
+        snprintf(label, sizeof(label), "%s %s", prefix, project->name);
+
+        // Look up icon from the icon table (indexed by position in the resident window)
+        pax_buf_t* icon = repository_icons_get(i);
+        if (icon != NULL) {
+            menu_insert_item_icon(menu, label, NULL, (void*)index, -1, icon);
         } else {
-            menu_insert_item(menu, label, NULL, (void*)sorted[j].index, -1);
+            menu_insert_item(menu, label, NULL, (void*)index, -1);
         }
 
-        if (project_statuses) project_statuses[j] = sorted[j].status;
-        if (project_locations) project_locations[j] = sorted[j].install_location;
-        if (project_indices) project_indices[j] = sorted[j].index;
+        project_statuses[project_count]  = status;
+        project_locations[project_count] = location;
+        project_indices[project_count]   = index;
+        project_count++;
+    }
+}
+
+// Rebuild the menu for the resident window, keeping the cursor on the project at the given index in the listing or
+// on the first listed project after it
+static void rebuild_project_list(menu_t* menu, uint32_t index) {
+    menu_free(menu);
+    menu_initialize(menu);
+    populate_project_list(menu, &projects);
+
+    size_t position = 0;
+    while ((int)position < project_count - 1 && project_indices[position] < index) {
+        position++;
+    }
+    menu_set_position(menu, position);
+}
+
+// Fetch the neighbouring page when the cursor gets close to the edge of the resident window, pages on the other
+// side of the window are dropped. Returns true when the menu was rebuilt. Pages other than the last hold at least
+// REPOSITORY_LIST_PAGE_SIZE projects, so after moving the window in one direction the cursor is far from the other
+// edge and the next keypress does not move it back.
+static bool update_window(menu_t* menu) {
+    size_t   position = menu_get_position(menu);
+    uint32_t index    = repository_list_first(&projects);
+    bool     changed  = false;
+    if ((int)position < project_count) {
+        index = project_indices[position];
+    }
+
+    while (menu_get_length(menu) - menu_get_position(menu) <= WINDOW_MARGIN && repository_list_has_next(&projects)) {
+        if (!repository_list_load_next(&projects)) break;
+        changed = true;
+        repository_icons_end();
+        rebuild_project_list(menu, index);
     }
 
-    free(sorted);
+    if (!changed) {
+        while (menu_get_position(menu) < WINDOW_MARGIN && repository_list_has_previous(&projects)) {
+            if (!repository_list_load_previous(&projects)) break;
+            changed = true;
+            repository_icons_end();
+            rebuild_project_list(menu, index);
+        }
+    }
+
+    if (changed) {
+        ESP_LOGI(TAG, "Window now holds projects %" PRIu32 " to %" PRIu32, repository_list_first(&projects),
+                 repository_list_first(&projects) + (uint32_t)repository_list_count(&projects));
+        load_all_icons(&projects);
+        apply_icons(menu);
+    }
+    return changed;
 }
 
 static void download_callback(size_t download_position, size_t file_size, const char* status_text) {
@@ -520,6 +364,45 @@ static void download_callback(size_t download_position, size_t file_size, const
     progress_dialog(get_icon(ICON_DOWNLOADING), "Downloading", text, percentage, true);
 }
 
+// Update every project of the current view that has an update available. The listing is walked page by page, so
+// projects outside of the resident window are included without holding the complete catalog in memory.
+static void update_all(int* out_updated, int* out_failed) {
+    bool want_plugins = projects.plugins;
+
+    repository_list_t scan = {0};
+    if (!repository_list_open(&scan, projects.server, projects.category, want_plugins)) {
+        (*out_failed)++;
+        return;
+    }
+
+    do {
+        // The page just fetched is always the last one in the window
+        repository_list_page_t* page = &scan.pages[scan.page_count - 1];
+        for (size_t i = 0; i < page->count; i++) {
+            repository_project_t* project = &page->projects[i];
+            const char* repo_version = (project->version[0] != '\0') ? project->version : NULL;
+
+            app_mgmt_location_t location =
+                want_plugins ? APP_MGMT_LOCATION_INTERNAL_PLUGINS : APP_MGMT_LOCATION_INTERNAL;
+            if (check_install_status(project->slug, repo_version, &location, want_plugins) !=
+                INSTALL_STATUS_UPDATE_AVAILABLE) {
+                continue;
+            }
+
+            char msg[64];
+            snprintf(msg, sizeof(msg), "Updating %s (%d)...", project->slug, *out_updated + *out_failed + 1);
+            busy_dialog(get_icon(ICON_STOREFRONT), "Updating", msg, true);
+            if (app_mgmt_install(scan.server, project->slug, location, download_callback) == ESP_OK) {
+                (*out_updated)++;
+            } else {
+                (*out_failed)++;
+            }
+        }
+    } while (repository_list_load_next(&scan));
+
+    repository_list_close(&scan);
+}
+
 static install_status_t previous_render_status = INSTALL_STATUS_NOT_INSTALLED;
 
 static void render(pax_buf_t* buffer, gui_theme_t* theme, menu_t* menu, const char* server, bool partial, bool icons) {
@@ -618,7 +501,7 @@ void menu_repository_client(char* category) {
 
     char server[128] = {0};
     nvs_settings_get_repo_server(server, sizeof(server), DEFAULT_REPO_SERVER);
-    bool success = load_projects(server, &projects, category);
+    bool success = repository_list_open(&projects, server, category, viewing_plugins());
     if (!success) {
         ESP_LOGE(TAG, "Failed to load projects");
         message_dialog(get_icon(ICON_STOREFRONT), "Repository: fatal error", "Failed to load projects from server",
@@ -626,8 +509,6 @@ void menu_repository_client(char* category) {
         return;
     }
 
-    load_all_icons(projects.json);
-
     busy_dialog(get_icon(ICON_STOREFRONT), "Repository", "Rendering list of projects...", true);
 
     QueueHandle_t input_event_queue = NULL;
@@ -635,12 +516,22 @@ void menu_repository_client(char* category) {
 
     menu_t menu = {0};
     menu_initialize(&menu);
-    populate_project_list(&menu, projects.json);
+    populate_project_list(&menu, &projects);
+    // A short first page pulls in the next one right away
+    if (!update_window(&menu)) {
+        load_all_icons(&projects);
+        apply_icons(&menu);
+    }
 
     render(buffer, theme, &menu, server, false, true);
     while (1) {
+        if (refresh_icons(&menu)) {
+            render(buffer, theme, &menu, server, true, true);
+        }
+
         bsp_input_event_t event;
-        if (xQueueReceive(input_event_queue, &event, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        TickType_t        timeout = repository_icons_busy() ? ICON_POLL_INTERVAL : pdMS_TO_TICKS(1000);
+        if (xQueueReceive(input_event_queue, &event, timeout) == pdTRUE) {
             switch (event.type) {
                 case INPUT_EVENT_TYPE_NAVIGATION: {
                     if (event.args_navigation.state) {
@@ -653,11 +544,11 @@ void menu_repository_client(char* category) {
                                 return;
                             case BSP_INPUT_NAVIGATION_KEY_UP:
                                 menu_navigate_previous(&menu);
-                                render(buffer, theme, &menu, server, true, false);
+                                render(buffer, theme, &menu, server, !update_window(&menu), false);
                                 break;
                             case BSP_INPUT_NAVIGATION_KEY_DOWN:
                                 menu_navigate_next(&menu);
-                                render(buffer, theme, &menu, server, true, false);
+                                render(buffer, theme, &menu, server, !update_window(&menu), false);
                                 break;
                             case BSP_INPUT_NAVIGATION_KEY_RETURN:
                             case BSP_INPUT_NAVIGATION_KEY_GAMEPAD_A:
@@ -670,31 +561,33 @@ void menu_repository_client(char* category) {
                                                                   ? "Update"
                                                                   : "Re-install";
                                     char        confirm_msg[128];
-                                    cJSON*      wrapper  = get_project_by_index(projects.json, project_indices[pos]);
-                                    cJSON*      slug_obj = wrapper ? cJSON_GetObjectItem(wrapper, "slug") : NULL;
                                     snprintf(confirm_msg, sizeof(confirm_msg), "%s this app?", action_name);
                                     message_dialog_return_type_t msg_ret =
                                         adv_dialog_yes_no(get_icon(ICON_HELP), action_name, confirm_msg);
-                                    if (msg_ret == MSG_DIALOG_RETURN_OK && slug_obj != NULL) {
+
+                                    repository_project_t* project =
+                                        get_project_by_index(&projects, project_indices[pos]);
+                                    if (msg_ret == MSG_DIALOG_RETURN_OK && project != NULL) {
                                         busy_dialog(get_icon(ICON_STOREFRONT), "Repository", "Installing...", true);
-                                        app_mgmt_install(server, slug_obj->valuestring, project_locations[pos],
+                                        app_mgmt_install(server, project->slug, project_locations[pos],
                                                          download_callback);
                                     }
                                     // Rebuild menu to refresh status markers
-                                    menu_free(&menu);
-                                    menu_initialize(&menu);
-                                    size_t saved_pos = pos;
-                                    populate_project_list(&menu, projects.json);
-                                    if (saved_pos >= menu_get_length(&menu) && menu_get_length(&menu) > 0) {
-                                        saved_pos = menu_get_length(&menu) - 1;
-                                    }
-                                    menu_set_position(&menu, saved_pos);
+                                    rebuild_project_list(&menu, project_indices[pos]);
                                 } else {
                                     // Not installed: open project detail with location picker
-                                    void*  arg     = menu_get_callback_args(&menu, pos);
-                                    cJSON* wrapper = get_project_by_index(projects.json, (int)(arg));
+                                    uint32_t              index   = (uint32_t)menu_get_callback_args(&menu, pos);
+                                    repository_project_t* project = get_project_by_index(&projects, index);
+                                    if (project == NULL) {
+                                        ESP_LOGE(TAG, "Project %" PRIu32 " is not resident", index);
+                                        break;
+                                    }
+                                    busy_dialog(get_icon(ICON_STOREFRONT), "Repository", "Loading project...", true);
+                                    cJSON* wrapper = load_project_wrapper(server, project->slug);
                                     if (wrapper == NULL) {
-                                        ESP_LOGE(TAG, "Wrapper object is NULL");
+                                        message_dialog(get_icon(ICON_ERROR), "Repository",
+                                                       "Failed to load project from server", "OK");
+                                        render(buffer, theme, &menu, server, false, true);
                                         break;
                                     }
 #ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
@@ -703,14 +596,9 @@ void menu_repository_client(char* category) {
 #else
                                     menu_repository_client_project(buffer, theme, wrapper, false);
 #endif
+                                    cJSON_Delete(wrapper);
                                     // Rebuild menu to refresh status markers (app may have been installed)
-                                    menu_free(&menu);
-                                    menu_initialize(&menu);
-                                    populate_project_list(&menu, projects.json);
-                                    if (pos >= menu_get_length(&menu) && menu_get_length(&menu) > 0) {
-                                        pos = menu_get_length(&menu) - 1;
-                                    }
-                                    menu_set_position(&menu, pos);
+                                    rebuild_project_list(&menu, index);
                                 }
                                 render(buffer, theme, &menu, server, false, true);
                                 break;
@@ -720,10 +608,17 @@ void menu_repository_client(char* category) {
                                 // Toggle between Apps and Plugins view
                                 current_view_mode =
                                     (current_view_mode == VIEW_MODE_APPS) ? VIEW_MODE_PLUGINS : VIEW_MODE_APPS;
-                                menu_free(&menu);
-                                menu_initialize(&menu);
-                                populate_project_list(&menu, projects.json);
-                                menu_set_position(&menu, 0);
+                                repository_icons_end();
+                                busy_dialog(get_icon(ICON_STOREFRONT), "Repository", "Downloading list of projects...",
+                                            true);
+                                if (!repository_list_open(&projects, server, category, viewing_plugins())) {
+                                    ESP_LOGE(TAG, "Failed to load projects");
+                                }
+                                rebuild_project_list(&menu, 0);
+                                if (!update_window(&menu)) {
+                                    load_all_icons(&projects);
+                                    apply_icons(&menu);
+                                }
                                 render(buffer, theme, &menu, server, false, true);
                                 break;
                             }
@@ -733,9 +628,8 @@ void menu_repository_client(char* category) {
                                 if (pos >= (size_t)project_count || project_statuses == NULL) break;
                                 if (project_statuses[pos] == INSTALL_STATUS_NOT_INSTALLED) break;
 
-                                cJSON* wrapper  = get_project_by_index(projects.json, project_indices[pos]);
-                                cJSON* slug_obj = wrapper ? cJSON_GetObjectItem(wrapper, "slug") : NULL;
-                                if (slug_obj == NULL) break;
+                                repository_project_t* project = get_project_by_index(&projects, project_indices[pos]);
+                                if (project == NULL) break;
 
 #ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
                                 const char* delete_title =
@@ -752,71 +646,46 @@ void menu_repository_client(char* category) {
                                 if (msg_ret == MSG_DIALOG_RETURN_OK) {
 #ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
                                     if (current_view_mode == VIEW_MODE_PLUGINS) {
-                                        app_mgmt_uninstall(slug_obj->valuestring, APP_MGMT_LOCATION_INTERNAL_PLUGINS);
-                                        app_mgmt_uninstall(slug_obj->valuestring, APP_MGMT_LOCATION_SD_PLUGINS);
+                                        app_mgmt_uninstall(project->slug, APP_MGMT_LOCATION_INTERNAL_PLUGINS);
+                                        app_mgmt_uninstall(project->slug, APP_MGMT_LOCATION_SD_PLUGINS);
                                     } else
 #endif
                                     {
-                                        app_mgmt_uninstall(slug_obj->valuestring, APP_MGMT_LOCATION_INTERNAL);
-                                        app_mgmt_uninstall(slug_obj->valuestring, APP_MGMT_LOCATION_SD);
+                                        app_mgmt_uninstall(project->slug, APP_MGMT_LOCATION_INTERNAL);
+                                        app_mgmt_uninstall(project->slug, APP_MGMT_LOCATION_SD);
                                     }
 
                                     // Rebuild menu to refresh status markers
-                                    menu_free(&menu);
-                                    menu_initialize(&menu);
-                                    populate_project_list(&menu, projects.json);
-                                    if (pos >= menu_get_length(&menu) && menu_get_length(&menu) > 0) {
-                                        pos = menu_get_length(&menu) - 1;
-                                    }
-                                    menu_set_position(&menu, pos);
+                                    rebuild_project_list(&menu, project_indices[pos]);
                                 }
                                 render(buffer, theme, &menu, server, false, true);
                                 break;
                             }
                             case BSP_INPUT_NAVIGATION_KEY_F6: {
-                                if (!has_updates) break;
+                                // Updates are looked up in the complete listing, not only in the resident window
                                 message_dialog_return_type_t msg_ret = adv_dialog_yes_no(
                                     get_icon(ICON_HELP), "Update all", "Update all apps with available updates?");
                                 if (msg_ret == MSG_DIALOG_RETURN_OK) {
                                     int updated = 0;
                                     int failed  = 0;
-                                    int total   = 0;
-                                    for (int j = 0; j < project_count; j++) {
-                                        if (project_statuses[j] != INSTALL_STATUS_UPDATE_AVAILABLE) continue;
-                                        total++;
-                                        cJSON* wrapper  = get_project_by_index(projects.json, project_indices[j]);
-                                        cJSON* slug_obj = wrapper ? cJSON_GetObjectItem(wrapper, "slug") : NULL;
-                                        if (slug_obj == NULL) {
-                                            failed++;
-                                            continue;
-                                        }
-                                        char msg[64];
-                                        snprintf(msg, sizeof(msg), "Updating %s (%d/%d)...", slug_obj->valuestring,
-                                                 updated + failed + 1, total);
-                                        busy_dialog(get_icon(ICON_STOREFRONT), "Updating", msg, true);
-                                        esp_err_t res = app_mgmt_install(server, slug_obj->valuestring,
-                                                                         project_locations[j], download_callback);
-                                        if (res == ESP_OK) {
-                                            updated++;
-                                        } else {
-                                            failed++;
-                                        }
-                                    }
+                                    busy_dialog(get_icon(ICON_STOREFRONT), "Updating", "Looking for updates...", true);
+                                    update_all(&updated, &failed);
                                     if (failed > 0) {
                                         char summary[64];
                                         snprintf(summary, sizeof(summary), "Updated %d/%d apps. %d failed.", updated,
-                                                 total, failed);
+                                                 updated + failed, failed);
                                         message_dialog(get_icon(ICON_ERROR), "Update all", summary, "OK");
+                                    } else if (updated == 0) {
+                                        message_dialog(get_icon(ICON_STOREFRONT), "Update all", "No updates available",
+                                                       "OK");
                                     }
                                     // Rebuild menu to refresh status markers
-                                    size_t saved_pos = menu_get_position(&menu);
-                                    menu_free(&menu);
-                                    menu_initialize(&menu);
-                                    populate_project_list(&menu, projects.json);
-                                    if (saved_pos >= menu_get_length(&menu) && menu_get_length(&menu) > 0) {
-                                        saved_pos = menu_get_length(&menu) - 1;
+                                    size_t   saved_pos = menu_get_position(&menu);
+                                    uint32_t index     = repository_list_first(&projects);
+                                    if ((int)saved_pos < project_count) {
+                                        index = project_indices[saved_pos];
                                     }
-                                    menu_set_position(&menu, saved_pos);
+                                    rebuild_project_list(&menu, index);
                                 }
                                 render(buffer, theme, &menu, server, false, true);
                                 break;
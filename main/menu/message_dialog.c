@@ -1,14 +1,13 @@
 #include "message_dialog.h"
 #include <stdbool.h>
-#include <time.h>
 #include "bsp/input.h"
 #include "bsp/power.h"
 #include "common/device.h"
 #include "common/display.h"
 #include "common/theme.h"
-#include "esp_wifi.h"
 #include "esp_wifi_types_generic.h"
 #include "freertos/idf_additions.h"
+#include "gui_damage.h"
 #include "gui_element_footer.h"
 #include "gui_element_header.h"
 #include "gui_element_icontext.h"
@@ -21,116 +20,84 @@
 #include "pax_types.h"
 #include "sdcard.h"
 #include "sdkconfig.h"
+#include "statusbar.h"
 #include "usb_device.h"
-#include "wifi_connection.h"
 #ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
 #include "plugin_manager.h"
 #endif
 #if defined(CONFIG_BSP_TARGET_TANMATSU)
-#include "bsp/tanmatsu.h"
 #include "synthwave.h"
-#include "tanmatsu_coprocessor.h"
 #endif
 
 static bool startup_dialog_initialized = false;
-static char clock_buffer[6]            = {0};
 
-static gui_element_icontext_t clock_indicator(void) {
-    time_t     now      = time(NULL);
-    struct tm* timeinfo = localtime(&now);
-    strftime(clock_buffer, sizeof(clock_buffer), "%H:%M", timeinfo);
-    return (gui_element_icontext_t){NULL, clock_buffer};
+static gui_element_icontext_t clock_indicator(statusbar_snapshot_t* status) {
+    return (gui_element_icontext_t){NULL, status->clock};
 }
 
 static char percentage_buffer[5] = {0};
 
-static gui_element_icontext_t battery_indicator(bsp_power_battery_information_t* information) {
-
-#if defined(CONFIG_BSP_TARGET_TANMATSU)
-    tanmatsu_coprocessor_handle_t coprocessor_handle = NULL;
-    bsp_tanmatsu_coprocessor_get_handle(&coprocessor_handle);
-    tanmatsu_coprocessor_pmic_faults_t faults = {0};
-    tanmatsu_coprocessor_get_pmic_faults(coprocessor_handle, &faults);
-#endif
-
-    if (!information->battery_available) {
+static gui_element_icontext_t battery_indicator(statusbar_snapshot_t* status) {
+    if (!status->battery_available) {
         return (gui_element_icontext_t){get_icon(ICON_BATTERY_UNKNOWN), ""};
     }
-    if (information->battery_charging) {
+    if (status->battery_charging) {
         return (gui_element_icontext_t){get_icon(ICON_BATTERY_BOLT), ""};
     }
-
-#if defined(CONFIG_BSP_TARGET_TANMATSU)
-    if (faults.watchdog || faults.chrg_input || faults.chrg_thermal || faults.chrg_safety || faults.batt_ovp ||
-        faults.ntc_cold || faults.ntc_hot) {
+    if (status->battery_fault) {
         return (gui_element_icontext_t){get_icon(ICON_BATTERY_ALERT), ""};
     }
-#endif
 
-    // snprintf(percentage_buffer, sizeof(percentage_buffer), "%3u%%", (uint8_t)information->remaining_percentage);
-    if (information->remaining_percentage >= 98) {
+    // snprintf(percentage_buffer, sizeof(percentage_buffer), "%3u%%", status->battery_percentage);
+    if (status->battery_percentage >= 98) {
         return (gui_element_icontext_t){get_icon(ICON_BATTERY_FULL), percentage_buffer};
     }
-    if (information->remaining_percentage >= 84) {
+    if (status->battery_percentage >= 84) {
         return (gui_element_icontext_t){get_icon(ICON_BATTERY_6), percentage_buffer};
     }
-    if (information->remaining_percentage >= 70) {
+    if (status->battery_percentage >= 70) {
         return (gui_element_icontext_t){get_icon(ICON_BATTERY_5), percentage_buffer};
     }
-    if (information->remaining_percentage >= 56) {
+    if (status->battery_percentage >= 56) {
         return (gui_element_icontext_t){get_icon(ICON_BATTERY_4), percentage_buffer};
     }
-    if (information->remaining_percentage >= 42) {
+    if (status->battery_percentage >= 42) {
         return (gui_element_icontext_t){get_icon(ICON_BATTERY_3), percentage_buffer};
     }
-    if (information->remaining_percentage >= 28) {
+    if (status->battery_percentage >= 28) {
         return (gui_element_icontext_t){get_icon(ICON_BATTERY_2), percentage_buffer};
     }
-    if (information->remaining_percentage >= 14) {
+    if (status->battery_percentage >= 14) {
         return (gui_element_icontext_t){get_icon(ICON_BATTERY_1), percentage_buffer};
     }
     return (gui_element_icontext_t){get_icon(ICON_BATTERY_0), percentage_buffer};
 }
 
-static gui_element_icontext_t usb_indicator(void) {
-    if (usb_mode_get() == USB_DEVICE) {
+static gui_element_icontext_t usb_indicator(statusbar_snapshot_t* status) {
+    if (status->usb_mode == USB_DEVICE) {
         return (gui_element_icontext_t){get_icon(ICON_USB), ""};
     } else {
         return (gui_element_icontext_t){get_icon(ICON_BUG_REPORT), ""};
     }
 }
 
-extern bool wifi_stack_get_initialized(void);
-
-static wifi_ap_record_t connected_ap = {0};
-
-static gui_element_icontext_t wifi_indicator(void) {
-    bool              radio_initialized = wifi_stack_get_initialized();
-    wifi_mode_t       mode              = WIFI_MODE_NULL;
-    bsp_radio_state_t state;
-    bsp_power_get_radio_state(&state);
-    switch (state) {
+static gui_element_icontext_t wifi_indicator(statusbar_snapshot_t* status) {
+    static const icon_t signal_icons[] = {ICON_WIFI_0_BAR, ICON_WIFI_1_BAR, ICON_WIFI_2_BAR, ICON_WIFI_3_BAR,
+                                          ICON_WIFI_4_BAR};
+    switch (status->radio_state) {
         case BSP_POWER_RADIO_STATE_OFF:
             return (gui_element_icontext_t){NULL, ""};
         case BSP_POWER_RADIO_STATE_BOOTLOADER:
             return (gui_element_icontext_t){NULL, "BOOT"};
         case BSP_POWER_RADIO_STATE_APPLICATION:
         default:
-            if (radio_initialized && esp_wifi_get_mode(&mode) == ESP_OK) {
-                bool show_text = pax_buf_get_width(display_get_buffer()) > 400;
+            if (status->wifi_initialized) {
+                bool        show_text = pax_buf_get_width(display_get_buffer()) > 400;
+                wifi_mode_t mode      = status->wifi_mode;
                 if (mode == WIFI_MODE_STA || mode == WIFI_MODE_APSTA) {
-                    if (wifi_connection_is_connected() && esp_wifi_sta_get_ap_info(&connected_ap) == ESP_OK) {
-                        pax_buf_t* icon = get_icon(ICON_WIFI_0_BAR);
-                        if (connected_ap.rssi > -50) {
-                            icon = get_icon(ICON_WIFI_4_BAR);
-                        } else if (connected_ap.rssi > -60) {
-                            icon = get_icon(ICON_WIFI_3_BAR);
-                        } else if (connected_ap.rssi > -70) {
-                            icon = get_icon(ICON_WIFI_2_BAR);
-                        } else if (connected_ap.rssi > -80) {
-                            icon = get_icon(ICON_WIFI_1_BAR);
-                        }
-                        return (gui_element_icontext_t){icon, show_text ? (char*)connected_ap.ssid : ""};
+                    if (status->wifi_connected) {
+                        pax_buf_t* icon = get_icon(signal_icons[status->wifi_signal]);
+                        return (gui_element_icontext_t){icon, show_text ? status->wifi_ssid : ""};
                     } else {
                         return (gui_element_icontext_t){get_icon(ICON_WIFI_OFF), show_text ? "Disconnected" : ""};
                     }
@@ -147,8 +114,8 @@ static gui_element_icontext_t wifi_indicator(void) {
     }
 }
 
-static gui_element_icontext_t sdcard_indicator(void) {
-    switch (sd_status()) {
+static gui_element_icontext_t sdcard_indicator(statusbar_snapshot_t* status) {
+    switch (status->sd_status) {
         case SD_STATUS_OK:
             return (gui_element_icontext_t){get_icon(ICON_SD_CARD), ""};
         case SD_STATUS_ERROR:
@@ -165,6 +132,7 @@ void render_base_screen(pax_buf_t* buffer, gui_theme_t* theme, bool background,
                         gui_element_icontext_t* footer_right, size_t footer_right_count) {
     if (background) {
         pax_background(buffer, theme->palette.color_background);
+        gui_damage_add_all();
     }
     if (header) {
         if (!background) {
@@ -172,6 +140,8 @@ void render_base_screen(pax_buf_t* buffer, gui_theme_t* theme, bool background,
                             theme->header.height + (theme->header.vertical_margin * 2));
         }
         gui_header_draw(buffer, theme, header_left, header_left_count, header_right, header_right_count);
+        // Includes the separator line drawn just below the header box
+        gui_damage_add(0, 0, pax_buf_get_width(buffer), theme->header.height + (theme->header.vertical_margin * 2) + 1);
     }
     if (footer) {
         if (!background) {
@@ -180,6 +150,8 @@ void render_base_screen(pax_buf_t* buffer, gui_theme_t* theme, bool background,
                             pax_buf_get_width(buffer), theme->footer.height + (theme->footer.vertical_margin * 2));
         }
         gui_footer_draw(buffer, theme, footer_left, footer_left_count, footer_right, footer_right_count);
+        gui_damage_add(0, pax_buf_get_height(buffer) - theme->footer.height - (theme->footer.vertical_margin * 2) - 1,
+                       pax_buf_get_width(buffer), theme->footer.height + (theme->footer.vertical_margin * 2) + 1);
     }
 }
 
@@ -187,26 +159,28 @@ void render_base_screen_statusbar(pax_buf_t* buffer, gui_theme_t* theme, bool ba
                                   gui_element_icontext_t* header_left, size_t header_left_count,
                                   gui_element_icontext_t* footer_left, size_t footer_left_count,
                                   gui_element_icontext_t* footer_right, size_t footer_right_count) {
+    statusbar_snapshot_t   status             = {0};
     gui_element_icontext_t header_right[5]    = {0};
     size_t                 header_right_count = 0;
     if (header) {
+        statusbar_get_snapshot(&status);
+
         if (device_has_rtc()) {
-            header_right[header_right_count++] = clock_indicator();
+            header_right[header_right_count++] = clock_indicator(&status);
         }
 
-        bsp_power_battery_information_t information = {0};
-        if (bsp_power_get_battery_information(&information) == ESP_OK) {
-            header_right[header_right_count++] = battery_indicator(&information);
+        if (status.battery_valid) {
+            header_right[header_right_count++] = battery_indicator(&status);
         }
 
         if (device_has_usb_switching()) {
-            header_right[header_right_count++] = usb_indicator();
+            header_right[header_right_count++] = usb_indicator(&status);
         }
 
-        header_right[header_right_count++] = wifi_indicator();
+        header_right[header_right_count++] = wifi_indicator(&status);
 
         if (device_has_sdcard()) {
-            header_right[header_right_count++] = sdcard_indicator();
+            header_right[header_right_count++] = sdcard_indicator(&status);
         }
     } else {
         header_right_count = 0;
@@ -237,7 +211,11 @@ static void render(pax_buf_t* buffer, gui_theme_t* theme, pax_vec2_t position, p
         pax_draw_text(buffer, theme->palette.color_foreground, theme->footer.text_font, 16, position.x0,
                       position.y0 + 18 * 0, message);
     }
-    display_blit_buffer(buffer);
+    if (partial) {
+        display_blit_damage(buffer);
+    } else {
+        display_blit_buffer(buffer);
+    }
 }
 
 void message_dialog(pax_buf_t* icon, const char* title, const char* message, const char* action_text) {
@@ -256,6 +234,7 @@ void message_dialog(pax_buf_t* icon, const char* title, const char* message, con
         .y1 = pax_buf_get_height(buffer) - footer_height - theme->menu.vertical_margin - theme->menu.vertical_padding,
     };
 
+    uint32_t statusbar_version = statusbar_get_version();
     render(buffer, theme, position, icon, title, message, ADV_DIALOG_FOOTER_OK_TEXT((char*)action_text), false, true);
     while (1) {
         bsp_input_event_t event;
@@ -277,7 +256,7 @@ void message_dialog(pax_buf_t* icon, const char* title, const char* message, con
                 default:
                     break;
             }
-        } else {
+        } else if (statusbar_changed(&statusbar_version)) {
             render(buffer, theme, position, icon, title, message, ADV_DIALOG_FOOTER_OK_TEXT((char*)action_text), true,
                    true);
         }
@@ -301,6 +280,7 @@ bsp_input_navigation_key_t adv_dialog(pax_buf_t* icon, const char* title, const
         .y1 = pax_buf_get_height(buffer) - footer_height - theme->menu.vertical_margin - theme->menu.vertical_padding,
     };
 
+    uint32_t statusbar_version = statusbar_get_version();
     render(buffer, theme, position, icon, title, message, footer, footer_count, false, true);
     while (1) {
         bsp_input_event_t event;
@@ -313,7 +293,7 @@ bsp_input_navigation_key_t adv_dialog(pax_buf_t* icon, const char* title, const
                 default:
                     break;
             }
-        } else {
+        } else if (statusbar_changed(&statusbar_version)) {
             render(buffer, theme, position, icon, title, message, footer, footer_count, true, true);
         }
     }
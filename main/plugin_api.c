@@ -18,11 +18,12 @@
 #include "fastopen.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "nvs.h"
-#include "nvs_flash.h"
 #include "pax_fonts.h"
 #include "pax_gfx.h"
 #include "plugin_context.h"
+#include "plugin_events.h"
+#include "plugin_profile.h"
+#include "plugin_settings.h"
 #include "tanmatsu_plugin.h"
 
 static const char* TAG = "plugin_api";
@@ -145,7 +146,10 @@ int plugin_api_render_status_widgets(pax_buf_t* buffer, int x_right, int y, int
 
     for (int i = 0; i < MAX_STATUS_WIDGETS; i++) {
         if (status_widgets[i].active && status_widgets[i].callback) {
-            int widget_width = status_widgets[i].callback(buffer, current_x, y, height, status_widgets[i].user_data);
+            int64_t start        = plugin_profile_begin();
+            int     widget_width =
+                status_widgets[i].callback(buffer, current_x, y, height, status_widgets[i].user_data);
+            plugin_profile_record(status_widgets[i].owner, PLUGIN_CALLBACK_STATUS_WIDGET, start);
             if (widget_width > 0) {
                 current_x   -= widget_width;
                 total_width += widget_width;
@@ -155,6 +159,16 @@ int plugin_api_render_status_widgets(pax_buf_t* buffer, int x_right, int y, int
     return total_width;
 }
 
+// Called by the statusbar sampler, widgets are redrawn periodically as long as any is registered
+bool plugin_api_has_status_widgets(void) {
+    for (int i = 0; i < MAX_STATUS_WIDGETS; i++) {
+        if (status_widgets[i].active && status_widgets[i].callback) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // ============================================
 // Input Hook API Implementation
 // ============================================
@@ -191,7 +205,10 @@ static bool plugin_input_hook_wrapper(bsp_input_event_t* bsp_event, void* user_d
         return false;
     }
 
-    return entry->callback((asp_input_event_t*)bsp_event, entry->user_data);
+    int64_t start    = plugin_profile_begin();
+    bool    consumed = entry->callback((asp_input_event_t*)bsp_event, entry->user_data);
+    plugin_profile_record(entry->owner, PLUGIN_CALLBACK_INPUT_HOOK, start);
+    return consumed;
 }
 
 int asp_plugin_input_hook_register(plugin_context_t* ctx, plugin_input_hook_fn callback, void* user_data) {
@@ -276,17 +293,7 @@ bool asp_plugin_input_get_key_state(uint32_t key) {
     return false;
 }
 
-int asp_plugin_event_register(plugin_context_t* ctx, uint32_t event_mask, void* handler, void* arg) {
-    (void)ctx;
-    (void)event_mask;
-    (void)handler;
-    (void)arg;
-    return -1;
-}
-
-void asp_plugin_event_unregister(int handler_id) {
-    (void)handler_id;
-}
+// Event API: see plugin_events.c
 
 // LED API moved to badge-elf-api (asp/led.h)
 
@@ -426,78 +433,34 @@ void asp_plugin_menu_remove_item(int item_id) {
 // Settings API Implementation
 // ============================================
 
+// Values live in a per-plugin cache and are written to NVS in batches, see plugin_settings.c
+
 bool asp_plugin_settings_get_string(plugin_context_t* ctx, const char* key, char* value, size_t max_len) {
     if (!ctx || !ctx->settings_namespace || !key || !value) {
         return false;
     }
-
-    nvs_handle_t handle;
-    esp_err_t    err = nvs_open(ctx->settings_namespace, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        return false;
-    }
-
-    err = nvs_get_str(handle, key, value, &max_len);
-    nvs_close(handle);
-
-    return err == ESP_OK;
+    return plugin_settings_get_string(ctx, key, value, max_len);
 }
 
 bool asp_plugin_settings_set_string(plugin_context_t* ctx, const char* key, const char* value) {
     if (!ctx || !ctx->settings_namespace || !key || !value) {
         return false;
     }
-
-    nvs_handle_t handle;
-    esp_err_t    err = nvs_open(ctx->settings_namespace, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        return false;
-    }
-
-    err = nvs_set_str(handle, key, value);
-    if (err == ESP_OK) {
-        err = nvs_commit(handle);
-    }
-    nvs_close(handle);
-
-    return err == ESP_OK;
+    return plugin_settings_set_string(ctx, key, value);
 }
 
 bool asp_plugin_settings_get_int(plugin_context_t* ctx, const char* key, int32_t* value) {
     if (!ctx || !ctx->settings_namespace || !key || !value) {
         return false;
     }
-
-    nvs_handle_t handle;
-    esp_err_t    err = nvs_open(ctx->settings_namespace, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        return false;
-    }
-
-    err = nvs_get_i32(handle, key, value);
-    nvs_close(handle);
-
-    return err == ESP_OK;
+    return plugin_settings_get_int(ctx, key, value);
 }
 
 bool asp_plugin_settings_set_int(plugin_context_t* ctx, const char* key, int32_t value) {
     if (!ctx || !ctx->settings_namespace || !key) {
         return false;
     }
-
-    nvs_handle_t handle;
-    esp_err_t    err = nvs_open(ctx->settings_namespace, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        return false;
-    }
-
-    err = nvs_set_i32(handle, key, value);
-    if (err == ESP_OK) {
-        err = nvs_commit(handle);
-    }
-    nvs_close(handle);
-
-    return err == ESP_OK;
+    return plugin_settings_set_int(ctx, key, value);
 }
 
 // ============================================
@@ -657,6 +620,13 @@ void plugin_api_init(void) {
         }
     }
 
+    plugin_profile_init();
+    plugin_settings_init();
+
+    if (plugin_events_start() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start plugin event bus");
+    }
+
     if (led_claims == NULL) {
         bsp_led_get_count(&led_claim_count);
         led_claims = calloc(led_claim_count, sizeof(led_claim_t));
@@ -672,6 +642,9 @@ void plugin_api_cleanup_for_plugin(plugin_context_t* ctx) {
 
     ESP_LOGI(TAG, "Cleaning up API registrations for plugin: %s", ctx->plugin_slug ? ctx->plugin_slug : "unknown");
 
+    // Event handlers have their own lock, held while the dispatcher calls them
+    plugin_events_cleanup_for_plugin(ctx);
+
     if (plugin_api_mutex) {
         xSemaphoreTake(plugin_api_mutex, portMAX_DELAY);
     }
@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: MIT
+
+#include "plugin_events.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "plugin_context.h"
+#include "plugin_profile.h"
+
+static const char* TAG = "plugin_events";
+
+#define PLUGIN_EVENT_QUEUE_LENGTH  32  // Power of two
+#define PLUGIN_EVENT_MAX_HANDLERS  16
+#define PLUGIN_EVENT_TASK_STACK    4096
+#define PLUGIN_EVENT_TASK_PRIORITY (tskIDLE_PRIORITY + 2)
+#define PLUGIN_EVENT_SLOW_US       10000  // Handlers taking longer delay every later event, they are logged
+
+_Static_assert((PLUGIN_EVENT_QUEUE_LENGTH & (PLUGIN_EVENT_QUEUE_LENGTH - 1)) == 0,
+               "PLUGIN_EVENT_QUEUE_LENGTH must be a power of two");
+_Static_assert(PLUGIN_EVENT_COUNT <= 32, "Event masks are 32 bits");
+
+// Bounded multi-producer/single-consumer queue. Every slot carries a
+// sequence number: a slot at position p is free for the producer that claims
+// p when its sequence is p, and holds an event for the consumer when it is
+// p + 1. The consumer hands the slot back for position p + LENGTH. Producers
+// claim positions with a compare-and-swap, so none of them ever waits for
+// another and a full queue drops the event instead of blocking.
+typedef struct {
+    atomic_uint         sequence;
+    plugin_event_data_t data;
+} event_slot_t;
+
+typedef struct {
+    bool                   active;
+    uint32_t               event_mask;
+    plugin_event_handler_t handler;
+    void*                  arg;
+    plugin_context_t*      owner;  // Track which plugin owns this registration
+} event_handler_entry_t;
+
+static event_slot_t slots[PLUGIN_EVENT_QUEUE_LENGTH];
+static atomic_uint  enqueue_position   = 0;
+static unsigned int dequeue_position   = 0;  // Only used by the dispatcher
+static atomic_uint  delivered_position = 0;  // Events before this position have been delivered
+static atomic_uint  dropped_events     = 0;
+
+// Recursive so handlers can register and unregister from the dispatcher task
+static SemaphoreHandle_t     handlers_mutex                      = NULL;
+static event_handler_entry_t handlers[PLUGIN_EVENT_MAX_HANDLERS] = {0};
+static TaskHandle_t          dispatcher_task                     = NULL;
+
+static bool dequeue(plugin_event_data_t* out_data) {
+    event_slot_t* slot     = &slots[dequeue_position & (PLUGIN_EVENT_QUEUE_LENGTH - 1)];
+    unsigned int  sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if (sequence != dequeue_position + 1) {
+        return false;
+    }
+    *out_data = slot->data;
+    atomic_store_explicit(&slot->sequence, dequeue_position + PLUGIN_EVENT_QUEUE_LENGTH, memory_order_release);
+    dequeue_position++;
+    return true;
+}
+
+static void deliver(const plugin_event_data_t* data) {
+    uint32_t bit = PLUGIN_EVENT_MASK(data->event);
+
+    xSemaphoreTakeRecursive(handlers_mutex, portMAX_DELAY);
+    for (int i = 0; i < PLUGIN_EVENT_MAX_HANDLERS; i++) {
+        event_handler_entry_t* entry = &handlers[i];
+        if (!entry->active || (entry->event_mask & bit) == 0) {
+            continue;
+        }
+        int64_t start = plugin_profile_begin();
+        entry->handler(data->event, data, entry->arg);
+        uint32_t duration = plugin_profile_record(entry->owner, PLUGIN_CALLBACK_EVENT_HANDLER, start);
+        if (duration > PLUGIN_EVENT_SLOW_US) {
+            ESP_LOGW(TAG, "Event handler %d of plugin %s took %lu us for event %d", i,
+                     entry->owner && entry->owner->plugin_slug ? entry->owner->plugin_slug : "unknown",
+                     (unsigned long)duration, (int)data->event);
+        }
+    }
+    xSemaphoreGiveRecursive(handlers_mutex);
+}
+
+static void dispatcher(void* pvParameters) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        plugin_event_data_t data;
+        while (dequeue(&data)) {
+            deliver(&data);
+            atomic_store_explicit(&delivered_position, dequeue_position, memory_order_release);
+        }
+
+        unsigned int dropped = atomic_exchange_explicit(&dropped_events, 0, memory_order_relaxed);
+        if (dropped > 0) {
+            ESP_LOGW(TAG, "Dropped %u events, the queue was full", dropped);
+        }
+    }
+}
+
+esp_err_t plugin_events_start(void) {
+    if (dispatcher_task != NULL) {
+        return ESP_OK;
+    }
+
+    for (unsigned int i = 0; i < PLUGIN_EVENT_QUEUE_LENGTH; i++) {
+        atomic_init(&slots[i].sequence, i);
+    }
+
+    handlers_mutex = xSemaphoreCreateRecursiveMutex();
+    if (handlers_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    TaskHandle_t task = NULL;
+    if (xTaskCreatePinnedToCore(dispatcher, TAG, PLUGIN_EVENT_TASK_STACK, NULL, PLUGIN_EVENT_TASK_PRIORITY, &task,
+                                CONFIG_SOC_CPU_CORES_NUM - 1) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start dispatcher task");
+        vSemaphoreDelete(handlers_mutex);
+        handlers_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    // Publishers check the task handle, everything it guards must be set up before
+    atomic_thread_fence(memory_order_release);
+    dispatcher_task = task;
+    return ESP_OK;
+}
+
+bool plugin_events_publish(plugin_event_t event, int32_t value, const char* text) {
+    if (dispatcher_task == NULL || event <= 0 || event >= PLUGIN_EVENT_COUNT) {
+        return false;
+    }
+
+    unsigned int  position = atomic_load_explicit(&enqueue_position, memory_order_relaxed);
+    event_slot_t* slot;
+    while (1) {
+        slot                  = &slots[position & (PLUGIN_EVENT_QUEUE_LENGTH - 1)];
+        unsigned int sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int          distance = (int)(sequence - position);
+        if (distance == 0) {
+            if (atomic_compare_exchange_weak_explicit(&enqueue_position, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (distance < 0) {
+            atomic_fetch_add_explicit(&dropped_events, 1, memory_order_relaxed);
+            return false;
+        } else {
+            position = atomic_load_explicit(&enqueue_position, memory_order_relaxed);
+        }
+    }
+
+    slot->data.event        = event;
+    slot->data.timestamp_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    slot->data.value        = value;
+    memset(slot->data.text, 0, sizeof(slot->data.text));
+    if (text != NULL) {
+        strncpy(slot->data.text, text, sizeof(slot->data.text) - 1);
+    }
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+
+    xTaskNotifyGive(dispatcher_task);
+    return true;
+}
+
+bool plugin_events_flush(uint32_t timeout_ms) {
+    if (dispatcher_task == NULL) {
+        return true;
+    }
+    unsigned int target = atomic_load_explicit(&enqueue_position, memory_order_relaxed);
+    TickType_t   start  = xTaskGetTickCount();
+    while ((int)(atomic_load_explicit(&delivered_position, memory_order_acquire) - target) < 0) {
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeout_ms)) {
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return true;
+}
+
+void plugin_events_cleanup_for_plugin(plugin_context_t* ctx) {
+    if (ctx == NULL || handlers_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTakeRecursive(handlers_mutex, portMAX_DELAY);
+    for (int i = 0; i < PLUGIN_EVENT_MAX_HANDLERS; i++) {
+        if (handlers[i].active && handlers[i].owner == ctx) {
+            ESP_LOGI(TAG, "Auto-unregistering event handler %d", i);
+            memset(&handlers[i], 0, sizeof(event_handler_entry_t));
+        }
+    }
+    xSemaphoreGiveRecursive(handlers_mutex);
+}
+
+// ============================================
+// Event API Implementation
+// ============================================
+
+int asp_plugin_event_register(plugin_context_t* ctx, uint32_t event_mask, plugin_event_handler_t handler, void* arg) {
+    if (ctx == NULL || handler == NULL || (event_mask & PLUGIN_EVENT_MASK_ALL) == 0 || handlers_mutex == NULL) {
+        return -1;
+    }
+
+    xSemaphoreTakeRecursive(handlers_mutex, portMAX_DELAY);
+    int handler_id = -1;
+    for (int i = 0; i < PLUGIN_EVENT_MAX_HANDLERS; i++) {
+        if (!handlers[i].active) {
+            handlers[i].active     = true;
+            handlers[i].event_mask = event_mask & PLUGIN_EVENT_MASK_ALL;
+            handlers[i].handler    = handler;
+            handlers[i].arg        = arg;
+            handlers[i].owner      = ctx;
+            handler_id             = i;
+            break;
+        }
+    }
+    xSemaphoreGiveRecursive(handlers_mutex);
+
+    if (handler_id < 0) {
+        ESP_LOGW(TAG, "No free event handler slots");
+    } else {
+        ESP_LOGI(TAG, "Registered event handler %d (mask 0x%08lx)", handler_id, (unsigned long)event_mask);
+    }
+    return handler_id;
+}
+
+void asp_plugin_event_unregister(int handler_id) {
+    if (handler_id < 0 || handler_id >= PLUGIN_EVENT_MAX_HANDLERS || handlers_mutex == NULL) {
+        return;
+    }
+    // Waits for a running delivery, the handler is not called after this returns
+    xSemaphoreTakeRecursive(handlers_mutex, portMAX_DELAY);
+    if (handlers[handler_id].active) {
+        memset(&handlers[handler_id], 0, sizeof(event_handler_entry_t));
+        ESP_LOGI(TAG, "Unregistered event handler %d", handler_id);
+    }
+    xSemaphoreGiveRecursive(handlers_mutex);
+}
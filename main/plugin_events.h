@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: MIT
+// Tanmatsu Plugin Event Bus
+// Delivers system state changes to the handlers plugins registered with
+// asp_plugin_event_register().
+//
+// Launcher code that notices a change (SD card, audio jack, WiFi, battery,
+// app launch) publishes it into a fixed-size lock-free queue; publishing
+// never blocks and can be done from any task. A dispatcher task drains the
+// queue and calls every handler whose filter mask contains the event, so
+// plugins no longer have to poll from their own tasks.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "tanmatsu_plugin.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Start the dispatcher task, events published before are dropped
+esp_err_t plugin_events_start(void);
+
+// Queue an event, `text` may be NULL and is truncated to fit the event.
+// Returns false when the queue is full and the event was dropped.
+bool plugin_events_publish(plugin_event_t event, int32_t value, const char* text);
+
+// Wait until the events published so far have been delivered, for at most
+// timeout_ms. Returns false on timeout.
+bool plugin_events_flush(uint32_t timeout_ms);
+
+// Remove the handlers of a plugin, waits for a running delivery to finish
+void plugin_events_cleanup_for_plugin(plugin_context_t* ctx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,628 @@
+// SPDX-License-Identifier: MIT
+// Tanmatsu Plugin Loader Implementation
+// Links plugins with kbelf and keeps relocated snapshots in the load cache.
+
+#include "plugin_loader.h"
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_app_desc.h"
+#include "esp_cache.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "fastopen.h"
+#include "filesystem_utils.h"
+#include "mbedtls/sha256.h"
+#include "sdkconfig.h"
+#define KBELF_REVEAL_PRIVATE
+#include "kbelf.h"
+
+static const char* TAG = "plugin_loader";
+
+#ifndef PLUGIN_CACHE_PATH  // The host benchmark keeps its cache in a temporary directory
+#define PLUGIN_CACHE_PATH "/int/cache/plugins"
+#endif
+#define PLUGIN_CACHE_MAGIC     0x43494C50  // "PLIC"
+#define PLUGIN_CACHE_VERSION   1
+#define PLUGIN_IMAGE_ALIGN     128  // Cache line size, so the image can be synchronized with the instruction cache
+#define PLUGIN_IMAGE_MAX_ALIGN 4096
+
+// The parts of the ELF32 format the loader reads itself
+#define ELF_PT_LOAD           1
+#define ELF_PT_DYNAMIC        2
+#define ELF_DT_NULL           0
+#define ELF_DT_PLTRELSZ       2
+#define ELF_DT_SYMTAB         6
+#define ELF_DT_RELA           7
+#define ELF_DT_RELASZ         8
+#define ELF_DT_JMPREL         23
+#define ELF_R_RISCV_NONE      0
+#define ELF_R_RISCV_32        1
+#define ELF_R_RISCV_RELATIVE  3
+#define ELF_R_RISCV_JUMP_SLOT 5
+
+typedef struct {
+    uint8_t  ident[16];
+    uint16_t type;
+    uint16_t machine;
+    uint32_t version;
+    uint32_t entry;
+    uint32_t phoff;
+    uint32_t shoff;
+    uint32_t flags;
+    uint16_t ehsize;
+    uint16_t phentsize;
+    uint16_t phnum;
+    uint16_t shentsize;
+    uint16_t shnum;
+    uint16_t shstrndx;
+} elf_header_t;
+
+typedef struct {
+    uint32_t type;
+    uint32_t offset;
+    uint32_t vaddr;
+    uint32_t paddr;
+    uint32_t filesz;
+    uint32_t memsz;
+    uint32_t flags;
+    uint32_t align;
+} elf_program_header_t;
+
+typedef struct {
+    int32_t  tag;
+    uint32_t value;
+} elf_dynamic_t;
+
+typedef struct {
+    uint32_t offset;
+    uint32_t info;
+    int32_t  addend;
+} elf_rela_t;
+
+typedef struct {
+    uint32_t name;
+    uint32_t value;
+    uint32_t size;
+    uint8_t  info;
+    uint8_t  other;
+    uint16_t shndx;
+} elf_symbol_t;
+
+// Cache file: the header, the image and then a table of virtual addresses:
+// site_count pairs of a word in the image and the address it points to,
+// followed by the preinit, init and fini functions.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint8_t  plugin_sha256[32];
+    uint8_t  launcher_sha256[32];  // Launcher firmware the symbols were resolved against
+    uint32_t vaddr;                // Virtual address of the first byte of the image
+    uint32_t size;                 // A multiple of PLUGIN_IMAGE_ALIGN
+    uint32_t align;
+    uint32_t site_count;
+    uint32_t preinit_count;
+    uint32_t init_count;
+    uint32_t fini_count;
+} plugin_cache_header_t;
+
+struct plugin_image {
+    kbelf_dyn dyn;        // Set when linked by kbelf
+    uint8_t*  memory;     // Set when mapped from the load cache
+    uint32_t  vaddr;      // Virtual address of memory[0]
+    uint32_t  size;
+    uint32_t* functions;  // Preinit, init and fini functions of a mapped image, as virtual addresses
+    size_t    preinit_count;
+    size_t    init_count;
+    size_t    fini_count;
+};
+
+uintptr_t plugin_loader_get_address(plugin_image_t image, uint32_t vaddr) {
+    if (image->dyn != NULL) {
+        return kbelf_inst_getvaddr(image->dyn->exec_inst, vaddr);
+    }
+    if (vaddr - image->vaddr >= image->size) {
+        return 0;
+    }
+    return (uintptr_t)image->memory + (vaddr - image->vaddr);
+}
+
+static void run_function(plugin_image_t image, uint32_t vaddr) {
+    void (*func)(void) = (void*)plugin_loader_get_address(image, vaddr);
+    func();
+}
+
+void plugin_loader_run_init(plugin_image_t image) {
+    if (image->dyn != NULL) {
+        size_t preinit_count = kbelf_dyn_preinit_len(image->dyn);
+        ESP_LOGI(TAG, "Running %zu preinit functions", preinit_count);
+        for (size_t i = 0; i < preinit_count; i++) {
+            void (*func)(void) = (void*)kbelf_dyn_preinit_get(image->dyn, i);
+            func();
+        }
+
+        size_t init_count = kbelf_dyn_init_len(image->dyn);
+        ESP_LOGI(TAG, "Running %zu init functions", init_count);
+        for (size_t i = 0; i < init_count; i++) {
+            void (*func)(void) = (void*)kbelf_dyn_init_get(image->dyn, i);
+            func();
+        }
+        return;
+    }
+
+    ESP_LOGI(TAG, "Running %zu preinit and %zu init functions", image->preinit_count, image->init_count);
+    for (size_t i = 0; i < image->preinit_count + image->init_count; i++) {
+        run_function(image, image->functions[i]);
+    }
+}
+
+void plugin_loader_run_fini(plugin_image_t image) {
+    if (image->dyn != NULL) {
+        size_t fini_count = kbelf_dyn_fini_len(image->dyn);
+        ESP_LOGI(TAG, "Running %zu fini functions", fini_count);
+        for (size_t i = 0; i < fini_count; i++) {
+            void (*func)(void) = (void*)kbelf_dyn_fini_get(image->dyn, i);
+            func();
+        }
+        return;
+    }
+
+    ESP_LOGI(TAG, "Running %zu fini functions", image->fini_count);
+    const uint32_t* fini = &image->functions[image->preinit_count + image->init_count];
+    for (size_t i = 0; i < image->fini_count; i++) {
+        run_function(image, fini[i]);
+    }
+}
+
+void plugin_loader_unload(plugin_image_t image) {
+    if (image == NULL) return;
+    if (image->dyn != NULL) {
+        kbelf_dyn_unload(image->dyn);
+        kbelf_dyn_destroy(image->dyn);
+    }
+    heap_caps_free(image->memory);
+    free(image->functions);
+    free(image);
+}
+
+static bool link_image(plugin_image_t image, const char* elf_path) {
+    kbelf_dyn dyn = kbelf_dyn_create(0);
+    if (!dyn) {
+        ESP_LOGE(TAG, "Failed to create kbelf context");
+        return false;
+    }
+
+    if (!kbelf_dyn_set_exec(dyn, elf_path, NULL)) {
+        ESP_LOGE(TAG, "Failed to set executable: %s", elf_path);
+        kbelf_dyn_destroy(dyn);
+        return false;
+    }
+
+    if (!kbelf_dyn_load(dyn)) {
+        ESP_LOGE(TAG, "Failed to load plugin ELF");
+        kbelf_dyn_destroy(dyn);
+        return false;
+    }
+
+    image->dyn = dyn;
+    return true;
+}
+
+#ifdef CONFIG_PLUGIN_LOAD_CACHE
+
+static uint8_t* read_file(const char* path, size_t* out_size) {
+    FILE* fd = fastopen(path, "rb");
+    if (fd == NULL) return NULL;
+
+    fseek(fd, 0, SEEK_END);
+    long size = ftell(fd);
+    fseek(fd, 0, SEEK_SET);
+
+    uint8_t* data = size > 0 ? heap_caps_malloc(size, MALLOC_CAP_SPIRAM) : NULL;
+    if (data == NULL || fread(data, 1, size, fd) != (size_t)size) {
+        free(data);
+        fastclose(fd);
+        return NULL;
+    }
+    fastclose(fd);
+    *out_size = size;
+    return data;
+}
+
+static void cache_file_path(const char* slug, char* out_path, size_t out_len) {
+    snprintf(out_path, out_len, PLUGIN_CACHE_PATH "/%s.bin", slug);
+}
+
+static bool map_cached_image(plugin_image_t image, const char* cache_path, const uint8_t* plugin_sha256) {
+    FILE* fd = fastopen(cache_path, "rb");
+    if (fd == NULL) {
+        return false;
+    }
+
+    plugin_cache_header_t header = {0};
+    if (fread(&header, sizeof(header), 1, fd) != 1 || header.magic != PLUGIN_CACHE_MAGIC ||
+        header.version != PLUGIN_CACHE_VERSION || memcmp(header.plugin_sha256, plugin_sha256, 32) != 0 ||
+        memcmp(header.launcher_sha256, esp_app_get_description()->app_elf_sha256, 32) != 0 || header.size == 0 ||
+        header.size % PLUGIN_IMAGE_ALIGN != 0 || header.align > PLUGIN_IMAGE_MAX_ALIGN ||
+        (header.align & (header.align - 1)) != 0) {
+        ESP_LOGI(TAG, "Load cache %s is outdated", cache_path);
+        fastclose(fd);
+        return false;
+    }
+
+    size_t    function_count = header.preinit_count + header.init_count + header.fini_count;
+    size_t    table_count    = header.site_count * 2 + function_count;
+    uint8_t*  memory         = heap_caps_aligned_alloc(header.align, header.size, MALLOC_CAP_SPIRAM);
+    uint32_t* table          = malloc((table_count + 1) * sizeof(uint32_t));
+    if (memory == NULL || table == NULL || fread(memory, 1, header.size, fd) != header.size ||
+        fread(table, sizeof(uint32_t), table_count, fd) != table_count) {
+        ESP_LOGE(TAG, "Failed to read load cache %s", cache_path);
+        heap_caps_free(memory);
+        free(table);
+        fastclose(fd);
+        return false;
+    }
+    fastclose(fd);
+
+    // Everything outside the image was resolved when the snapshot was taken,
+    // only the words pointing into the image depend on where it is loaded
+    uintptr_t base = (uintptr_t)memory - header.vaddr;
+    for (size_t i = 0; i < header.site_count; i++) {
+        uint32_t site  = table[i * 2];
+        uint32_t value = base + table[i * 2 + 1];
+        if (site - header.vaddr > header.size - sizeof(uint32_t)) {
+            ESP_LOGE(TAG, "Load cache %s is corrupt", cache_path);
+            heap_caps_free(memory);
+            free(table);
+            return false;
+        }
+        memcpy((void*)(base + site), &value, sizeof(uint32_t));
+    }
+
+    // The image holds code, which is fetched through the instruction cache
+    esp_cache_msync(memory, header.size, ESP_CACHE_MSYNC_FLAG_DIR_C2M);
+    esp_cache_msync(memory, header.size, ESP_CACHE_MSYNC_FLAG_DIR_M2C | ESP_CACHE_MSYNC_FLAG_TYPE_INST);
+
+    memmove(table, &table[header.site_count * 2], function_count * sizeof(uint32_t));
+    image->memory        = memory;
+    image->vaddr         = header.vaddr;
+    image->size          = header.size;
+    image->functions     = table;
+    image->preinit_count = header.preinit_count;
+    image->init_count    = header.init_count;
+    image->fini_count    = header.fini_count;
+
+    for (size_t i = 0; i < function_count; i++) {
+        if (plugin_loader_get_address(image, table[i]) == 0) {
+            ESP_LOGE(TAG, "Load cache %s is corrupt", cache_path);
+            heap_caps_free(memory);
+            free(table);
+            memset(image, 0, sizeof(struct plugin_image));
+            return false;
+        }
+    }
+    return true;
+}
+
+// Copy `length` bytes at `offset` of the ELF file, false when out of bounds
+static bool elf_read(const uint8_t* elf, size_t elf_size, uint32_t offset, void* out, size_t length) {
+    if (offset > elf_size || length > elf_size - offset) return false;
+    memcpy(out, &elf[offset], length);
+    return true;
+}
+
+// Copy `length` bytes at virtual address `vaddr` from the file contents of a segment
+static bool elf_read_vaddr(const uint8_t* elf, size_t elf_size, const elf_header_t* header, uint32_t vaddr, void* out,
+                           size_t length) {
+    for (uint16_t i = 0; i < header->phnum; i++) {
+        elf_program_header_t segment;
+        if (!elf_read(elf, elf_size, header->phoff + i * sizeof(segment), &segment, sizeof(segment))) return false;
+        if (segment.type == ELF_PT_LOAD && vaddr - segment.vaddr < segment.filesz &&
+            length <= segment.filesz - (vaddr - segment.vaddr)) {
+            return elf_read(elf, elf_size, segment.offset + (vaddr - segment.vaddr), out, length);
+        }
+    }
+    return false;
+}
+
+// State for building a cache file from an image kbelf has just linked
+typedef struct {
+    const uint8_t* elf;
+    size_t         elf_size;
+    elf_header_t   header;
+    uint32_t       vaddr;  // Image bounds
+    uint32_t       size;
+    uint32_t       align;
+    uintptr_t      delta;  // Load address minus virtual address
+    uint32_t*      sites;
+    size_t         site_count;
+} cache_builder_t;
+
+// kbelf loads all segments into one block, keeping their distances. The
+// snapshot relies on that, images laid out otherwise are not cached.
+static bool find_image_bounds(cache_builder_t* builder, plugin_image_t image) {
+    uint32_t end   = 0;
+    bool     found = false;
+    builder->vaddr = UINT32_MAX;
+    builder->align = PLUGIN_IMAGE_ALIGN;
+    builder->delta = 0;
+    for (uint16_t i = 0; i < builder->header.phnum; i++) {
+        elf_program_header_t segment;
+        if (!elf_read(builder->elf, builder->elf_size, builder->header.phoff + i * sizeof(segment), &segment,
+                      sizeof(segment))) {
+            return false;
+        }
+        if (segment.type != ELF_PT_LOAD || segment.memsz == 0) continue;
+
+        uintptr_t address = plugin_loader_get_address(image, segment.vaddr);
+        if (address == 0 || (found && address - segment.vaddr != builder->delta)) {
+            ESP_LOGW(TAG, "Segments are not loaded contiguously");
+            return false;
+        }
+        found          = true;
+        builder->delta = address - segment.vaddr;
+        if (segment.vaddr < builder->vaddr) builder->vaddr = segment.vaddr;
+        if (segment.vaddr + segment.memsz > end) end = segment.vaddr + segment.memsz;
+        if (segment.align > builder->align) builder->align = segment.align;
+    }
+    if (!found || builder->align > PLUGIN_IMAGE_MAX_ALIGN) {
+        return false;
+    }
+    builder->size = ((end - builder->vaddr) + PLUGIN_IMAGE_ALIGN - 1) & ~(PLUGIN_IMAGE_ALIGN - 1);
+    return true;
+}
+
+// Record the words of one relocation table that kbelf pointed into the image
+static bool collect_sites(cache_builder_t* builder, uint32_t symtab, uint32_t table, uint32_t table_size) {
+    for (uint32_t offset = 0; offset + sizeof(elf_rela_t) <= table_size; offset += sizeof(elf_rela_t)) {
+        elf_rela_t rela;
+        if (!elf_read_vaddr(builder->elf, builder->elf_size, &builder->header, table + offset, &rela, sizeof(rela))) {
+            return false;
+        }
+
+        uint32_t type   = rela.info & 0xFF;
+        uint32_t target = rela.addend;
+        switch (type) {
+            case ELF_R_RISCV_NONE:
+                continue;
+            case ELF_R_RISCV_RELATIVE:
+                break;
+            case ELF_R_RISCV_32:
+            case ELF_R_RISCV_JUMP_SLOT: {
+                elf_symbol_t symbol;
+                if (!elf_read_vaddr(builder->elf, builder->elf_size, &builder->header,
+                                    symtab + (rela.info >> 8) * sizeof(symbol), &symbol, sizeof(symbol))) {
+                    return false;
+                }
+                if (symbol.shndx == 0) continue;  // Resolved to the launcher, constant
+                target += symbol.value;
+                break;
+            }
+            default:
+                ESP_LOGW(TAG, "Unsupported relocation type %" PRIu32, type);
+                return false;
+        }
+
+        if (rela.offset - builder->vaddr > builder->size - sizeof(uint32_t)) {
+            return false;
+        }
+        // A symbol the plugin defines can still have been bound to a launcher export, what kbelf wrote decides
+        uint32_t value;
+        memcpy(&value, (void*)(builder->delta + rela.offset), sizeof(uint32_t));
+        if (value != builder->delta + target) continue;
+
+        builder->sites[builder->site_count * 2]     = rela.offset;
+        builder->sites[builder->site_count * 2 + 1] = target;
+        builder->site_count++;
+    }
+    return true;
+}
+
+static bool find_sites(cache_builder_t* builder) {
+    uint32_t symtab      = 0;
+    uint32_t rela        = 0;
+    uint32_t rela_size   = 0;
+    uint32_t jmprel      = 0;
+    uint32_t jmprel_size = 0;
+    for (uint16_t i = 0; i < builder->header.phnum; i++) {
+        elf_program_header_t segment;
+        if (!elf_read(builder->elf, builder->elf_size, builder->header.phoff + i * sizeof(segment), &segment,
+                      sizeof(segment))) {
+            return false;
+        }
+        if (segment.type != ELF_PT_DYNAMIC) continue;
+
+        for (uint32_t offset = 0; offset + sizeof(elf_dynamic_t) <= segment.filesz; offset += sizeof(elf_dynamic_t)) {
+            elf_dynamic_t entry;
+            if (!elf_read(builder->elf, builder->elf_size, segment.offset + offset, &entry, sizeof(entry))) {
+                return false;
+            }
+            if (entry.tag == ELF_DT_NULL) break;
+            switch (entry.tag) {
+                case ELF_DT_SYMTAB:
+                    symtab = entry.value;
+                    break;
+                case ELF_DT_RELA:
+                    rela = entry.value;
+                    break;
+                case ELF_DT_RELASZ:
+                    rela_size = entry.value;
+                    break;
+                case ELF_DT_JMPREL:
+                    jmprel = entry.value;
+                    break;
+                case ELF_DT_PLTRELSZ:
+                    jmprel_size = entry.value;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    // Every relocation patches at most one site, the tables may overlap
+    size_t capacity = (rela_size + jmprel_size) / sizeof(elf_rela_t);
+    builder->sites  = malloc((capacity + 1) * 2 * sizeof(uint32_t));
+    if (builder->sites == NULL) {
+        return false;
+    }
+    return (rela_size == 0 || collect_sites(builder, symtab, rela, rela_size)) &&
+           (jmprel_size == 0 || collect_sites(builder, symtab, jmprel, jmprel_size));
+}
+
+// Convert the load addresses kbelf reports for the preinit, init and fini
+// functions to virtual addresses. Returns NULL when out of memory.
+static uint32_t* collect_functions(cache_builder_t* builder, plugin_image_t image, plugin_cache_header_t* header) {
+    kbelf_dyn dyn         = image->dyn;
+    header->preinit_count = kbelf_dyn_preinit_len(dyn);
+    header->init_count    = kbelf_dyn_init_len(dyn);
+    header->fini_count    = kbelf_dyn_fini_len(dyn);
+
+    uint32_t* functions = malloc((header->preinit_count + header->init_count + header->fini_count + 1) *
+                                 sizeof(uint32_t));
+    if (functions == NULL) {
+        return NULL;
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < header->preinit_count; i++) {
+        functions[count++] = kbelf_dyn_preinit_get(dyn, i) - builder->delta;
+    }
+    for (size_t i = 0; i < header->init_count; i++) {
+        functions[count++] = kbelf_dyn_init_get(dyn, i) - builder->delta;
+    }
+    for (size_t i = 0; i < header->fini_count; i++) {
+        functions[count++] = kbelf_dyn_fini_get(dyn, i) - builder->delta;
+    }
+    return functions;
+}
+
+static bool write_cache_file(const char* cache_path, const plugin_cache_header_t* header, const uint8_t* snapshot,
+                             const uint32_t* sites, const uint32_t* functions) {
+    if (fs_utils_mkdir_recursive(PLUGIN_CACHE_PATH, false) != ESP_OK) {
+        return false;
+    }
+
+    char temp_path[128];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", cache_path);
+    FILE* fd = fastopen(temp_path, "wb");
+    if (fd == NULL) {
+        return false;
+    }
+    size_t function_count = header->preinit_count + header->init_count + header->fini_count;
+
+    bool ok = fwrite(header, sizeof(*header), 1, fd) == 1;
+    ok      = ok && fwrite(snapshot, 1, header->size, fd) == header->size;
+    ok      = ok && fwrite(sites, sizeof(uint32_t), header->site_count * 2, fd) == header->site_count * 2;
+    ok      = ok && fwrite(functions, sizeof(uint32_t), function_count, fd) == function_count;
+    fastclose(fd);
+
+    // FAT can not rename over an existing file
+    remove(cache_path);
+    if (!ok || rename(temp_path, cache_path) != 0) {
+        remove(temp_path);
+        return false;
+    }
+    return true;
+}
+
+// Store a snapshot of an image kbelf has just linked. Must be called before
+// the init functions run, the snapshot has to be the state right after
+// relocation.
+static void store_cached_image(plugin_image_t image, const char* cache_path, const uint8_t* elf, size_t elf_size,
+                               const uint8_t* plugin_sha256) {
+    cache_builder_t builder = {
+        .elf      = elf,
+        .elf_size = elf_size,
+    };
+    uint8_t*  snapshot  = NULL;
+    uint32_t* functions = NULL;
+
+    bool ok = elf_read(elf, elf_size, 0, &builder.header, sizeof(builder.header)) &&
+              builder.header.phentsize == sizeof(elf_program_header_t);
+    ok      = ok && find_image_bounds(&builder, image) && find_sites(&builder);
+
+    plugin_cache_header_t header = {
+        .magic   = PLUGIN_CACHE_MAGIC,
+        .version = PLUGIN_CACHE_VERSION,
+    };
+    if (ok) {
+        memcpy(header.plugin_sha256, plugin_sha256, 32);
+        memcpy(header.launcher_sha256, esp_app_get_description()->app_elf_sha256, 32);
+        header.vaddr      = builder.vaddr;
+        header.size       = builder.size;
+        header.align      = builder.align;
+        header.site_count = builder.site_count;
+        functions         = collect_functions(&builder, image, &header);
+        snapshot          = heap_caps_calloc(1, builder.size, MALLOC_CAP_SPIRAM);
+        ok                = functions != NULL && snapshot != NULL;
+    }
+
+    // Only the segments are copied, kbelf owns whatever lies between them
+    for (uint16_t i = 0; ok && i < builder.header.phnum; i++) {
+        elf_program_header_t segment;
+        elf_read(elf, elf_size, builder.header.phoff + i * sizeof(segment), &segment, sizeof(segment));
+        if (segment.type == ELF_PT_LOAD && segment.memsz > 0) {
+            memcpy(&snapshot[segment.vaddr - builder.vaddr], (void*)(builder.delta + segment.vaddr), segment.memsz);
+        }
+    }
+
+    if (ok && write_cache_file(cache_path, &header, snapshot, builder.sites, functions)) {
+        ESP_LOGI(TAG, "Stored load cache %s (%" PRIu32 " bytes, %" PRIu32 " rebased words)", cache_path,
+                 header.size, header.site_count);
+    } else {
+        ESP_LOGW(TAG, "Plugin image can not be cached");
+    }
+    heap_caps_free(snapshot);
+    free(functions);
+    free(builder.sites);
+}
+
+#endif  // CONFIG_PLUGIN_LOAD_CACHE
+
+plugin_image_t plugin_loader_load(const char* elf_path, const char* slug) {
+    int64_t        start_time = esp_timer_get_time();
+    plugin_image_t image      = calloc(1, sizeof(struct plugin_image));
+    if (image == NULL) {
+        return NULL;
+    }
+
+#ifdef CONFIG_PLUGIN_LOAD_CACHE
+    // The file is hashed to validate the cache, on a miss the same copy is
+    // parsed to build the new cache file
+    char     cache_path[96];
+    uint8_t  plugin_sha256[32];
+    size_t   elf_size = 0;
+    uint8_t* elf      = read_file(elf_path, &elf_size);
+    cache_file_path(slug, cache_path, sizeof(cache_path));
+    if (elf != NULL && mbedtls_sha256(elf, elf_size, plugin_sha256, 0) != 0) {
+        heap_caps_free(elf);
+        elf = NULL;
+    }
+
+    if (elf != NULL && map_cached_image(image, cache_path, plugin_sha256)) {
+        ESP_LOGI(TAG, "Mapped %s from the load cache in %lld us", slug, esp_timer_get_time() - start_time);
+        heap_caps_free(elf);
+        return image;
+    }
+#endif
+
+    if (!link_image(image, elf_path)) {
+#ifdef CONFIG_PLUGIN_LOAD_CACHE
+        heap_caps_free(elf);
+#endif
+        free(image);
+        return NULL;
+    }
+    ESP_LOGI(TAG, "Linked %s in %lld us", slug, esp_timer_get_time() - start_time);
+
+#ifdef CONFIG_PLUGIN_LOAD_CACHE
+    if (elf != NULL) {
+        store_cached_image(image, cache_path, elf, elf_size, plugin_sha256);
+        heap_caps_free(elf);
+    }
+#endif
+    return image;
+}
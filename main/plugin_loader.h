@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: MIT
+// Tanmatsu Plugin Loader
+// Maps plugin ELF images into memory, through kbelf or the load cache.
+//
+// Linking a plugin with kbelf reads the whole ELF, resolves every symbol
+// against the launcher's exports and processes all relocations. After a
+// successful link the loader snapshots the relocated image, before any init
+// function has run, into a cache file keyed by the SHA-256 of the plugin
+// file and of the launcher firmware. The next load of the same plugin on the
+// same firmware reads the snapshot in one go and only rebases the words that
+// point into the image itself; words holding launcher addresses are already
+// resolved in the snapshot.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct plugin_image* plugin_image_t;
+
+// Load the plugin ELF at elf_path, `slug` names its cache file.
+// Returns NULL on failure.
+plugin_image_t plugin_loader_load(const char* elf_path, const char* slug);
+
+// Unmap the image. The fini functions must have been run.
+void plugin_loader_unload(plugin_image_t image);
+
+// Address the virtual address `vaddr` of the ELF is loaded at, 0 when it is
+// not part of the image
+uintptr_t plugin_loader_get_address(plugin_image_t image, uint32_t vaddr);
+
+// Run the preinit and init functions, once after loading
+void plugin_loader_run_init(plugin_image_t image);
+
+// Run the fini functions, once before unloading
+void plugin_loader_run_fini(plugin_image_t image);
+
+#ifdef __cplusplus
+}
+#endif
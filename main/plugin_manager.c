@@ -13,13 +13,14 @@
 #include "esp_log.h"
 #include "nvs.h"
 #include "nvs_flash.h"
-#define KBELF_REVEAL_PRIVATE
 #include "fastopen.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "freertos/timers.h"
-#include "kbelf.h"
+#include "plugin_loader.h"
+#include "plugin_profile.h"
+#include "plugin_settings.h"
 #include "sdkconfig.h"
 #ifdef CONFIG_ENABLE_AUDIOMIXER
 #include "audio_mixer.h"
@@ -33,6 +34,12 @@ static const char* PLUGIN_PATHS[] = {"/int/plugins", "/sd/plugins", NULL};
 // NVS namespace for plugin settings
 #define PLUGIN_NVS_NAMESPACE "plugins"
 
+// Service task defaults, plugin.json may lower the priority and resize the stack within the limits
+#define SERVICE_TASK_STACK_SIZE 8192   // In StackType_t units, typically 4 bytes each
+#define SERVICE_TASK_STACK_MIN  4096   // Bytes
+#define SERVICE_TASK_STACK_MAX  65536  // Bytes
+#define SERVICE_TASK_PRIORITY   5
+
 // Loaded plugins registry
 static plugin_context_t* loaded_plugins[PLUGIN_MAX_LOADED] = {0};
 static size_t            loaded_plugin_count               = 0;
@@ -43,8 +50,9 @@ extern size_t plugin_api_get_status_widgets(plugin_icontext_t* out, size_t max,
 extern void   plugin_api_init(void);
 extern void   plugin_api_cleanup_for_plugin(plugin_context_t* ctx);
 
-// Forward declaration of internal unload function
+// Forward declaration of internal unload and stop functions
 static bool _plugin_manager_unload(plugin_context_t* ctx);
+static bool _plugin_manager_stop_service(plugin_context_t* ctx);
 
 // ============================================
 // Plugin Manager Lifecycle
@@ -143,7 +151,9 @@ static bool parse_plugin_metadata(const char* path, plugin_discovery_info_t* inf
 
     info->path = strdup(path);
     info->slug = strdup(slug);
-    info->type = PLUGIN_TYPE_MENU;  // Default
+    info->type               = PLUGIN_TYPE_MENU;  // Default
+    info->service_stack_size = SERVICE_TASK_STACK_SIZE * sizeof(StackType_t);
+    info->service_priority   = SERVICE_TASK_PRIORITY;
 
     cJSON* type = cJSON_GetObjectItem(plugin_root, "type");
     if (type && cJSON_IsString(type)) {
@@ -156,6 +166,22 @@ static bool parse_plugin_metadata(const char* path, plugin_discovery_info_t* inf
         }
     }
 
+    cJSON* service_stack_size = cJSON_GetObjectItem(plugin_root, "service_stack_size");
+    if (service_stack_size && cJSON_IsNumber(service_stack_size)) {
+        double bytes = service_stack_size->valuedouble;
+        if (bytes < SERVICE_TASK_STACK_MIN) bytes = SERVICE_TASK_STACK_MIN;
+        if (bytes > SERVICE_TASK_STACK_MAX) bytes = SERVICE_TASK_STACK_MAX;
+        info->service_stack_size = (uint32_t)bytes;
+    }
+
+    cJSON* service_priority = cJSON_GetObjectItem(plugin_root, "service_priority");
+    if (service_priority && cJSON_IsNumber(service_priority)) {
+        int priority = service_priority->valueint;
+        if (priority < 1) priority = 1;
+        if (priority > SERVICE_TASK_PRIORITY) priority = SERVICE_TASK_PRIORITY;
+        info->service_priority = (uint8_t)priority;
+    }
+
     cJSON_Delete(plugin_root);
 
     // Read metadata.json for display fields (name, version)
@@ -362,79 +388,32 @@ plugin_context_t* plugin_manager_load(const char* plugin_path) {
     if (ctx->settings_namespace) {
         sprintf(ctx->settings_namespace, "plugin_%s", discovery_info.slug);
     }
-    ctx->state            = PLUGIN_STATE_UNLOADED;
-    ctx->status_widget_id = -1;
+    ctx->state              = PLUGIN_STATE_UNLOADED;
+    ctx->status_widget_id   = -1;
+    ctx->service_stack_size = discovery_info.service_stack_size;
+    ctx->service_priority   = discovery_info.service_priority;
+    ctx->profile            = plugin_profile_create();
 
     // Free unused discovery fields
     free(discovery_info.path);
     free(discovery_info.name);
     free(discovery_info.version);
 
-    // Load ELF using kbelf
-    // Memory debugging (commented out)
-    // size_t internal_before_create = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
-
-    kbelf_dyn dyn = kbelf_dyn_create(0);
-    if (!dyn) {
-        ESP_LOGE(TAG, "Failed to create kbelf context");
+    plugin_image_t image = plugin_loader_load(elf_path, ctx->plugin_slug);
+    if (image == NULL) {
         goto error_cleanup;
     }
 
-    // Memory debugging (commented out)
-    // size_t internal_after_create = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
-    // ESP_LOGI(TAG, "After kbelf_dyn_create: internal used %u",
-    //          (unsigned)(internal_before_create - internal_after_create));
-
-    if (!kbelf_dyn_set_exec(dyn, elf_path, NULL)) {
-        ESP_LOGE(TAG, "Failed to set executable: %s", elf_path);
-        kbelf_dyn_destroy(dyn);
-        goto error_cleanup;
-    }
-
-    // Memory debugging (commented out)
-    // size_t internal_after_setexec = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
-    // ESP_LOGI(TAG, "After kbelf_dyn_set_exec: internal used %u (total so far: %u)",
-    //          (unsigned)(internal_after_create - internal_after_setexec),
-    //          (unsigned)(internal_before_create - internal_after_setexec));
-
-    if (!kbelf_dyn_load(dyn)) {
-        ESP_LOGE(TAG, "Failed to load plugin ELF");
-        kbelf_dyn_destroy(dyn);
-        goto error_cleanup;
-    }
-
-    // Memory debugging (commented out)
-    // size_t internal_after_load = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
-    // ESP_LOGI(TAG, "After kbelf_dyn_load: internal used %u (total so far: %u)",
-    //          (unsigned)(internal_after_setexec - internal_after_load),
-    //          (unsigned)(internal_before_create - internal_after_load));
-    // if (!heap_caps_check_integrity_all(true)) {
-    //     ESP_LOGE(TAG, "HEAP CORRUPTED after kbelf_dyn_load!");
-    // }
-
     free(elf_path);
     elf_path        = NULL;  // Prevent double-free if we goto error_cleanup later
-    ctx->elf_handle = dyn;
+    ctx->elf_handle = image;
     ctx->state      = PLUGIN_STATE_LOADED;
 
-    // Run preinit and init functions
-    size_t preinit_count = kbelf_dyn_preinit_len(dyn);
-    ESP_LOGI(TAG, "Running %zu preinit functions", preinit_count);
-    for (size_t i = 0; i < preinit_count; i++) {
-        void (*func)(void) = (void*)kbelf_dyn_preinit_get(dyn, i);
-        func();
-    }
-
-    size_t init_count = kbelf_dyn_init_len(dyn);
-    ESP_LOGI(TAG, "Running %zu init functions", init_count);
-    for (size_t i = 0; i < init_count; i++) {
-        void (*func)(void) = (void*)kbelf_dyn_init_get(dyn, i);
-        func();
-    }
+    plugin_loader_run_init(image);
 
     // Find plugin registration
     // The _plugin_registration is placed in .plugin_info section at VMA 0
-    kbelf_addr reg_addr = kbelf_inst_getvaddr(dyn->exec_inst, 0);
+    uintptr_t reg_addr = plugin_loader_get_address(image, 0);
     if (reg_addr != 0) {
         plugin_registration_t* reg = (plugin_registration_t*)reg_addr;
 
@@ -517,7 +496,9 @@ plugin_context_t* plugin_manager_load(const char* plugin_path) {
         // Call the plugin's init function if available
         if (reg->entry.init != NULL) {
             ESP_LOGI(TAG, "Calling init at %p with ctx=%p", reg->entry.init, (void*)ctx);
-            int init_result = reg->entry.init(ctx);
+            int64_t start       = plugin_profile_begin();
+            int     init_result = reg->entry.init(ctx);
+            plugin_profile_record(ctx, PLUGIN_CALLBACK_INIT, start);
 
             // Memory debugging (commented out)
             // if (!heap_caps_check_integrity_all(true)) {
@@ -552,12 +533,15 @@ error_cleanup:
 
     // Clean up ELF if it was loaded
     if (ctx && ctx->elf_handle) {
-        kbelf_dyn dyn = (kbelf_dyn)ctx->elf_handle;
-        kbelf_dyn_unload(dyn);
-        kbelf_dyn_destroy(dyn);
+        plugin_loader_unload((plugin_image_t)ctx->elf_handle);
         ctx->elf_handle = NULL;
     }
 
+    // Save the settings the init functions changed
+    if (ctx) {
+        plugin_settings_release(ctx);
+    }
+
     if (elf_path != NULL) {
         free(elf_path);
     }
@@ -567,6 +551,7 @@ error_cleanup:
         free(ctx->plugin_slug);
         free(ctx->storage_base_path);
         free(ctx->settings_namespace);
+        plugin_profile_free(ctx->profile);
         free(ctx);
     }
     xSemaphoreGive(plugin_mutex);
@@ -590,7 +575,7 @@ static bool _plugin_manager_unload(plugin_context_t* ctx) {
 
     // Stop service if running
     if (ctx->state == PLUGIN_STATE_RUNNING) {
-        plugin_manager_stop_service(ctx);
+        _plugin_manager_stop_service(ctx);
     }
 
     // Automatically clean up any API registrations (widgets, hooks, events)
@@ -599,39 +584,21 @@ static bool _plugin_manager_unload(plugin_context_t* ctx) {
 
     // Call cleanup if available (plugin may also try to unregister, which is fine)
     if (ctx->registration && ctx->registration->entry.cleanup) {
+        int64_t start = plugin_profile_begin();
         ctx->registration->entry.cleanup(ctx);
+        plugin_profile_record(ctx, PLUGIN_CALLBACK_CLEANUP, start);
     }
 
     // Run fini functions
-    kbelf_dyn dyn = (kbelf_dyn)ctx->elf_handle;
-    if (dyn) {
-        size_t fini_count = kbelf_dyn_fini_len(dyn);
-        ESP_LOGI(TAG, "Running %zu fini functions", fini_count);
-        for (size_t i = 0; i < fini_count; i++) {
-            void (*func)(void) = (void*)kbelf_dyn_fini_get(dyn, i);
-            func();
-        }
-
-        // Memory debugging (commented out)
-        // size_t internal_before_unload = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
-        // ESP_LOGI(TAG, "Before kbelf_dyn_unload: internal %u", (unsigned)internal_before_unload);
-
-        kbelf_dyn_unload(dyn);
-
-        // Memory debugging (commented out)
-        // size_t internal_after_unload = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
-        // ESP_LOGI(TAG, "After kbelf_dyn_unload: internal freed %u",
-        //          (unsigned)(internal_after_unload - internal_before_unload));
-
-        kbelf_dyn_destroy(dyn);
-
-        // Memory debugging (commented out)
-        // size_t internal_after_destroy = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
-        // ESP_LOGI(TAG, "After kbelf_dyn_destroy: internal freed %u (total kbelf freed: %u)",
-        //          (unsigned)(internal_after_destroy - internal_after_unload),
-        //          (unsigned)(internal_after_destroy - internal_before_unload));
+    plugin_image_t image = (plugin_image_t)ctx->elf_handle;
+    if (image) {
+        plugin_loader_run_fini(image);
+        plugin_loader_unload(image);
     }
 
+    // No plugin code runs anymore, save its settings
+    plugin_settings_release(ctx);
+
     // Remove from loaded plugins
     for (size_t i = 0; i < loaded_plugin_count; i++) {
         if (loaded_plugins[i] == ctx) {
@@ -653,6 +620,7 @@ static bool _plugin_manager_unload(plugin_context_t* ctx) {
     free(ctx->plugin_slug);
     free(ctx->storage_base_path);
     free(ctx->settings_namespace);
+    plugin_profile_free(ctx->profile);
     free(ctx);
 
     // Memory debugging (commented out)
@@ -714,6 +682,17 @@ size_t plugin_manager_get_loaded_count(void) {
     return loaded_plugin_count;
 }
 
+bool plugin_manager_get_profile(const char* slug, plugin_profile_t* out_profile) {
+    if (slug == NULL || out_profile == NULL || plugin_mutex == NULL) return false;
+
+    xSemaphoreTake(plugin_mutex, portMAX_DELAY);
+    plugin_context_t* ctx    = plugin_manager_get_by_slug(slug);
+    bool              result = ctx != NULL && plugin_profile_get(ctx, out_profile);
+    xSemaphoreGive(plugin_mutex);
+
+    return result;
+}
+
 // ============================================
 // Service Plugin Management
 // ============================================
@@ -757,6 +736,9 @@ static void plugin_service_task(void* arg) {
 
     ESP_LOGI(TAG, "Service task ended for plugin: %s", ctx->plugin_slug);
 
+    // Sample CPU time and stack usage while this task still exists
+    plugin_profile_task_ended(ctx, NULL);
+
     // Clear handle BEFORE marking as not running to prevent race with stop_service()
     // This ensures stop_service() won't try to delete an already-deleting task
     ctx->task_handle  = NULL;
@@ -774,9 +756,6 @@ static void plugin_service_task(void* arg) {
     vTaskDelete(NULL);
 }
 
-// Stack size for service tasks (in StackType_t units, typically 4 bytes each)
-#define SERVICE_TASK_STACK_SIZE 8192
-
 bool plugin_manager_start_service(plugin_context_t* ctx) {
     if (ctx == NULL || ctx->state == PLUGIN_STATE_RUNNING) {
         return false;
@@ -792,7 +771,7 @@ bool plugin_manager_start_service(plugin_context_t* ctx) {
     ctx->task_running   = false;
 
     // Allocate task stack and TCB - we own this memory, no cleanup race with FreeRTOS
-    ctx->task_stack = malloc(SERVICE_TASK_STACK_SIZE * sizeof(StackType_t));
+    ctx->task_stack = malloc(ctx->service_stack_size);
     if (ctx->task_stack == NULL) {
         ESP_LOGE(TAG, "Failed to allocate task stack");
         return false;
@@ -801,7 +780,7 @@ bool plugin_manager_start_service(plugin_context_t* ctx) {
     // Memory debugging (commented out)
     // size_t internal_after_stack = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
     // ESP_LOGI(TAG, "Task stack allocated: %u bytes at %p (internal used: %u)",
-    //          (unsigned)(SERVICE_TASK_STACK_SIZE * sizeof(StackType_t)),
+    //          (unsigned)ctx->service_stack_size,
     //          ctx->task_stack,
     //          (unsigned)(internal_before - internal_after_stack));
 
@@ -819,9 +798,12 @@ bool plugin_manager_start_service(plugin_context_t* ctx) {
     //          (unsigned)sizeof(StaticTask_t),
     //          (unsigned)(internal_after_stack - internal_after_tcb));
 
+    // Started before the task so a service that returns immediately is still profiled
+    plugin_profile_task_started(ctx);
+
     // Use static task creation - FreeRTOS won't free our memory
-    TaskHandle_t task = xTaskCreateStatic(plugin_service_task, ctx->plugin_slug, SERVICE_TASK_STACK_SIZE, ctx,
-                                          5,  // Priority
+    TaskHandle_t task = xTaskCreateStatic(plugin_service_task, ctx->plugin_slug,
+                                          ctx->service_stack_size / sizeof(StackType_t), ctx, ctx->service_priority,
                                           (StackType_t*)ctx->task_stack, (StaticTask_t*)ctx->task_tcb);
 
     if (task == NULL) {
@@ -848,7 +830,8 @@ bool plugin_manager_start_service(plugin_context_t* ctx) {
     return true;
 }
 
-bool plugin_manager_stop_service(plugin_context_t* ctx) {
+// Internal stop - caller must hold plugin_mutex, which keeps the task stack and TCB valid for readers holding it
+static bool _plugin_manager_stop_service(plugin_context_t* ctx) {
     if (ctx == NULL) {
         return false;
     }
@@ -887,6 +870,7 @@ bool plugin_manager_stop_service(plugin_context_t* ctx) {
         ctx->task_handle  = NULL;  // Clear immediately to prevent double-delete
 
         if (task != NULL) {
+            plugin_profile_task_ended(ctx, task);
             vTaskDelete(task);
         }
 
@@ -934,6 +918,16 @@ cleanup_task_memory:
     return true;
 }
 
+bool plugin_manager_stop_service(plugin_context_t* ctx) {
+    if (ctx == NULL) return false;
+
+    xSemaphoreTake(plugin_mutex, portMAX_DELAY);
+    bool result = _plugin_manager_stop_service(ctx);
+    xSemaphoreGive(plugin_mutex);
+
+    return result;
+}
+
 // ============================================
 // Autostart Management
 // ============================================
@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "plugin_context.h"
+#include "plugin_profile.h"
 #include "tanmatsu_plugin.h"
 
 #ifdef __cplusplus
@@ -18,12 +19,14 @@ extern "C" {
 
 // Plugin discovery result
 typedef struct {
-    char*         path;       // Full path to plugin directory
-    char*         slug;       // Plugin slug from metadata
-    char*         name;       // Display name
-    char*         version;    // Version string
-    plugin_type_t type;       // Plugin type
-    bool          is_loaded;  // Currently loaded?
+    char*         path;                // Full path to plugin directory
+    char*         slug;                // Plugin slug from metadata
+    char*         name;                // Display name
+    char*         version;             // Version string
+    plugin_type_t type;                // Plugin type
+    uint32_t      service_stack_size;  // Service task stack in bytes
+    uint8_t       service_priority;    // Service task priority
+    bool          is_loaded;           // Currently loaded?
 } plugin_discovery_info_t;
 
 // ============================================
@@ -73,6 +76,12 @@ size_t plugin_manager_get_by_type(plugin_type_t type, plugin_context_t** out_plu
 // Get count of loaded plugins
 size_t plugin_manager_get_loaded_count(void);
 
+// Get the profile of a loaded plugin by slug. Read under the plugin manager
+// lock, so the plugin can not be unloaded and its service task memory can not
+// be freed while it is sampled.
+// Returns false if the plugin is not loaded
+bool plugin_manager_get_profile(const char* slug, plugin_profile_t* out_profile);
+
 // ============================================
 // Service Plugin Management
 // ============================================
@@ -108,6 +117,9 @@ void plugin_manager_load_autostart(void);
 // Returns total width used by all widgets
 int plugin_api_render_status_widgets(pax_buf_t* buffer, int x_right, int y, int height);
 
+// Check if any plugin status widget is registered
+bool plugin_api_has_status_widgets(void);
+
 // ============================================
 // LED Claim Tracking
 // ============================================
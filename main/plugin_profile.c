@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: MIT
+
+#include "plugin_profile.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "plugin_context.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "plugin_profile";
+
+// Bucket 0 holds calls under 1 us, bucket n calls from 2^(n-1) up to 2^n - 1 us, the last one everything longer
+#define PLUGIN_PROFILE_BUCKETS 16
+
+typedef struct {
+    uint32_t calls;
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t histogram[PLUGIN_PROFILE_BUCKETS];
+} callback_profile_t;
+
+struct plugin_profile {
+    callback_profile_t callbacks[PLUGIN_CALLBACK_TYPE_COUNT];
+    int64_t            task_start_us;  // 0 if no service task ran
+    int64_t            task_end_us;    // 0 while the task runs
+    uint64_t           task_runtime_us;
+    uint32_t           task_stack_min_free;
+};
+
+// Protects all profiles, held for a few instructions per record
+static SemaphoreHandle_t profile_mutex = NULL;
+
+void plugin_profile_init(void) {
+    if (profile_mutex == NULL) {
+        profile_mutex = xSemaphoreCreateMutex();
+        if (profile_mutex == NULL) {
+            ESP_LOGE(TAG, "Failed to create mutex");
+        }
+    }
+}
+
+struct plugin_profile* plugin_profile_create(void) {
+    return calloc(1, sizeof(struct plugin_profile));
+}
+
+void plugin_profile_free(struct plugin_profile* profile) {
+    free(profile);
+}
+
+static int bucket_of(uint32_t us) {
+    int bucket = us == 0 ? 0 : 32 - __builtin_clz(us);
+    return bucket < PLUGIN_PROFILE_BUCKETS ? bucket : PLUGIN_PROFILE_BUCKETS - 1;
+}
+
+uint32_t plugin_profile_record(plugin_context_t* ctx, plugin_callback_type_t type, int64_t start) {
+    int64_t  elapsed  = esp_timer_get_time() - start;
+    uint32_t duration = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+    if (ctx == NULL || ctx->profile == NULL || type >= PLUGIN_CALLBACK_TYPE_COUNT || profile_mutex == NULL) {
+        return duration;
+    }
+
+    xSemaphoreTake(profile_mutex, portMAX_DELAY);
+    callback_profile_t* callback = &ctx->profile->callbacks[type];
+    callback->calls++;
+    callback->total_us += duration;
+    if (duration > callback->max_us) {
+        callback->max_us = duration;
+    }
+    callback->histogram[bucket_of(duration)]++;
+    xSemaphoreGive(profile_mutex);
+    return duration;
+}
+
+static uint64_t task_runtime_us(TaskHandle_t task) {
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    // The run time counter is clocked by esp_timer, in microseconds
+    return (uint64_t)ulTaskGetRunTimeCounter(task);
+#else
+    (void)task;
+    return 0;
+#endif
+}
+
+void plugin_profile_task_started(plugin_context_t* ctx) {
+    if (ctx == NULL || ctx->profile == NULL || profile_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(profile_mutex, portMAX_DELAY);
+    ctx->profile->task_start_us       = esp_timer_get_time();
+    ctx->profile->task_end_us         = 0;
+    ctx->profile->task_runtime_us     = 0;
+    ctx->profile->task_stack_min_free = ctx->service_stack_size;
+    xSemaphoreGive(profile_mutex);
+}
+
+void plugin_profile_task_ended(plugin_context_t* ctx, TaskHandle_t task) {
+    if (ctx == NULL || ctx->profile == NULL || profile_mutex == NULL) {
+        return;
+    }
+    // Once the task is deleted its counters are gone
+    uint64_t runtime  = task_runtime_us(task);
+    uint32_t min_free = uxTaskGetStackHighWaterMark(task) * sizeof(StackType_t);
+
+    xSemaphoreTake(profile_mutex, portMAX_DELAY);
+    ctx->profile->task_end_us         = esp_timer_get_time();
+    ctx->profile->task_runtime_us     = runtime;
+    ctx->profile->task_stack_min_free = min_free;
+    xSemaphoreGive(profile_mutex);
+}
+
+static uint32_t percentile(const callback_profile_t* callback, uint32_t permille) {
+    if (callback->calls == 0) {
+        return 0;
+    }
+    uint64_t rank = ((uint64_t)callback->calls * permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < PLUGIN_PROFILE_BUCKETS - 1; bucket++) {
+        seen += callback->histogram[bucket];
+        if (seen >= rank) {
+            uint32_t bound = (1UL << bucket) - 1;
+            return bound < callback->max_us ? bound : callback->max_us;
+        }
+    }
+    return callback->max_us;
+}
+
+bool plugin_profile_get(plugin_context_t* ctx, plugin_profile_t* out_profile) {
+    if (ctx == NULL || out_profile == NULL || ctx->profile == NULL || profile_mutex == NULL) {
+        return false;
+    }
+    memset(out_profile, 0, sizeof(plugin_profile_t));
+
+    // The TCB and stack of a service task are owned by the context and only freed under the plugin manager lock,
+    // so they stay readable here even if the task ends while it is sampled
+    TaskHandle_t task     = (TaskHandle_t)ctx->task_handle;
+    uint64_t     runtime  = task != NULL ? task_runtime_us(task) : 0;
+    uint32_t     min_free = task != NULL ? uxTaskGetStackHighWaterMark(task) * sizeof(StackType_t) : 0;
+    int64_t      now      = esp_timer_get_time();
+
+    xSemaphoreTake(profile_mutex, portMAX_DELAY);
+    struct plugin_profile* profile = ctx->profile;
+    for (int type = 0; type < PLUGIN_CALLBACK_TYPE_COUNT; type++) {
+        const callback_profile_t* callback = &profile->callbacks[type];
+        plugin_callback_stats_t*  stats    = &out_profile->callbacks[type];
+        stats->calls                       = callback->calls;
+        stats->total_us                    = callback->total_us;
+        stats->max_us                      = callback->max_us;
+        stats->p50_us                      = percentile(callback, 500);
+        stats->p95_us                      = percentile(callback, 950);
+        stats->p99_us                      = percentile(callback, 990);
+    }
+
+    if (profile->task_start_us != 0) {
+        out_profile->task_valid      = true;
+        out_profile->task_running    = profile->task_end_us == 0 && task != NULL;
+        out_profile->task_priority   = ctx->service_priority;
+        out_profile->task_stack_size = ctx->service_stack_size;
+        int64_t end                  = now;
+        if (out_profile->task_running) {
+            out_profile->task_runtime_us     = runtime;
+            out_profile->task_stack_min_free = min_free;
+        } else {
+            out_profile->task_runtime_us     = profile->task_runtime_us;
+            out_profile->task_stack_min_free = profile->task_stack_min_free;
+            end                              = profile->task_end_us != 0 ? profile->task_end_us : now;
+        }
+        int64_t elapsed = end - profile->task_start_us;
+        if (elapsed > 0) {
+            uint64_t percent              = out_profile->task_runtime_us * 100 / (uint64_t)elapsed;
+            out_profile->task_cpu_percent = percent > 100 ? 100 : (uint8_t)percent;
+        }
+    }
+    xSemaphoreGive(profile_mutex);
+    return true;
+}
+
+const char* plugin_profile_callback_name(plugin_callback_type_t type) {
+    switch (type) {
+        case PLUGIN_CALLBACK_INIT:
+            return "Init";
+        case PLUGIN_CALLBACK_CLEANUP:
+            return "Cleanup";
+        case PLUGIN_CALLBACK_STATUS_WIDGET:
+            return "Widget";
+        case PLUGIN_CALLBACK_INPUT_HOOK:
+            return "Input hook";
+        case PLUGIN_CALLBACK_EVENT_HANDLER:
+            return "Event";
+        default:
+            return "Unknown";
+    }
+}
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: MIT
+// Tanmatsu Plugin Profiling
+// Times the calls the launcher makes into plugin code and samples service
+// tasks, so slow plugins can be found on the plugin manager's info screen.
+//
+// Every call is counted per plugin and per callback type, with its total and
+// worst-case duration and a histogram of power of two buckets from which
+// percentiles are derived. Service tasks are sampled for their CPU time and
+// stack high-water mark when the profile is read and when the task ends.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "tanmatsu_plugin.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Plugin code called from launcher tasks
+typedef enum {
+    PLUGIN_CALLBACK_INIT = 0,       // entry.init
+    PLUGIN_CALLBACK_CLEANUP,        // entry.cleanup
+    PLUGIN_CALLBACK_STATUS_WIDGET,  // Status widget render, from the display path
+    PLUGIN_CALLBACK_INPUT_HOOK,     // Input hook, from the input path
+    PLUGIN_CALLBACK_EVENT_HANDLER,  // Event handler, from the event dispatcher
+    PLUGIN_CALLBACK_TYPE_COUNT,
+} plugin_callback_type_t;
+
+// Percentiles are the upper bound of a power of two bucket, capped at max_us
+typedef struct {
+    uint32_t calls;
+    uint64_t total_us;
+    uint32_t max_us;  // Worst case
+    uint32_t p50_us;
+    uint32_t p95_us;
+    uint32_t p99_us;
+} plugin_callback_stats_t;
+
+// Profile of a plugin since it was loaded, shown on its info screen
+typedef struct {
+    plugin_callback_stats_t callbacks[PLUGIN_CALLBACK_TYPE_COUNT];
+    bool                    task_valid;  // A service task ran, the task_* fields are valid
+    bool                    task_running;
+    uint8_t                 task_priority;
+    uint8_t                 task_cpu_percent;     // Share of one core since the task started, 0 without run time stats
+    uint64_t                task_runtime_us;      // CPU time used by the task, 0 without run time stats
+    uint32_t                task_stack_size;      // Bytes
+    uint32_t                task_stack_min_free;  // Stack high-water mark: least free bytes seen
+} plugin_profile_t;
+
+// Create the mutex, called from plugin_api_init
+void plugin_profile_init(void);
+
+// Allocate and free the profile of a plugin, NULL disables profiling for it
+struct plugin_profile* plugin_profile_create(void);
+void                   plugin_profile_free(struct plugin_profile* profile);
+
+// Start time to pass to plugin_profile_record after the callback returns
+static inline int64_t plugin_profile_begin(void) {
+    return esp_timer_get_time();
+}
+
+// Record a callback that started at `start`, returns its duration in microseconds
+uint32_t plugin_profile_record(plugin_context_t* ctx, plugin_callback_type_t type, int64_t start);
+
+// Called by the plugin manager when it starts the service task, and just
+// before the task is deleted: by the task itself with a NULL handle, or by
+// the plugin manager when it force stops the task
+void plugin_profile_task_started(plugin_context_t* ctx);
+void plugin_profile_task_ended(plugin_context_t* ctx, TaskHandle_t task);
+
+// Caller must hold the plugin manager lock, use plugin_manager_get_profile
+bool plugin_profile_get(plugin_context_t* ctx, plugin_profile_t* out_profile);
+
+const char* plugin_profile_callback_name(plugin_callback_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
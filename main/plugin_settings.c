@@ -0,0 +1,445 @@
+// SPDX-License-Identifier: MIT
+
+#include "plugin_settings.h"
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "nvs.h"
+#include "plugin_context.h"
+
+static const char* TAG = "plugin_settings";
+
+#define PLUGIN_SETTINGS_COMMIT_DELAY_MS  5000  // Longest time a changed value waits in RAM
+#define PLUGIN_SETTINGS_SHUTDOWN_WAIT_MS 500
+#define PLUGIN_SETTINGS_MAX_STRING       4000  // Longest string NVS stores, including the terminator
+
+typedef enum {
+    SETTING_INT,
+    SETTING_STRING,
+} setting_type_t;
+
+typedef struct setting {
+    struct setting* next;
+    char            key[NVS_KEY_NAME_MAX_SIZE];
+    setting_type_t  type;
+    bool            dirty;  // Changed since it was last written to NVS
+    int32_t         int_value;
+    char*           string_value;  // Only for SETTING_STRING
+} setting_t;
+
+// Logged when the plugin is unloaded, writes / flash_writes is the write reduction
+typedef struct {
+    uint32_t writes;            // Set calls
+    uint32_t unchanged_writes;  // Set calls with the value already stored, skipped
+    uint32_t coalesced_writes;  // Set calls replacing a value not written to flash yet
+    uint32_t flash_writes;      // Values written to NVS
+    uint32_t commits;           // NVS commits
+} settings_stats_t;
+
+struct plugin_settings {
+    struct plugin_settings* next;
+    char                    namespace_name[NVS_NS_NAME_MAX_SIZE];
+    setting_t*              settings;
+    uint32_t                dirty_count;
+    settings_stats_t        stats;
+};
+
+// Protects the contents of the caches, only held for memory operations
+static SemaphoreHandle_t settings_mutex = NULL;
+// Serializes writing to NVS and changes to the list of caches, so a flush can walk the list and use a cache while
+// gets and sets of plugins continue
+static SemaphoreHandle_t       commit_mutex     = NULL;
+static struct plugin_settings* caches           = NULL;
+static esp_timer_handle_t      commit_timer     = NULL;
+static bool                    commit_scheduled = false;  // Protected by settings_mutex
+
+static setting_t* find_setting(struct plugin_settings* cache, const char* key) {
+    for (setting_t* setting = cache->settings; setting != NULL; setting = setting->next) {
+        if (strcmp(setting->key, key) == 0) {
+            return setting;
+        }
+    }
+    return NULL;
+}
+
+static setting_t* add_setting(struct plugin_settings* cache, const char* key) {
+    setting_t* setting = calloc(1, sizeof(setting_t));
+    if (setting == NULL) {
+        return NULL;
+    }
+    strncpy(setting->key, key, sizeof(setting->key) - 1);
+    setting->next   = cache->settings;
+    cache->settings = setting;
+    return setting;
+}
+
+static void free_cache(struct plugin_settings* cache) {
+    while (cache->settings != NULL) {
+        setting_t* setting = cache->settings;
+        cache->settings    = setting->next;
+        free(setting->string_value);
+        free(setting);
+    }
+    free(cache);
+}
+
+static bool load_setting(struct plugin_settings* cache, nvs_handle_t handle, const nvs_entry_info_t* info) {
+    if (info->type != NVS_TYPE_I32 && info->type != NVS_TYPE_STR) {
+        return true;  // Not written through the settings API
+    }
+    setting_t* setting = add_setting(cache, info->key);
+    if (setting == NULL) {
+        return false;
+    }
+    if (info->type == NVS_TYPE_I32) {
+        setting->type = SETTING_INT;
+        return nvs_get_i32(handle, info->key, &setting->int_value) == ESP_OK;
+    }
+
+    setting->type = SETTING_STRING;
+    size_t length = 0;
+    if (nvs_get_str(handle, info->key, NULL, &length) != ESP_OK) {
+        return false;
+    }
+    setting->string_value = malloc(length);
+    return setting->string_value != NULL &&
+           nvs_get_str(handle, info->key, setting->string_value, &length) == ESP_OK;
+}
+
+// Reads every value stored in the namespace. Caller must hold commit_mutex.
+static struct plugin_settings* load_cache(const char* namespace_name) {
+    if (namespace_name == NULL || strlen(namespace_name) >= NVS_NS_NAME_MAX_SIZE) {
+        return NULL;
+    }
+    struct plugin_settings* cache = calloc(1, sizeof(struct plugin_settings));
+    if (cache == NULL) {
+        return NULL;
+    }
+    strcpy(cache->namespace_name, namespace_name);
+
+    nvs_handle_t handle;
+    esp_err_t    res = nvs_open(namespace_name, NVS_READONLY, &handle);
+    if (res == ESP_ERR_NVS_NOT_FOUND) {
+        return cache;  // Nothing stored yet
+    } else if (res != ESP_OK) {
+        free(cache);
+        return NULL;
+    }
+
+    bool           success  = true;
+    nvs_iterator_t iterator = NULL;
+    res                     = nvs_entry_find(NVS_DEFAULT_PART_NAME, namespace_name, NVS_TYPE_ANY, &iterator);
+    while (res == ESP_OK && success) {
+        nvs_entry_info_t info;
+        nvs_entry_info(iterator, &info);
+        success = load_setting(cache, handle, &info);
+        res     = nvs_entry_next(&iterator);
+    }
+    nvs_release_iterator(iterator);
+    nvs_close(handle);
+
+    if (!success) {
+        ESP_LOGE(TAG, "Failed to load settings of %s", namespace_name);
+        free_cache(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+// Returns the cache of the plugin, loading it on first use
+static struct plugin_settings* get_cache(plugin_context_t* ctx) {
+    if (ctx == NULL || settings_mutex == NULL) {
+        return NULL;
+    }
+    xSemaphoreTake(settings_mutex, portMAX_DELAY);
+    struct plugin_settings* cache = ctx->settings_cache;
+    xSemaphoreGive(settings_mutex);
+    if (cache != NULL) {
+        return cache;
+    }
+
+    xSemaphoreTake(commit_mutex, portMAX_DELAY);
+    if (ctx->settings_cache == NULL) {
+        cache = load_cache(ctx->settings_namespace);
+        if (cache != NULL) {
+            xSemaphoreTake(settings_mutex, portMAX_DELAY);
+            cache->next         = caches;
+            caches              = cache;
+            ctx->settings_cache = cache;
+            xSemaphoreGive(settings_mutex);
+        }
+    }
+    cache = ctx->settings_cache;
+    xSemaphoreGive(commit_mutex);
+    return cache;
+}
+
+// Caller must hold settings_mutex
+static void mark_dirty(struct plugin_settings* cache, setting_t* setting) {
+    if (setting->dirty) {
+        cache->stats.coalesced_writes++;  // The previous value never reached flash
+    } else {
+        setting->dirty = true;
+        cache->dirty_count++;
+    }
+    if (!commit_scheduled && commit_timer != NULL &&
+        esp_timer_start_once(commit_timer, PLUGIN_SETTINGS_COMMIT_DELAY_MS * 1000ULL) == ESP_OK) {
+        commit_scheduled = true;
+    }
+}
+
+// Writes the dirty values of a cache with a single commit. The values are copied first so the cache stays usable
+// while flash is written. Caller must hold commit_mutex.
+static bool write_dirty(struct plugin_settings* cache) {
+    xSemaphoreTake(settings_mutex, portMAX_DELAY);
+    uint32_t   count = 0;
+    setting_t* batch = cache->dirty_count > 0 ? calloc(cache->dirty_count, sizeof(setting_t)) : NULL;
+    if (batch != NULL) {
+        for (setting_t* setting = cache->settings; setting != NULL; setting = setting->next) {
+            if (!setting->dirty || count == cache->dirty_count) {
+                continue;
+            }
+            batch[count] = *setting;
+            if (setting->type == SETTING_STRING &&
+                (batch[count].string_value = strdup(setting->string_value)) == NULL) {
+                break;  // Stays dirty for the next flush
+            }
+            setting->dirty = false;
+            count++;
+        }
+        cache->dirty_count -= count;
+    }
+    bool out_of_memory = cache->dirty_count > 0;
+    xSemaphoreGive(settings_mutex);
+
+    if (count == 0) {
+        free(batch);
+        return !out_of_memory;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t    res = nvs_open(cache->namespace_name, NVS_READWRITE, &handle);
+    if (res == ESP_OK) {
+        for (uint32_t i = 0; i < count && res == ESP_OK; i++) {
+            if (batch[i].type == SETTING_INT) {
+                res = nvs_set_i32(handle, batch[i].key, batch[i].int_value);
+            } else {
+                res = nvs_set_str(handle, batch[i].key, batch[i].string_value);
+            }
+        }
+        if (res == ESP_OK) {
+            res = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+
+    xSemaphoreTake(settings_mutex, portMAX_DELAY);
+    if (res == ESP_OK) {
+        cache->stats.flash_writes += count;
+        cache->stats.commits++;
+    } else {
+        // Retried by the next flush, unless the value was changed again in the meantime and is dirty already
+        for (uint32_t i = 0; i < count; i++) {
+            setting_t* setting = find_setting(cache, batch[i].key);
+            if (setting != NULL && !setting->dirty) {
+                setting->dirty = true;
+                cache->dirty_count++;
+            }
+        }
+    }
+    xSemaphoreGive(settings_mutex);
+
+    if (res != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write settings of %s (%s)", cache->namespace_name, esp_err_to_name(res));
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        free(batch[i].string_value);
+    }
+    free(batch);
+    return res == ESP_OK && !out_of_memory;
+}
+
+static bool write_all(TickType_t wait) {
+    if (commit_mutex == NULL || xSemaphoreTake(commit_mutex, wait) != pdTRUE) {
+        return false;
+    }
+    bool success = true;
+    for (struct plugin_settings* cache = caches; cache != NULL; cache = cache->next) {
+        success &= write_dirty(cache);
+    }
+    xSemaphoreGive(commit_mutex);
+    return success;
+}
+
+static void commit_timer_callback(void* arg) {
+    xSemaphoreTake(settings_mutex, portMAX_DELAY);
+    commit_scheduled = false;
+    xSemaphoreGive(settings_mutex);
+    write_all(portMAX_DELAY);
+}
+
+static void shutdown_handler(void) {
+    if (!write_all(pdMS_TO_TICKS(PLUGIN_SETTINGS_SHUTDOWN_WAIT_MS))) {
+        ESP_LOGW(TAG, "Not all plugin settings were saved before shutdown");
+    }
+}
+
+void plugin_settings_init(void) {
+    if (settings_mutex != NULL) {
+        return;
+    }
+    settings_mutex = xSemaphoreCreateMutex();
+    commit_mutex   = xSemaphoreCreateMutex();
+    if (settings_mutex == NULL || commit_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutexes");
+        return;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback        = commit_timer_callback,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name            = TAG,
+    };
+    if (esp_timer_create(&timer_args, &commit_timer) != ESP_OK) {
+        // Values are still written on flush, unload and shutdown
+        ESP_LOGE(TAG, "Failed to create commit timer");
+        commit_timer = NULL;
+    }
+    esp_register_shutdown_handler(shutdown_handler);
+}
+
+bool plugin_settings_get_string(plugin_context_t* ctx, const char* key, char* value, size_t max_len) {
+    struct plugin_settings* cache = get_cache(ctx);
+    if (cache == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(settings_mutex, portMAX_DELAY);
+    setting_t* setting = find_setting(cache, key);
+    bool       found   = setting != NULL && setting->type == SETTING_STRING && strlen(setting->string_value) < max_len;
+    if (found) {
+        strcpy(value, setting->string_value);
+    }
+    xSemaphoreGive(settings_mutex);
+    return found;
+}
+
+bool plugin_settings_set_string(plugin_context_t* ctx, const char* key, const char* value) {
+    if (strlen(key) >= NVS_KEY_NAME_MAX_SIZE || strlen(value) >= PLUGIN_SETTINGS_MAX_STRING) {
+        return false;
+    }
+    struct plugin_settings* cache = get_cache(ctx);
+    if (cache == NULL) {
+        return false;
+    }
+
+    bool success = true;
+    xSemaphoreTake(settings_mutex, portMAX_DELAY);
+    cache->stats.writes++;
+    setting_t* setting = find_setting(cache, key);
+    if (setting != NULL && setting->type == SETTING_STRING && strcmp(setting->string_value, value) == 0) {
+        cache->stats.unchanged_writes++;
+    } else {
+        char* copy = strdup(value);
+        if (copy != NULL && setting == NULL) {
+            setting = add_setting(cache, key);
+        }
+        if (copy != NULL && setting != NULL) {
+            free(setting->string_value);
+            setting->type         = SETTING_STRING;
+            setting->string_value = copy;
+            mark_dirty(cache, setting);
+        } else {
+            free(copy);
+            success = false;
+        }
+    }
+    xSemaphoreGive(settings_mutex);
+    return success;
+}
+
+bool plugin_settings_get_int(plugin_context_t* ctx, const char* key, int32_t* value) {
+    struct plugin_settings* cache = get_cache(ctx);
+    if (cache == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(settings_mutex, portMAX_DELAY);
+    setting_t* setting = find_setting(cache, key);
+    bool       found   = setting != NULL && setting->type == SETTING_INT;
+    if (found) {
+        *value = setting->int_value;
+    }
+    xSemaphoreGive(settings_mutex);
+    return found;
+}
+
+bool plugin_settings_set_int(plugin_context_t* ctx, const char* key, int32_t value) {
+    if (strlen(key) >= NVS_KEY_NAME_MAX_SIZE) {
+        return false;
+    }
+    struct plugin_settings* cache = get_cache(ctx);
+    if (cache == NULL) {
+        return false;
+    }
+
+    bool success = true;
+    xSemaphoreTake(settings_mutex, portMAX_DELAY);
+    cache->stats.writes++;
+    setting_t* setting = find_setting(cache, key);
+    if (setting != NULL && setting->type == SETTING_INT && setting->int_value == value) {
+        cache->stats.unchanged_writes++;
+    } else {
+        if (setting == NULL) {
+            setting = add_setting(cache, key);
+        }
+        if (setting != NULL) {
+            free(setting->string_value);
+            setting->type         = SETTING_INT;
+            setting->int_value    = value;
+            setting->string_value = NULL;
+            mark_dirty(cache, setting);
+        } else {
+            success = false;
+        }
+    }
+    xSemaphoreGive(settings_mutex);
+    return success;
+}
+
+void plugin_settings_release(plugin_context_t* ctx) {
+    if (ctx == NULL || commit_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(commit_mutex, portMAX_DELAY);
+    struct plugin_settings* cache = ctx->settings_cache;
+    if (cache != NULL) {
+        if (!write_dirty(cache)) {
+            ESP_LOGW(TAG, "Settings of %s changed since the last commit are lost", cache->namespace_name);
+        }
+        ESP_LOGI(TAG,
+                 "Settings of %s: %" PRIu32 " writes (%" PRIu32 " unchanged, %" PRIu32 " coalesced), %" PRIu32
+                 " to flash in %" PRIu32 " commits",
+                 cache->namespace_name, cache->stats.writes, cache->stats.unchanged_writes,
+                 cache->stats.coalesced_writes, cache->stats.flash_writes, cache->stats.commits);
+
+        xSemaphoreTake(settings_mutex, portMAX_DELAY);
+        for (struct plugin_settings** link = &caches; *link != NULL; link = &(*link)->next) {
+            if (*link == cache) {
+                *link = cache->next;
+                break;
+            }
+        }
+        ctx->settings_cache = NULL;
+        xSemaphoreGive(settings_mutex);
+        free_cache(cache);
+    }
+    xSemaphoreGive(commit_mutex);
+}
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: MIT
+// Tanmatsu Plugin Settings Store
+// Backs the asp_plugin_settings_* API with a per-plugin cache in RAM.
+//
+// The first settings call of a plugin loads its whole NVS namespace into
+// memory; after that reads never touch NVS. Writes only update the cache
+// and mark the value dirty. Dirty values are written to NVS, with a single
+// commit per plugin, by a deferred commit timer, when the plugin is
+// unloaded and when the device shuts down. A plugin
+// that saves its state on every frame therefore costs one flash write per
+// changed value per commit period instead of one per call.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "tanmatsu_plugin.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Create the commit timer and register the shutdown flush, called from plugin_api_init
+void plugin_settings_init(void);
+
+bool plugin_settings_get_string(plugin_context_t* ctx, const char* key, char* value, size_t max_len);
+bool plugin_settings_set_string(plugin_context_t* ctx, const char* key, const char* value);
+bool plugin_settings_get_int(plugin_context_t* ctx, const char* key, int32_t* value);
+bool plugin_settings_set_int(plugin_context_t* ctx, const char* key, int32_t value);
+
+// Flush and free the cache of the plugin, called when it is unloaded
+void plugin_settings_release(plugin_context_t* ctx);
+
+#ifdef __cplusplus
+}
+#endif
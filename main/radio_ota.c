@@ -167,8 +167,18 @@ esp_err_t radio_ota_update(void) {
         char message[256] = {0};
         sprintf(message, "Downloading firmware part %d of %d...", i + 1, step_count);
 
-        http_session_set_callback(session, download_callback, message);
-        dl_res = http_session_download_ram(session, url, &steps[i].compressed_data, &steps[i].compressed_size);
+        // Parts listing a digest are verified while they download, before anything is written to the radio
+        uint8_t digest[HTTP_SHA256_SIZE];
+        cJSON*  sha256_json = cJSON_GetObjectItem(step_json, "sha256");
+        if (sha256_json != NULL &&
+            (!cJSON_IsString(sha256_json) || !http_sha256_from_hex(sha256_json->valuestring, digest))) {
+            ESP_LOGE(TAG, "Invalid SHA-256 digest for %s", filename);
+            dl_res = false;
+        } else {
+            http_session_set_expected_sha256(session, sha256_json != NULL ? digest : NULL);
+            http_session_set_callback(session, download_callback, message);
+            dl_res = http_session_download_ram(session, url, &steps[i].compressed_data, &steps[i].compressed_size);
+        }
         if (!dl_res) {
             for (int j = 0; j < i; j++) {
                 free(steps[j].compressed_data);
@@ -7,69 +7,227 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/idf_additions.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 
+#if defined(CONFIG_IDF_TARGET_ESP32P4) || defined(CONFIG_IDF_TARGET_LINUX)
 #if defined(CONFIG_IDF_TARGET_ESP32P4)
 #include "esp_hosted.h"
+#else
+#include "radio_system_protocol_loopback.h"
+#endif
 
 static const char TAG[] = "radio system";
 
-static SemaphoreHandle_t radio_system_protocol_mutex                 = NULL;
-static SemaphoreHandle_t radio_system_protocol_transaction_semaphore = NULL;
-static uint8_t           radio_system_protocol_packet_buffer[512]    = {0};
-static uint32_t          radio_system_protocol_packet_size           = 0;
-static uint32_t          radio_system_sequence_number                = 0;
+#define RADIO_SYSTEM_PROTOCOL_MESSAGE_ID 0x05
+#define RADIO_SYSTEM_PROTOCOL_TIMEOUT_MS 2000
 
-static esp_err_t radio_system_protocol_transaction(const uint8_t* request, size_t request_length, uint8_t* out_response,
-                                                   size_t* response_length, size_t max_response_length) {
-    if (!radio_system_protocol_mutex || !radio_system_protocol_transaction_semaphore) {
+// Requests are matched to responses by sequence number, so several callers
+// can have a request in flight at the same time instead of each waiting for
+// the previous round trip to finish. The number of outstanding requests is
+// bounded by RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE; further callers block until
+// a slot frees up.
+typedef struct {
+    bool              in_use;
+    bool              completed;
+    uint32_t          sequence_number;
+    uint8_t*          response;
+    size_t            max_response_length;
+    size_t            response_length;
+    esp_err_t         result;
+    SemaphoreHandle_t done;  // Given by the receive callback when the response arrived
+} radio_system_protocol_pending_t;
+
+static SemaphoreHandle_t radio_system_protocol_mutex  = NULL;  // Protects the pending table
+static SemaphoreHandle_t radio_system_protocol_window = NULL;  // Counts free pending slots
+static uint32_t          radio_system_sequence_number = 0;
+
+static radio_system_protocol_pending_t radio_system_protocol_pending[RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE] = {0};
+
+static esp_err_t radio_system_protocol_send(const uint8_t* packet, size_t length) {
+#if defined(CONFIG_IDF_TARGET_ESP32P4)
+    return esp_hosted_send_custom_data(RADIO_SYSTEM_PROTOCOL_MESSAGE_ID, (uint8_t*)packet, length);
+#else
+    return radio_system_protocol_loopback_send(packet, length);
+#endif
+}
+
+static void radio_system_protocol_release(radio_system_protocol_pending_t* pending) {
+    xSemaphoreTake(radio_system_protocol_mutex, portMAX_DELAY);
+    pending->in_use    = false;
+    pending->completed = false;
+    pending->response  = NULL;
+    xSemaphoreGive(radio_system_protocol_mutex);
+    xSemaphoreGive(radio_system_protocol_window);
+}
+
+// Reserves a slot in the window, stamps the sequence number into the request
+// header and sends the request. Does not wait for the response.
+static esp_err_t radio_system_protocol_submit(uint8_t* request, size_t request_length, uint8_t* out_response,
+                                              size_t max_response_length, TickType_t wait,
+                                              radio_system_protocol_pending_t** out_pending) {
+    if (!radio_system_protocol_mutex || !radio_system_protocol_window) {
         ESP_LOGE(TAG, "Invalid state");
         return ESP_ERR_INVALID_STATE;
     }
+    if (request_length < sizeof(radio_system_protocol_header_t)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
 
-    esp_err_t result = ESP_FAIL;
+    if (xSemaphoreTake(radio_system_protocol_window, wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    radio_system_protocol_pending_t* pending = NULL;
     xSemaphoreTake(radio_system_protocol_mutex, portMAX_DELAY);
-    xSemaphoreTake(radio_system_protocol_transaction_semaphore, 0);  // Clear semaphore
-    result = esp_hosted_send_custom_data(0x05, (uint8_t*)request, request_length);
-    if (result == ESP_OK) {
-        if (xSemaphoreTake(radio_system_protocol_transaction_semaphore, pdMS_TO_TICKS(2000)) ==
-            pdTRUE) {  // Wait for response
-            if (radio_system_protocol_packet_size <= max_response_length) {
-                memcpy(out_response, radio_system_protocol_packet_buffer, radio_system_protocol_packet_size);
-                *response_length = radio_system_protocol_packet_size;
-                result           = ESP_OK;
-            } else {
-                ESP_LOGE(TAG, "Invalid size");
-                result = ESP_ERR_INVALID_SIZE;
-            }
-        } else {
-            ESP_LOGE(TAG, "Timeout");
-            result = ESP_ERR_TIMEOUT;
+    for (size_t i = 0; i < RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE; i++) {
+        if (!radio_system_protocol_pending[i].in_use) {
+            pending = &radio_system_protocol_pending[i];
+            break;
         }
     }
-    radio_system_sequence_number++;
+    // The window semaphore guarantees a free slot
+    pending->in_use              = true;
+    pending->completed           = false;
+    pending->sequence_number     = radio_system_sequence_number++;
+    pending->response            = out_response;
+    pending->max_response_length = max_response_length;
+    pending->response_length     = 0;
+    pending->result              = ESP_FAIL;
+    xSemaphoreTake(pending->done, 0);  // Clear a completion left over from a late response
+    ((radio_system_protocol_header_t*)request)->sequence_number = pending->sequence_number;
     xSemaphoreGive(radio_system_protocol_mutex);
+
+    esp_err_t result = radio_system_protocol_send(request, request_length);
+    if (result != ESP_OK) {
+        radio_system_protocol_release(pending);
+        return result;
+    }
+    *out_pending = pending;
+    return ESP_OK;
+}
+
+// Waits for the response to a submitted request and frees its slot.
+static esp_err_t radio_system_protocol_wait(radio_system_protocol_pending_t* pending, size_t* response_length) {
+    bool received = xSemaphoreTake(pending->done, pdMS_TO_TICKS(RADIO_SYSTEM_PROTOCOL_TIMEOUT_MS)) == pdTRUE;
+
+    // A response may still have arrived between the timeout and taking the mutex
+    xSemaphoreTake(radio_system_protocol_mutex, portMAX_DELAY);
+    esp_err_t result = ESP_ERR_TIMEOUT;
+    if (received || pending->completed) {
+        result           = pending->result;
+        *response_length = pending->response_length;
+    }
+    xSemaphoreGive(radio_system_protocol_mutex);
+
+    if (result == ESP_ERR_TIMEOUT) {
+        ESP_LOGE(TAG, "Timeout");
+    } else if (result == ESP_ERR_INVALID_SIZE) {
+        ESP_LOGE(TAG, "Invalid size");
+    }
+    radio_system_protocol_release(pending);
     return result;
 }
 
-static void radio_system_protocol_transaction_receive(uint32_t msg_id, const uint8_t* packet, size_t length) {
-    if (msg_id != 0x05) {
-        ESP_LOGW(TAG, "Received system message with unknown ID: %u", msg_id);
-        return;
+esp_err_t radio_system_protocol_transaction_batch(radio_system_protocol_transfer_t* transfers, size_t count) {
+    if (transfers == NULL && count > 0) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    if (!radio_system_protocol_mutex || !radio_system_protocol_transaction_semaphore) {
+    esp_err_t                        result = ESP_OK;
+    radio_system_protocol_pending_t* pending[RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE];
+    size_t                           next = 0;
+    while (next < count) {
+        // Block for the first slot only, then take whatever else is free. Holding
+        // on to slots while blocking for more could starve other callers.
+        size_t submitted = 0;
+        while (next + submitted < count && submitted < RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE) {
+            radio_system_protocol_transfer_t* transfer = &transfers[next + submitted];
+            transfer->response_length                  = 0;
+            transfer->result = radio_system_protocol_submit(transfer->request, transfer->request_length,
+                                                            transfer->response, transfer->max_response_length,
+                                                            submitted == 0 ? portMAX_DELAY : 0, &pending[submitted]);
+            if (transfer->result == ESP_ERR_TIMEOUT && submitted > 0) {
+                break;  // Window is full, collect what is in flight first
+            }
+            if (transfer->result != ESP_OK) {
+                pending[submitted] = NULL;
+            }
+            submitted++;
+        }
+
+        for (size_t i = 0; i < submitted; i++) {
+            radio_system_protocol_transfer_t* transfer = &transfers[next + i];
+            if (pending[i] != NULL) {
+                transfer->result = radio_system_protocol_wait(pending[i], &transfer->response_length);
+            }
+            if (transfer->result != ESP_OK) {
+                result = transfer->result;
+            }
+        }
+        next += submitted;
+    }
+    return result;
+}
+
+// A single request is a batch of one, it shares the window with every other caller
+static esp_err_t radio_system_protocol_transaction(uint8_t* request, size_t request_length, uint8_t* out_response,
+                                                   size_t* response_length, size_t max_response_length) {
+    radio_system_protocol_transfer_t transfer = {
+        .request             = request,
+        .request_length      = request_length,
+        .response            = out_response,
+        .max_response_length = max_response_length,
+    };
+    esp_err_t result = radio_system_protocol_transaction_batch(&transfer, 1);
+    *response_length = transfer.response_length;
+    return result;
+}
+
+static void radio_system_protocol_transaction_receive(const uint8_t* packet, size_t length) {
+    if (!radio_system_protocol_mutex || !radio_system_protocol_window) {
         ESP_LOGW(TAG, "Received system message but system not initialized");
         return;
     }
-    if (length > sizeof(radio_system_protocol_packet_buffer) || length < sizeof(radio_system_protocol_header_t)) {
+    if (length < sizeof(radio_system_protocol_header_t)) {
         ESP_LOGW(TAG, "Received radio system message but size incorrect");
         return;
     }
-    memcpy(radio_system_protocol_packet_buffer, packet, length);
-    radio_system_protocol_packet_size = length;
-    xSemaphoreGive(radio_system_protocol_transaction_semaphore);
+
+    uint32_t sequence_number = ((const radio_system_protocol_header_t*)packet)->sequence_number;
+    bool     matched         = false;
+    xSemaphoreTake(radio_system_protocol_mutex, portMAX_DELAY);
+    for (size_t i = 0; i < RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE; i++) {
+        radio_system_protocol_pending_t* pending = &radio_system_protocol_pending[i];
+        if (!pending->in_use || pending->completed || pending->sequence_number != sequence_number) continue;
+        if (length <= pending->max_response_length) {
+            memcpy(pending->response, packet, length);
+            pending->response_length = length;
+            pending->result          = ESP_OK;
+        } else {
+            pending->result = ESP_ERR_INVALID_SIZE;
+        }
+        pending->completed = true;
+        xSemaphoreGive(pending->done);
+        matched = true;
+        break;
+    }
+    xSemaphoreGive(radio_system_protocol_mutex);
+
+    if (!matched) {
+        ESP_LOGW(TAG, "Dropping response with unknown sequence number %u", sequence_number);
+    }
 }
 
+#if defined(CONFIG_IDF_TARGET_ESP32P4)
+static void radio_system_protocol_hosted_receive(uint32_t msg_id, const uint8_t* packet, size_t length) {
+    if (msg_id != RADIO_SYSTEM_PROTOCOL_MESSAGE_ID) {
+        ESP_LOGW(TAG, "Received system message with unknown ID: %u", msg_id);
+        return;
+    }
+    radio_system_protocol_transaction_receive(packet, length);
+}
+#endif
+
 // Validates a received response: checks minimum length, sequence number, and type.
 // Returns ESP_FAIL if the remote sent NACK, ESP_FAIL for any other mismatch.
 static esp_err_t validate_response(const uint8_t* response, size_t response_length, uint32_t expected_seq,
@@ -94,20 +252,42 @@ static esp_err_t validate_response(const uint8_t* response, size_t response_leng
 }
 
 esp_err_t radio_system_protocol_init(void) {
-    radio_system_protocol_mutex                 = xSemaphoreCreateMutex();
-    radio_system_protocol_transaction_semaphore = xSemaphoreCreateBinary();
-    if (radio_system_protocol_mutex == NULL || radio_system_protocol_transaction_semaphore == NULL) {
+    if (radio_system_protocol_mutex != NULL) {
+        return ESP_OK;
+    }
+
+    radio_system_protocol_mutex  = xSemaphoreCreateMutex();
+    radio_system_protocol_window = xSemaphoreCreateCounting(RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE,
+                                                            RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE);
+    bool ok = radio_system_protocol_mutex != NULL && radio_system_protocol_window != NULL;
+    for (size_t i = 0; ok && i < RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE; i++) {
+        radio_system_protocol_pending[i].done = xSemaphoreCreateBinary();
+        ok                                    = radio_system_protocol_pending[i].done != NULL;
+    }
+    if (!ok) {
+        for (size_t i = 0; i < RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE; i++) {
+            if (radio_system_protocol_pending[i].done != NULL) {
+                vSemaphoreDelete(radio_system_protocol_pending[i].done);
+                radio_system_protocol_pending[i].done = NULL;
+            }
+        }
         if (radio_system_protocol_mutex != NULL) {
             vSemaphoreDelete(radio_system_protocol_mutex);
+            radio_system_protocol_mutex = NULL;
         }
-        if (radio_system_protocol_transaction_semaphore != NULL) {
-            vSemaphoreDelete(radio_system_protocol_transaction_semaphore);
+        if (radio_system_protocol_window != NULL) {
+            vSemaphoreDelete(radio_system_protocol_window);
+            radio_system_protocol_window = NULL;
         }
         return ESP_ERR_NO_MEM;
     }
 
-    esp_hosted_register_custom_callback(0x05, radio_system_protocol_transaction_receive);
+#if defined(CONFIG_IDF_TARGET_ESP32P4)
+    esp_hosted_register_custom_callback(RADIO_SYSTEM_PROTOCOL_MESSAGE_ID, radio_system_protocol_hosted_receive);
     return ESP_OK;
+#else
+    return radio_system_protocol_loopback_init(radio_system_protocol_transaction_receive);
+#endif
 }
 
 esp_err_t radio_system_protocol_get_information(radio_system_protocol_information_t* out_information) {
@@ -117,7 +297,6 @@ esp_err_t radio_system_protocol_get_information(radio_system_protocol_informatio
     size_t  request_length = sizeof(radio_system_protocol_header_t) + sizeof(radio_system_protocol_information_t);
     uint8_t request[request_length];
     radio_system_protocol_header_t* header = (radio_system_protocol_header_t*)request;
-    header->sequence_number                = radio_system_sequence_number;
     header->type                           = RADIO_SYSTEM_PROTOCOL_TYPE_GET_INFORMATION;
     uint8_t   response[sizeof(radio_system_protocol_header_t) + sizeof(radio_system_protocol_information_t)] = {0};
     size_t    response_length                                                                                = 0;
@@ -151,7 +330,6 @@ esp_err_t radio_system_protocol_set_configuration(const radio_system_protocol_co
     }
     uint8_t request[sizeof(radio_system_protocol_header_t) + sizeof(radio_system_protocol_configuration_t)] = {0};
     radio_system_protocol_header_t* header = (radio_system_protocol_header_t*)request;
-    header->sequence_number                = radio_system_sequence_number;
     header->type                           = RADIO_SYSTEM_PROTOCOL_TYPE_SET_CONFIGURATION;
     memcpy(request + sizeof(radio_system_protocol_header_t), configuration,
            sizeof(radio_system_protocol_configuration_t));
@@ -164,6 +342,52 @@ esp_err_t radio_system_protocol_set_configuration(const radio_system_protocol_co
     return validate_response(response, response_length, header->sequence_number, RADIO_SYSTEM_PROTOCOL_TYPE_ACK, 0);
 }
 
+esp_err_t radio_system_protocol_apply_configuration(const radio_system_protocol_configuration_t* configuration,
+                                                    radio_system_protocol_information_t*         out_information) {
+    if (configuration == NULL || out_information == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint8_t set_request[sizeof(radio_system_protocol_header_t) + sizeof(radio_system_protocol_configuration_t)] = {0};
+    uint8_t get_request[sizeof(radio_system_protocol_header_t) + sizeof(radio_system_protocol_information_t)]   = {0};
+    uint8_t set_response[sizeof(radio_system_protocol_header_t)]                                                = {0};
+    uint8_t get_response[sizeof(radio_system_protocol_header_t) + sizeof(radio_system_protocol_information_t)]  = {0};
+    radio_system_protocol_header_t* set_header = (radio_system_protocol_header_t*)set_request;
+    radio_system_protocol_header_t* get_header = (radio_system_protocol_header_t*)get_request;
+    set_header->type                           = RADIO_SYSTEM_PROTOCOL_TYPE_SET_CONFIGURATION;
+    get_header->type                           = RADIO_SYSTEM_PROTOCOL_TYPE_GET_INFORMATION;
+    memcpy(set_request + sizeof(radio_system_protocol_header_t), configuration,
+           sizeof(radio_system_protocol_configuration_t));
+
+    // The radio handles requests in the order they were sent, so the information already reflects the change
+    radio_system_protocol_transfer_t transfers[] = {
+        {.request             = set_request,
+         .request_length      = sizeof(set_request),
+         .response            = set_response,
+         .max_response_length = sizeof(set_response)},
+        {.request             = get_request,
+         .request_length      = sizeof(get_request),
+         .response            = get_response,
+         .max_response_length = sizeof(get_response)},
+    };
+    esp_err_t result = radio_system_protocol_transaction_batch(transfers, 2);
+    if (result != ESP_OK) return result;
+    result = validate_response(set_response, transfers[0].response_length, set_header->sequence_number,
+                               RADIO_SYSTEM_PROTOCOL_TYPE_ACK, 0);
+    if (result != ESP_OK) return result;
+    result = validate_response(get_response, transfers[1].response_length, get_header->sequence_number,
+                               RADIO_SYSTEM_PROTOCOL_TYPE_GET_INFORMATION, sizeof(radio_system_protocol_information_t));
+    if (result != ESP_OK) return result;
+
+    memcpy(out_information, get_response + sizeof(radio_system_protocol_header_t),
+           sizeof(radio_system_protocol_information_t));
+    if (out_information->board_revision != configuration->board_revision ||
+        memcmp(out_information->country_code, configuration->country_code, sizeof(configuration->country_code)) != 0) {
+        ESP_LOGE(TAG, "Radio did not apply the configuration");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
 // NVS
 
 typedef struct {
@@ -186,7 +410,6 @@ esp_err_t radio_system_protocol_nvs_list(const char* namespace_name, const char*
 
     uint8_t                         request[sizeof(radio_system_protocol_header_t) + sizeof(nvs_list_request_t)] = {0};
     radio_system_protocol_header_t* header = (radio_system_protocol_header_t*)request;
-    header->sequence_number                = radio_system_sequence_number;
     header->type                           = RADIO_SYSTEM_PROTOCOL_TYPE_NVS_LIST;
     nvs_list_request_t* body               = (nvs_list_request_t*)(request + sizeof(radio_system_protocol_header_t));
     if (namespace_name) strlcpy(body->namespace_name, namespace_name, sizeof(body->namespace_name));
@@ -216,7 +439,6 @@ esp_err_t radio_system_protocol_nvs_read(const char* namespace_name, const char*
 
     uint8_t request[sizeof(radio_system_protocol_header_t) + sizeof(radio_system_protocol_nvs_location_t)] = {0};
     radio_system_protocol_header_t* header = (radio_system_protocol_header_t*)request;
-    header->sequence_number                = radio_system_sequence_number;
     header->type                           = RADIO_SYSTEM_PROTOCOL_TYPE_NVS_READ;
     radio_system_protocol_nvs_location_t* body =
         (radio_system_protocol_nvs_location_t*)(request + sizeof(radio_system_protocol_header_t));
@@ -250,7 +472,6 @@ esp_err_t radio_system_protocol_nvs_write(const radio_system_protocol_nvs_value_
 
     uint8_t                         request[512] = {0};
     radio_system_protocol_header_t* header       = (radio_system_protocol_header_t*)request;
-    header->sequence_number                      = radio_system_sequence_number;
     header->type                                 = RADIO_SYSTEM_PROTOCOL_TYPE_NVS_WRITE;
     memcpy(request + sizeof(radio_system_protocol_header_t), value, value_size);
 
@@ -268,7 +489,6 @@ esp_err_t radio_system_protocol_nvs_delete(const char* namespace_name, const cha
 
     uint8_t request[sizeof(radio_system_protocol_header_t) + sizeof(radio_system_protocol_nvs_location_t)] = {0};
     radio_system_protocol_header_t* header = (radio_system_protocol_header_t*)request;
-    header->sequence_number                = radio_system_sequence_number;
     header->type                           = RADIO_SYSTEM_PROTOCOL_TYPE_NVS_DELETE;
     radio_system_protocol_nvs_location_t* body =
         (radio_system_protocol_nvs_location_t*)(request + sizeof(radio_system_protocol_header_t));
@@ -293,6 +513,10 @@ esp_err_t radio_system_protocol_init(void) {
     return ESP_ERR_NOT_SUPPORTED;
 }
 
+esp_err_t radio_system_protocol_transaction_batch(radio_system_protocol_transfer_t* transfers, size_t count) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
 esp_err_t radio_system_protocol_get_information(radio_system_protocol_information_t* out_information) {
     return ESP_ERR_NOT_SUPPORTED;
 }
@@ -301,6 +525,11 @@ esp_err_t radio_system_protocol_set_configuration(const radio_system_protocol_co
     return ESP_ERR_NOT_SUPPORTED;
 }
 
+esp_err_t radio_system_protocol_apply_configuration(const radio_system_protocol_configuration_t* configuration,
+                                                    radio_system_protocol_information_t*         out_information) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
 esp_err_t radio_system_protocol_nvs_list(const char* namespace_name, const char* key_filter,
                                          radio_system_protocol_nvs_value_type_t type, uint32_t offset,
                                          radio_system_protocol_nvs_entry_t* out_entries, uint32_t max_entries,
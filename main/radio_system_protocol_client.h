@@ -5,6 +5,7 @@
 #include "esp_err.h"
 
 #define RADIO_SYSTEM_PROTOCOL_NVS_MAX_KEY_LENGTH 16
+#define RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE        4  // Maximum number of requests in flight
 
 typedef enum {
     RADIO_SYSTEM_PROTOCOL_TYPE_ACK               = 0x00,
@@ -79,11 +80,31 @@ typedef struct {
     };
 } __attribute__((packed)) radio_system_protocol_nvs_value_t;
 
+// A single request/response pair for radio_system_protocol_transaction_batch. The
+// request starts with a radio_system_protocol_header_t; its sequence number is
+// filled in when the request is sent.
+typedef struct {
+    uint8_t*  request;
+    size_t    request_length;
+    uint8_t*  response;
+    size_t    max_response_length;
+    size_t    response_length;  // Out: length of the received response
+    esp_err_t result;           // Out: result of this transfer
+} radio_system_protocol_transfer_t;
+
 // Functions
 
 esp_err_t radio_system_protocol_init(void);
+// Sends all requests without waiting for each response in turn, keeping up to
+// RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE of them in flight. Returns ESP_OK when every
+// transfer succeeded, otherwise the error of a failed transfer.
+esp_err_t radio_system_protocol_transaction_batch(radio_system_protocol_transfer_t* transfers, size_t count);
 esp_err_t radio_system_protocol_get_information(radio_system_protocol_information_t* out_information);
 esp_err_t radio_system_protocol_set_configuration(const radio_system_protocol_configuration_t* configuration);
+// Sends the configuration and reads the information back in a single batch. Fails if the information the radio
+// returns does not match the configuration.
+esp_err_t radio_system_protocol_apply_configuration(const radio_system_protocol_configuration_t* configuration,
+                                                    radio_system_protocol_information_t*         out_information);
 esp_err_t radio_system_protocol_nvs_list(const char* namespace_name, const char* key_filter,
                                          radio_system_protocol_nvs_value_type_t type, uint32_t offset,
                                          radio_system_protocol_nvs_entry_t* out_entries, uint32_t max_entries,
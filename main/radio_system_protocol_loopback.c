@@ -0,0 +1,131 @@
+#include "radio_system_protocol_loopback.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "radio_system_protocol_client.h"
+
+static const char TAG[] = "radio loopback";
+
+#define LOOPBACK_MAX_PACKET_SIZE 512
+#define LOOPBACK_QUEUE_LENGTH    (RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE * 2)
+
+typedef struct {
+    size_t  length;
+    uint8_t data[LOOPBACK_MAX_PACKET_SIZE];
+} loopback_packet_t;
+
+static QueueHandle_t                            loopback_queue   = NULL;
+static radio_system_protocol_loopback_receive_t loopback_receive = NULL;
+
+static radio_system_protocol_configuration_t loopback_configuration = {0};
+
+// Scratch space for the loopback task, static to keep it off the task stack
+static loopback_packet_t loopback_requests[LOOPBACK_QUEUE_LENGTH];
+static loopback_packet_t loopback_responses[LOOPBACK_QUEUE_LENGTH];
+
+static size_t loopback_handle(const uint8_t* request, size_t request_length, uint8_t* response) {
+    const radio_system_protocol_header_t* request_header  = (const radio_system_protocol_header_t*)request;
+    radio_system_protocol_header_t*       response_header = (radio_system_protocol_header_t*)response;
+    const uint8_t*                        body            = request + sizeof(radio_system_protocol_header_t);
+    size_t                                body_length     = request_length - sizeof(radio_system_protocol_header_t);
+    uint8_t*                              response_body   = response + sizeof(radio_system_protocol_header_t);
+
+    response_header->sequence_number = request_header->sequence_number;
+    response_header->type            = RADIO_SYSTEM_PROTOCOL_TYPE_NACK;
+
+    switch (request_header->type) {
+        case RADIO_SYSTEM_PROTOCOL_TYPE_GET_INFORMATION: {
+            radio_system_protocol_information_t information = {0};
+            strlcpy(information.firmware_name, "loopback", sizeof(information.firmware_name));
+            strlcpy(information.firmware_version, "loopback", sizeof(information.firmware_version));
+            information.board_revision = loopback_configuration.board_revision;
+            memcpy(information.country_code, loopback_configuration.country_code, sizeof(information.country_code));
+            memcpy(response_body, &information, sizeof(information));
+            response_header->type = RADIO_SYSTEM_PROTOCOL_TYPE_GET_INFORMATION;
+            return sizeof(radio_system_protocol_header_t) + sizeof(information);
+        }
+        case RADIO_SYSTEM_PROTOCOL_TYPE_SET_CONFIGURATION:
+            if (body_length < sizeof(loopback_configuration)) break;
+            memcpy(&loopback_configuration, body, sizeof(loopback_configuration));
+            response_header->type = RADIO_SYSTEM_PROTOCOL_TYPE_ACK;
+            break;
+        case RADIO_SYSTEM_PROTOCOL_TYPE_NVS_LIST: {
+            uint32_t count = 0;  // The emulated radio has an empty NVS
+            memcpy(response_body, &count, sizeof(count));
+            response_header->type = RADIO_SYSTEM_PROTOCOL_TYPE_NVS_LIST;
+            return sizeof(radio_system_protocol_header_t) + sizeof(count);
+        }
+        case RADIO_SYSTEM_PROTOCOL_TYPE_NVS_WRITE:
+        case RADIO_SYSTEM_PROTOCOL_TYPE_NVS_DELETE:
+            response_header->type = RADIO_SYSTEM_PROTOCOL_TYPE_ACK;
+            break;
+        default:
+            break;
+    }
+    return sizeof(radio_system_protocol_header_t);
+}
+
+static void loopback_task(void* arg) {
+    (void)arg;
+    while (1) {
+        size_t count = 0;
+        if (xQueueReceive(loopback_queue, &loopback_requests[count], portMAX_DELAY) != pdTRUE) continue;
+        count++;
+        while (count < LOOPBACK_QUEUE_LENGTH && xQueueReceive(loopback_queue, &loopback_requests[count], 0) == pdTRUE) {
+            count++;
+        }
+
+        // Requests are handled in the order they were sent, like the radio does, only the responses are reordered
+        for (size_t i = 0; i < count; i++) {
+            loopback_responses[i].length =
+                loopback_handle(loopback_requests[i].data, loopback_requests[i].length, loopback_responses[i].data);
+        }
+        while (count > 0) {
+            count--;
+            loopback_receive(loopback_responses[count].data, loopback_responses[count].length);
+        }
+    }
+}
+
+esp_err_t radio_system_protocol_loopback_init(radio_system_protocol_loopback_receive_t receive) {
+    if (receive == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (loopback_queue != NULL) {
+        return ESP_OK;
+    }
+
+    loopback_receive = receive;
+    loopback_queue   = xQueueCreate(LOOPBACK_QUEUE_LENGTH, sizeof(loopback_packet_t));
+    if (loopback_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(loopback_task, "radio_loopback", 4096, NULL, 5, NULL) != pdPASS) {
+        vQueueDelete(loopback_queue);
+        loopback_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Radio system protocol loopback started");
+    return ESP_OK;
+}
+
+esp_err_t radio_system_protocol_loopback_send(const uint8_t* packet, size_t length) {
+    if (loopback_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (length < sizeof(radio_system_protocol_header_t) || length > LOOPBACK_MAX_PACKET_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    loopback_packet_t packet_copy;
+    packet_copy.length = length;
+    memcpy(packet_copy.data, packet, length);
+    if (xQueueSend(loopback_queue, &packet_copy, portMAX_DELAY) != pdTRUE) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
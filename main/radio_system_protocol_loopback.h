@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Stand-in for the radio on targets without esp_hosted (the linux target).
+// Requests are answered by a task that emulates the radio firmware, so the
+// system protocol client can be exercised without hardware. Requests that are
+// queued together are handled in order but answered in reverse order to
+// exercise sequence number matching.
+
+typedef void (*radio_system_protocol_loopback_receive_t)(const uint8_t* packet, size_t length);
+
+esp_err_t radio_system_protocol_loopback_init(radio_system_protocol_loopback_receive_t receive);
+esp_err_t radio_system_protocol_loopback_send(const uint8_t* packet, size_t length);
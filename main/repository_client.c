@@ -1,12 +1,14 @@
 #include "repository_client.h"
 #include <ctype.h>
+#include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "bsp/device.h"
 #include "cJSON.h"
 #include "device_settings.h"
 #include "esp_log.h"
-#include "http_download.h"
+#include "http_cache.h"
 #include "nvs_settings.h"
 #include "wifi_connection.h"
 
@@ -29,14 +31,9 @@ void free_repository_data_json(repository_json_data_t* data) {
 }
 
 static bool download_and_parse(const char* url, repository_json_data_t* out_data) {
-    // Free any prior contents so callers can safely re-use the same struct
-    // (e.g. the static `projects` global in menu_repository_client) without leaking.
+    // Free any prior contents so callers can safely re-use the same struct without leaking.
     free_repository_data_json(out_data);
-    http_session_t session = http_session_begin(url);
-    if (session == NULL) return false;
-    bool success = http_session_download_ram(session, url, (uint8_t**)&out_data->data, &out_data->size);
-    http_session_end(session);
-    if (!success) return false;
+    if (!http_cache_download(url, (uint8_t**)&out_data->data, &out_data->size)) return false;
     out_data->json = cJSON_ParseWithLength(out_data->data, out_data->size);
     if (out_data->json == NULL) {
         free(out_data->data);
@@ -111,8 +108,8 @@ bool load_projects(const char* base_url, repository_json_data_t* out_data, const
     return download_and_parse(url, out_data);
 }
 
-bool load_projects_paginated(const char* base_url, repository_json_data_t* out_data, const char* category,
-                             uint32_t offset, uint32_t amount) {
+static void projects_page_url(char* url, size_t url_size, const char* base_url, const char* category,
+                              uint32_t offset, uint32_t amount) {
     char base_uri[64] = {0};
     nvs_settings_get_repo_base_uri(base_uri, sizeof(base_uri), DEFAULT_REPO_BASE_URI);
 
@@ -122,17 +119,44 @@ bool load_projects_paginated(const char* base_url, repository_json_data_t* out_d
         device_name[i] = tolower(device_name[i]);
     }
 
-    char url[256];
     if (category != NULL) {
         sprintf(url, "%s%s/projects?category=%s&offset=%" PRIu32 "&amount=%" PRIu32 "&device=", base_url, base_uri,
                 category, offset, amount);
     } else {
         sprintf(url, "%s%s/projects?offset=%" PRIu32 "&amount=%" PRIu32 "&device=", base_url, base_uri, offset, amount);
     }
-    url_append(url, device_name, sizeof(url));
+    url_append(url, device_name, url_size);
+}
+
+bool load_projects_paginated(const char* base_url, repository_json_data_t* out_data, const char* category,
+                             uint32_t offset, uint32_t amount) {
+    char url[256];
+    projects_page_url(url, sizeof(url), base_url, category, offset, amount);
     return download_and_parse(url, out_data);
 }
 
+bool load_project_records(const char* base_url, const char* category, uint32_t offset, uint32_t amount,
+                          repository_project_t** out_projects, size_t* out_count, size_t* out_entries) {
+    char url[256];
+    projects_page_url(url, sizeof(url), base_url, category, offset, amount);
+
+    // The listing is projected while it streams in from the server or the cache, only the records are kept
+    repository_projection_t* projection = malloc(sizeof(repository_projection_t));
+    if (projection == NULL) return false;
+    repository_projection_begin(projection);
+    http_stream_sink_t sink       = repository_projection_sink(projection);
+    bool               downloaded = http_cache_download_stream(url, &sink);
+    if (!downloaded) {
+        projection->failed = true;  // Makes repository_projection_end free whatever was projected
+    }
+    bool success = repository_projection_end(projection, out_projects, out_count);
+    if (success && out_entries != NULL) {
+        *out_entries = projection->entries;
+    }
+    free(projection);
+    return success;
+}
+
 bool load_project(const char* base_url, repository_json_data_t* out_data, const char* project_slug) {
     char base_uri[64] = {0};
     nvs_settings_get_repo_base_uri(base_uri, sizeof(base_uri), DEFAULT_REPO_BASE_URI);
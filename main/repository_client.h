@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "cJSON.h"
+#include "repository_projection.h"
 
 typedef struct {
     char*  data;
@@ -16,4 +17,9 @@ bool load_categories(const char* base_url, repository_json_data_t* out_data);
 bool load_projects(const char* base_url, repository_json_data_t* out_data, const char* category);
 bool load_projects_paginated(const char* base_url, repository_json_data_t* out_data, const char* category,
                              uint32_t offset, uint32_t amount);
+// Fetches a page of the project listing as compact records instead of a cJSON tree, free them with
+// repository_projection_free. out_entries receives the number of entries the server sent, entries that could not
+// be projected are counted as well, so it tells where the next page starts. It may be NULL.
+bool load_project_records(const char* base_url, const char* category, uint32_t offset, uint32_t amount,
+                          repository_project_t** out_projects, size_t* out_count, size_t* out_entries);
 bool load_project(const char* base_url, repository_json_data_t* out_data, const char* project_slug);
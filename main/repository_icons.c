@@ -0,0 +1,467 @@
+#include "repository_icons.h"
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "esp_log.h"
+#include "fastopen.h"
+#include "filesystem_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "http_download.h"
+#include "mbedtls/base64.h"
+#include "pax_codecs.h"
+#include "pax_gfx.h"
+#include "repository_client.h"
+#include "sys/unistd.h"
+
+static const char* TAG = "Repository icons";
+
+#define ICON_CACHE_SD_PATH    "/sd/cache/icons"
+#define ICON_CACHE_INT_PATH   "/int/cache/icons"
+#define ICON_CACHE_MAGIC      0x4E434952  // "RICN"
+#define ICON_CACHE_MAX_FILES  512
+#define ICON_WORKER_STACK     8192
+#define ICON_WORKER_MAX_COUNT 4
+#define ICON_DATA_PATH_SIZE   128
+#define ICON_CACHE_PATH_SIZE  64
+
+typedef struct {
+    uint32_t magic;
+    uint16_t width;
+    uint16_t height;
+    uint32_t format;
+    uint32_t size;  // Size of the pixel data following the header, 4 bytes per pixel
+} icon_cache_header_t;
+
+typedef struct {
+    char* slug;
+    char* version;
+    char* inline_icon;  // Base64 encoded PNG embedded in the project listing
+    char* icon_file;    // Name of the 32x32 icon in the repository
+} icon_job_t;
+
+typedef struct {
+    icon_job_t*       jobs;
+    pax_buf_t**       icons;  // Icons handed out to the menu, only used by the task that called begin
+    pax_buf_t**       ready;  // Icons finished by the workers and not picked up yet
+    size_t            count;
+    size_t            next;     // Index of the next job to hand out
+    size_t            pending;  // Number of icons in ready
+    size_t            active;   // Workers that have not exited yet
+    size_t            started;
+    volatile bool     stop;
+    SemaphoreHandle_t mutex;            // Protects next, ready, pending and active, taken by the UI as well
+    SemaphoreHandle_t data_path_mutex;  // Protects the data path, only taken by workers
+    SemaphoreHandle_t workers_done;     // Given by every worker when it exits
+
+    pax_buf_type_t format;
+    int            width;
+    int            height;
+    bool           download;
+    bool           disk_cache;
+    const char*    cache_directory;
+    char           server[128];
+    char           data_path[ICON_DATA_PATH_SIZE];
+    bool           data_path_resolved;
+} repository_icons_t;
+
+static repository_icons_t state = {0};
+
+static char* strdup_or_null(const char* value) {
+    return (value != NULL) ? strdup(value) : NULL;
+}
+
+static pax_buf_t* create_placeholder(void) {
+    pax_buf_t* icon = calloc(1, sizeof(pax_buf_t));
+    if (icon == NULL) return NULL;
+    pax_buf_init(icon, NULL, state.width, state.height, state.format);
+    pax_background(icon, 0x00000000);
+    return icon;
+}
+
+static void destroy_icon(pax_buf_t* icon) {
+    if (icon == NULL) return;
+    pax_buf_destroy(icon);
+    free(icon);
+}
+
+static pax_buf_t* decode_png(const uint8_t* data, size_t size) {
+    pax_buf_t* icon = calloc(1, sizeof(pax_buf_t));
+    if (icon == NULL) return NULL;
+    if (!pax_decode_png_buf(icon, data, size, state.format, 0)) {
+        free(icon);
+        return NULL;
+    }
+    return icon;
+}
+
+static pax_buf_t* decode_base64_icon(const char* base64_data) {
+    size_t b64_len     = strlen(base64_data);
+    size_t decoded_len = 0;
+    if (mbedtls_base64_decode(NULL, 0, &decoded_len, (const unsigned char*)base64_data, b64_len) !=
+        MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL) {
+        return NULL;
+    }
+
+    uint8_t* png_data = malloc(decoded_len);
+    if (png_data == NULL) return NULL;
+
+    size_t     actual_len = 0;
+    pax_buf_t* icon       = NULL;
+    if (mbedtls_base64_decode(png_data, decoded_len, &actual_len, (const unsigned char*)base64_data, b64_len) == 0) {
+        icon = decode_png(png_data, actual_len);
+    }
+    free(png_data);
+    return icon;
+}
+
+// Disk cache
+
+static const char* get_cache_directory(void) {
+    if (fs_utils_exists("/sd") && fs_utils_mkdir_recursive(ICON_CACHE_SD_PATH, false) == ESP_OK) {
+        return ICON_CACHE_SD_PATH;
+    }
+    if (fs_utils_mkdir_recursive(ICON_CACHE_INT_PATH, false) == ESP_OK) {
+        return ICON_CACHE_INT_PATH;
+    }
+    return NULL;
+}
+
+// Entries are named after a 64-bit FNV-1a hash of the slug and version, a new version gets a new entry
+static bool get_cache_path(const icon_job_t* job, char* out_path, size_t path_size) {
+    if (state.cache_directory == NULL) return false;
+    uint64_t    hash    = 0xcbf29ce484222325ULL;
+    const char* parts[] = {job->slug, "@", job->version != NULL ? job->version : ""};
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+        for (const char* c = parts[i]; *c != '\0'; c++) {
+            hash ^= (uint8_t)*c;
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    int res = snprintf(out_path, path_size, "%s/%016" PRIx64 ".icn", state.cache_directory, hash);
+    return res > 0 && res < path_size;
+}
+
+static pax_buf_t* cache_load(const icon_job_t* job) {
+    char path[ICON_CACHE_PATH_SIZE];
+    if (!get_cache_path(job, path, sizeof(path))) return NULL;
+    FILE* fd = fastopen(path, "rb");
+    if (fd == NULL) return NULL;
+
+    icon_cache_header_t header = {0};
+    pax_buf_t*          icon   = NULL;
+    if (fread(&header, sizeof(header), 1, fd) == 1 && header.magic == ICON_CACHE_MAGIC &&
+        header.format == (uint32_t)state.format && header.width > 0 && header.height > 0) {
+        icon = calloc(1, sizeof(pax_buf_t));
+        if (icon != NULL) {
+            pax_buf_init(icon, NULL, header.width, header.height, state.format);
+            if ((size_t)header.width * header.height * 4 != header.size ||
+                fread(pax_buf_get_pixels_rw(icon), 1, header.size, fd) != header.size) {
+                destroy_icon(icon);
+                icon = NULL;
+            }
+        }
+    }
+    fastclose(fd);
+    return icon;
+}
+
+static void cache_store(const icon_job_t* job, pax_buf_t* icon) {
+    char path[ICON_CACHE_PATH_SIZE];
+    if (!state.disk_cache || !get_cache_path(job, path, sizeof(path))) return;
+    FILE* fd = fastopen(path, "wb");
+    if (fd == NULL) return;
+
+    icon_cache_header_t header = {
+        .magic  = ICON_CACHE_MAGIC,
+        .width  = pax_buf_get_width(icon),
+        .height = pax_buf_get_height(icon),
+        .format = (uint32_t)state.format,
+        .size   = (uint32_t)pax_buf_get_width(icon) * pax_buf_get_height(icon) * 4,
+    };
+    bool ok = fwrite(&header, sizeof(header), 1, fd) == 1;
+    ok      = ok && fwrite(pax_buf_get_pixels(icon), 1, header.size, fd) == header.size;
+    fastclose(fd);
+    if (!ok) {
+        unlink(path);
+    }
+}
+
+typedef struct {
+    char   name[24];
+    time_t mtime;
+} icon_cache_file_t;
+
+static int compare_mtime(const void* a, const void* b) {
+    const icon_cache_file_t* file_a = (const icon_cache_file_t*)a;
+    const icon_cache_file_t* file_b = (const icon_cache_file_t*)b;
+    return (file_a->mtime > file_b->mtime) - (file_a->mtime < file_b->mtime);
+}
+
+// Icons of old versions are never read again, the oldest entries are removed once the cache holds too many
+static void cache_prune(void) {
+    DIR* dir = opendir(state.cache_directory);
+    if (dir == NULL) return;
+
+    icon_cache_file_t* files    = NULL;
+    size_t             count    = 0;
+    size_t             capacity = 0;
+    struct dirent*     dirent;
+    while ((dirent = readdir(dir)) != NULL) {
+        if (strlen(dirent->d_name) >= sizeof(files[0].name) || strstr(dirent->d_name, ".icn") == NULL) continue;
+        if (count >= capacity) {
+            size_t             new_capacity = capacity ? capacity * 2 : 64;
+            icon_cache_file_t* new_files    = realloc(files, new_capacity * sizeof(icon_cache_file_t));
+            if (new_files == NULL) break;
+            files    = new_files;
+            capacity = new_capacity;
+        }
+        char        path[ICON_CACHE_PATH_SIZE];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", state.cache_directory, dirent->d_name);
+        if (stat(path, &st) != 0) continue;
+        strcpy(files[count].name, dirent->d_name);
+        files[count].mtime = st.st_mtime;
+        count++;
+    }
+    closedir(dir);
+
+    if (count > ICON_CACHE_MAX_FILES) {
+        qsort(files, count, sizeof(icon_cache_file_t), compare_mtime);
+        for (size_t i = 0; i < count - ICON_CACHE_MAX_FILES; i++) {
+            char path[ICON_CACHE_PATH_SIZE];
+            snprintf(path, sizeof(path), "%s/%s", state.cache_directory, files[i].name);
+            unlink(path);
+        }
+    }
+    free(files);
+}
+
+// Downloading
+
+// The data path is requested from the repository once, by the first worker that needs it. The request blocks, so
+// it is made under a mutex of its own: other workers wait for the result, the UI polling the icons does not.
+static bool get_data_path(char* out_data_path) {
+    xSemaphoreTake(state.data_path_mutex, portMAX_DELAY);
+    if (!state.data_path_resolved) {
+        state.data_path_resolved = true;
+
+        repository_json_data_t info = {0};
+        if (load_information(state.server, &info)) {
+            cJSON* data_path = cJSON_GetObjectItem(info.json, "data_path");
+            if (data_path != NULL && cJSON_IsString(data_path)) {
+                snprintf(state.data_path, sizeof(state.data_path), "%s", data_path->valuestring);
+            }
+            free_repository_data_json(&info);
+        }
+    }
+    strcpy(out_data_path, state.data_path);
+    xSemaphoreGive(state.data_path_mutex);
+    return out_data_path[0] != '\0';
+}
+
+static pax_buf_t* download_icon(http_session_t* session, const icon_job_t* job) {
+    char data_path[ICON_DATA_PATH_SIZE];
+    if (!get_data_path(data_path)) return NULL;
+
+    char url[384];
+    snprintf(url, sizeof(url), "%s%s/%s/%s", state.server, data_path, job->slug, job->icon_file);
+    if (*session == NULL) {
+        *session = http_session_begin(url);
+        if (*session == NULL) return NULL;
+    }
+
+    uint8_t*   png_data = NULL;
+    size_t     png_size = 0;
+    pax_buf_t* icon     = NULL;
+    if (http_session_download_ram(*session, url, &png_data, &png_size) && png_data != NULL) {
+        icon = decode_png(png_data, png_size);
+    }
+    free(png_data);
+    return icon;
+}
+
+static bool has_work(size_t index) {
+    const icon_job_t* job = &state.jobs[index];
+    return state.icons[index] != NULL && (job->inline_icon != NULL || (state.download && job->icon_file != NULL));
+}
+
+static void repository_icons_worker_task(void* arg) {
+    http_session_t session = NULL;
+
+    while (!state.stop) {
+        xSemaphoreTake(state.mutex, portMAX_DELAY);
+        size_t index = state.next;
+        while (index < state.count && !has_work(index)) {
+            index++;
+        }
+        state.next = index + 1;
+        xSemaphoreGive(state.mutex);
+        if (index >= state.count) break;
+
+        const icon_job_t* job  = &state.jobs[index];
+        pax_buf_t*        icon = state.disk_cache ? cache_load(job) : NULL;
+        if (icon == NULL) {
+            if (job->inline_icon != NULL) {
+                icon = decode_base64_icon(job->inline_icon);
+            }
+            if (icon == NULL && job->icon_file != NULL && state.download) {
+                icon = download_icon(&session, job);
+            }
+            if (icon != NULL) {
+                cache_store(job, icon);
+            }
+        }
+
+        if (icon != NULL) {
+            xSemaphoreTake(state.mutex, portMAX_DELAY);
+            state.ready[index] = icon;
+            state.pending++;
+            xSemaphoreGive(state.mutex);
+        }
+    }
+
+    http_session_end(session);
+    xSemaphoreTake(state.mutex, portMAX_DELAY);
+    state.active--;
+    xSemaphoreGive(state.mutex);
+    xSemaphoreGive(state.workers_done);
+    vTaskDelete(NULL);
+}
+
+static void free_state(void) {
+    for (size_t i = 0; i < state.count; i++) {
+        if (state.jobs != NULL) {
+            free(state.jobs[i].slug);
+            free(state.jobs[i].version);
+            free(state.jobs[i].inline_icon);
+            free(state.jobs[i].icon_file);
+        }
+        if (state.icons != NULL) destroy_icon(state.icons[i]);
+        if (state.ready != NULL) destroy_icon(state.ready[i]);
+    }
+    free(state.jobs);
+    free(state.icons);
+    free(state.ready);
+    if (state.mutex != NULL) vSemaphoreDelete(state.mutex);
+    if (state.data_path_mutex != NULL) vSemaphoreDelete(state.data_path_mutex);
+    if (state.workers_done != NULL) vSemaphoreDelete(state.workers_done);
+    memset(&state, 0, sizeof(state));
+}
+
+static bool create_job(const repository_project_t* project, icon_job_t* job) {
+    job->slug        = strdup(project->slug);
+    job->version     = (project->version[0] != '\0') ? strdup(project->version) : NULL;
+    job->inline_icon = strdup_or_null(project->inline_icon);
+    job->icon_file   = (project->icon_file[0] != '\0') ? strdup(project->icon_file) : NULL;
+    return job->slug != NULL;
+}
+
+bool repository_icons_begin(repository_project_t* const* projects, size_t count, const char* server,
+                            pax_buf_type_t format, int width, int height, bool download, bool disk_cache) {
+    repository_icons_end();
+
+    if (count == 0) return false;
+
+    state.count           = count;
+    state.format          = format;
+    state.width           = width;
+    state.height          = height;
+    state.download        = download;
+    state.jobs            = calloc(count, sizeof(icon_job_t));
+    state.icons           = calloc(count, sizeof(pax_buf_t*));
+    state.ready           = calloc(count, sizeof(pax_buf_t*));
+    state.mutex           = xSemaphoreCreateMutex();
+    state.data_path_mutex = xSemaphoreCreateMutex();
+    state.workers_done    = xSemaphoreCreateCounting(ICON_WORKER_MAX_COUNT, 0);
+    snprintf(state.server, sizeof(state.server), "%s", server);
+    if (state.jobs == NULL || state.icons == NULL || state.ready == NULL || state.mutex == NULL ||
+        state.data_path_mutex == NULL || state.workers_done == NULL) {
+        free_state();
+        return false;
+    }
+
+    // Placeholders keep the list aligned while icons are loading. Without downloads only projects with an
+    // embedded icon get one, like before icons were loaded in the background.
+    size_t work = 0;
+    for (size_t index = 0; index < count; index++) {
+        icon_job_t* job = &state.jobs[index];
+        if (create_job(projects[index], job) && (download || job->inline_icon != NULL)) {
+            state.icons[index] = create_placeholder();
+            if (has_work(index)) {
+                work++;
+            }
+        }
+    }
+    if (work == 0) return true;
+
+    if (disk_cache) {
+        state.cache_directory = get_cache_directory();
+        state.disk_cache      = state.cache_directory != NULL;
+    }
+
+    size_t workers = (CONFIG_DOWNLOAD_POOL_WORKERS < ICON_WORKER_MAX_COUNT) ? CONFIG_DOWNLOAD_POOL_WORKERS
+                                                                             : ICON_WORKER_MAX_COUNT;
+    if (workers > work) workers = work;
+    xSemaphoreTake(state.mutex, portMAX_DELAY);
+    for (size_t i = 0; i < workers; i++) {
+        state.active++;
+        if (xTaskCreate(repository_icons_worker_task, "repo_icons", ICON_WORKER_STACK, NULL, 4, NULL) != pdPASS) {
+            state.active--;
+            ESP_LOGW(TAG, "Failed to start icon worker %u", i);
+            break;
+        }
+        state.started++;
+    }
+    xSemaphoreGive(state.mutex);
+    if (state.started == 0) {
+        ESP_LOGE(TAG, "No icon workers could be started");
+    }
+    return true;
+}
+
+void repository_icons_end(void) {
+    if (state.mutex == NULL) return;
+    state.stop = true;
+    for (size_t i = 0; i < state.started; i++) {
+        xSemaphoreTake(state.workers_done, portMAX_DELAY);
+    }
+    if (state.disk_cache) {
+        cache_prune();
+    }
+    free_state();
+}
+
+pax_buf_t* repository_icons_get(int index) {
+    if (state.icons == NULL || index < 0 || (size_t)index >= state.count) return NULL;
+    return state.icons[index];
+}
+
+bool repository_icons_update(void) {
+    if (state.mutex == NULL) return false;
+    xSemaphoreTake(state.mutex, portMAX_DELAY);
+    bool changed = state.pending > 0;
+    for (size_t i = 0; i < state.count && state.pending > 0; i++) {
+        if (state.ready[i] != NULL) {
+            destroy_icon(state.icons[i]);
+            state.icons[i] = state.ready[i];
+            state.ready[i] = NULL;
+            state.pending--;
+        }
+    }
+    xSemaphoreGive(state.mutex);
+    return changed;
+}
+
+bool repository_icons_busy(void) {
+    if (state.mutex == NULL) return false;
+    xSemaphoreTake(state.mutex, portMAX_DELAY);
+    bool busy = state.active > 0 || state.pending > 0;
+    xSemaphoreGive(state.mutex);
+    return busy;
+}
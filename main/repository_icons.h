@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "pax_types.h"
+#include "repository_projection.h"
+
+// Icons of the projects in a repository listing. Every project gets a placeholder up front and the actual icons
+// are filled in by background workers while the list is already in use: from the on-disk cache of decoded icons,
+// keyed by slug and version, from the base64 icon embedded in the listing or by downloading the icon from the
+// repository. Icons that had to be decoded are written to the cache, so a later visit needs no PNG decoding. The
+// cache stores raw pixels of 32-bit formats, disk_cache has to be false for other formats.
+
+// Starts loading icons for the given projects, icons are indexed by their position in that array
+bool repository_icons_begin(repository_project_t* const* projects, size_t count, const char* server,
+                            pax_buf_type_t format, int width, int height, bool download, bool disk_cache);
+// Stops the workers and frees every icon, the menu must no longer reference them
+void repository_icons_end(void);
+
+pax_buf_t* repository_icons_get(int index);
+// Hands icons finished by the workers over to the caller's task. Replaced placeholders are freed, so menu items
+// referring to them have to be updated with repository_icons_get before the next render. Returns true when any
+// icon changed.
+bool repository_icons_update(void);
+// Indication that workers are still loading icons
+bool repository_icons_busy(void);
@@ -0,0 +1,202 @@
+#include "repository_list.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "repository_client.h"
+
+static const char* TAG = "Repository list";
+
+static void free_page(repository_list_page_t* page) {
+    repository_projection_free(page->projects, page->count);
+    page->projects = NULL;
+    page->count    = 0;
+}
+
+// Fetches amount entries of the listing from offset and adds the matching projects to the start or the end of the
+// page. Returns the number of entries the server sent in entries, fewer than requested at the end of the listing.
+static bool fetch_entries(repository_list_t* list, uint32_t offset, uint32_t amount, bool prepend,
+                          repository_list_page_t* page, size_t* entries) {
+    repository_project_t* records = NULL;
+    size_t                count   = 0;
+    if (!load_project_records(list->server, list->category, offset, amount, &records, &count, entries)) {
+        ESP_LOGE(TAG, "Failed to load projects %" PRIu32 " to %" PRIu32, offset, offset + amount - 1);
+        return false;
+    }
+
+    size_t matching = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (records[i].is_plugin == list->plugins) {
+            records[matching++] = records[i];
+        } else {
+            free(records[i].inline_icon);
+        }
+    }
+    if (matching == 0) {
+        free(records);
+        return true;
+    }
+
+    repository_project_t* projects = realloc(page->projects, sizeof(repository_project_t) * (page->count + matching));
+    if (projects == NULL) {
+        repository_projection_free(records, matching);
+        return false;
+    }
+    if (prepend) {
+        memmove(&projects[matching], projects, sizeof(repository_project_t) * page->count);
+        memcpy(projects, records, sizeof(repository_project_t) * matching);
+    } else {
+        memcpy(&projects[page->count], records, sizeof(repository_project_t) * matching);
+    }
+    page->projects  = projects;
+    page->count    += matching;
+    free(records);
+    return true;
+}
+
+// Filters the listing from source_offset on until the page is full or the listing ends
+static bool fetch_page_after(repository_list_t* list, uint32_t offset, uint32_t source_offset,
+                             repository_list_page_t* out_page, bool* out_end) {
+    memset(out_page, 0, sizeof(repository_list_page_t));
+    out_page->offset        = offset;
+    out_page->source_offset = source_offset;
+    out_page->source_end    = source_offset;
+    *out_end                = false;
+    while (out_page->count < REPOSITORY_LIST_PAGE_SIZE && !*out_end) {
+        size_t entries = 0;
+        if (!fetch_entries(list, out_page->source_end, REPOSITORY_LIST_PAGE_SIZE, false, out_page, &entries)) {
+            free_page(out_page);
+            return false;
+        }
+        out_page->source_end += entries;
+        *out_end              = entries < REPOSITORY_LIST_PAGE_SIZE;
+    }
+    return true;
+}
+
+// Filters the listing backwards from source_end until the page is full or the start of the listing is reached
+static bool fetch_page_before(repository_list_t* list, uint32_t source_end, repository_list_page_t* out_page) {
+    memset(out_page, 0, sizeof(repository_list_page_t));
+    out_page->source_offset = source_end;
+    out_page->source_end    = source_end;
+    while (out_page->count < REPOSITORY_LIST_PAGE_SIZE && out_page->source_offset > 0) {
+        uint32_t amount = (out_page->source_offset > REPOSITORY_LIST_PAGE_SIZE) ? REPOSITORY_LIST_PAGE_SIZE
+                                                                                 : out_page->source_offset;
+        size_t   entries = 0;
+        if (!fetch_entries(list, out_page->source_offset - amount, amount, true, out_page, &entries)) {
+            free_page(out_page);
+            return false;
+        }
+        out_page->source_offset -= amount;
+    }
+    return true;
+}
+
+bool repository_list_open(repository_list_t* list, const char* server, const char* category, bool plugins) {
+    repository_list_close(list);
+    snprintf(list->server, sizeof(list->server), "%s", server);
+    list->plugins = plugins;
+    if (category != NULL) {
+        list->category = strdup(category);
+        if (list->category == NULL) return false;
+    }
+
+    if (!fetch_page_after(list, 0, 0, &list->pages[0], &list->end_reached)) {
+        repository_list_close(list);
+        return false;
+    }
+    list->page_count = 1;
+    return true;
+}
+
+void repository_list_close(repository_list_t* list) {
+    for (size_t i = 0; i < list->page_count; i++) {
+        free_page(&list->pages[i]);
+    }
+    free(list->category);
+    memset(list, 0, sizeof(repository_list_t));
+}
+
+bool repository_list_load_next(repository_list_t* list) {
+    if (!repository_list_has_next(list)) return false;
+
+    repository_list_page_t* last = &list->pages[list->page_count - 1];
+    repository_list_page_t  page;
+    bool                    end;
+    if (!fetch_page_after(list, last->offset + last->count, last->source_end, &page, &end)) return false;
+
+    if (page.count == 0) {
+        // The rest of the listing holds nothing for this window, extend the last page so it is not scanned again
+        last->source_end  = page.source_end;
+        list->end_reached = true;
+        free_page(&page);
+        return false;
+    }
+
+    if (list->page_count == REPOSITORY_LIST_WINDOW_PAGES) {
+        free_page(&list->pages[0]);
+        memmove(&list->pages[0], &list->pages[1], sizeof(repository_list_page_t) * (list->page_count - 1));
+        list->page_count--;
+    }
+    list->pages[list->page_count++] = page;
+    list->end_reached               = end;
+    return true;
+}
+
+bool repository_list_load_previous(repository_list_t* list) {
+    if (!repository_list_has_previous(list)) return false;
+
+    repository_list_page_t* first = &list->pages[0];
+    repository_list_page_t  page;
+    if (!fetch_page_before(list, first->source_offset, &page)) return false;
+
+    // Every page before the window holds matching projects, the first page starts at the start of the listing
+    if (page.count == 0 || page.count > first->offset) {
+        ESP_LOGE(TAG, "Listing changed while browsing, %u projects found before project %" PRIu32, page.count,
+                 first->offset);
+        free_page(&page);
+        return false;
+    }
+    page.offset = first->offset - page.count;
+
+    if (list->page_count == REPOSITORY_LIST_WINDOW_PAGES) {
+        free_page(&list->pages[list->page_count - 1]);
+        list->page_count--;
+        list->end_reached = false;
+    }
+    memmove(&list->pages[1], &list->pages[0], sizeof(repository_list_page_t) * list->page_count);
+    list->pages[0] = page;
+    list->page_count++;
+    return true;
+}
+
+bool repository_list_has_next(repository_list_t* list) {
+    return list->page_count > 0 && !list->end_reached;
+}
+
+bool repository_list_has_previous(repository_list_t* list) {
+    return list->page_count > 0 && list->pages[0].offset > 0;
+}
+
+uint32_t repository_list_first(repository_list_t* list) {
+    return (list->page_count > 0) ? list->pages[0].offset : 0;
+}
+
+size_t repository_list_count(repository_list_t* list) {
+    size_t count = 0;
+    for (size_t i = 0; i < list->page_count; i++) {
+        count += list->pages[i].count;
+    }
+    return count;
+}
+
+repository_project_t* repository_list_get(repository_list_t* list, uint32_t index) {
+    for (size_t i = 0; i < list->page_count; i++) {
+        repository_list_page_t* page = &list->pages[i];
+        if (index >= page->offset && index < page->offset + page->count) {
+            return &page->projects[index - page->offset];
+        }
+    }
+    return NULL;
+}
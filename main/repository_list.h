@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "repository_projection.h"
+
+// Window over the project listing of a repository, holding either the applications or the plugins. The listing is
+// fetched in pages with load_project_records and filtered while it arrives, only a bounded number of consecutive
+// pages of matching projects is kept resident, so memory use does not depend on the size of the catalog.
+//
+// The server cannot filter by type. A page keeps fetching from the listing until it holds at least
+// REPOSITORY_LIST_PAGE_SIZE matching projects or the listing ends, so a sparse view still gets full pages (at the
+// cost of more requests per page) and a window never holds fewer projects than its pages require.
+//
+// Projects are addressed by their index among the matching projects; only indices between repository_list_first
+// and repository_list_first + repository_list_count are available at any time.
+
+#define REPOSITORY_LIST_PAGE_SIZE    20  // Projects requested per request, matching projects per page
+#define REPOSITORY_LIST_WINDOW_PAGES 3   // Pages kept resident
+
+typedef struct {
+    repository_project_t* projects;  // At most 2 * REPOSITORY_LIST_PAGE_SIZE - 1
+    uint32_t              offset;    // Index of the first project of the page among the matching projects
+    size_t                count;
+    uint32_t              source_offset;  // Range of the complete listing the page was filtered from
+    uint32_t              source_end;
+} repository_list_page_t;
+
+typedef struct {
+    char                   server[128];
+    char*                  category;
+    bool                   plugins;                              // Holds plugins instead of applications
+    repository_list_page_t pages[REPOSITORY_LIST_WINDOW_PAGES];  // Consecutive pages, ordered by offset
+    size_t                 page_count;
+    bool                   end_reached;  // The last resident page ends with the listing
+} repository_list_t;
+
+// Fetches the first page of the applications or the plugins of the listing, the window holds only that page
+bool repository_list_open(repository_list_t* list, const char* server, const char* category, bool plugins);
+void repository_list_close(repository_list_t* list);
+
+// Appends the page following the window, dropping the first page when the window is full. Returns false at the
+// end of the listing or when the page could not be fetched.
+bool repository_list_load_next(repository_list_t* list);
+// Prepends the page preceding the window, dropping the last page when the window is full
+bool repository_list_load_previous(repository_list_t* list);
+
+bool     repository_list_has_next(repository_list_t* list);
+bool     repository_list_has_previous(repository_list_t* list);
+uint32_t repository_list_first(repository_list_t* list);
+size_t   repository_list_count(repository_list_t* list);
+// Returns the project at the given index among the matching projects, NULL when it is not resident
+repository_project_t* repository_list_get(repository_list_t* list, uint32_t index);
@@ -0,0 +1,279 @@
+#include "repository_projection.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "bsp/device.h"
+#include "esp_log.h"
+#include "json_stream.h"
+
+static const char* TAG = "Repository projection";
+
+#define ENTRY_DEPTH        2  // Depth of the project entries, inside the array of the listing
+#define APPLICATION_PATH   "project.application[]"
+#define APPLICATION_TYPE   "project.application[].type"
+#define APPLICATION_TARGET "project.application[].targets[]"
+#define INLINE_ICON_PATH   "icon"
+
+// Values copied into the fixed size fields of a record, paths are relative to the project entry
+typedef struct {
+    const char* path;
+    size_t      offset;
+    size_t      size;
+} projection_field_t;
+
+static const projection_field_t fields[] = {
+    {"slug", offsetof(repository_project_t, slug), REPOSITORY_PROJECT_SLUG_SIZE},
+    {"project.name", offsetof(repository_project_t, name), REPOSITORY_PROJECT_NAME_SIZE},
+    {"project.version", offsetof(repository_project_t, version), REPOSITORY_PROJECT_VERSION_SIZE},
+    {"project.icon.32x32", offsetof(repository_project_t, icon_file), REPOSITORY_PROJECT_ICON_FILE_SIZE},
+};
+
+static void copy_value(char* destination, size_t size, const char* value, size_t length) {
+    if (length >= size) {
+        length = size - 1;
+    }
+    memcpy(destination, value, length);
+    destination[length] = '\0';
+}
+
+static bool path_is(repository_projection_t* projection, const char* path) {
+    return projection->ignored_depth == 0 && strcmp(projection->path, path) == 0;
+}
+
+static void path_truncate(repository_projection_t* projection, size_t length) {
+    projection->path[length] = '\0';
+}
+
+static void path_append(repository_projection_t* projection, const char* separator, const char* segment,
+                        size_t length) {
+    size_t current = strlen(projection->path);
+    size_t needed  = current + strlen(separator) + length;
+    if (needed >= REPOSITORY_PROJECTION_MAX_PATH) {
+        // Nothing below this point can match a field, it is skipped until the parser leaves it
+        if (projection->ignored_depth == 0) {
+            projection->ignored_depth = projection->depth;
+        }
+        return;
+    }
+    strcpy(&projection->path[current], separator);
+    memcpy(&projection->path[current + strlen(separator)], segment, length);
+    projection->path[needed] = '\0';
+}
+
+// Values inside an array all share the path of the array
+static void enter_value(repository_projection_t* projection) {
+    size_t depth = projection->depth;
+    if (depth > 0 && projection->stream.containers[depth - 1] == '[') {
+        path_truncate(projection, projection->path_lengths[depth]);
+    }
+}
+
+static void leave_container(repository_projection_t* projection) {
+    if (projection->ignored_depth != 0 && projection->depth <= projection->ignored_depth) {
+        projection->ignored_depth = 0;
+    }
+    projection->depth--;
+}
+
+static bool add_project(repository_projection_t* projection) {
+    repository_project_t* project = &projection->current;
+    if (project->slug[0] == '\0' || project->name[0] == '\0') {
+        ESP_LOGE(TAG, "Skipping project %u without slug or name", projection->count);
+        free(project->inline_icon);
+        return true;
+    }
+    if (projection->count >= projection->capacity) {
+        size_t                capacity = projection->capacity ? projection->capacity * 2 : 16;
+        repository_project_t* projects = realloc(projection->projects, sizeof(repository_project_t) * capacity);
+        if (projects == NULL) {
+            free(project->inline_icon);
+            return false;
+        }
+        projection->projects = projects;
+        projection->capacity = capacity;
+    }
+    projection->projects[projection->count++] = *project;
+    return true;
+}
+
+static bool on_object_begin(void* arg) {
+    repository_projection_t* projection = arg;
+    if (projection->depth == 0) return false;  // The listing is an array of projects
+    enter_value(projection);
+    projection->depth++;
+    projection->path_lengths[projection->depth] = strlen(projection->path);
+
+    if (projection->depth == ENTRY_DEPTH) {
+        memset(&projection->current, 0, sizeof(repository_project_t));
+        projection->has_current       = true;
+        projection->application_found = false;
+    } else if (path_is(projection, APPLICATION_PATH)) {
+        projection->application_type[0] = '\0';
+        projection->application_matches = false;
+    }
+    return true;
+}
+
+static bool on_object_end(void* arg) {
+    repository_projection_t* projection = arg;
+    bool                     result     = true;
+    path_truncate(projection, projection->path_lengths[projection->depth]);
+
+    if (projection->depth == ENTRY_DEPTH) {
+        result                  = add_project(projection);
+        projection->has_current = false;
+        projection->entries++;
+    } else if (path_is(projection, APPLICATION_PATH) && projection->application_matches &&
+               !projection->application_found) {
+        // The first application targeting this device decides what kind of project it is
+        projection->application_found = true;
+        projection->current.is_plugin = strcmp(projection->application_type, "plugin") == 0;
+    }
+    leave_container(projection);
+    return result;
+}
+
+static bool on_array_begin(void* arg) {
+    repository_projection_t* projection = arg;
+    enter_value(projection);
+    projection->depth++;
+    if (projection->depth > ENTRY_DEPTH) {
+        path_append(projection, "", "[]", 2);
+    }
+    projection->path_lengths[projection->depth] = strlen(projection->path);
+    return true;
+}
+
+static bool on_array_end(void* arg) {
+    leave_container(arg);
+    return true;
+}
+
+static bool on_key(const char* key, size_t length, void* arg) {
+    repository_projection_t* projection = arg;
+    if (projection->depth < ENTRY_DEPTH) return true;
+    if (projection->ignored_depth == projection->depth) {
+        projection->ignored_depth = 0;
+    }
+    size_t base = projection->path_lengths[projection->depth];
+    path_truncate(projection, base);
+    path_append(projection, base > 0 ? "." : "", key, length);
+    return true;
+}
+
+static bool on_value(json_stream_type_t type, const char* value, size_t length, void* arg) {
+    repository_projection_t* projection = arg;
+    enter_value(projection);
+    if (projection->depth < ENTRY_DEPTH || projection->ignored_depth != 0) return true;
+    if (type != JSON_STREAM_STRING && type != JSON_STREAM_NUMBER) return true;
+
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        if (strcmp(projection->path, fields[i].path) == 0) {
+            copy_value((char*)&projection->current + fields[i].offset, fields[i].size, value, length);
+            return true;
+        }
+    }
+
+    if (type != JSON_STREAM_STRING) return true;
+    if (strcmp(projection->path, INLINE_ICON_PATH) == 0) {
+        free(projection->current.inline_icon);
+        projection->current.inline_icon = strdup(value);
+        return projection->current.inline_icon != NULL;
+    } else if (strcmp(projection->path, APPLICATION_TYPE) == 0) {
+        copy_value(projection->application_type, sizeof(projection->application_type), value, length);
+    } else if (strcmp(projection->path, APPLICATION_TARGET) == 0) {
+        if (strcasecmp(value, projection->device_name) == 0) {
+            projection->application_matches = true;
+        }
+    }
+    return true;
+}
+
+void repository_projection_begin(repository_projection_t* projection) {
+    memset(projection, 0, sizeof(repository_projection_t));
+    projection->handler = (json_stream_handler_t){
+        .object_begin = on_object_begin,
+        .object_end   = on_object_end,
+        .array_begin  = on_array_begin,
+        .array_end    = on_array_end,
+        .key          = on_key,
+        .value        = on_value,
+        .arg          = projection,
+    };
+    bsp_device_get_name(projection->device_name, sizeof(projection->device_name));
+    json_stream_init(&projection->stream, &projection->handler);
+}
+
+bool repository_projection_feed(repository_projection_t* projection, const char* data, size_t length) {
+    if (projection->failed) return false;
+    if (!json_stream_feed(&projection->stream, data, length)) {
+        projection->failed = true;
+    }
+    return !projection->failed;
+}
+
+bool repository_projection_end(repository_projection_t* projection, repository_project_t** out_projects,
+                               size_t* out_count) {
+    bool success = !projection->failed && json_stream_finish(&projection->stream);
+    json_stream_free(&projection->stream);
+    if (projection->has_current) {
+        free(projection->current.inline_icon);  // Entry of an incomplete listing
+    }
+
+    if (!success) {
+        ESP_LOGE(TAG, "Failed to parse project listing");
+        repository_projection_free(projection->projects, projection->count);
+        projection->projects = NULL;
+        projection->count    = 0;
+        return false;
+    }
+
+    *out_projects        = projection->projects;
+    *out_count           = projection->count;
+    projection->projects = NULL;
+    projection->count    = 0;
+    return true;
+}
+
+// Frees what was projected so far and begins again
+static void restart(repository_projection_t* projection) {
+    json_stream_free(&projection->stream);
+    if (projection->has_current) {
+        free(projection->current.inline_icon);
+    }
+    repository_projection_free(projection->projects, projection->count);
+    repository_projection_begin(projection);
+}
+
+static bool sink_begin(size_t size, void* arg) {
+    return true;  // The projection was begun by the caller or restarted by the end of a failed attempt
+}
+
+static bool sink_write(const uint8_t* data, size_t length, size_t offset, void* arg) {
+    return repository_projection_feed((repository_projection_t*)arg, (const char*)data, length);
+}
+
+static bool sink_end(bool success, void* arg) {
+    repository_projection_t* projection = (repository_projection_t*)arg;
+    if (!success) {
+        restart(projection);
+        return true;  // The next attempt starts over
+    }
+    if (json_stream_finish(&projection->stream)) return true;
+    // A listing that ends early is rejected by the download, so the cache does not store it either
+    restart(projection);
+    return false;
+}
+
+http_stream_sink_t repository_projection_sink(repository_projection_t* projection) {
+    return (http_stream_sink_t){.begin = sink_begin, .write = sink_write, .end = sink_end, .arg = projection};
+}
+
+void repository_projection_free(repository_project_t* projects, size_t count) {
+    for (size_t i = 0; i < count && projects != NULL; i++) {
+        free(projects[i].inline_icon);
+    }
+    free(projects);
+}
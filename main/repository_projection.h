@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "http_download.h"
+#include "json_stream.h"
+
+// Projection of a repository project listing onto compact records. The listing is parsed with json_stream and
+// only the fields below are kept, so the memory needed for a listing is that of the records instead of a complete
+// cJSON tree. Strings longer than their field are truncated. Entries without a slug or name are skipped.
+
+#define REPOSITORY_PROJECT_SLUG_SIZE      48
+#define REPOSITORY_PROJECT_NAME_SIZE      64
+#define REPOSITORY_PROJECT_VERSION_SIZE   24
+#define REPOSITORY_PROJECT_ICON_FILE_SIZE 64
+
+typedef struct {
+    char  slug[REPOSITORY_PROJECT_SLUG_SIZE];
+    char  name[REPOSITORY_PROJECT_NAME_SIZE];
+    char  version[REPOSITORY_PROJECT_VERSION_SIZE];      // Numeric versions are kept as written
+    char  icon_file[REPOSITORY_PROJECT_ICON_FILE_SIZE];  // Name of the 32x32 icon in the repository
+    char* inline_icon;                                   // Base64 encoded PNG embedded in the listing or NULL
+    bool  is_plugin;  // The application for this device is a launcher plugin
+} repository_project_t;
+
+#define REPOSITORY_PROJECTION_MAX_PATH 96
+
+typedef struct {
+    json_stream_t         stream;
+    json_stream_handler_t handler;
+    repository_project_t* projects;
+    size_t                count;
+    size_t                capacity;
+    size_t                entries;  // Entries in the listing, including the skipped ones
+    repository_project_t  current;
+    bool                  has_current;
+    size_t                depth;
+    char                  path[REPOSITORY_PROJECTION_MAX_PATH];  // Path of the current value below the entry
+    size_t                path_lengths[JSON_STREAM_MAX_DEPTH];   // Length of path where every container started
+    size_t                ignored_depth;  // Depth below which keys did not fit in path, 0 when none
+    char                  device_name[32];
+    char                  application_type[16];
+    bool                  application_matches;
+    bool                  application_found;
+    bool                  failed;
+} repository_projection_t;
+
+// The listing can be fed in chunks of any size as it arrives
+void repository_projection_begin(repository_projection_t* projection);
+bool repository_projection_feed(repository_projection_t* projection, const char* data, size_t length);
+// Completes the listing and hands the records over to the caller, free them with repository_projection_free
+bool repository_projection_end(repository_projection_t* projection, repository_project_t** out_projects,
+                               size_t* out_count);
+
+// Stream sink feeding the listing to a begun projection as it is downloaded. An attempt that fails drops what was
+// projected so far and the next attempt starts over, a listing that ends early fails the download. Complete the
+// listing with repository_projection_end once the download returned, whether it succeeded or not.
+http_stream_sink_t repository_projection_sink(repository_projection_t* projection);
+
+void repository_projection_free(repository_project_t* projects, size_t count);
@@ -0,0 +1,278 @@
+#include "statusbar.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "bsp/power.h"
+#include "common/device.h"
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdcard.h"
+#include "sdkconfig.h"
+#include "usb_device.h"
+#include "wifi_connection.h"
+
+#ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
+#include "plugin_events.h"
+#include "plugin_manager.h"
+#endif
+
+#if defined(CONFIG_BSP_TARGET_TANMATSU)
+#include "bsp/tanmatsu.h"
+#include "tanmatsu_coprocessor.h"
+#endif
+
+static const char* TAG = "Statusbar";
+
+#define STATUSBAR_TICK_MS           1000
+#define STATUSBAR_TASK_STACK        4096
+#define STATUSBAR_POWER_LOW_PERCENT 10
+
+extern bool wifi_stack_get_initialized(void);
+
+typedef struct {
+    void (*sample)(statusbar_snapshot_t* snapshot);
+    uint32_t interval;  // In ticks of the sampler task
+} statusbar_source_t;
+
+static SemaphoreHandle_t    mutex     = NULL;  // Protects published
+static statusbar_snapshot_t published = {0};
+
+static void sample_clock(statusbar_snapshot_t* snapshot) {
+    if (!device_has_rtc()) {
+        return;
+    }
+    time_t     now      = time(NULL);
+    struct tm* timeinfo = localtime(&now);
+    strftime(snapshot->clock, sizeof(snapshot->clock), "%H:%M", timeinfo);
+}
+
+static void sample_battery(statusbar_snapshot_t* snapshot) {
+    bsp_power_battery_information_t information = {0};
+    if (bsp_power_get_battery_information(&information) != ESP_OK) {
+        snapshot->battery_valid = false;
+        return;
+    }
+    snapshot->battery_valid      = true;
+    snapshot->battery_available  = information.battery_available;
+    snapshot->battery_charging   = information.battery_charging;
+    snapshot->battery_percentage = (uint8_t)information.remaining_percentage;
+    snapshot->battery_fault      = false;
+    snapshot->power_supply       = information.power_supply_available;
+
+#if defined(CONFIG_BSP_TARGET_TANMATSU)
+    if (snapshot->battery_available && !snapshot->battery_charging) {
+        tanmatsu_coprocessor_handle_t coprocessor_handle = NULL;
+        bsp_tanmatsu_coprocessor_get_handle(&coprocessor_handle);
+        tanmatsu_coprocessor_pmic_faults_t faults = {0};
+        tanmatsu_coprocessor_get_pmic_faults(coprocessor_handle, &faults);
+        snapshot->battery_fault = faults.watchdog || faults.chrg_input || faults.chrg_thermal || faults.chrg_safety ||
+                                  faults.batt_ovp || faults.ntc_cold || faults.ntc_hot;
+    }
+#endif
+}
+
+static void sample_usb(statusbar_snapshot_t* snapshot) {
+    if (device_has_usb_switching()) {
+        snapshot->usb_mode = usb_mode_get();
+    }
+}
+
+static void sample_wifi(statusbar_snapshot_t* snapshot) {
+    snapshot->radio_state      = BSP_POWER_RADIO_STATE_OFF;
+    snapshot->wifi_initialized = false;
+    snapshot->wifi_mode        = WIFI_MODE_NULL;
+    snapshot->wifi_connected   = false;
+    snapshot->wifi_signal      = 0;
+    memset(snapshot->wifi_ssid, 0, sizeof(snapshot->wifi_ssid));
+
+    bsp_power_get_radio_state(&snapshot->radio_state);
+    if (snapshot->radio_state == BSP_POWER_RADIO_STATE_OFF ||
+        snapshot->radio_state == BSP_POWER_RADIO_STATE_BOOTLOADER) {
+        return;
+    }
+
+    wifi_mode_t mode = WIFI_MODE_NULL;
+    if (!wifi_stack_get_initialized() || esp_wifi_get_mode(&mode) != ESP_OK) {
+        return;
+    }
+    snapshot->wifi_initialized = true;
+    snapshot->wifi_mode        = mode;
+
+    wifi_ap_record_t connected_ap = {0};
+    if ((mode == WIFI_MODE_STA || mode == WIFI_MODE_APSTA) && wifi_connection_is_connected() &&
+        esp_wifi_sta_get_ap_info(&connected_ap) == ESP_OK) {
+        snapshot->wifi_connected = true;
+        if (connected_ap.rssi > -50) {
+            snapshot->wifi_signal = 4;
+        } else if (connected_ap.rssi > -60) {
+            snapshot->wifi_signal = 3;
+        } else if (connected_ap.rssi > -70) {
+            snapshot->wifi_signal = 2;
+        } else if (connected_ap.rssi > -80) {
+            snapshot->wifi_signal = 1;
+        }
+        strncpy(snapshot->wifi_ssid, (char*)connected_ap.ssid, sizeof(snapshot->wifi_ssid) - 1);
+    }
+}
+
+static void sample_sdcard(statusbar_snapshot_t* snapshot) {
+    if (device_has_sdcard()) {
+        snapshot->sd_status = sd_status();
+    }
+}
+
+// The battery state and PMIC faults are read from the coprocessor over I2C and change slowly, the other sources
+// are cheap to read. The clock only shows minutes but is polled every tick to follow the minute change closely.
+static const statusbar_source_t sources[] = {
+    {sample_clock, 1},
+    {sample_battery, 5},
+    {sample_usb, 1},
+    {sample_wifi, 2},
+    {sample_sdcard, 1},
+};
+
+#ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
+// The sampler already notices these changes, plugins get them as events instead of polling themselves
+static void publish_events(const statusbar_snapshot_t* previous, const statusbar_snapshot_t* sample) {
+    if (sample->wifi_connected != previous->wifi_connected) {
+        if (sample->wifi_connected) {
+            plugin_events_publish(PLUGIN_EVENT_WIFI_CONNECTED, 0, sample->wifi_ssid);
+        } else {
+            plugin_events_publish(PLUGIN_EVENT_WIFI_DISCONNECTED, 0, NULL);
+        }
+    }
+
+    if (!sample->battery_valid) {
+        return;
+    }
+    // Only changes are published, not the state found by the first sample
+    if (previous->battery_valid && sample->power_supply != previous->power_supply) {
+        plugin_events_publish(sample->power_supply ? PLUGIN_EVENT_USB_CONNECTED : PLUGIN_EVENT_USB_DISCONNECTED, 0,
+                              NULL);
+    }
+
+    if (!sample->battery_available) {
+        return;
+    }
+    if (sample->battery_percentage != previous->battery_percentage ||
+        sample->battery_charging != previous->battery_charging) {
+        plugin_events_publish(PLUGIN_EVENT_BATTERY_CHANGED, sample->battery_percentage,
+                              sample->battery_charging ? "charging" : NULL);
+    }
+    bool low     = !sample->battery_charging && sample->battery_percentage <= STATUSBAR_POWER_LOW_PERCENT;
+    bool was_low = previous->battery_valid && !previous->battery_charging &&
+                   previous->battery_percentage <= STATUSBAR_POWER_LOW_PERCENT;
+    if (low && !was_low) {
+        plugin_events_publish(PLUGIN_EVENT_POWER_LOW, sample->battery_percentage, NULL);
+    }
+}
+#endif
+
+static void sample_all(statusbar_snapshot_t* snapshot) {
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++) {
+        sources[i].sample(snapshot);
+    }
+}
+
+static void statusbar_task(void* pvParameters) {
+    // Only this task writes the snapshot, it keeps its own copy to compare samples against. Copies use memcpy so
+    // the padding compared by memcmp is copied as well.
+    statusbar_snapshot_t current;
+    memcpy(&current, &published, sizeof(statusbar_snapshot_t));
+    TickType_t last_wake = xTaskGetTickCount();
+    uint32_t   tick      = 0;
+
+    while (1) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(STATUSBAR_TICK_MS));
+        tick++;
+
+        statusbar_snapshot_t sample;
+        memcpy(&sample, &current, sizeof(statusbar_snapshot_t));
+        for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++) {
+            if (tick % sources[i].interval == 0) {
+                sources[i].sample(&sample);
+            }
+        }
+
+        bool changed = memcmp(&sample, &current, sizeof(statusbar_snapshot_t)) != 0;
+#ifdef CONFIG_ENABLE_LAUNCHERPLUGINS
+        if (changed) {
+            publish_events(&current, &sample);
+        }
+        // Plugin widgets draw whatever they like, while any is registered the statusbar is redrawn every tick
+        changed |= plugin_api_has_status_widgets();
+#endif
+        if (!changed) {
+            continue;
+        }
+
+        sample.version++;
+        memcpy(&current, &sample, sizeof(statusbar_snapshot_t));
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        published = current;
+        xSemaphoreGive(mutex);
+    }
+}
+
+esp_err_t statusbar_start(void) {
+    if (mutex != NULL) {
+        return ESP_OK;
+    }
+
+    memset(&published, 0, sizeof(statusbar_snapshot_t));
+    sample_all(&published);
+    published.version = 1;
+
+    mutex = xSemaphoreCreateMutex();
+    if (mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreatePinnedToCore(statusbar_task, TAG, STATUSBAR_TASK_STACK, NULL, tskIDLE_PRIORITY + 1, NULL,
+                                CONFIG_SOC_CPU_CORES_NUM - 1) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start sampler task");
+        vSemaphoreDelete(mutex);
+        mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void statusbar_get_snapshot(statusbar_snapshot_t* out_snapshot) {
+    if (mutex == NULL) {
+        memset(out_snapshot, 0, sizeof(statusbar_snapshot_t));
+        sample_all(out_snapshot);
+        return;
+    }
+    // The sampler only holds the lock while copying, the slow reads of the sources happen outside of it
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    *out_snapshot = published;
+    xSemaphoreGive(mutex);
+}
+
+uint32_t statusbar_get_version(void) {
+    if (mutex == NULL) {
+        return 0;
+    }
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    uint32_t version = published.version;
+    xSemaphoreGive(mutex);
+    return version;
+}
+
+bool statusbar_changed(uint32_t* last_version) {
+    if (mutex == NULL) {
+        return true;  // Without the sampler every redraw polls the sources, as before
+    }
+    uint32_t version = statusbar_get_version();
+    if (version == *last_version) {
+        return false;
+    }
+    *last_version = version;
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bsp/power.h"
+#include "esp_err.h"
+#include "esp_wifi_types_generic.h"
+#include "sdcard.h"
+#include "usb_device.h"
+
+// State shown in the statusbar. A low priority task polls every source at its own rate and publishes the result as
+// a snapshot, so rendering the statusbar never talks to the coprocessor or the radio. The version of the snapshot
+// only changes when one of the fields changes, menus compare it to decide whether the statusbar needs a redraw.
+
+typedef struct {
+    uint32_t          version;   // Incremented whenever one of the other fields changes
+    char              clock[6];  // "HH:MM", empty on devices without a real time clock
+    bool              battery_valid;
+    bool              battery_available;
+    bool              battery_charging;
+    bool              battery_fault;  // The PMIC reports a charger or battery fault
+    bool              power_supply;   // A power supply is connected to the USB port
+    uint8_t           battery_percentage;
+    usb_mode_t        usb_mode;
+    bsp_radio_state_t radio_state;
+    bool              wifi_initialized;  // The WiFi stack is running and wifi_mode is valid
+    wifi_mode_t       wifi_mode;
+    bool              wifi_connected;
+    uint8_t           wifi_signal;  // Bars from 0 to 4
+    char              wifi_ssid[33];
+    sd_status_t       sd_status;
+} statusbar_snapshot_t;
+
+esp_err_t statusbar_start(void);
+
+// Copies the latest snapshot, before the sampler is started the sources are polled directly
+void     statusbar_get_snapshot(statusbar_snapshot_t* out_snapshot);
+uint32_t statusbar_get_version(void);
+// Returns true when the snapshot changed since the version stored in last_version, and stores the current version
+bool     statusbar_changed(uint32_t* last_version);
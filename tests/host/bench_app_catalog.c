@@ -0,0 +1,332 @@
+// App list benchmark (app_metadata_parser.c, app_catalog.c)
+// Times create_list_of_apps on a generated tree of apps on the internal filesystem and the SD card, with AppFS
+// entries for the apps that have one. A cold scan finds no catalog and parses every metadata.json and decodes every
+// icon, which is what the launcher did for every scan before the catalog. A warm scan restores the apps from the
+// catalog file the cold scan stored, like the first scan after a reboot, and a repeated scan from the records the
+// catalog keeps in memory, like opening the app list again. The apps of all three have to be identical, and an app
+// whose metadata changed has to be parsed again.
+//
+// Every scan runs in a child process, so the catalog starts out unloaded like after a reboot. The files are read
+// from the page cache of the host, so this compares the work of parsing and restoring, not the time the filesystem
+// takes to read them.
+
+#include <png.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "app_catalog.h"
+#include "app_favorite.h"
+#include "app_metadata_parser.h"
+#include "bsp/device.h"
+#include "host_appfs.h"
+#include "host_test.h"
+#include "icons.h"
+#include "pax_gfx.h"
+
+#define INT_APPS       40
+#define SD_APPS        60
+#define SD_OVERRIDES   10  // SD apps with the slug of an internal one, which only update its executable
+#define APPFS_ONLY     5   // AppFS entries without an app directory
+#define DIRECTORY_APPS (INT_APPS + SD_APPS - SD_OVERRIDES)
+#define LIST_SIZE      256
+#define ITERATIONS     20
+#define ICON_SIZE      32
+
+typedef struct {
+    uint64_t            nanoseconds;
+    uint64_t            repeated_nanoseconds;  // Second scan of the same process, from the records in memory
+    size_t              count;
+    uint64_t            digest;
+    uint64_t            repeated_digest;
+    app_catalog_stats_t stats;
+    app_catalog_stats_t repeated_stats;
+} scan_t;
+
+// Stand-ins for the launcher parts create_list_of_apps uses
+
+static pax_buf_t default_icon = {.width = ICON_SIZE, .height = ICON_SIZE};
+
+pax_buf_t* get_icon(icon_t icon) {
+    return &default_icon;
+}
+
+size_t app_favorite_get_all(char (*out_slugs)[APP_MAX_SLUG_SIZE], size_t max_slugs) {
+    size_t count = 0;
+    for (int i = 0; i < INT_APPS && count < max_slugs; i += 7) {
+        snprintf(out_slugs[count++], APP_MAX_SLUG_SIZE, "int_app_%02d", i);
+    }
+    return count;
+}
+
+esp_err_t app_autostart_get(char* out_slug) {
+    snprintf(out_slug, APP_MAX_SLUG_SIZE, "sd_app_%02d", 3);
+    return ESP_OK;
+}
+
+// Generated app tree
+
+static void write_file(const char* path, const void* data, size_t length) {
+    FILE* fd = fopen(path, "wb");
+    if (fd == NULL || fwrite(data, 1, length, fd) != length) {
+        fprintf(stderr, "Failed to write %s\n", path);
+        exit(1);
+    }
+    fclose(fd);
+}
+
+static void write_icon(const char* path, uint32_t seed) {
+    uint8_t pixels[ICON_SIZE * ICON_SIZE * 4];
+    for (size_t i = 0; i < sizeof(pixels); i++) {
+        seed      = seed * 1103515245 + 12345;
+        pixels[i] = (uint8_t)(seed >> 16);
+    }
+    png_image image = {
+        .version = PNG_IMAGE_VERSION,
+        .width   = ICON_SIZE,
+        .height  = ICON_SIZE,
+        .format  = PNG_FORMAT_RGBA,
+    };
+    if (!png_image_write_to_file(&image, path, 0, pixels, 0, NULL)) {
+        fprintf(stderr, "Failed to write %s: %s\n", path, image.message);
+        exit(1);
+    }
+}
+
+// Metadata like the apps of the repository, with the executables of several devices. Every third app is an ELF and
+// every fifth a script, the others are AppFS apps with their binary stored next to the metadata.
+static const char metadata_format[] =
+    "{\n"
+    "  \"name\": \"App %d\",\n"
+    "  \"description\": \"Generated app %d, described in about as many words as the apps in the repository are, "
+    "with \\\"quotes\\\" and an \\u00e9.\",\n"
+    "  \"categories\": [\"Games\", \"Utility\"],\n"
+    "  \"author\": \"Author %d\",\n"
+    "  \"license_type\": \"MIT\",\n"
+    "  \"license_file\": \"LICENSE\",\n"
+    "  \"repository\": \"https://github.com/example/app-%d\",\n"
+    "  \"version\": \"%d.%d.0\",\n"
+    "  \"icon\": {\"16x16\": \"icon16.png\", \"32x32\": \"icon32.png\", \"64x64\": \"icon64.png\"},\n"
+    "  \"application\": [\n"
+    "    {\"targets\": [\"mch2022\"], \"type\": \"appfs\", \"revision\": 1, \"executable\": \"mch2022.bin\"},\n"
+    "    {\"targets\": [\"kami\", \"tanmatsu\"], \"type\": \"%s\", \"revision\": %d, \"executable\": \"main.bin\", "
+    "\"interpreter\": \"python\"}\n"
+    "  ]\n"
+    "}\n";
+
+static void write_app(const char* root, const char* slug, int index, int version) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", root, slug);
+    mkdir(path, 0755);
+
+    const char* type = (index % 3 == 0) ? "elf" : (index % 5 == 0) ? "script" : "appfs";
+    char        metadata[2048];
+    int         length = snprintf(metadata, sizeof(metadata), metadata_format, index, index, index, index, version,
+                                  index, type, version);
+    snprintf(path, sizeof(path), "%s/%s/metadata.json", root, slug);
+    write_file(path, metadata, length);
+
+    snprintf(path, sizeof(path), "%s/%s/icon32.png", root, slug);
+    write_icon(path, index * 31 + version);
+
+    if (strcmp(type, "appfs") == 0) {
+        uint8_t binary[4096];
+        memset(binary, index, sizeof(binary));
+        snprintf(path, sizeof(path), "%s/%s/main.bin", root, slug);
+        write_file(path, binary, sizeof(binary));
+        host_appfs_add(slug, slug, version, binary, sizeof(binary));
+    }
+}
+
+static void generate(void) {
+    char slug[APP_MAX_SLUG_SIZE];
+    if (system("rm -rf " APPS_INT_DIR " " APPS_SD_DIR " && mkdir -p " APPS_INT_DIR " " APPS_SD_DIR) != 0) {
+        fprintf(stderr, "Failed to create the app tree\n");
+        exit(1);
+    }
+    host_appfs_reset();
+    for (int i = 0; i < INT_APPS; i++) {
+        snprintf(slug, sizeof(slug), "int_app_%02d", i);
+        write_app(APPS_INT_DIR, slug, i, 1);
+    }
+    for (int i = 0; i < SD_APPS; i++) {
+        if (i < SD_OVERRIDES) {
+            snprintf(slug, sizeof(slug), "int_app_%02d", i);
+        } else {
+            snprintf(slug, sizeof(slug), "sd_app_%02d", i);
+        }
+        write_app(APPS_SD_DIR, slug, INT_APPS + i, 2);
+    }
+    for (int i = 0; i < APPFS_ONLY; i++) {
+        uint8_t binary[1024] = {0};
+        snprintf(slug, sizeof(slug), "appfs_only_%d", i);
+        host_appfs_add(slug, "main.bin", 1, binary, sizeof(binary));
+    }
+}
+
+// Scanning
+
+static uint64_t hash(uint64_t digest, const void* data, size_t length) {
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        digest = (digest ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    return digest;
+}
+
+static uint64_t hash_string(uint64_t digest, const char* value) {
+    return (value != NULL) ? hash(digest, value, strlen(value) + 1) : hash(digest, "\xff", 1);
+}
+
+// Everything the launcher shows or starts an app by
+static uint64_t digest_apps(app_t** apps, size_t count) {
+    uint64_t digest = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < count; i++) {
+        const app_t* app = apps[i];
+        digest           = hash_string(digest, app->path);
+        digest           = hash_string(digest, app->slug);
+        digest           = hash_string(digest, app->name);
+        digest           = hash_string(digest, app->description);
+        for (int category = 0; category < APP_MAX_NUM_CATEGORIES; category++) {
+            digest = hash_string(digest, app->categories[category]);
+        }
+        digest = hash_string(digest, app->version);
+        digest = hash_string(digest, app->icon_path);
+        digest = hash_string(digest, app->author);
+        digest = hash_string(digest, app->license_type);
+        digest = hash_string(digest, app->license_file);
+        digest = hash_string(digest, app->repository);
+        digest = hash_string(digest, app->executable_filename);
+        digest = hash_string(digest, app->executable_interpreter_slug);
+        digest = hash_string(digest, app->executable_on_fs_filename);
+
+        uint32_t values[] = {app->executable_type,           app->executable_revision,
+                             (uint32_t)app->executable_appfs_fd, app->executable_on_fs_available,
+                             app->executable_on_fs_revision, (uint32_t)app->executable_on_fs_filesize,
+                             app->favorite,                  app->autostart};
+        digest            = hash(digest, values, sizeof(values));
+
+        if (app->icon == NULL) {
+            fprintf(stderr, "App %s has no icon\n", app->slug);
+            exit(1);
+        }
+        int width  = pax_buf_get_width(app->icon);
+        int height = pax_buf_get_height(app->icon);
+        digest     = hash(digest, &width, sizeof(width));
+        digest     = hash(digest, &height, sizeof(height));
+        digest     = hash(digest, pax_buf_get_pixels(app->icon), (size_t)width * height * 4);
+    }
+    return digest;
+}
+
+// Scans into a cleared list like the app menu does, the lookup of SD apps that override internal ones walks all of it
+static void scan_once(app_t** apps, uint64_t* out_nanoseconds, uint64_t* out_digest, app_catalog_stats_t* out_stats,
+                      size_t* out_count) {
+    memset(apps, 0, LIST_SIZE * sizeof(app_t*));
+    uint64_t start   = host_time_ns();
+    size_t   count   = create_list_of_apps(apps, LIST_SIZE);
+    *out_nanoseconds = host_time_ns() - start;
+    *out_digest      = digest_apps(apps, count);
+    *out_count       = count;
+    app_catalog_get_stats(out_stats);
+    free_list_of_apps(apps, count);
+}
+
+static scan_t scan(bool cold) {
+    if (cold) {
+        remove(CATALOG_PATH);
+    }
+
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+        perror("pipe");
+        exit(1);
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        static app_t* apps[LIST_SIZE];
+        scan_t        result = {0};
+        size_t        repeated_count;
+        scan_once(apps, &result.nanoseconds, &result.digest, &result.stats, &result.count);
+        scan_once(apps, &result.repeated_nanoseconds, &result.repeated_digest, &result.repeated_stats, &repeated_count);
+        if (repeated_count != result.count) {
+            result.count = 0;
+        }
+        _exit(write(pipe_fds[1], &result, sizeof(result)) == sizeof(result) ? 0 : 1);
+    }
+
+    scan_t result = {0};
+    int    status = 0;
+    close(pipe_fds[1]);
+    bool ok = pid > 0 && read(pipe_fds[0], &result, sizeof(result)) == sizeof(result);
+    close(pipe_fds[0]);
+    if (pid > 0) {
+        waitpid(pid, &status, 0);
+    }
+    if (!ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "Scan failed\n");
+        exit(1);
+    }
+    return result;
+}
+
+static void expect(bool condition, const char* what) {
+    if (!condition) {
+        fprintf(stderr, "%s\n", what);
+        exit(1);
+    }
+}
+
+// Cold, warm and repeated scans list the same apps, and a changed app is parsed again
+static void verify(void) {
+    scan_t cold = scan(true);
+    expect(cold.count == DIRECTORY_APPS + APPFS_ONLY, "The cold scan did not list every app");
+    expect(cold.stats.misses == DIRECTORY_APPS && cold.stats.hits == 0, "The cold scan did not parse every app");
+    expect(cold.repeated_stats.hits == DIRECTORY_APPS && cold.repeated_stats.misses == 0,
+           "The repeated scan did not restore every app");
+    expect(cold.repeated_digest == cold.digest, "The repeated scan listed different apps");
+
+    scan_t warm = scan(false);
+    expect(warm.count == cold.count, "The warm scan listed a different number of apps");
+    expect(warm.stats.hits == DIRECTORY_APPS && warm.stats.misses == 0, "The warm scan did not restore every app");
+    expect(warm.digest == cold.digest, "The warm scan listed different apps");
+
+    // A new version of an app, of the same size but written a second later so its modification time differs
+    char slug[APP_MAX_SLUG_SIZE];
+    snprintf(slug, sizeof(slug), "sd_app_%02d", SD_OVERRIDES);
+    sleep(1);
+    write_app(APPS_SD_DIR, slug, INT_APPS + SD_OVERRIDES, 3);
+    scan_t changed = scan(false);
+    expect(changed.stats.hits == DIRECTORY_APPS - 1 && changed.stats.misses == 1,
+           "The app that changed was not parsed again");
+    expect(changed.digest != warm.digest, "The app that changed was restored from the catalog");
+}
+
+int main(void) {
+    generate();
+    verify();
+
+    double cold = 0, warm = 0, repeated = 0;
+    for (int i = 0; i < ITERATIONS; i++) {
+        cold += scan(true).nanoseconds / 1e6 / ITERATIONS;
+    }
+    for (int i = 0; i < ITERATIONS; i++) {
+        scan_t result  = scan(false);
+        warm          += result.nanoseconds / 1e6 / ITERATIONS;
+        repeated      += result.repeated_nanoseconds / 1e6 / ITERATIONS;
+    }
+
+    struct stat catalog;
+    stat(CATALOG_PATH, &catalog);
+    printf("%d apps in directories, %d in AppFS only, catalog of %lld bytes, %d iterations\n", DIRECTORY_APPS,
+           APPFS_ONLY, (long long)catalog.st_size, ITERATIONS);
+    printf("  cold scan, parsed        %8.3f ms\n", cold);
+    printf("  warm scan, catalog file  %8.3f ms\n", warm);
+    printf("  repeated scan, memory    %8.3f ms\n", repeated);
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Sample rate converter quality and cost benchmark
+// Converts a 1 kHz sine with the windowed sinc filter and with linear interpolation, reports THD+N over one second
+// of output and the time and cycles spent per output sample.
+
+#include <math.h>
+#include <stdio.h>
+#include "audio_convert.h"
+#include "host_test.h"
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#define AMPLITUDE     0.5
+#define FREQUENCY     1000   // Whole Hz, so the tone lands on an exact bin of the one second window
+#define SETTLE_FRAMES 1024   // Output frames skipped while the filter history fills
+#define OUTPUT_FRAMES 50000  // Settle time plus one second at the highest output rate
+#define INPUT_FRAMES  100000
+#define CHUNK_FRAMES  256    // Pushed at a time, like the mixer pulls a chunk per stream
+#define ITERATIONS    20
+
+static int16_t input[INPUT_FRAMES * 2];
+static int16_t output[OUTPUT_FRAMES * 2];
+
+static uint64_t cycles(void) {
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Converts `frames` input frames of the sine, returns the number of output frames
+static size_t convert(audio_resampler_t resampler, uint32_t input_rate, uint32_t output_rate, size_t frames) {
+    audio_format_t    format    = {.rate          = input_rate,
+                                   .channels      = 2,
+                                   .sample_format = AUDIO_SAMPLE_S16,
+                                   .resampler     = resampler};
+    audio_converter_t converter = audio_converter_create(&format, output_rate);
+    if (converter == NULL) {
+        printf("failed to create a converter for %u -> %u Hz\n", input_rate, output_rate);
+        exit(1);
+    }
+    size_t pushed   = 0;
+    size_t produced = 0;
+    while (pushed < frames && produced < OUTPUT_FRAMES) {
+        size_t chunk  = frames - pushed < CHUNK_FRAMES ? frames - pushed : CHUNK_FRAMES;
+        size_t bytes  = audio_converter_push(converter, &input[pushed * 2], chunk * 2 * sizeof(int16_t));
+        pushed       += bytes / (2 * sizeof(int16_t));
+        produced     += audio_converter_pull(converter, &output[produced * 2], OUTPUT_FRAMES - produced);
+    }
+    audio_converter_free(converter);
+    return produced;
+}
+
+// Noise and distortion relative to the tone over the second after the settle time: the power left over after
+// taking out the tone, found with the Goertzel algorithm on its exact bin
+static double thd_n_db(uint32_t output_rate) {
+    const int16_t* window = &output[SETTLE_FRAMES * 2];
+    double         coeff  = 2.0 * cos(2.0 * M_PI * FREQUENCY / output_rate);
+    double         s1 = 0, s2 = 0, total = 0;
+    for (uint32_t f = 0; f < output_rate; f++) {
+        double sample  = window[f * 2];
+        double s0      = sample + coeff * s1 - s2;
+        s2             = s1;
+        s1             = s0;
+        total         += sample * sample;
+    }
+    double amplitude = 2.0 * sqrt(s1 * s1 + s2 * s2 - coeff * s1 * s2) / output_rate;
+    double tone      = amplitude * amplitude / 2.0;
+    double residual  = total / output_rate - tone;
+    return 10.0 * log10((residual > 0 ? residual : 1e-30) / tone);
+}
+
+static void run(const char* name, audio_resampler_t resampler, uint32_t input_rate, uint32_t output_rate) {
+    size_t frames = (size_t)((uint64_t)(SETTLE_FRAMES + output_rate) * input_rate / output_rate) + CHUNK_FRAMES;
+    for (size_t f = 0; f < frames; f++) {
+        int16_t sample   = (int16_t)lrint(AMPLITUDE * 32767.0 * sin(2.0 * M_PI * FREQUENCY * f / input_rate));
+        input[f * 2]     = sample;
+        input[f * 2 + 1] = sample;
+    }
+    if (convert(resampler, input_rate, output_rate, frames) < SETTLE_FRAMES + output_rate) {
+        printf("%s %u -> %u Hz produced too few frames\n", name, input_rate, output_rate);
+        exit(1);
+    }
+    double quality = thd_n_db(output_rate);
+
+    size_t   produced     = 0;
+    uint64_t start_ns     = host_time_ns();
+    uint64_t start_cycles = cycles();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        produced += convert(resampler, input_rate, output_rate, frames);
+        host_keep(output);
+    }
+    double samples = (double)produced * 2;
+    double ns      = (double)(host_time_ns() - start_ns) / samples;
+    double cost    = (double)(cycles() - start_cycles) / samples;
+    printf("  %-6s %5u -> %5u Hz  THD+N %6.1f dB  %6.2f ns/sample %7.1f cycles/sample\n", name, input_rate,
+           output_rate, quality, ns, cost);
+}
+
+static const uint32_t rates[][2] = {
+    {44100, 48000}, {22050, 48000}, {16000, 48000}, {48000, 44100}, {32000, 44100},
+};
+
+int main(void) {
+    printf("%d Hz sine at %.0f dBFS, stereo S16, %d frame chunks, %d iterations\n", FREQUENCY,
+           20.0 * log10(AMPLITUDE), CHUNK_FRAMES, ITERATIONS);
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        run("sinc", AUDIO_RESAMPLER_SINC, rates[i][0], rates[i][1]);
+        run("linear", AUDIO_RESAMPLER_LINEAR, rates[i][0], rates[i][1]);
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+// Mixer summing and limiter microbenchmark
+// Times one mixer chunk, summing 1 to AUDIO_MIXER_MAX_STREAMS streams and limiting the result, for a mix below
+// the threshold and for a sustained overload where every block is ramped.
+
+#include <stdio.h>
+#include <string.h>
+#include "audio_mix.h"
+#include "host_test.h"
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#define SAMPLE_RATE   44100
+#define CHUNK_FRAMES  256  // MIXER_CHUNK_FRAMES in audio_mixer.c
+#define CHUNK_SAMPLES (CHUNK_FRAMES * 2)
+#define MAX_STREAMS   8    // AUDIO_MIXER_MAX_STREAMS in audio_mixer.h
+#define ITERATIONS    20000
+
+static int16_t streams[MAX_STREAMS][CHUNK_SAMPLES];
+static int32_t accum[CHUNK_SAMPLES];
+static int16_t output[CHUNK_SAMPLES];
+
+static uint64_t cycles(void) {
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void run(const char* name, int count, int16_t amplitude) {
+    uint32_t state = 1;
+    for (int stream = 0; stream < count; stream++) {
+        for (int j = 0; j < CHUNK_SAMPLES; j++) {
+            state              = state * 1664525 + 1013904223;
+            streams[stream][j] = (int16_t)((int32_t)(state >> 16) % (2 * amplitude + 1) - amplitude);
+        }
+    }
+
+    audio_limiter_t limiter;
+    audio_limiter_reset(&limiter);
+    uint64_t start_ns     = host_time_ns();
+    uint64_t start_cycles = cycles();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        memset(accum, 0, sizeof(accum));
+        for (int stream = 0; stream < count; stream++) {
+            // Every other stream at a reduced gain, to time both accumulate paths
+            int32_t gain = stream & 1 ? AUDIO_MIX_GAIN_UNITY / 2 : AUDIO_MIX_GAIN_UNITY;
+            audio_mix_accumulate(accum, streams[stream], CHUNK_SAMPLES, gain);
+        }
+        audio_limiter_process(&limiter, accum, output, CHUNK_FRAMES);
+        host_keep(output);
+    }
+    double ns     = (double)(host_time_ns() - start_ns) / ITERATIONS;
+    double chunk  = (double)(cycles() - start_cycles) / ITERATIONS;
+    double budget = CHUNK_FRAMES * 1e9 / SAMPLE_RATE;
+    printf("  %-10s %d stream(s) %9.1f ns/chunk %9.0f cycles/chunk %6.2f %% of a chunk\n", name, count, ns, chunk,
+           ns * 100 / budget);
+}
+
+int main(void) {
+    printf("%d frame chunks, %d iterations\n", CHUNK_FRAMES, ITERATIONS);
+    for (int count = 1; count <= MAX_STREAMS; count++) {
+        run("quiet", count, 29204 / MAX_STREAMS);
+    }
+    for (int count = 1; count <= MAX_STREAMS; count++) {
+        run("overload", count, INT16_MAX);
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+// Menu storage microbenchmark
+// Times the menu_* operations the launcher uses on a 10000 item menu: appending, the positional lookups
+// menu_render does for every visible row while scrolling, navigation and removal. The same access pattern is run
+// against a doubly linked list walked from the head, the storage gui_menu.c used before, for comparison.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gui_menu.h"
+#include "host_test.h"
+
+#define ITEM_COUNT   10000
+#define VISIBLE_ROWS 12
+#define REMOVE_COUNT 1000
+#define LABEL_MAX    32
+
+// Reference: the linked list storage with a find that walks from the first item
+typedef struct list_item {
+    char*             label;
+    void*             callback_arguments;
+    struct list_item* previous;
+    struct list_item* next;
+} list_item_t;
+
+typedef struct {
+    list_item_t* first;
+    list_item_t* last;
+    size_t       length;
+} list_t;
+
+static list_item_t* list_find(list_t* list, size_t position) {
+    list_item_t* item = list->first;
+    for (size_t index = 0; index < position && item != NULL && item->next != NULL; index++) {
+        item = item->next;
+    }
+    return item;
+}
+
+static void list_append(list_t* list, const char* label, void* callback_arguments) {
+    list_item_t* item        = calloc(1, sizeof(list_item_t));
+    item->label              = strdup(label);
+    item->callback_arguments = callback_arguments;
+    item->previous           = list->last;
+    if (list->last != NULL) {
+        list->last->next = item;
+    } else {
+        list->first = item;
+    }
+    list->last = item;
+    list->length++;
+}
+
+static void list_remove(list_t* list, size_t position) {
+    list_item_t* item = list_find(list, position);
+    if (item->previous != NULL) item->previous->next = item->next;
+    if (item->next != NULL) item->next->previous = item->previous;
+    if (list->first == item) list->first = item->next;
+    if (list->last == item) list->last = item->previous;
+    free(item->label);
+    free(item);
+    list->length--;
+}
+
+static void list_free(list_t* list) {
+    while (list->first != NULL) {
+        list_item_t* next = list->first->next;
+        free(list->first->label);
+        free(list->first);
+        list->first = next;
+    }
+}
+
+static void report(const char* name, uint64_t elapsed_ns, size_t operations) {
+    printf("  %-36s %10.3f ms %10.1f ns/op\n", name, elapsed_ns / 1e6, (double)elapsed_ns / operations);
+}
+
+// Scrolls through the whole menu, looking up every visible row at each position like menu_render does
+static uint64_t scroll_menu(menu_t* menu) {
+    uint64_t start = host_time_ns();
+    for (size_t position = 0; position < ITEM_COUNT; position++) {
+        for (size_t row = 0; row < VISIBLE_ROWS; row++) {
+            host_keep(menu_get_label(menu, position + row));
+        }
+    }
+    return host_time_ns() - start;
+}
+
+static uint64_t scroll_list(list_t* list) {
+    uint64_t start = host_time_ns();
+    for (size_t position = 0; position < ITEM_COUNT; position++) {
+        for (size_t row = 0; row < VISIBLE_ROWS; row++) {
+            host_keep(list_find(list, position + row)->label);
+        }
+    }
+    return host_time_ns() - start;
+}
+
+int main(void) {
+    char label[LABEL_MAX];
+
+    printf("Menu with %d items, %d visible rows\n", ITEM_COUNT, VISIBLE_ROWS);
+
+    menu_t   menu;
+    uint64_t start = host_time_ns();
+    menu_initialize(&menu);
+    for (size_t index = 0; index < ITEM_COUNT; index++) {
+        snprintf(label, sizeof(label), "Item %zu", index);
+        menu_insert_item(&menu, label, NULL, (void*)(uintptr_t)index, -1);
+    }
+    report("menu append", host_time_ns() - start, ITEM_COUNT);
+    REQUIRE(menu_get_length(&menu) == ITEM_COUNT);
+    REQUIRE((uintptr_t)menu_get_callback_args(&menu, ITEM_COUNT / 2) == ITEM_COUNT / 2);
+
+    report("menu scroll (lookup per row)", scroll_menu(&menu), (size_t)ITEM_COUNT * VISIBLE_ROWS);
+
+    start = host_time_ns();
+    for (size_t index = 0; index < ITEM_COUNT; index++) {
+        menu_navigate_next(&menu);
+        host_keep(menu_get_callback_args(&menu, menu_get_position(&menu)));
+    }
+    report("menu navigate next + args", host_time_ns() - start, ITEM_COUNT);
+
+    start = host_time_ns();
+    for (size_t index = 0; index < REMOVE_COUNT; index++) {
+        menu_remove_item(&menu, menu_get_length(&menu) / 2);
+    }
+    report("menu remove from middle", host_time_ns() - start, REMOVE_COUNT);
+    REQUIRE(menu_get_length(&menu) == ITEM_COUNT - REMOVE_COUNT);
+    menu_free(&menu);
+
+    list_t list = {0};
+    start       = host_time_ns();
+    for (size_t index = 0; index < ITEM_COUNT; index++) {
+        snprintf(label, sizeof(label), "Item %zu", index);
+        list_append(&list, label, (void*)(uintptr_t)index);
+    }
+    report("linked list append", host_time_ns() - start, ITEM_COUNT);
+    report("linked list scroll (lookup per row)", scroll_list(&list), (size_t)ITEM_COUNT * VISIBLE_ROWS);
+
+    start = host_time_ns();
+    for (size_t index = 0; index < REMOVE_COUNT; index++) {
+        list_remove(&list, list.length / 2);
+    }
+    report("linked list remove from middle", host_time_ns() - start, REMOVE_COUNT);
+    list_free(&list);
+
+    return 0;
+}
@@ -0,0 +1,357 @@
+// Plugin load benchmark (plugin_loader.c)
+// Times loading a generated plugin the way plugin_manager_load does: linked by kbelf (the stand-in in
+// support/host_kbelf.c) with the load cache cleared before every load, and mapped from the cache entry the first load
+// stored. Built without CONFIG_PLUGIN_LOAD_CACHE it times linking alone, which is what the launcher did before.
+// Every word of a loaded image is checked against what the relocations of the plugin make of it, for both ways of
+// loading, and a changed plugin file has to be linked again instead of mapped from its old entry.
+//
+// The plugin files and the cache entries are read from the page cache of the host, so this compares the work of
+// linking and mapping, not the time flash takes to read them.
+
+#include <malloc.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "host_kbelf.h"
+#include "host_test.h"
+#include "plugin_loader.h"
+
+#define SLUG       "bench"
+#define CACHE_FILE PLUGIN_CACHE_PATH "/" SLUG ".bin"
+#define ITERATIONS 50
+
+// Generated plugin, sized like a status widget with a few screens of its own
+#define EXPORTS        1200  // Symbols of the launcher export table
+#define IMPORTS        300   // Launcher functions the plugin calls through its PLT
+#define DATA_IMPORTS   100   // Launcher addresses stored in plugin data
+#define LOCALS         50    // Plugin functions referenced through their symbol
+#define POINTERS       2000  // Pointers into the plugin itself
+#define INIT_FUNCTIONS 4
+#define FINI_FUNCTIONS 2
+#define TEXT_SIZE      (96 * 1024)
+#define DATA_WORDS     (POINTERS + DATA_IMPORTS + LOCALS + 512)
+#define BSS_SIZE       (16 * 1024)
+#define PAGE_SIZE      4096
+#define DYNAMIC_SIZE   11  // Entries of the dynamic section
+
+#define ELF_PT_LOAD           1
+#define ELF_PT_DYNAMIC        2
+#define ELF_DT_PLTRELSZ       2
+#define ELF_DT_STRTAB         5
+#define ELF_DT_SYMTAB         6
+#define ELF_DT_RELA           7
+#define ELF_DT_RELASZ         8
+#define ELF_DT_JMPREL         23
+#define ELF_DT_INIT_ARRAY     25
+#define ELF_DT_FINI_ARRAY     26
+#define ELF_DT_INIT_ARRAYSZ   27
+#define ELF_DT_FINI_ARRAYSZ   28
+#define ELF_R_RISCV_32        1
+#define ELF_R_RISCV_RELATIVE  3
+#define ELF_R_RISCV_JUMP_SLOT 5
+#define NOT_INTERNAL          UINT32_MAX
+
+typedef struct {
+    uint8_t  ident[16];
+    uint16_t type;
+    uint16_t machine;
+    uint32_t version;
+    uint32_t entry;
+    uint32_t phoff;
+    uint32_t shoff;
+    uint32_t flags;
+    uint16_t ehsize;
+    uint16_t phentsize;
+    uint16_t phnum;
+    uint16_t shentsize;
+    uint16_t shnum;
+    uint16_t shstrndx;
+} elf_header_t;
+
+typedef struct {
+    uint32_t type;
+    uint32_t offset;
+    uint32_t vaddr;
+    uint32_t paddr;
+    uint32_t filesz;
+    uint32_t memsz;
+    uint32_t flags;
+    uint32_t align;
+} elf_program_header_t;
+
+typedef struct {
+    uint32_t offset;
+    uint32_t info;
+    int32_t  addend;
+} elf_rela_t;
+
+typedef struct {
+    uint32_t name;
+    uint32_t value;
+    uint32_t size;
+    uint8_t  info;
+    uint8_t  other;
+    uint16_t shndx;
+} elf_symbol_t;
+
+static host_kbelf_export_t exports[EXPORTS];
+static char                export_names[EXPORTS][32];
+
+// The plugin file, the image starts at virtual address 0 and PAGE_SIZE into the file. Words relocated to point into
+// the image hold the virtual address they point to in `internal`, words bound to the launcher its address in
+// `external`, every other word has to match the file.
+static uint8_t  file[PAGE_SIZE + TEXT_SIZE + 256 * 1024];
+static size_t   file_size;
+static uint32_t internal[(TEXT_SIZE + 256 * 1024) / sizeof(uint32_t)];
+static uint32_t external[(TEXT_SIZE + 256 * 1024) / sizeof(uint32_t)];
+static uint32_t image_size;  // Virtual addresses covered by the segments
+static size_t   relocations;
+
+static void create_exports(void) {
+    static const char* const prefixes[] = {"asp_plugin_", "pax_", "esp_", "lib_"};
+    for (size_t i = 0; i < EXPORTS; i++) {
+        snprintf(export_names[i], sizeof(export_names[i]), "%sfunction_%04zu", prefixes[i % 4], i);
+        exports[i] = (host_kbelf_export_t){.name = export_names[i], .address = 0x40000000 + i * 16};
+    }
+    host_kbelf_set_exports(exports, EXPORTS);
+}
+
+// Appends a relocation making the word at `site` point to `target` in the image
+static void add_internal(elf_rela_t* table, size_t* count, uint32_t site, uint32_t type, uint32_t symbol,
+                         uint32_t target) {
+    int32_t addend                    = type == ELF_R_RISCV_RELATIVE ? (int32_t)target : 0;
+    table[(*count)++]                 = (elf_rela_t){.offset = site, .info = symbol << 8 | type, .addend = addend};
+    internal[site / sizeof(uint32_t)] = target;
+    relocations++;
+}
+
+// Appends a relocation binding the word at `site` to the export `symbol` is resolved to
+static void add_external(elf_rela_t* table, size_t* count, uint32_t site, uint32_t type, uint32_t symbol,
+                         const host_kbelf_export_t* export) {
+    table[(*count)++]                 = (elf_rela_t){.offset = site, .info = symbol << 8 | type};
+    external[site / sizeof(uint32_t)] = export->address;
+    relocations++;
+}
+
+// A position independent ELF32 with a text and a data segment: the data segment holds the symbol and relocation
+// tables, the GOT, data with pointers and the init and fini arrays, followed by bss
+static void generate(uint32_t seed) {
+    memset(file, 0, sizeof(file));
+    memset(internal, 0xFF, sizeof(internal));
+    memset(external, 0, sizeof(external));
+    relocations = 0;
+
+    uint32_t data_vaddr = TEXT_SIZE;
+    uint8_t* text       = &file[PAGE_SIZE];
+    uint32_t state      = seed;
+    for (size_t i = 0; i < TEXT_SIZE; i++) {
+        state   = state * 1664525 + 1013904223;
+        text[i] = state >> 24;
+    }
+
+    // Data segment layout
+    uint32_t symtab    = data_vaddr;
+    uint32_t strtab    = symtab + (1 + IMPORTS + LOCALS) * sizeof(elf_symbol_t);
+    uint32_t rela      = strtab + IMPORTS * 32 + LOCALS * 16;
+    uint32_t rela_size = (POINTERS + DATA_IMPORTS + LOCALS + INIT_FUNCTIONS + FINI_FUNCTIONS) * sizeof(elf_rela_t);
+    uint32_t jmprel    = rela + rela_size;
+    uint32_t got       = jmprel + IMPORTS * sizeof(elf_rela_t);
+    uint32_t words     = got + IMPORTS * sizeof(uint32_t);
+    uint32_t init      = words + DATA_WORDS * sizeof(uint32_t);
+    uint32_t fini      = init + INIT_FUNCTIONS * sizeof(uint32_t);
+    uint32_t dynamic   = fini + FINI_FUNCTIONS * sizeof(uint32_t);
+    uint32_t data_end  = dynamic + DYNAMIC_SIZE * 2 * sizeof(int32_t);
+    image_size         = data_end + BSS_SIZE;
+
+    elf_symbol_t* symbols = (elf_symbol_t*)&file[PAGE_SIZE + symtab];
+    char*         strings = (char*)&file[PAGE_SIZE + strtab];
+    size_t        length  = 1;
+    for (size_t i = 0; i < IMPORTS + LOCALS; i++) {
+        symbols[1 + i].name = length;
+        if (i < IMPORTS) {
+            length += sprintf(&strings[length], "%s", export_names[(i * 37) % EXPORTS]) + 1;
+        } else {
+            length               += sprintf(&strings[length], "widget_%zu", i) + 1;
+            symbols[1 + i].value  = (i * 256) % TEXT_SIZE;
+            symbols[1 + i].shndx  = 1;
+        }
+    }
+
+    elf_rela_t* rela_table   = (elf_rela_t*)&file[PAGE_SIZE + rela];
+    elf_rela_t* jmprel_table = (elf_rela_t*)&file[PAGE_SIZE + jmprel];
+    size_t      rela_count   = 0;
+    size_t      jmprel_count = 0;
+    for (size_t i = 0; i < POINTERS; i++) {
+        uint32_t target = (i % 2 == 0) ? (i * 48) % TEXT_SIZE : words + ((i * 7) % DATA_WORDS) * sizeof(uint32_t);
+        add_internal(rela_table, &rela_count, words + i * sizeof(uint32_t), ELF_R_RISCV_RELATIVE, 0, target);
+    }
+    for (size_t i = 0; i < DATA_IMPORTS; i++) {
+        size_t symbol = (i * 3) % IMPORTS;
+        add_external(rela_table, &rela_count, words + (POINTERS + i) * sizeof(uint32_t), ELF_R_RISCV_32, 1 + symbol,
+                     &exports[(symbol * 37) % EXPORTS]);
+    }
+    for (size_t i = 0; i < LOCALS; i++) {
+        add_internal(rela_table, &rela_count, words + (POINTERS + DATA_IMPORTS + i) * sizeof(uint32_t),
+                     ELF_R_RISCV_32, 1 + IMPORTS + i, symbols[1 + IMPORTS + i].value);
+    }
+    for (size_t i = 0; i < INIT_FUNCTIONS + FINI_FUNCTIONS; i++) {
+        add_internal(rela_table, &rela_count, init + i * sizeof(uint32_t), ELF_R_RISCV_RELATIVE, 0, 1024 * (i + 1));
+    }
+    for (size_t i = 0; i < IMPORTS; i++) {
+        add_external(jmprel_table, &jmprel_count, got + i * sizeof(uint32_t), ELF_R_RISCV_JUMP_SLOT, 1 + i,
+                     &exports[(i * 37) % EXPORTS]);
+    }
+    for (size_t i = POINTERS + DATA_IMPORTS + LOCALS; i < DATA_WORDS; i++) {
+        uint32_t value = 0x5a5a0000 + i;
+        memcpy(&file[PAGE_SIZE + words + i * sizeof(uint32_t)], &value, sizeof(uint32_t));
+    }
+
+    int32_t dynamic_entries[DYNAMIC_SIZE][2] = {
+        {ELF_DT_SYMTAB, symtab},
+        {ELF_DT_STRTAB, strtab},
+        {ELF_DT_RELA, rela},
+        {ELF_DT_RELASZ, rela_size},
+        {ELF_DT_JMPREL, jmprel},
+        {ELF_DT_PLTRELSZ, IMPORTS * sizeof(elf_rela_t)},
+        {ELF_DT_INIT_ARRAY, init},
+        {ELF_DT_INIT_ARRAYSZ, INIT_FUNCTIONS * sizeof(uint32_t)},
+        {ELF_DT_FINI_ARRAY, fini},
+        {ELF_DT_FINI_ARRAYSZ, FINI_FUNCTIONS * sizeof(uint32_t)},
+        {0, 0},
+    };
+    memcpy(&file[PAGE_SIZE + dynamic], dynamic_entries, sizeof(dynamic_entries));
+
+    elf_header_t header = {
+        .ident     = {0x7f, 'E', 'L', 'F', 1, 1, 1},
+        .type      = 3,     // ET_DYN
+        .machine   = 0xF3,  // EM_RISCV
+        .version   = 1,
+        .phoff     = sizeof(elf_header_t),
+        .ehsize    = sizeof(elf_header_t),
+        .phentsize = sizeof(elf_program_header_t),
+        .phnum     = 3,
+    };
+    elf_program_header_t segments[] = {
+        {.type   = ELF_PT_LOAD, .offset = PAGE_SIZE, .filesz = TEXT_SIZE, .memsz = TEXT_SIZE, .flags = 5,
+         .align  = PAGE_SIZE},
+        {.type   = ELF_PT_LOAD, .offset = PAGE_SIZE + data_vaddr, .vaddr = data_vaddr, .filesz = data_end - data_vaddr,
+         .memsz  = image_size - data_vaddr, .flags = 6, .align = PAGE_SIZE},
+        {.type   = ELF_PT_DYNAMIC, .offset = PAGE_SIZE + dynamic, .vaddr = dynamic,
+         .filesz = sizeof(dynamic_entries), .memsz = sizeof(dynamic_entries), .flags = 6, .align = 4},
+    };
+    memcpy(file, &header, sizeof(header));
+    memcpy(&file[sizeof(header)], segments, sizeof(segments));
+    file_size = PAGE_SIZE + data_end;
+}
+
+static void write_plugin(void) {
+    FILE* fd = fopen(PLUGIN_FILE, "wb");
+    if (fd == NULL || fwrite(file, 1, file_size, fd) != file_size) {
+        fprintf(stderr, "Failed to write %s\n", PLUGIN_FILE);
+        exit(1);
+    }
+    fclose(fd);
+}
+
+static plugin_image_t load(void) {
+    plugin_image_t image = plugin_loader_load(PLUGIN_FILE, SLUG);
+    if (image == NULL) {
+        fprintf(stderr, "Failed to load the plugin\n");
+        exit(1);
+    }
+    return image;
+}
+
+// Compares every word of the image with what the relocations make of the plugin file
+static bool image_matches(plugin_image_t image, const char* how) {
+    uintptr_t base = plugin_loader_get_address(image, 0);
+    if (base == 0 || base + image_size > UINT32_MAX) {
+        fprintf(stderr, "Image %s at %#zx is not below 4 GiB\n", how, (size_t)base);
+        exit(1);
+    }
+    for (uint32_t offset = 0; offset < image_size; offset += sizeof(uint32_t)) {
+        uint32_t word;
+        uint32_t want;
+        memcpy(&word, (void*)(base + offset), sizeof(uint32_t));
+        if (internal[offset / sizeof(uint32_t)] != NOT_INTERNAL) {
+            want = base + internal[offset / sizeof(uint32_t)];
+        } else if (external[offset / sizeof(uint32_t)] != 0) {
+            want = external[offset / sizeof(uint32_t)];
+        } else {
+            memcpy(&want, &file[PAGE_SIZE + offset], sizeof(uint32_t));  // Zero past the file contents, the bss
+        }
+        if (word != want) {
+            fprintf(stderr, "Image %s holds %#x at %#x instead of %#x\n", how, word, offset, want);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void verify(void) {
+    remove(CACHE_FILE);
+    plugin_image_t linked = load();
+    bool           ok     = image_matches(linked, "linked by kbelf");
+#ifdef CONFIG_PLUGIN_LOAD_CACHE
+    struct stat entry;
+    ok                    = ok && stat(CACHE_FILE, &entry) == 0;
+    plugin_image_t mapped = load();
+    ok                    = ok && plugin_loader_get_address(mapped, 0) != plugin_loader_get_address(linked, 0) &&
+         image_matches(mapped, "mapped from the cache");
+    plugin_loader_unload(mapped);
+
+    // A new build of the plugin must not be mapped from the entry of the old one
+    generate(2);
+    write_plugin();
+    plugin_image_t changed = load();
+    ok                     = ok && image_matches(changed, "of the changed plugin");
+    plugin_loader_unload(changed);
+    changed = load();
+    ok      = ok && image_matches(changed, "of the changed plugin mapped from the cache");
+    plugin_loader_unload(changed);
+#endif
+    plugin_loader_unload(linked);
+    if (!ok) {
+        fprintf(stderr, "Loaded images do not match the plugin\n");
+        exit(1);
+    }
+}
+
+static double time_loads(bool cached) {
+    uint64_t total = 0;
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        if (!cached) remove(CACHE_FILE);
+        uint64_t       start = host_time_ns();
+        plugin_image_t image = load();
+        total               += host_time_ns() - start;
+        host_keep(image);
+        plugin_loader_unload(image);
+    }
+    return (double)total / ITERATIONS / 1e6;
+}
+
+int main(void) {
+    // The loader keeps 32-bit addresses like on the device. The benchmark is linked without PIE and serves every
+    // allocation from the program break, so images are loaded below 4 GiB.
+    mallopt(M_MMAP_THRESHOLD, 32 * 1024 * 1024);
+    mkdir(PLUGIN_CACHE_PATH, 0755);
+    create_exports();
+    generate(1);
+    write_plugin();
+    verify();
+
+    generate(1);
+    write_plugin();
+    printf("Plugin of %zu bytes, %zu relocations, %d imports from %d exports, %d iterations\n", file_size, relocations,
+           IMPORTS + DATA_IMPORTS, EXPORTS, ITERATIONS);
+#ifdef CONFIG_PLUGIN_LOAD_CACHE
+    printf("  linked and stored      %8.3f ms\n", time_loads(false));
+    printf("  mapped from the cache  %8.3f ms\n", time_loads(true));
+#else
+    printf("  linked                 %8.3f ms (without the load cache)\n", time_loads(false));
+#endif
+    remove(CACHE_FILE);
+    return 0;
+}
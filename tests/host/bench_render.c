@@ -0,0 +1,159 @@
+// GUI rendering benchmark
+// Renders launcher frames with the real menu grid, header and footer renderers against the pax-gfx stand-in, and lays
+// out an edit field one character at a time the way gui_edit_render_text does. Reports the time per frame and the
+// pax_text_size calls and glyph lookups per frame. Built twice: with the text measurement cache of gui_text.c and,
+// as bench_render_uncached, with support/gui_text_uncached.c, which measures every label on every frame.
+
+#include <stdio.h>
+#include <string.h>
+#include "gui_element_footer.h"
+#include "gui_element_header.h"
+#include "gui_menu.h"
+#include "gui_style.h"
+#include "gui_text.h"
+#include "host_pax.h"
+#include "host_test.h"
+#include "pax_gfx.h"
+
+#define SCREEN_WIDTH  800
+#define SCREEN_HEIGHT 480
+#define ITEM_COUNT    40
+#define FRAMES        20000
+#define EDIT_LENGTH   200
+
+#ifdef GUI_TEXT_UNCACHED
+#define VARIANT "uncached"
+#else
+#define VARIANT "cached"
+#endif
+
+// Stand-ins for the fonts of the themes, with as many ranges as the real ones. Like in the generated fonts a range
+// of control characters comes first, ASCII second and the rest after it.
+#define MAX_RANGES 101
+
+static pax_font_range_t font_ranges[3][MAX_RANGES];
+static uint8_t          font_widths[0x80];
+static pax_font_t       chakrapetchmedium = {.name = "chakrapetchmedium", .n_ranges = 101, .default_size = 16};
+static pax_font_t       rajdhani          = {.name = "rajdhani", .n_ranges = 55, .default_size = 24};
+static pax_font_t       sky_mono          = {.name = "sky_mono", .n_ranges = 2, .default_size = 9};
+
+static void set_fonts(void) {
+    for (size_t i = 0; i < sizeof(font_widths); i++) {
+        font_widths[i] = 4 + (i * 5) % 9;
+    }
+    pax_font_t* fonts[] = {&chakrapetchmedium, &rajdhani, &sky_mono};
+    for (size_t font = 0; font < 3; font++) {
+        pax_font_range_t* ranges = font_ranges[font];
+        ranges[0]                = (pax_font_range_t){0xd, 0xd, font_widths};
+        ranges[1]                = (pax_font_range_t){0x20, 0x7e, font_widths};
+        for (size_t i = 2; i < fonts[font]->n_ranges; i++) {
+            ranges[i] = (pax_font_range_t){0xa0 + i * 0x80, 0xa0 + i * 0x80 + 0x7f, font_widths};
+        }
+        fonts[font]->ranges = ranges;
+    }
+}
+
+static pax_buf_t   screen = {.width = SCREEN_WIDTH, .height = SCREEN_HEIGHT};
+static pax_buf_t   icon   = {.width = 32, .height = 32};
+static gui_theme_t theme;
+
+// The theme of the 800x480 devices in main/common/theme.c
+static void set_theme(void) {
+    memset(&theme, 0, sizeof(theme));
+    theme.footer = (gui_element_style_t){.height            = 32,
+                                         .vertical_margin   = 7,
+                                         .horizontal_margin = 20,
+                                         .text_height       = 16,
+                                         .vertical_padding  = 20,
+                                         .text_font         = &chakrapetchmedium};
+    theme.header = theme.footer;
+    theme.menu   = (gui_element_style_t){.height                = SCREEN_HEIGHT - 64,
+                                         .vertical_margin       = 20,
+                                         .horizontal_margin     = 30,
+                                         .text_height           = 16,
+                                         .vertical_padding      = 6,
+                                         .horizontal_padding    = 6,
+                                         .text_font             = &chakrapetchmedium,
+                                         .list_entry_height     = 32,
+                                         .grid_horizontal_count = 4,
+                                         .grid_vertical_count   = 3};
+}
+
+static void report(const char* name, uint64_t start, const host_pax_stats_t* stats) {
+    double ns = (double)(host_time_ns() - start) / FRAMES;
+    printf("  %-22s %-8s %9.1f ns/frame %7.2f measures/frame %8.1f glyphs measured/frame\n", name, VARIANT, ns,
+           (double)stats->measures / FRAMES, (double)stats->glyphs / FRAMES);
+}
+
+// The launcher: header, footer and a grid of applications, with the cursor moving every frame
+static void bench_launcher(void) {
+    menu_t menu;
+    menu_initialize(&menu);
+    char labels[ITEM_COUNT][32];
+    for (size_t i = 0; i < ITEM_COUNT; i++) {
+        snprintf(labels[i], sizeof(labels[i]), "Application %zu", i);
+        menu_insert_item_icon(&menu, labels[i], NULL, NULL, -1, &icon);
+    }
+
+    gui_element_icontext_t header_left[]  = {{&icon, "Launcher"}};
+    gui_element_icontext_t header_right[] = {{NULL, "12:34"}, {&icon, "87%"}, {&icon, "WiFi"}};
+    gui_element_icontext_t footer_left[]  = {{&icon, "Start"}, {&icon, "Back"}, {&icon, "Settings"}};
+    gui_element_icontext_t footer_right[] = {{NULL, "v1.4.0"}};
+    pax_vec2_t             position       = {0, 65, SCREEN_WIDTH, SCREEN_HEIGHT - 65};
+
+    host_pax_reset_stats();
+    uint64_t start = host_time_ns();
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        menu_set_position(&menu, frame % ITEM_COUNT);
+        gui_header_draw(&screen, &theme, header_left, 1, header_right, 3);
+        menu_render_grid(&screen, &menu, position, &theme, false);
+        gui_footer_draw(&screen, &theme, footer_left, 3, footer_right, 1);
+    }
+    host_pax_stats_t stats = host_pax_stats();
+    report("launcher", start, &stats);
+    menu_free(&menu);
+}
+
+// The layout loop of gui_edit_render_text over an edit field with a long text
+static void bench_edit(const pax_font_t* font, float font_size) {
+    char content[EDIT_LENGTH + 1];
+    for (size_t i = 0; i < EDIT_LENGTH; i++) {
+        content[i] = ' ' + (i * 7) % 95;
+    }
+    content[EDIT_LENGTH] = '\0';
+
+    host_pax_reset_stats();
+    uint64_t start = host_time_ns();
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        float  x      = 2;
+        float  y      = 2;
+        char   tmp[2] = {0, 0};
+        size_t length = strlen(content);
+        for (size_t i = 0; i < length; i++) {
+            tmp[0]      = content[i];
+            float width = gui_text_char_width(font, font_size, tmp[0]);
+            if (x + width > SCREEN_WIDTH - 4) {
+                x  = 2;
+                y += font_size;
+            }
+            pax_draw_text(&screen, 0, font, font_size, x, y, tmp);
+            x += width;
+        }
+        host_keep(&x);
+    }
+    host_pax_stats_t stats = host_pax_stats();
+    char name[32];
+    snprintf(name, sizeof(name), "edit %s", font->name);
+    report(name, start, &stats);
+}
+
+int main(void) {
+    set_fonts();
+    set_theme();
+    printf("%d frames, %s text measurement\n", FRAMES, VARIANT);
+    bench_launcher();
+    bench_edit(&chakrapetchmedium, 16);
+    bench_edit(&rajdhani, 24);
+    bench_edit(&sky_mono, 9);
+    return 0;
+}
@@ -0,0 +1,186 @@
+// Repository listing projection benchmark
+// Times projecting generated listings with json_stream the way load_project_records does, fed in pieces of the
+// size the HTTP client hands over, and reports the memory the result keeps. When cJSON from ESP-IDF is available
+// (IDF_PATH set), the same listings are parsed into a cJSON tree and walked into the same records, which is what
+// the launcher did before, for comparison. Without it that part is skipped.
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "bsp/device.h"
+#include "host_test.h"
+#include "repository_projection.h"
+#ifdef HAVE_CJSON
+#include "cJSON.h"
+#endif
+
+#define PIECE_SIZE  512  // DEFAULT_HTTP_BUF_SIZE of esp_http_client
+#define ITERATIONS  20
+#define MAX_LISTING (8 * 1024 * 1024)
+#define INLINE_ICON "iVBORw0KGgoAAAANSUhEUgAAACAAAAAgCAYAAABzenr0AAAAGklEQVR4nO3BMQEAAADCoPVPbQsvoAAAAOBrDkAAAV0A"
+
+static char   listing[MAX_LISTING];
+static size_t listing_length;
+
+// A listing like the one the repository serves, with the fields the projection drops and an inline icon for some
+static void generate(size_t count) {
+    size_t length = snprintf(listing, sizeof(listing), "[");
+    for (size_t i = 0; i < count; i++) {
+        length += snprintf(
+            listing + length, sizeof(listing) - length,
+            "%s{\"slug\":\"project-%zu\",\"project\":{\"name\":\"Project %zu\",\"version\":\"1.%zu.0\","
+            "\"description\":\"A project that does something with the badge, number %zu of the listing\","
+            "\"author\":\"Someone\",\"license\":\"MIT\",\"categories\":[\"Utility\",\"Games\"],"
+            "\"icon\":{\"16x16\":\"icon16.png\",\"32x32\":\"icon32.png\",\"64x64\":\"icon64.png\"},"
+            "\"application\":[{\"type\":\"%s\",\"targets\":[\"mch2022\",\"%s\"],\"executable\":\"app.bin\"}]}%s}",
+            i > 0 ? "," : "", i, i, i, i, (i % 3 == 2) ? "plugin" : "appfs", HOST_DEVICE_NAME,
+            (i % 4 == 0) ? ",\"icon\":\"" INLINE_ICON "\"" : "");
+        if (length >= sizeof(listing) - 1) {
+            fprintf(stderr, "Listing of %zu projects does not fit\n", count);
+            exit(1);
+        }
+    }
+    length         += snprintf(listing + length, sizeof(listing) - length, "]");
+    listing_length  = length;
+}
+
+static size_t records_size(const repository_project_t* projects, size_t count) {
+    size_t size = count * sizeof(repository_project_t);
+    for (size_t i = 0; i < count; i++) {
+        if (projects[i].inline_icon != NULL) size += strlen(projects[i].inline_icon) + 1;
+    }
+    return size;
+}
+
+static void bench_projection(size_t count) {
+    uint64_t start = host_time_ns();
+    size_t   kept  = 0;
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        repository_projection_t* projection = malloc(sizeof(repository_projection_t));
+        repository_projection_begin(projection);
+        for (size_t offset = 0; offset < listing_length; offset += PIECE_SIZE) {
+            size_t length = listing_length - offset < PIECE_SIZE ? listing_length - offset : PIECE_SIZE;
+            repository_projection_feed(projection, listing + offset, length);
+        }
+        repository_project_t* projects = NULL;
+        size_t                projected;
+        if (!repository_projection_end(projection, &projects, &projected) || projected != count) {
+            fprintf(stderr, "Projection failed\n");
+            exit(1);
+        }
+        kept = records_size(projects, projected);
+        host_keep(projects);
+        repository_projection_free(projects, projected);
+        free(projection);
+    }
+    double ms = (double)(host_time_ns() - start) / ITERATIONS / 1e6;
+    printf("  json_stream %6zu projects %9.3f ms %8.1f MB/s, keeps %8zu bytes (body streamed)\n", count, ms,
+           listing_length / ms / 1e3, kept);
+}
+
+#ifdef HAVE_CJSON
+static size_t heap_in_use(void) {
+    return mallinfo2().uordblks;
+}
+
+static const char* string_at(const cJSON* object, const char* key) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(object, key);
+    return cJSON_IsString(item) ? item->valuestring : NULL;
+}
+
+static void copy_string(char* field, size_t size, const char* value) {
+    if (value != NULL) snprintf(field, size, "%s", value);
+}
+
+// The records from a complete tree, with the rules of the projection
+static size_t walk_tree(const cJSON* root, repository_project_t* projects) {
+    size_t       count = 0;
+    const cJSON* entry;
+    cJSON_ArrayForEach(entry, root) {
+        const cJSON*          project = cJSON_GetObjectItemCaseSensitive(entry, "project");
+        repository_project_t* record  = &projects[count];
+        memset(record, 0, sizeof(repository_project_t));
+        copy_string(record->slug, sizeof(record->slug), string_at(entry, "slug"));
+        copy_string(record->name, sizeof(record->name), string_at(project, "name"));
+        copy_string(record->version, sizeof(record->version), string_at(project, "version"));
+        copy_string(record->icon_file, sizeof(record->icon_file),
+                    string_at(cJSON_GetObjectItemCaseSensitive(project, "icon"), "32x32"));
+        const char* inline_icon = string_at(entry, "icon");
+        record->inline_icon     = inline_icon != NULL ? strdup(inline_icon) : NULL;
+
+        const cJSON* application;
+        cJSON_ArrayForEach(application, cJSON_GetObjectItemCaseSensitive(project, "application")) {
+            bool         matches = false;
+            const cJSON* target;
+            cJSON_ArrayForEach(target, cJSON_GetObjectItemCaseSensitive(application, "targets")) {
+                if (cJSON_IsString(target) && strcasecmp(target->valuestring, HOST_DEVICE_NAME) == 0) {
+                    matches = true;
+                }
+            }
+            if (matches) {
+                const char* type  = string_at(application, "type");
+                record->is_plugin = type != NULL && strcmp(type, "plugin") == 0;
+                break;
+            }
+        }
+        if (record->slug[0] == '\0' || record->name[0] == '\0') {
+            free(record->inline_icon);
+            continue;
+        }
+        count++;
+    }
+    return count;
+}
+
+static void bench_cjson(size_t count) {
+    repository_project_t* projects = malloc(count * sizeof(repository_project_t));
+    uint64_t              start    = host_time_ns();
+    size_t                kept     = 0;
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        // The body is downloaded into RAM first and kept next to the tree
+        size_t before = heap_in_use();
+        char*  body   = malloc(listing_length);
+        memcpy(body, listing, listing_length);
+        cJSON* root = cJSON_ParseWithLength(body, listing_length);
+        if (root == NULL) {
+            fprintf(stderr, "cJSON failed to parse the listing\n");
+            exit(1);
+        }
+        kept             = heap_in_use() - before;
+        size_t projected = walk_tree(root, projects);
+        if (projected != count) {
+            fprintf(stderr, "cJSON walk found %zu of %zu projects\n", projected, count);
+            exit(1);
+        }
+        host_keep(projects);
+        for (size_t i = 0; i < projected; i++) {
+            free(projects[i].inline_icon);
+        }
+        cJSON_Delete(root);
+        free(body);
+    }
+    double ms = (double)(host_time_ns() - start) / ITERATIONS / 1e6;
+    printf("  cJSON       %6zu projects %9.3f ms %8.1f MB/s, keeps %8zu bytes (body and tree)\n", count, ms,
+           listing_length / ms / 1e3, kept);
+    free(projects);
+}
+#endif
+
+int main(void) {
+    static const size_t counts[] = {20, 200, 2000, 10000};
+    printf("Pieces of %d bytes, %d iterations\n", PIECE_SIZE, ITERATIONS);
+#ifndef HAVE_CJSON
+    printf("  cJSON not found, set IDF_PATH to compare against it\n");
+#endif
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        generate(counts[i]);
+        printf("%zu projects, %zu byte listing\n", counts[i], listing_length);
+        bench_projection(counts[i]);
+#ifdef HAVE_CJSON
+        bench_cjson(counts[i]);
+#endif
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+// Stand-in application for test_app_delta, built at two revisions to get an old and a new executable
+// Revision 2 changes a string, a table and links an additional module, which moves most of the code and data
+// around the way an application update does.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "http_download.h"
+#if REVISION >= 2
+#include "audio_mix.h"
+#endif
+
+#ifndef REVISION
+#define REVISION 1
+#endif
+
+#if REVISION >= 2
+static const char greeting[] = "Delta update stand-in application, now with a mixer";
+#else
+static const char greeting[] = "Delta update stand-in application";
+#endif
+
+static const uint16_t table[] = {
+    1, 2, 3, 5, 8, 13, 21, 34, 55, 89, 144, 233, 377, 610, 987,
+#if REVISION >= 2
+    1597, 2584, 4181, 6765,
+#endif
+};
+
+int main(int argc, char** argv) {
+    printf("%s, revision %d\n", greeting, REVISION);
+    unsigned sum = 0;
+    for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+        sum += table[i];
+    }
+    printf("Table sum %u\n", sum);
+
+#if REVISION >= 2
+    int16_t         samples[2 * AUDIO_LIMITER_BLOCK_FRAMES] = {0};
+    int32_t         mix[2 * AUDIO_LIMITER_BLOCK_FRAMES]     = {0};
+    audio_limiter_t limiter;
+    audio_limiter_reset(&limiter);
+    audio_mix_accumulate(mix, samples, AUDIO_LIMITER_BLOCK_FRAMES, AUDIO_MIX_GAIN_UNITY);
+    audio_limiter_process(&limiter, mix, samples, AUDIO_LIMITER_BLOCK_FRAMES);
+#endif
+
+    if (argc > 1) {
+        http_session_t session = http_session_begin(argv[1]);
+        uint8_t*       data    = NULL;
+        size_t         size    = 0;
+        if (http_session_download_ram(session, argv[1], &data, &size)) {
+            printf("Downloaded %zu bytes\n", size);
+            free(data);
+        }
+        http_session_end(session);
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+// Host stand-in for appfs.h
+// AppFS files live in memory, see support/host_appfs.h. Like flash, written bits can only be cleared, so a write to
+// a region that was not erased first fails.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define APPFS_INVALID_FD        -1
+#define SPI_FLASH_MMU_PAGE_SIZE 0x10000
+
+typedef int appfs_handle_t;
+
+appfs_handle_t appfsOpen(const char* filename);
+int            appfsExists(const char* filename);
+appfs_handle_t appfsNextEntry(appfs_handle_t fd);
+void      appfsEntryInfoExt(appfs_handle_t fd, const char** name, const char** title, uint16_t* version, int* size);
+size_t    appfsGetFreeMem(void);
+esp_err_t appfsCreateFileExt(const char* filename, const char* title, uint16_t version, size_t size,
+                             appfs_handle_t* handle);
+esp_err_t appfsDeleteFile(const char* filename);
+esp_err_t appfsRename(const char* from, const char* to);
+esp_err_t appfsErase(appfs_handle_t fd, size_t start, size_t len);
+esp_err_t appfsWrite(appfs_handle_t fd, size_t start, uint8_t* buf, size_t len);
+esp_err_t appfsRead(appfs_handle_t fd, size_t start, void* buf, size_t len);
@@ -0,0 +1,10 @@
+// Host stand-in for bsp/device.h, the device name comes from support/bsp_device.c
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define HOST_DEVICE_NAME "Tanmatsu"
+
+esp_err_t bsp_device_get_name(char* output, uint8_t buffer_length);
@@ -0,0 +1,47 @@
+// Host stand-in for cJSON.h, the subset of cJSON the modules under test call, implemented by support/host_cjson.c
+// Uses the include guard and the node layout of the real header, so a benchmark that includes cJSON from ESP-IDF
+// first skips this one.
+#ifndef cJSON__h
+#define cJSON__h
+
+#include <stddef.h>
+
+#define cJSON_Invalid (0)
+#define cJSON_False   (1 << 0)
+#define cJSON_True    (1 << 1)
+#define cJSON_NULL    (1 << 2)
+#define cJSON_Number  (1 << 3)
+#define cJSON_String  (1 << 4)
+#define cJSON_Array   (1 << 5)
+#define cJSON_Object  (1 << 6)
+
+typedef int cJSON_bool;
+
+typedef struct cJSON {
+    struct cJSON* next;
+    struct cJSON* prev;
+    struct cJSON* child;
+    int           type;
+    char*         valuestring;
+    int           valueint;
+    double        valuedouble;
+    char*         string;  // Key of a member of an object
+} cJSON;
+
+cJSON* cJSON_Parse(const char* value);
+cJSON* cJSON_ParseWithLength(const char* value, size_t buffer_length);
+void   cJSON_Delete(cJSON* item);
+
+// Looks up a member of an object, cJSON_GetObjectItem compares keys without case like the real one
+cJSON* cJSON_GetObjectItem(const cJSON* object, const char* string);
+cJSON* cJSON_GetObjectItemCaseSensitive(const cJSON* object, const char* string);
+
+cJSON_bool cJSON_IsString(const cJSON* item);
+cJSON_bool cJSON_IsNumber(const cJSON* item);
+cJSON_bool cJSON_IsArray(const cJSON* item);
+cJSON_bool cJSON_IsObject(const cJSON* item);
+
+#define cJSON_ArrayForEach(element, array) \
+    for (element = (array != NULL) ? (array)->child : NULL; element != NULL; element = element->next)
+
+#endif
@@ -0,0 +1,19 @@
+// Host stand-in for esp_app_desc.h, a fixed description of the firmware
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    char    version[32];
+    char    project_name[32];
+    uint8_t app_elf_sha256[32];
+} esp_app_desc_t;
+
+static inline const esp_app_desc_t* esp_app_get_description(void) {
+    static const esp_app_desc_t description = {
+        .version        = "host",
+        .project_name   = "launcher",
+        .app_elf_sha256 = {0x4c, 0x61, 0x75, 0x6e, 0x63, 0x68, 0x65, 0x72},
+    };
+    return &description;
+}
@@ -0,0 +1,16 @@
+// Host stand-in for esp_cache.h, the host keeps its caches coherent
+#pragma once
+
+#include <stddef.h>
+#include "esp_err.h"
+
+#define ESP_CACHE_MSYNC_FLAG_INVALIDATE (1 << 0)
+#define ESP_CACHE_MSYNC_FLAG_UNALIGNED  (1 << 1)
+#define ESP_CACHE_MSYNC_FLAG_DIR_C2M    (1 << 2)
+#define ESP_CACHE_MSYNC_FLAG_DIR_M2C    (1 << 3)
+#define ESP_CACHE_MSYNC_FLAG_TYPE_DATA  (1 << 4)
+#define ESP_CACHE_MSYNC_FLAG_TYPE_INST  (1 << 5)
+
+static inline esp_err_t esp_cache_msync(void* address, size_t size, int flags) {
+    return ESP_OK;
+}
@@ -0,0 +1,4 @@
+// Host stand-in for esp_event.h, nothing from it is used by the modules under test
+#pragma once
+
+#include "esp_err.h"
@@ -0,0 +1,38 @@
+// Host stand-in for esp_heap_caps.h, every capability is served from the C heap
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_EXEC     (1 << 0)
+#define MALLOC_CAP_32BIT    (1 << 1)
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+
+static inline void* heap_caps_malloc(size_t size, uint32_t caps) {
+    return malloc(size);
+}
+
+static inline void* heap_caps_calloc(size_t count, size_t size, uint32_t caps) {
+    return calloc(count, size);
+}
+
+static inline void* heap_caps_realloc(void* ptr, size_t size, uint32_t caps) {
+    return realloc(ptr, size);
+}
+
+static inline void* heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps) {
+    void* ptr = NULL;
+    return posix_memalign(&ptr, alignment, size) == 0 ? ptr : NULL;
+}
+
+static inline void heap_caps_free(void* ptr) {
+    free(ptr);
+}
+
+#define heap_caps_malloc_prefer(size, count, ...)       malloc(size)
+#define heap_caps_realloc_prefer(ptr, size, count, ...) realloc(ptr, size)
@@ -0,0 +1,83 @@
+// Host stand-in for esp_http_client.h
+// There is no network. esp_http_client_perform hands each request to the server installed with
+// host_http_set_handler (support/http_server.h) and plays the response back through the event handler in the order
+// the real client dispatches its events.
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include "esp_err.h"
+#include "esp_log.h"  // Not included by the real header, but reached through it by the modules under test
+#include "sdkconfig.h"
+
+#define ESP_ERR_HTTP_BASE              0x7000
+#define ESP_ERR_HTTP_MAX_REDIRECT      (ESP_ERR_HTTP_BASE + 1)
+#define ESP_ERR_HTTP_CONNECT           (ESP_ERR_HTTP_BASE + 2)
+#define ESP_ERR_HTTP_WRITE_DATA        (ESP_ERR_HTTP_BASE + 3)
+#define ESP_ERR_HTTP_FETCH_HEADER      (ESP_ERR_HTTP_BASE + 4)
+#define ESP_ERR_HTTP_CONNECTION_CLOSED (ESP_ERR_HTTP_BASE + 8)
+
+typedef struct esp_http_client* esp_http_client_handle_t;
+
+typedef enum {
+    HTTP_EVENT_ERROR,
+    HTTP_EVENT_ON_CONNECTED,
+    HTTP_EVENT_HEADERS_SENT,
+    HTTP_EVENT_ON_HEADER,
+    HTTP_EVENT_ON_HEADERS_COMPLETE,
+    HTTP_EVENT_ON_STATUS_CODE,
+    HTTP_EVENT_ON_DATA,
+    HTTP_EVENT_ON_FINISH,
+    HTTP_EVENT_DISCONNECTED,
+    HTTP_EVENT_REDIRECT,
+} esp_http_client_event_id_t;
+
+typedef struct {
+    esp_http_client_event_id_t event_id;
+    esp_http_client_handle_t   client;
+    void*                      data;
+    int                        data_len;
+    void*                      user_data;
+    char*                      header_key;
+    char*                      header_value;
+} esp_http_client_event_t;
+
+typedef esp_err_t (*http_event_handle_cb)(esp_http_client_event_t* evt);
+
+typedef enum {
+    HTTP_METHOD_GET,
+    HTTP_METHOD_POST,
+    HTTP_METHOD_HEAD,
+} esp_http_client_method_t;
+
+typedef struct {
+    const char*              url;
+    bool                     use_global_ca_store;
+    bool                     keep_alive_enable;
+    int                      timeout_ms;
+    int                      buffer_size;
+    int                      buffer_size_tx;
+    void*                    user_data;
+    http_event_handle_cb     event_handler;
+    const char*              user_agent;
+    esp_http_client_method_t method;
+    bool                     disable_auto_redirect;
+    int                      max_redirection_count;
+    esp_err_t (*crt_bundle_attach)(void* conf);
+} esp_http_client_config_t;
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t* config);
+esp_err_t                esp_http_client_perform(esp_http_client_handle_t client);
+esp_err_t                esp_http_client_set_url(esp_http_client_handle_t client, const char* url);
+esp_err_t                esp_http_client_set_header(esp_http_client_handle_t client, const char* key,
+                                                    const char* value);
+esp_err_t                esp_http_client_get_header(esp_http_client_handle_t client, const char* key, char** value);
+esp_err_t                esp_http_client_delete_header(esp_http_client_handle_t client, const char* key);
+esp_err_t                esp_http_client_set_method(esp_http_client_handle_t client, esp_http_client_method_t method);
+int                      esp_http_client_get_status_code(esp_http_client_handle_t client);
+int64_t                  esp_http_client_get_content_length(esp_http_client_handle_t client);
+bool                     esp_http_client_is_chunked_response(esp_http_client_handle_t client);
+esp_err_t                esp_http_client_close(esp_http_client_handle_t client);
+esp_err_t                esp_http_client_cleanup(esp_http_client_handle_t client);
@@ -0,0 +1,14 @@
+// Host stand-in for esp_log.h
+// Errors and warnings go to stderr, the other levels are only compiled to check their arguments.
+#pragma once
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)                                        \
+    do {                                                                  \
+        if (0) fprintf(stderr, "I %s: " format "\n", tag, ##__VA_ARGS__); \
+    } while (0)
+#define ESP_LOGD ESP_LOGI
+#define ESP_LOGV ESP_LOGI
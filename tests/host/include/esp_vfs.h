@@ -0,0 +1,5 @@
+// Host stand-in for esp_vfs.h, which brings in the POSIX directory functions the modules under test use
+#pragma once
+
+#include <dirent.h>
+#include "esp_err.h"
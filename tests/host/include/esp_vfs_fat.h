@@ -0,0 +1,4 @@
+// Host stand-in for esp_vfs_fat.h, nothing from it is used by the modules under test
+#pragma once
+
+#include "esp_err.h"
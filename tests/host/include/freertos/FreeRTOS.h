@@ -0,0 +1,19 @@
+// Host stand-in for FreeRTOS, implemented on pthreads in support/freertos.c
+// One tick is one millisecond.
+#pragma once
+
+#include <stdint.h>
+
+typedef int          BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t     TickType_t;
+typedef uint8_t      StackType_t;
+
+#define pdTRUE             1
+#define pdFALSE            0
+#define pdPASS             pdTRUE
+#define pdFAIL             pdFALSE
+#define portMAX_DELAY      ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms))
+#define tskIDLE_PRIORITY   0
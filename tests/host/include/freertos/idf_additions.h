@@ -0,0 +1,5 @@
+// Host stand-in for the ESP-IDF FreeRTOS additions
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
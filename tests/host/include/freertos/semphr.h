@@ -0,0 +1,16 @@
+// Host stand-in for FreeRTOS semaphores and mutexes
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_semaphore* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+void              vSemaphoreDelete(SemaphoreHandle_t semaphore);
+BaseType_t        xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t        xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t        xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t        xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore);
@@ -0,0 +1,15 @@
+// Host stand-in for FreeRTOS tasks, each task is a detached pthread
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* arg);
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack_depth, void* arg,
+                       UBaseType_t priority, TaskHandle_t* out_handle);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack_depth, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* out_handle, BaseType_t core);
+void       vTaskDelete(TaskHandle_t task);
+void       vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
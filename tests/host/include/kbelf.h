@@ -0,0 +1,38 @@
+// Host stand-in for kbelf.h, implemented by support/host_kbelf.c
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uintptr_t            kbelf_addr;   // Virtual address in the ELF file
+typedef uintptr_t            kbelf_laddr;  // Address it is loaded at
+typedef struct kbelf_inst_s* kbelf_inst;
+typedef struct kbelf_dyn_s*  kbelf_dyn;
+
+#ifdef KBELF_REVEAL_PRIVATE
+struct kbelf_dyn_s {
+    kbelf_inst   exec_inst;
+    char*        path;
+    kbelf_laddr* functions;  // Preinit, init and fini functions
+    size_t       preinit_len;
+    size_t       init_len;
+    size_t       fini_len;
+};
+#endif
+
+kbelf_dyn kbelf_dyn_create(int pid);
+bool      kbelf_dyn_set_exec(kbelf_dyn dyn, const char* path, const char* name);
+bool      kbelf_dyn_load(kbelf_dyn dyn);
+void      kbelf_dyn_unload(kbelf_dyn dyn);
+void      kbelf_dyn_destroy(kbelf_dyn dyn);
+
+size_t      kbelf_dyn_preinit_len(kbelf_dyn dyn);
+kbelf_laddr kbelf_dyn_preinit_get(kbelf_dyn dyn, size_t index);
+size_t      kbelf_dyn_init_len(kbelf_dyn dyn);
+kbelf_laddr kbelf_dyn_init_get(kbelf_dyn dyn, size_t index);
+size_t      kbelf_dyn_fini_len(kbelf_dyn dyn);
+kbelf_laddr kbelf_dyn_fini_get(kbelf_dyn dyn, size_t index);
+
+// Load address of the virtual address `vaddr`, 0 when it is not part of a loaded segment
+kbelf_laddr kbelf_inst_getvaddr(kbelf_inst inst, kbelf_addr vaddr);
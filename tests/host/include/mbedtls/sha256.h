@@ -0,0 +1,34 @@
+// Host stand-in for mbedtls/sha256.h on OpenSSL, link with -lcrypto
+#pragma once
+
+#include <openssl/evp.h>
+#include <stddef.h>
+
+typedef struct {
+    EVP_MD_CTX* context;
+} mbedtls_sha256_context;
+
+static inline void mbedtls_sha256_init(mbedtls_sha256_context* ctx) {
+    ctx->context = EVP_MD_CTX_new();
+}
+
+static inline void mbedtls_sha256_free(mbedtls_sha256_context* ctx) {
+    EVP_MD_CTX_free(ctx->context);
+    ctx->context = NULL;
+}
+
+static inline int mbedtls_sha256_starts(mbedtls_sha256_context* ctx, int is224) {
+    return EVP_DigestInit_ex(ctx->context, is224 ? EVP_sha224() : EVP_sha256(), NULL) == 1 ? 0 : -1;
+}
+
+static inline int mbedtls_sha256_update(mbedtls_sha256_context* ctx, const unsigned char* input, size_t length) {
+    return EVP_DigestUpdate(ctx->context, input, length) == 1 ? 0 : -1;
+}
+
+static inline int mbedtls_sha256_finish(mbedtls_sha256_context* ctx, unsigned char* output) {
+    return EVP_DigestFinal_ex(ctx->context, output, NULL) == 1 ? 0 : -1;
+}
+
+static inline int mbedtls_sha256(const unsigned char* input, size_t length, unsigned char* output, int is224) {
+    return EVP_Digest(input, length, output, NULL, is224 ? EVP_sha224() : EVP_sha256(), NULL) == 1 ? 0 : -1;
+}
@@ -0,0 +1,9 @@
+// Host stand-in for pax_codecs.h, PNG decoding by libpng in support/host_pax_codecs.c
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "pax_types.h"
+
+// Decodes a PNG into a buffer it initializes, false when the file is not a valid PNG
+bool pax_decode_png_fd(pax_buf_t* buf, FILE* fd, pax_buf_type_t buf_type, int flags);
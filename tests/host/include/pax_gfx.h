@@ -0,0 +1,28 @@
+// Host stand-in for pax_gfx.h, implemented by support/host_pax.c
+// Buffers hold 32-bit pixels. Drawing only counts the calls and walks the glyphs of a text. Text is measured glyph by
+// glyph, searching the ranges of the font like pax does for its bitmap fonts, so the cost of pax_text_size is of the
+// same kind as on the device.
+#pragma once
+
+#include "pax_types.h"
+
+pax_vec2f pax_text_size(const pax_font_t* font, float font_size, const char* text);
+pax_vec2f pax_draw_text(pax_buf_t* buf, pax_col_t color, const pax_font_t* font, float font_size, float x, float y,
+                        const char* text);
+pax_vec2f pax_right_text(pax_buf_t* buf, pax_col_t color, const pax_font_t* font, float font_size, float x, float y,
+                         const char* text);
+
+void pax_simple_rect(pax_buf_t* buf, pax_col_t color, float x, float y, float width, float height);
+void pax_outline_rect(pax_buf_t* buf, pax_col_t color, float x, float y, float width, float height);
+void pax_draw_rect(pax_buf_t* buf, pax_col_t color, float x, float y, float width, float height);
+void pax_draw_line(pax_buf_t* buf, pax_col_t color, float x0, float y0, float x1, float y1);
+void pax_draw_image(pax_buf_t* buf, const pax_buf_t* image, float x, float y);
+void pax_clip(pax_buf_t* buf, float x, float y, float width, float height);
+void pax_noclip(pax_buf_t* buf);
+
+void        pax_buf_init(pax_buf_t* buf, void* mem, int width, int height, pax_buf_type_t type);
+void        pax_buf_destroy(pax_buf_t* buf);
+int         pax_buf_get_width(const pax_buf_t* buf);
+int         pax_buf_get_height(const pax_buf_t* buf);
+const void* pax_buf_get_pixels(const pax_buf_t* buf);
+void*       pax_buf_get_pixels_rw(pax_buf_t* buf);
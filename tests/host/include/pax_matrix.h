@@ -0,0 +1,4 @@
+// Host stand-in for pax-gfx
+#pragma once
+
+#include "pax_types.h"
@@ -0,0 +1,44 @@
+// Host stand-in for the pax-gfx types used by the modules under test
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef uint32_t pax_col_t;
+
+typedef struct pax_buf {
+    int   width;
+    int   height;
+    void* pixels;
+    bool  do_free;  // The pixels were allocated by pax_buf_init
+} pax_buf_t;
+
+// Characters start to end of a font, like the ranges of the pax bitmap fonts
+typedef struct {
+    uint32_t       start;
+    uint32_t       end;
+    const uint8_t* widths;  // Advance of every glyph of the range at the default size
+} pax_font_range_t;
+
+typedef struct pax_font {
+    const char*             name;
+    size_t                  n_ranges;
+    const pax_font_range_t* ranges;
+    float                   default_size;
+} pax_font_t;
+
+typedef struct {
+    float x, y;
+} pax_vec2f;
+
+typedef pax_vec2f pax_vec1_t;
+
+typedef struct {
+    float x0, y0, x1, y1;
+} pax_vec2_t;
+
+typedef enum {
+    PAX_BUF_32_8888ARGB,
+} pax_buf_type_t;
@@ -0,0 +1,13 @@
+// Host stand-in for the generated sdkconfig.h, Kconfig defaults of the options the modules under test read.
+// Tests can override a value with -D.
+#pragma once
+
+#ifndef CONFIG_HTTP_DOWNLOAD_RAM_LIMIT
+#define CONFIG_HTTP_DOWNLOAD_RAM_LIMIT 16384
+#endif
+
+#ifndef CONFIG_HTTP_CACHE_SIZE
+#define CONFIG_HTTP_CACHE_SIZE 1024
+#endif
+
+#define CONFIG_SOC_CPU_CORES_NUM 2
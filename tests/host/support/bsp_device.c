@@ -0,0 +1,9 @@
+// Host stand-in for the device identification of the BSP
+
+#include "bsp/device.h"
+#include <stdio.h>
+
+esp_err_t bsp_device_get_name(char* output, uint8_t buffer_length) {
+    snprintf(output, buffer_length, "%s", HOST_DEVICE_NAME);
+    return ESP_OK;
+}
@@ -0,0 +1,9 @@
+// Host stand-ins for the device settings the modules under test read
+
+#include "device_settings.h"
+#include <string.h>
+#include "host_compat.h"
+
+void device_settings_get_default_http_user_agent(char* out_value, size_t max_length) {
+    strlcpy(out_value, "tanmatsu-launcher/host", max_length);
+}
@@ -0,0 +1,300 @@
+// FreeRTOS stand-in on pthreads, just enough for the modules under test
+// Semaphores, mutexes and queues share one implementation: a counter or ring buffer guarded by a pthread mutex,
+// with a condition variable to wait on. Timeouts are in ticks of one millisecond.
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+struct host_semaphore {
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+    UBaseType_t     count;
+    UBaseType_t     max_count;
+    bool            recursive;
+    pthread_t       owner;
+    UBaseType_t     depth;
+};
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+    UBaseType_t     length;
+    UBaseType_t     item_size;
+    UBaseType_t     head;
+    UBaseType_t     count;
+    uint8_t*        items;
+};
+
+struct host_task {
+    pthread_t      thread;
+    TaskFunction_t function;
+    void*          arg;
+};
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK:
+            return "ESP_OK";
+        case ESP_FAIL:
+            return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:
+            return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:
+            return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:
+            return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:
+            return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:
+            return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:
+            return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:
+            return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE:
+            return "ESP_ERR_INVALID_RESPONSE";
+        default:
+            return "UNKNOWN ERROR";
+    }
+}
+
+size_t strlcpy(char* destination, const char* source, size_t size) {
+    size_t length = strlen(source);
+    if (size > 0) {
+        size_t copy = length < size - 1 ? length : size - 1;
+        memcpy(destination, source, copy);
+        destination[copy] = '\0';
+    }
+    return length;
+}
+
+// Waits on `changed` until `ready` or the timeout, with `lock` held
+static bool wait_until(pthread_cond_t* changed, pthread_mutex_t* lock, TickType_t ticks, bool (*ready)(void*),
+                       void* context) {
+    if (ticks == portMAX_DELAY) {
+        while (!ready(context)) {
+            pthread_cond_wait(changed, lock);
+        }
+        return true;
+    }
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec  += ticks / 1000;
+    deadline.tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    while (!ready(context)) {
+        if (ticks == 0 || pthread_cond_timedwait(changed, lock, &deadline) == ETIMEDOUT) {
+            return ready(context);
+        }
+    }
+    return true;
+}
+
+// Semaphores
+
+static SemaphoreHandle_t create_semaphore(UBaseType_t max_count, UBaseType_t initial_count, bool recursive) {
+    SemaphoreHandle_t semaphore = calloc(1, sizeof(struct host_semaphore));
+    if (semaphore == NULL) return NULL;
+    pthread_mutex_init(&semaphore->lock, NULL);
+    pthread_cond_init(&semaphore->changed, NULL);
+    semaphore->count     = initial_count;
+    semaphore->max_count = max_count;
+    semaphore->recursive = recursive;
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return create_semaphore(1, 1, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+    return create_semaphore(1, 1, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return create_semaphore(1, 0, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+    return create_semaphore(max_count, initial_count, false);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    if (semaphore == NULL) return;
+    pthread_cond_destroy(&semaphore->changed);
+    pthread_mutex_destroy(&semaphore->lock);
+    free(semaphore);
+}
+
+static bool semaphore_available(void* context) {
+    return ((SemaphoreHandle_t)context)->count > 0;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    pthread_mutex_lock(&semaphore->lock);
+    bool taken = wait_until(&semaphore->changed, &semaphore->lock, ticks, semaphore_available, semaphore);
+    if (taken) {
+        semaphore->count--;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return taken ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    pthread_mutex_lock(&semaphore->lock);
+    bool given = semaphore->count < semaphore->max_count;
+    if (given) {
+        semaphore->count++;
+        pthread_cond_broadcast(&semaphore->changed);
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return given ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    pthread_mutex_lock(&semaphore->lock);
+    bool taken = semaphore->depth > 0 && pthread_equal(semaphore->owner, pthread_self());
+    if (!taken) {
+        taken = wait_until(&semaphore->changed, &semaphore->lock, ticks, semaphore_available, semaphore);
+        if (taken) {
+            semaphore->count--;
+            semaphore->owner = pthread_self();
+        }
+    }
+    if (taken) {
+        semaphore->depth++;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return taken ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) {
+    pthread_mutex_lock(&semaphore->lock);
+    bool given = semaphore->depth > 0 && pthread_equal(semaphore->owner, pthread_self());
+    if (given && --semaphore->depth == 0) {
+        semaphore->count++;
+        pthread_cond_broadcast(&semaphore->changed);
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return given ? pdTRUE : pdFALSE;
+}
+
+// Queues
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    QueueHandle_t queue = calloc(1, sizeof(struct host_queue));
+    if (queue == NULL) return NULL;
+    queue->items = calloc(length, item_size);
+    if (queue->items == NULL) {
+        free(queue);
+        return NULL;
+    }
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->changed, NULL);
+    queue->length    = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    if (queue == NULL) return;
+    pthread_cond_destroy(&queue->changed);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue->items);
+    free(queue);
+}
+
+static bool queue_has_space(void* context) {
+    QueueHandle_t queue = context;
+    return queue->count < queue->length;
+}
+
+static bool queue_has_item(void* context) {
+    return ((QueueHandle_t)context)->count > 0;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    pthread_mutex_lock(&queue->lock);
+    bool sent = wait_until(&queue->changed, &queue->lock, ticks, queue_has_space, queue);
+    if (sent) {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(&queue->items[tail * queue->item_size], item, queue->item_size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->changed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return sent ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* out_item, TickType_t ticks) {
+    pthread_mutex_lock(&queue->lock);
+    bool received = wait_until(&queue->changed, &queue->lock, ticks, queue_has_item, queue);
+    if (received) {
+        memcpy(out_item, &queue->items[queue->head * queue->item_size], queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_broadcast(&queue->changed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return received ? pdTRUE : pdFALSE;
+}
+
+// Tasks
+
+static void* task_entry(void* context) {
+    struct host_task* task = context;
+    task->function(task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack_depth, void* arg,
+                       UBaseType_t priority, TaskHandle_t* out_handle) {
+    struct host_task* task = calloc(1, sizeof(struct host_task));
+    if (task == NULL) return pdFAIL;
+    task->function = function;
+    task->arg      = arg;
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    if (out_handle != NULL) {
+        *out_handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack_depth, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* out_handle, BaseType_t core) {
+    return xTaskCreate(function, name, stack_depth, arg, priority, out_handle);
+}
+
+// Only deleting the calling task is supported, the task structure is leaked like a static task would be
+void vTaskDelete(TaskHandle_t task) {
+    if (task == NULL) {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec duration = {.tv_sec = ticks / 1000, .tv_nsec = (long)(ticks % 1000) * 1000000L};
+    nanosleep(&duration, NULL);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (TickType_t)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
@@ -0,0 +1,17 @@
+// gui_text.h without the cache: every call measures with pax_text_size, as the renderers did before gui_text.c.
+// Linked into the uncached build of bench_render as its baseline.
+
+#include "gui_text.h"
+#include "pax_gfx.h"
+
+pax_vec2f gui_text_size(const pax_font_t* font, float font_size, const char* text) {
+    return pax_text_size(font, font_size, text);
+}
+
+float gui_text_char_width(const pax_font_t* font, float font_size, char character) {
+    char text[2] = {character, '\0'};
+    return pax_text_size(font, font_size, text).x;
+}
+
+void gui_text_cache_clear(void) {
+}
@@ -0,0 +1,164 @@
+// In-memory AppFS, see host_appfs.h
+
+#include "host_appfs.h"
+#include <stdlib.h>
+#include <string.h>
+#include "appfs.h"
+
+#define MAX_FILES 128  // Room for the AppFS apps of the app list benchmark
+
+typedef struct {
+    char*    name;  // NULL for an unused slot
+    char*    title;
+    uint16_t version;
+    uint8_t* data;
+    size_t   size;
+} host_appfs_file_t;
+
+static host_appfs_file_t files[MAX_FILES];
+
+static size_t rounded(size_t size) {
+    return (size + (SPI_FLASH_MMU_PAGE_SIZE - 1)) & ~(size_t)(SPI_FLASH_MMU_PAGE_SIZE - 1);
+}
+
+static host_appfs_file_t* file_of(appfs_handle_t fd) {
+    if (fd < 0 || fd >= MAX_FILES || files[fd].name == NULL) return NULL;
+    return &files[fd];
+}
+
+static void remove_file(host_appfs_file_t* file) {
+    free(file->name);
+    free(file->title);
+    free(file->data);
+    memset(file, 0, sizeof(*file));
+}
+
+void host_appfs_reset(void) {
+    for (int i = 0; i < MAX_FILES; i++) {
+        if (files[i].name != NULL) remove_file(&files[i]);
+    }
+}
+
+void host_appfs_add(const char* filename, const char* title, uint16_t version, const uint8_t* data, size_t length) {
+    appfs_handle_t fd;
+    appfsDeleteFile(filename);
+    if (appfsCreateFileExt(filename, title, version, length, &fd) == ESP_OK) {
+        memcpy(files[fd].data, data, length);
+    }
+}
+
+const uint8_t* host_appfs_contents(const char* filename, size_t* length) {
+    host_appfs_file_t* file = file_of(appfsOpen(filename));
+    if (file == NULL) return NULL;
+    *length = file->size;
+    return file->data;
+}
+
+int host_appfs_count(void) {
+    int count = 0;
+    for (int i = 0; i < MAX_FILES; i++) {
+        if (files[i].name != NULL) count++;
+    }
+    return count;
+}
+
+// AppFS
+
+appfs_handle_t appfsOpen(const char* filename) {
+    for (int i = 0; i < MAX_FILES; i++) {
+        if (files[i].name != NULL && strcmp(files[i].name, filename) == 0) return i;
+    }
+    return APPFS_INVALID_FD;
+}
+
+int appfsExists(const char* filename) {
+    return appfsOpen(filename) != APPFS_INVALID_FD;
+}
+
+appfs_handle_t appfsNextEntry(appfs_handle_t fd) {
+    for (int i = (fd == APPFS_INVALID_FD) ? 0 : fd + 1; i < MAX_FILES; i++) {
+        if (files[i].name != NULL) return i;
+    }
+    return APPFS_INVALID_FD;
+}
+
+void appfsEntryInfoExt(appfs_handle_t fd, const char** name, const char** title, uint16_t* version, int* size) {
+    host_appfs_file_t* file = file_of(fd);
+    if (file == NULL) return;
+    if (name != NULL) *name = file->name;
+    if (title != NULL) *title = file->title;
+    if (version != NULL) *version = file->version;
+    if (size != NULL) *size = (int)file->size;
+}
+
+size_t appfsGetFreeMem(void) {
+    size_t used = 0;
+    for (int i = 0; i < MAX_FILES; i++) {
+        if (files[i].name != NULL) used += rounded(files[i].size);
+    }
+    return HOST_APPFS_SIZE - used;
+}
+
+esp_err_t appfsCreateFileExt(const char* filename, const char* title, uint16_t version, size_t size,
+                             appfs_handle_t* handle) {
+    if (appfsExists(filename) || rounded(size) > appfsGetFreeMem()) return ESP_ERR_NO_MEM;
+    for (int i = 0; i < MAX_FILES; i++) {
+        if (files[i].name != NULL) continue;
+        files[i] = (host_appfs_file_t){
+            .name    = strdup(filename),
+            .title   = strdup(title),
+            .version = version,
+            .data    = malloc(size > 0 ? size : 1),
+            .size    = size,
+        };
+        memset(files[i].data, 0xFF, size);
+        *handle = i;
+        return ESP_OK;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t appfsDeleteFile(const char* filename) {
+    host_appfs_file_t* file = file_of(appfsOpen(filename));
+    if (file == NULL) return ESP_ERR_NOT_FOUND;
+    remove_file(file);
+    return ESP_OK;
+}
+
+esp_err_t appfsRename(const char* from, const char* to) {
+    host_appfs_file_t* file = file_of(appfsOpen(from));
+    if (file == NULL) return ESP_ERR_NOT_FOUND;
+    if (appfsExists(to)) return ESP_FAIL;
+    free(file->name);
+    file->name = strdup(to);
+    return ESP_OK;
+}
+
+// Erases whole sectors and may run past the end of the file into the rest of its last page, like on flash
+esp_err_t appfsErase(appfs_handle_t fd, size_t start, size_t len) {
+    host_appfs_file_t* file = file_of(fd);
+    if (file == NULL || (start % 4096) != 0 || (len % 4096) != 0 || start + len > rounded(file->size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (start < file->size) {
+        memset(file->data + start, 0xFF, (start + len < file->size ? start + len : file->size) - start);
+    }
+    return ESP_OK;
+}
+
+esp_err_t appfsWrite(appfs_handle_t fd, size_t start, uint8_t* buf, size_t len) {
+    host_appfs_file_t* file = file_of(fd);
+    if (file == NULL || start > file->size || len > file->size - start) return ESP_ERR_INVALID_ARG;
+    for (size_t i = 0; i < len; i++) {
+        if ((file->data[start + i] & buf[i]) != buf[i]) return ESP_FAIL;  // Not erased
+        file->data[start + i] &= buf[i];
+    }
+    return ESP_OK;
+}
+
+esp_err_t appfsRead(appfs_handle_t fd, size_t start, void* buf, size_t len) {
+    host_appfs_file_t* file = file_of(fd);
+    if (file == NULL || start > file->size || len > file->size - start) return ESP_ERR_INVALID_ARG;
+    memcpy(buf, file->data + start, len);
+    return ESP_OK;
+}
@@ -0,0 +1,19 @@
+// In-memory AppFS behind the host appfs.h (include/appfs.h)
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HOST_APPFS_SIZE (16 * 1024 * 1024)  // Flash available to files, in whole MMU pages like on a device
+
+// Removes every file
+void host_appfs_reset(void);
+
+// Creates a file holding a copy of data, replacing an existing one with the same name
+void host_appfs_add(const char* filename, const char* title, uint16_t version, const uint8_t* data, size_t length);
+
+// Contents of a file, NULL when it does not exist. Valid until the file is changed.
+const uint8_t* host_appfs_contents(const char* filename, size_t* length);
+
+// Number of files
+int host_appfs_count(void);
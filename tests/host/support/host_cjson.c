@@ -0,0 +1,263 @@
+// Host cJSON behind include/cJSON.h, a recursive descent parser building the same tree of nodes as cJSON
+
+#include "cJSON.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define MAX_DEPTH 64  // Like CJSON_NESTING_LIMIT, so a malformed document can not exhaust the stack
+
+typedef struct {
+    const char* position;
+    const char* end;
+} parser_t;
+
+static cJSON* parse_value(parser_t* parser, int depth);
+
+static void skip_whitespace(parser_t* parser) {
+    while (parser->position < parser->end && isspace((unsigned char)*parser->position)) {
+        parser->position++;
+    }
+}
+
+static bool consume(parser_t* parser, const char* literal) {
+    size_t length = strlen(literal);
+    if ((size_t)(parser->end - parser->position) < length || memcmp(parser->position, literal, length) != 0) {
+        return false;
+    }
+    parser->position += length;
+    return true;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Writes a code point of the basic multilingual plane as UTF-8, surrogate pairs are not needed by the metadata
+static char* append_utf8(char* out, uint32_t code_point) {
+    if (code_point < 0x80) {
+        *out++ = (char)code_point;
+    } else if (code_point < 0x800) {
+        *out++ = (char)(0xc0 | (code_point >> 6));
+        *out++ = (char)(0x80 | (code_point & 0x3f));
+    } else {
+        *out++ = (char)(0xe0 | (code_point >> 12));
+        *out++ = (char)(0x80 | ((code_point >> 6) & 0x3f));
+        *out++ = (char)(0x80 | (code_point & 0x3f));
+    }
+    return out;
+}
+
+// Parses a string at the opening quote, an escaped string never grows so its raw length bounds the result
+static char* parse_string(parser_t* parser) {
+    const char* start = ++parser->position;
+    while (parser->position < parser->end && *parser->position != '"') {
+        if (*parser->position == '\\') parser->position++;
+        parser->position++;
+    }
+    if (parser->position >= parser->end) {
+        return NULL;
+    }
+
+    char* result = malloc(parser->position - start + 1);
+    char* out    = result;
+    if (result == NULL) {
+        return NULL;
+    }
+    for (const char* c = start; c < parser->position; c++) {
+        if (*c != '\\') {
+            *out++ = *c;
+            continue;
+        }
+        switch (*++c) {
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case 'u': {
+                uint32_t code_point = 0;
+                for (int i = 1; i <= 4; i++) {
+                    int value = (c + i < parser->position) ? hex_value(c[i]) : -1;
+                    if (value < 0) {
+                        free(result);
+                        return NULL;
+                    }
+                    code_point = (code_point << 4) | value;
+                }
+                out  = append_utf8(out, code_point);
+                c   += 4;
+                break;
+            }
+            default: *out++ = *c; break;
+        }
+    }
+    *out = '\0';
+    parser->position++;
+    return result;
+}
+
+// Parses the members of an array or object at the opening bracket, linking them as children of item
+static bool parse_children(parser_t* parser, cJSON* item, char close, bool named, int depth) {
+    parser->position++;
+    skip_whitespace(parser);
+    if (parser->position < parser->end && *parser->position == close) {
+        parser->position++;
+        return true;
+    }
+
+    cJSON* last = NULL;
+    while (parser->position < parser->end) {
+        char* key = NULL;
+        if (named) {
+            if (*parser->position != '"' || (key = parse_string(parser)) == NULL) {
+                return false;
+            }
+            skip_whitespace(parser);
+            if (!consume(parser, ":")) {
+                free(key);
+                return false;
+            }
+        }
+
+        cJSON* child = parse_value(parser, depth + 1);
+        if (child == NULL) {
+            free(key);
+            return false;
+        }
+        child->string = key;
+        child->prev   = last;
+        if (last != NULL) {
+            last->next = child;
+        } else {
+            item->child = child;
+        }
+        last = child;
+
+        skip_whitespace(parser);
+        if (consume(parser, ",")) {
+            skip_whitespace(parser);
+        } else {
+            char end[2] = {close, '\0'};
+            return consume(parser, end);
+        }
+    }
+    return false;
+}
+
+static cJSON* parse_value(parser_t* parser, int depth) {
+    skip_whitespace(parser);
+    if (parser->position >= parser->end || depth > MAX_DEPTH) {
+        return NULL;
+    }
+
+    cJSON* item = calloc(1, sizeof(cJSON));
+    if (item == NULL) {
+        return NULL;
+    }
+
+    bool ok = true;
+    char c  = *parser->position;
+    if (c == '{' || c == '[') {
+        item->type = (c == '{') ? cJSON_Object : cJSON_Array;
+        ok         = parse_children(parser, item, (c == '{') ? '}' : ']', c == '{', depth);
+    } else if (c == '"') {
+        item->type        = cJSON_String;
+        item->valuestring = parse_string(parser);
+        ok                = item->valuestring != NULL;
+    } else if (consume(parser, "true")) {
+        item->type     = cJSON_True;
+        item->valueint = 1;
+    } else if (consume(parser, "false")) {
+        item->type = cJSON_False;
+    } else if (consume(parser, "null")) {
+        item->type = cJSON_NULL;
+    } else {
+        // The document is terminated, so strtod stops at the terminator at the latest
+        char* number_end  = NULL;
+        item->type        = cJSON_Number;
+        item->valuedouble = strtod(parser->position, &number_end);
+        ok                = number_end != parser->position && number_end <= parser->end;
+        if (item->valuedouble >= INT32_MAX) {
+            item->valueint = INT32_MAX;
+        } else if (item->valuedouble <= INT32_MIN) {
+            item->valueint = INT32_MIN;
+        } else {
+            item->valueint = (int)item->valuedouble;
+        }
+        parser->position = ok ? number_end : parser->position;
+    }
+
+    if (!ok) {
+        cJSON_Delete(item);
+        return NULL;
+    }
+    return item;
+}
+
+cJSON* cJSON_ParseWithLength(const char* value, size_t buffer_length) {
+    if (value == NULL) {
+        return NULL;
+    }
+    parser_t parser = {.position = value, .end = value + strnlen(value, buffer_length)};
+    cJSON*   root   = parse_value(&parser, 0);
+    skip_whitespace(&parser);
+    if (root != NULL && parser.position != parser.end) {
+        cJSON_Delete(root);
+        return NULL;
+    }
+    return root;
+}
+
+cJSON* cJSON_Parse(const char* value) {
+    return (value != NULL) ? cJSON_ParseWithLength(value, strlen(value)) : NULL;
+}
+
+void cJSON_Delete(cJSON* item) {
+    while (item != NULL) {
+        cJSON* next = item->next;
+        cJSON_Delete(item->child);
+        free(item->valuestring);
+        free(item->string);
+        free(item);
+        item = next;
+    }
+}
+
+cJSON* cJSON_GetObjectItem(const cJSON* object, const char* string) {
+    cJSON* child = (object != NULL) ? object->child : NULL;
+    while (child != NULL && (child->string == NULL || strcasecmp(child->string, string) != 0)) {
+        child = child->next;
+    }
+    return child;
+}
+
+cJSON* cJSON_GetObjectItemCaseSensitive(const cJSON* object, const char* string) {
+    cJSON* child = (object != NULL) ? object->child : NULL;
+    while (child != NULL && (child->string == NULL || strcmp(child->string, string) != 0)) {
+        child = child->next;
+    }
+    return child;
+}
+
+cJSON_bool cJSON_IsString(const cJSON* item) {
+    return item != NULL && item->type == cJSON_String;
+}
+
+cJSON_bool cJSON_IsNumber(const cJSON* item) {
+    return item != NULL && item->type == cJSON_Number;
+}
+
+cJSON_bool cJSON_IsArray(const cJSON* item) {
+    return item != NULL && item->type == cJSON_Array;
+}
+
+cJSON_bool cJSON_IsObject(const cJSON* item) {
+    return item != NULL && item->type == cJSON_Object;
+}
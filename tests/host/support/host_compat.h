@@ -0,0 +1,6 @@
+// Functions newlib on the device has and the host C library may not, included with -include
+#pragma once
+
+#include <stddef.h>
+
+size_t strlcpy(char* destination, const char* source, size_t size);
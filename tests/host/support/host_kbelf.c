@@ -0,0 +1,337 @@
+// Host stand-in for kbelf
+// Links ELF32 plugins the way kbelf does on the device: the segments are read from the file into one block, every
+// undefined symbol is looked up by name in the export table and the RELATIVE, 32 and JUMP_SLOT relocations of
+// .rela.dyn and .rela.plt are applied. Addresses are stored in 32 bits like on the device, so the block has to be
+// allocated below 4 GiB.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "host_kbelf.h"
+#define KBELF_REVEAL_PRIVATE
+#include "kbelf.h"
+
+#define ELF_PT_LOAD            1
+#define ELF_PT_DYNAMIC         2
+#define ELF_DT_NULL            0
+#define ELF_DT_PLTRELSZ        2
+#define ELF_DT_STRTAB          5
+#define ELF_DT_SYMTAB          6
+#define ELF_DT_RELA            7
+#define ELF_DT_RELASZ          8
+#define ELF_DT_JMPREL          23
+#define ELF_DT_INIT_ARRAY      25
+#define ELF_DT_FINI_ARRAY      26
+#define ELF_DT_INIT_ARRAYSZ    27
+#define ELF_DT_FINI_ARRAYSZ    28
+#define ELF_DT_PREINIT_ARRAY   32
+#define ELF_DT_PREINIT_ARRAYSZ 33
+#define ELF_R_RISCV_NONE       0
+#define ELF_R_RISCV_32         1
+#define ELF_R_RISCV_RELATIVE   3
+#define ELF_R_RISCV_JUMP_SLOT  5
+
+typedef struct {
+    uint8_t  ident[16];
+    uint16_t type;
+    uint16_t machine;
+    uint32_t version;
+    uint32_t entry;
+    uint32_t phoff;
+    uint32_t shoff;
+    uint32_t flags;
+    uint16_t ehsize;
+    uint16_t phentsize;
+    uint16_t phnum;
+    uint16_t shentsize;
+    uint16_t shnum;
+    uint16_t shstrndx;
+} elf_header_t;
+
+typedef struct {
+    uint32_t type;
+    uint32_t offset;
+    uint32_t vaddr;
+    uint32_t paddr;
+    uint32_t filesz;
+    uint32_t memsz;
+    uint32_t flags;
+    uint32_t align;
+} elf_program_header_t;
+
+typedef struct {
+    uint32_t offset;
+    uint32_t info;
+    int32_t  addend;
+} elf_rela_t;
+
+typedef struct {
+    uint32_t name;
+    uint32_t value;
+    uint32_t size;
+    uint8_t  info;
+    uint8_t  other;
+    uint16_t shndx;
+} elf_symbol_t;
+
+struct kbelf_inst_s {
+    uint8_t* memory;
+    uint32_t vaddr;  // Virtual address of memory[0]
+    uint32_t size;
+};
+
+typedef struct {
+    uint32_t symtab;
+    uint32_t strtab;
+    uint32_t tables[2];  // .rela.dyn and .rela.plt
+    uint32_t table_sizes[2];
+    uint32_t arrays[3];  // Preinit, init and fini
+    uint32_t array_sizes[3];
+} dynamic_t;
+
+static const host_kbelf_export_t* exports;
+static size_t                     export_count;
+
+void host_kbelf_set_exports(const host_kbelf_export_t* table, size_t count) {
+    exports      = table;
+    export_count = count;
+}
+
+kbelf_laddr kbelf_inst_getvaddr(kbelf_inst inst, kbelf_addr vaddr) {
+    if (inst == NULL || vaddr - inst->vaddr >= inst->size) return 0;
+    return (kbelf_laddr)inst->memory + (vaddr - inst->vaddr);
+}
+
+// Pointer to `length` bytes at `vaddr` of the loaded image, NULL when out of bounds
+static void* image_at(kbelf_inst inst, uint32_t vaddr, size_t length) {
+    if (vaddr - inst->vaddr > inst->size || length > inst->size - (vaddr - inst->vaddr)) return NULL;
+    return inst->memory + (vaddr - inst->vaddr);
+}
+
+static bool resolve(kbelf_inst inst, const dynamic_t* dynamic, uint32_t index, uint32_t* out_address) {
+    const elf_symbol_t* symbol = image_at(inst, dynamic->symtab + index * sizeof(elf_symbol_t), sizeof(elf_symbol_t));
+    if (symbol == NULL) return false;
+    if (symbol->shndx != 0) {
+        *out_address = (uint32_t)(kbelf_laddr)inst->memory - inst->vaddr + symbol->value;
+        return true;
+    }
+    const char* name = image_at(inst, dynamic->strtab + symbol->name, 1);
+    if (name == NULL) return false;
+    for (size_t i = 0; i < export_count; i++) {
+        if (strcmp(exports[i].name, name) == 0) {
+            *out_address = exports[i].address;
+            return true;
+        }
+    }
+    fprintf(stderr, "kbelf: undefined symbol %s\n", name);
+    return false;
+}
+
+static bool relocate(kbelf_inst inst, const dynamic_t* dynamic, uint32_t table, uint32_t table_size) {
+    for (uint32_t offset = 0; offset + sizeof(elf_rela_t) <= table_size; offset += sizeof(elf_rela_t)) {
+        const elf_rela_t* rela = image_at(inst, table + offset, sizeof(elf_rela_t));
+        if (rela == NULL) return false;
+        uint32_t value;
+        switch (rela->info & 0xFF) {
+            case ELF_R_RISCV_NONE:
+                continue;
+            case ELF_R_RISCV_RELATIVE:
+                value = (uint32_t)(kbelf_laddr)inst->memory - inst->vaddr + rela->addend;
+                break;
+            case ELF_R_RISCV_32:
+            case ELF_R_RISCV_JUMP_SLOT:
+                if (!resolve(inst, dynamic, rela->info >> 8, &value)) return false;
+                value += rela->addend;
+                break;
+            default:
+                return false;
+        }
+        void* site = image_at(inst, rela->offset, sizeof(uint32_t));
+        if (site == NULL) return false;
+        memcpy(site, &value, sizeof(uint32_t));
+    }
+    return true;
+}
+
+static bool read_dynamic(kbelf_inst inst, uint32_t vaddr, uint32_t size, dynamic_t* dynamic) {
+    for (uint32_t offset = 0; offset + 8 <= size; offset += 8) {
+        const int32_t* entry = image_at(inst, vaddr + offset, 8);
+        if (entry == NULL) return false;
+        uint32_t value = (uint32_t)entry[1];
+        switch (entry[0]) {
+            case ELF_DT_NULL:
+                return true;
+            case ELF_DT_SYMTAB:
+                dynamic->symtab = value;
+                break;
+            case ELF_DT_STRTAB:
+                dynamic->strtab = value;
+                break;
+            case ELF_DT_RELA:
+                dynamic->tables[0] = value;
+                break;
+            case ELF_DT_RELASZ:
+                dynamic->table_sizes[0] = value;
+                break;
+            case ELF_DT_JMPREL:
+                dynamic->tables[1] = value;
+                break;
+            case ELF_DT_PLTRELSZ:
+                dynamic->table_sizes[1] = value;
+                break;
+            case ELF_DT_PREINIT_ARRAY:
+                dynamic->arrays[0] = value;
+                break;
+            case ELF_DT_PREINIT_ARRAYSZ:
+                dynamic->array_sizes[0] = value;
+                break;
+            case ELF_DT_INIT_ARRAY:
+                dynamic->arrays[1] = value;
+                break;
+            case ELF_DT_INIT_ARRAYSZ:
+                dynamic->array_sizes[1] = value;
+                break;
+            case ELF_DT_FINI_ARRAY:
+                dynamic->arrays[2] = value;
+                break;
+            case ELF_DT_FINI_ARRAYSZ:
+                dynamic->array_sizes[2] = value;
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+// The arrays hold load addresses once relocated
+static bool collect_functions(kbelf_dyn dyn, const dynamic_t* dynamic) {
+    size_t counts[3];
+    for (int i = 0; i < 3; i++) {
+        counts[i] = dynamic->array_sizes[i] / sizeof(uint32_t);
+    }
+    dyn->functions = malloc((counts[0] + counts[1] + counts[2] + 1) * sizeof(kbelf_laddr));
+    if (dyn->functions == NULL) return false;
+    size_t count = 0;
+    for (int i = 0; i < 3; i++) {
+        const uint32_t* array = image_at(dyn->exec_inst, dynamic->arrays[i], counts[i] * sizeof(uint32_t));
+        if (counts[i] > 0 && array == NULL) return false;
+        for (size_t j = 0; j < counts[i]; j++) {
+            dyn->functions[count++] = array[j];
+        }
+    }
+    dyn->preinit_len = counts[0];
+    dyn->init_len    = counts[1];
+    dyn->fini_len    = counts[2];
+    return true;
+}
+
+static bool load_segments(kbelf_inst inst, FILE* fd, const elf_program_header_t* segments, uint16_t count,
+                          dynamic_t* dynamic) {
+    uint32_t end   = 0;
+    uint32_t align = sizeof(uint32_t);
+    inst->vaddr    = UINT32_MAX;
+    for (uint16_t i = 0; i < count; i++) {
+        if (segments[i].type != ELF_PT_LOAD) continue;
+        if (segments[i].vaddr < inst->vaddr) inst->vaddr = segments[i].vaddr;
+        if (segments[i].vaddr + segments[i].memsz > end) end = segments[i].vaddr + segments[i].memsz;
+        if (segments[i].align > align) align = segments[i].align;
+    }
+    if (end <= inst->vaddr) return false;
+    inst->size   = ((end - inst->vaddr) + align - 1) & ~(align - 1);
+    inst->memory = heap_caps_aligned_alloc(align, inst->size, MALLOC_CAP_SPIRAM);
+    if (inst->memory == NULL) return false;
+    memset(inst->memory, 0, inst->size);
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (segments[i].type != ELF_PT_LOAD) continue;
+        if (segments[i].filesz > segments[i].memsz || fseek(fd, segments[i].offset, SEEK_SET) != 0 ||
+            fread(inst->memory + (segments[i].vaddr - inst->vaddr), 1, segments[i].filesz, fd) !=
+                segments[i].filesz) {
+            return false;
+        }
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        if (segments[i].type == ELF_PT_DYNAMIC) {
+            return read_dynamic(inst, segments[i].vaddr, segments[i].filesz, dynamic);
+        }
+    }
+    return false;
+}
+
+kbelf_dyn kbelf_dyn_create(int pid) {
+    return calloc(1, sizeof(struct kbelf_dyn_s));
+}
+
+bool kbelf_dyn_set_exec(kbelf_dyn dyn, const char* path, const char* name) {
+    free(dyn->path);
+    dyn->path = strdup(path);
+    return dyn->path != NULL;
+}
+
+bool kbelf_dyn_load(kbelf_dyn dyn) {
+    FILE* fd = fopen(dyn->path, "rb");
+    if (fd == NULL) return false;
+
+    elf_header_t          header;
+    elf_program_header_t* segments = NULL;
+    dynamic_t             dynamic  = {0};
+    dyn->exec_inst                 = calloc(1, sizeof(struct kbelf_inst_s));
+    bool ok = dyn->exec_inst != NULL && fread(&header, sizeof(header), 1, fd) == 1 &&
+              memcmp(header.ident, "\x7f" "ELF\x01\x01", 6) == 0 && header.phentsize == sizeof(elf_program_header_t);
+    ok      = ok && (segments = malloc(header.phnum * sizeof(elf_program_header_t))) != NULL &&
+              fseek(fd, header.phoff, SEEK_SET) == 0 &&
+              fread(segments, sizeof(elf_program_header_t), header.phnum, fd) == header.phnum;
+    ok      = ok && load_segments(dyn->exec_inst, fd, segments, header.phnum, &dynamic);
+    fclose(fd);
+    free(segments);
+
+    for (int i = 0; ok && i < 2; i++) {
+        ok = relocate(dyn->exec_inst, &dynamic, dynamic.tables[i], dynamic.table_sizes[i]);
+    }
+    ok = ok && collect_functions(dyn, &dynamic);
+    if (!ok) {
+        kbelf_dyn_unload(dyn);
+    }
+    return ok;
+}
+
+void kbelf_dyn_unload(kbelf_dyn dyn) {
+    if (dyn->exec_inst != NULL) {
+        heap_caps_free(dyn->exec_inst->memory);
+        free(dyn->exec_inst);
+        dyn->exec_inst = NULL;
+    }
+    free(dyn->functions);
+    dyn->functions = NULL;
+}
+
+void kbelf_dyn_destroy(kbelf_dyn dyn) {
+    free(dyn->path);
+    free(dyn);
+}
+
+size_t kbelf_dyn_preinit_len(kbelf_dyn dyn) {
+    return dyn->preinit_len;
+}
+
+kbelf_laddr kbelf_dyn_preinit_get(kbelf_dyn dyn, size_t index) {
+    return dyn->functions[index];
+}
+
+size_t kbelf_dyn_init_len(kbelf_dyn dyn) {
+    return dyn->init_len;
+}
+
+kbelf_laddr kbelf_dyn_init_get(kbelf_dyn dyn, size_t index) {
+    return dyn->functions[dyn->preinit_len + index];
+}
+
+size_t kbelf_dyn_fini_len(kbelf_dyn dyn) {
+    return dyn->fini_len;
+}
+
+kbelf_laddr kbelf_dyn_fini_get(kbelf_dyn dyn, size_t index) {
+    return dyn->functions[dyn->preinit_len + dyn->init_len + index];
+}
@@ -0,0 +1,14 @@
+// Export table of the kbelf stand-in (support/host_kbelf.c)
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    const char* name;
+    uint32_t    address;
+} host_kbelf_export_t;
+
+// Symbols the launcher exports to plugins, undefined symbols of a plugin are resolved against them by name. The
+// table has to stay valid while plugins are linked.
+void host_kbelf_set_exports(const host_kbelf_export_t* exports, size_t count);
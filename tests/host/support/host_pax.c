@@ -0,0 +1,135 @@
+// Host pax-gfx backed by the call counters of host_pax.h
+
+#include "host_pax.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include "pax_gfx.h"
+
+static host_pax_stats_t stats = {0};
+
+host_pax_stats_t host_pax_stats(void) {
+    return stats;
+}
+
+void host_pax_reset_stats(void) {
+    stats = (host_pax_stats_t){0};
+}
+
+// Decodes the next UTF-8 character, a byte that does not start a valid sequence is taken as a character of its own
+static uint32_t next_character(const char** text) {
+    const uint8_t* c      = (const uint8_t*)*text;
+    size_t         length = (c[0] & 0xe0) == 0xc0 ? 2 : (c[0] & 0xf0) == 0xe0 ? 3 : (c[0] & 0xf8) == 0xf0 ? 4 : 1;
+    uint32_t       character = (length == 1) ? c[0] : c[0] & (0x7f >> length);
+    size_t         i         = 1;
+    for (; i < length && (c[i] & 0xc0) == 0x80; i++) {
+        character = (character << 6) | (c[i] & 0x3f);
+    }
+    *text += i;
+    return character;
+}
+
+// Advance of a character at the default size, searched in the ranges of the font the way pax does
+static float glyph_width(const pax_font_t* font, uint32_t character) {
+    for (size_t i = 0; i < font->n_ranges; i++) {
+        const pax_font_range_t* range = &font->ranges[i];
+        if (character >= range->start && character <= range->end) {
+            return range->widths[character - range->start];
+        }
+    }
+    return font->default_size / 2;  // Drawn as a box
+}
+
+static pax_vec2f measure(const pax_font_t* font, float font_size, const char* text, size_t* glyphs) {
+    float     scale = font_size / font->default_size;
+    pax_vec2f size  = {0, font_size};
+    float     line  = 0;
+    while (*text != '\0') {
+        uint32_t character = next_character(&text);
+        (*glyphs)++;
+        if (character == '\n') {
+            size.y += font_size;
+            line    = 0;
+            continue;
+        }
+        line += glyph_width(font, character) * scale;
+        if (line > size.x) size.x = line;
+    }
+    return size;
+}
+
+pax_vec2f pax_text_size(const pax_font_t* font, float font_size, const char* text) {
+    stats.measures++;
+    return measure(font, font_size, text, &stats.glyphs);
+}
+
+// Drawing walks the glyphs as well, they are not counted as measured
+pax_vec2f pax_draw_text(pax_buf_t* buf, pax_col_t color, const pax_font_t* font, float font_size, float x, float y,
+                        const char* text) {
+    size_t glyphs = 0;
+    stats.texts++;
+    return measure(font, font_size, text, &glyphs);
+}
+
+pax_vec2f pax_right_text(pax_buf_t* buf, pax_col_t color, const pax_font_t* font, float font_size, float x, float y,
+                         const char* text) {
+    size_t glyphs = 0;
+    stats.texts++;
+    return measure(font, font_size, text, &glyphs);
+}
+
+void pax_simple_rect(pax_buf_t* buf, pax_col_t color, float x, float y, float width, float height) {
+    stats.shapes++;
+}
+
+void pax_outline_rect(pax_buf_t* buf, pax_col_t color, float x, float y, float width, float height) {
+    stats.shapes++;
+}
+
+void pax_draw_rect(pax_buf_t* buf, pax_col_t color, float x, float y, float width, float height) {
+    stats.shapes++;
+}
+
+void pax_draw_line(pax_buf_t* buf, pax_col_t color, float x0, float y0, float x1, float y1) {
+    stats.shapes++;
+}
+
+void pax_draw_image(pax_buf_t* buf, const pax_buf_t* image, float x, float y) {
+    stats.shapes++;
+}
+
+void pax_clip(pax_buf_t* buf, float x, float y, float width, float height) {
+}
+
+void pax_noclip(pax_buf_t* buf) {
+}
+
+int pax_buf_get_width(const pax_buf_t* buf) {
+    return buf->width;
+}
+
+int pax_buf_get_height(const pax_buf_t* buf) {
+    return buf->height;
+}
+
+void pax_buf_init(pax_buf_t* buf, void* mem, int width, int height, pax_buf_type_t type) {
+    *buf = (pax_buf_t){.width = width, .height = height, .pixels = mem};
+    if (mem == NULL) {
+        buf->pixels  = calloc((size_t)width * height, sizeof(uint32_t));
+        buf->do_free = true;
+    }
+}
+
+void pax_buf_destroy(pax_buf_t* buf) {
+    if (buf->do_free) {
+        free(buf->pixels);
+    }
+    *buf = (pax_buf_t){0};
+}
+
+const void* pax_buf_get_pixels(const pax_buf_t* buf) {
+    return buf->pixels;
+}
+
+void* pax_buf_get_pixels_rw(pax_buf_t* buf) {
+    return buf->pixels;
+}
@@ -0,0 +1,14 @@
+// Call counters of the pax-gfx stand-in (include/pax_gfx.h)
+#pragma once
+
+#include <stddef.h>
+
+typedef struct {
+    size_t measures;  // pax_text_size calls made by the code under test
+    size_t glyphs;    // Glyphs looked up by those calls
+    size_t texts;     // pax_draw_text and pax_right_text calls
+    size_t shapes;    // Rectangles, lines and images
+} host_pax_stats_t;
+
+host_pax_stats_t host_pax_stats(void);
+void             host_pax_reset_stats(void);
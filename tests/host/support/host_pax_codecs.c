@@ -0,0 +1,23 @@
+// Host PNG decoding behind include/pax_codecs.h
+
+#include "pax_codecs.h"
+#include <png.h>
+#include "pax_gfx.h"
+
+bool pax_decode_png_fd(pax_buf_t* buf, FILE* fd, pax_buf_type_t buf_type, int flags) {
+    png_image image = {.version = PNG_IMAGE_VERSION};
+    if (!png_image_begin_read_from_stdio(&image, fd)) {
+        return false;
+    }
+
+    // BGRA in memory is ARGB in a little endian 32-bit word, the layout of PAX_BUF_32_8888ARGB
+    image.format = PNG_FORMAT_BGRA;
+    pax_buf_init(buf, NULL, image.width, image.height, buf_type);
+    if (pax_buf_get_pixels(buf) == NULL ||
+        !png_image_finish_read(&image, NULL, pax_buf_get_pixels_rw(buf), 0, NULL)) {
+        png_image_free(&image);
+        pax_buf_destroy(buf);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+// Minimal assertions and timing for the host tests and benchmarks
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static int host_test_failures = 0;
+
+// Records a failure and carries on, so one run reports every broken check
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            host_test_failures++;                                                         \
+        }                                                                                 \
+    } while (0)
+
+// Stops the test, for checks later steps depend on
+#define REQUIRE(condition)                                                                  \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            fprintf(stderr, "%s:%d: REQUIRE failed: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#define RUN_TEST(function)                                                                     \
+    do {                                                                                       \
+        int failures_before = host_test_failures;                                              \
+        function();                                                                            \
+        printf("%s %s\n", host_test_failures == failures_before ? "PASS" : "FAIL", #function); \
+    } while (0)
+
+static inline int host_test_result(void) {
+    if (host_test_failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", host_test_failures);
+        return 1;
+    }
+    return 0;
+}
+
+static inline uint64_t host_time_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+// Keeps the optimizer from dropping a benchmarked result
+static inline void host_keep(const void* value) {
+    __asm__ volatile("" : : "g"(value) : "memory");
+}
@@ -0,0 +1,285 @@
+// Host esp_http_client backed by the stand-in server of http_server.h
+
+#include "http_server.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "esp_http_client.h"
+
+#define MAX_REQUEST_HEADERS 16
+#define MAX_REDIRECTS       10
+#define DEFAULT_BUFFER_SIZE 512  // DEFAULT_HTTP_BUF_SIZE of esp_http_client
+
+struct esp_http_client {
+    esp_http_client_config_t config;
+    char*                    url;
+    char*                    header_keys[MAX_REQUEST_HEADERS];
+    char*                    header_values[MAX_REQUEST_HEADERS];
+    int                      status_code;
+    int64_t                  content_length;
+    bool                     chunked;
+    bool                     connected;
+};
+
+static host_http_handler_t server_handler = NULL;
+static void*               server_arg     = NULL;
+static host_http_stats_t   server_stats   = {0};
+static pthread_mutex_t     stats_mutex    = PTHREAD_MUTEX_INITIALIZER;  // Clients can run on several threads
+
+void host_http_set_handler(host_http_handler_t handler, void* arg) {
+    server_handler = handler;
+    server_arg     = arg;
+}
+
+host_http_stats_t host_http_stats(void) {
+    pthread_mutex_lock(&stats_mutex);
+    host_http_stats_t stats = server_stats;
+    pthread_mutex_unlock(&stats_mutex);
+    return stats;
+}
+
+void host_http_reset_stats(void) {
+    pthread_mutex_lock(&stats_mutex);
+    memset(&server_stats, 0, sizeof(server_stats));
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+static void add_stats(unsigned requests, unsigned range_requests, unsigned cut, size_t body_bytes) {
+    pthread_mutex_lock(&stats_mutex);
+    server_stats.requests       += requests;
+    server_stats.range_requests += range_requests;
+    server_stats.cut            += cut;
+    server_stats.body_bytes     += body_bytes;
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+void host_http_serve_file(const host_http_request_t* request, const host_http_file_t* file,
+                          host_http_response_t* response) {
+    response->status        = 200;
+    response->etag          = file->etag;
+    response->last_modified = file->last_modified;
+    response->chunked       = file->chunked;
+    response->piece_size    = file->piece_size;
+
+    size_t offset = 0;
+    if (file->ranges && request->range != NULL && sscanf(request->range, "bytes=%zu-", &offset) == 1) {
+        // A weak validator never matches If-Range, the whole file is sent instead
+        const char* if_range = request->if_range;
+        bool        current  = if_range == NULL ||
+                       (strncmp(if_range, "W/", 2) != 0 && file->etag != NULL && strcmp(if_range, file->etag) == 0) ||
+                       (file->last_modified != NULL && strcmp(if_range, file->last_modified) == 0);
+        if (!current) {
+            offset = 0;
+        } else if (offset >= file->length) {
+            response->status = 416;
+            response->body   = NULL;
+            response->length = 0;
+            return;
+        }
+    } else {
+        offset = 0;
+    }
+
+    if (offset > 0) {
+        response->status = 206;
+        snprintf(response->content_range, sizeof(response->content_range), "bytes %zu-%zu/%zu", offset,
+                 file->length - 1, file->length);
+    }
+    response->body   = file->data + offset;
+    response->length = file->length - offset;
+}
+
+// Client
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t* config) {
+    struct esp_http_client* client = calloc(1, sizeof(struct esp_http_client));
+    if (client == NULL) return NULL;
+    client->config = *config;
+    client->url    = strdup(config->url != NULL ? config->url : "");
+    return client;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client) {
+    if (client == NULL) return ESP_FAIL;
+    for (int i = 0; i < MAX_REQUEST_HEADERS; i++) {
+        free(client->header_keys[i]);
+        free(client->header_values[i]);
+    }
+    free(client->url);
+    free(client);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t client) {
+    client->connected = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char* url) {
+    free(client->url);
+    client->url = strdup(url);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_method(esp_http_client_handle_t client, esp_http_client_method_t method) {
+    client->config.method = method;
+    return ESP_OK;
+}
+
+static int find_header(esp_http_client_handle_t client, const char* key) {
+    for (int i = 0; i < MAX_REQUEST_HEADERS; i++) {
+        if (client->header_keys[i] != NULL && strcasecmp(client->header_keys[i], key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char* key, const char* value) {
+    int index = find_header(client, key);
+    if (index < 0) {
+        for (int i = 0; index < 0 && i < MAX_REQUEST_HEADERS; i++) {
+            if (client->header_keys[i] == NULL) index = i;
+        }
+        if (index < 0) return ESP_ERR_NO_MEM;
+        client->header_keys[index] = strdup(key);
+    }
+    free(client->header_values[index]);
+    client->header_values[index] = strdup(value);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_get_header(esp_http_client_handle_t client, const char* key, char** value) {
+    int index = find_header(client, key);
+    *value    = index >= 0 ? client->header_values[index] : NULL;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_delete_header(esp_http_client_handle_t client, const char* key) {
+    int index = find_header(client, key);
+    if (index >= 0) {
+        free(client->header_keys[index]);
+        free(client->header_values[index]);
+        client->header_keys[index]   = NULL;
+        client->header_values[index] = NULL;
+    }
+    return ESP_OK;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client) {
+    return client->status_code;
+}
+
+int64_t esp_http_client_get_content_length(esp_http_client_handle_t client) {
+    return client->content_length;
+}
+
+bool esp_http_client_is_chunked_response(esp_http_client_handle_t client) {
+    return client->chunked;
+}
+
+static esp_err_t dispatch(esp_http_client_handle_t client, esp_http_client_event_id_t id, const void* data,
+                          size_t length, const char* key, const char* value) {
+    if (client->config.event_handler == NULL) return ESP_OK;
+    esp_http_client_event_t event = {
+        .event_id     = id,
+        .client       = client,
+        .data         = (void*)data,
+        .data_len     = (int)length,
+        .user_data    = client->config.user_data,
+        .header_key   = (char*)key,
+        .header_value = (char*)value,
+    };
+    return client->config.event_handler(&event);
+}
+
+static void dispatch_header(esp_http_client_handle_t client, const char* key, const char* value) {
+    if (value == NULL) return;
+    // The handler gets writable copies, like the buffers the real client parses into
+    char* key_copy   = strdup(key);
+    char* value_copy = strdup(value);
+    dispatch(client, HTTP_EVENT_ON_HEADER, NULL, 0, key_copy, value_copy);
+    free(key_copy);
+    free(value_copy);
+}
+
+static bool is_redirect(int status) {
+    return status == 301 || status == 302 || status == 303 || status == 307 || status == 308;
+}
+
+static const char* request_header(esp_http_client_handle_t client, const char* key) {
+    int index = find_header(client, key);
+    return index >= 0 ? client->header_values[index] : NULL;
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client) {
+    if (server_handler == NULL) return ESP_ERR_HTTP_CONNECT;
+
+    for (int redirects = 0; redirects <= MAX_REDIRECTS; redirects++) {
+        host_http_request_t request = {
+            .url               = client->url,
+            .range             = request_header(client, "Range"),
+            .if_range          = request_header(client, "If-Range"),
+            .if_none_match     = request_header(client, "If-None-Match"),
+            .if_modified_since = request_header(client, "If-Modified-Since"),
+        };
+        host_http_response_t response = {.status = 200, .cut_after = SIZE_MAX};
+        server_handler(&request, &response, server_arg);
+        add_stats(1, request.range != NULL, 0, 0);
+
+        if (!client->connected) {
+            dispatch(client, HTTP_EVENT_ON_CONNECTED, NULL, 0, NULL, NULL);
+            client->connected = true;
+        }
+        dispatch(client, HTTP_EVENT_HEADERS_SENT, NULL, 0, NULL, NULL);
+
+        client->status_code    = response.status;
+        client->chunked        = response.chunked;
+        client->content_length = response.chunked ? -1 : (int64_t)response.length;
+        dispatch(client, HTTP_EVENT_ON_STATUS_CODE, NULL, 0, NULL, NULL);
+
+        char content_length[24];
+        snprintf(content_length, sizeof(content_length), "%zu", response.length);
+        dispatch_header(client, "Server", "host");
+        dispatch_header(client, response.chunked ? "Transfer-Encoding" : "Content-Length",
+                        response.chunked ? "chunked" : content_length);
+        dispatch_header(client, "ETag", response.etag);
+        dispatch_header(client, "Last-Modified", response.last_modified);
+        dispatch_header(client, "Location", response.location);
+        dispatch_header(client, "Content-Range", response.content_range[0] != '\0' ? response.content_range : NULL);
+        dispatch(client, HTTP_EVENT_ON_HEADERS_COMPLETE, NULL, 0, NULL, NULL);
+
+        size_t piece = response.piece_size;
+        if (piece == 0) {
+            piece = client->config.buffer_size > 0 ? (size_t)client->config.buffer_size : DEFAULT_BUFFER_SIZE;
+        }
+        size_t end = response.length < response.cut_after ? response.length : response.cut_after;
+        for (size_t offset = 0; offset < end; offset += piece) {
+            size_t length = end - offset < piece ? end - offset : piece;
+            dispatch(client, HTTP_EVENT_ON_DATA, response.body + offset, length, NULL, NULL);
+            add_stats(0, 0, 0, length);
+        }
+        if (end < response.length) {
+            add_stats(0, 0, 1, 0);
+            client->connected = false;
+            dispatch(client, HTTP_EVENT_DISCONNECTED, NULL, 0, NULL, NULL);
+            return ESP_ERR_HTTP_CONNECTION_CLOSED;
+        }
+
+        if (is_redirect(response.status) && response.location != NULL && !client->config.disable_auto_redirect) {
+            esp_http_client_set_url(client, response.location);
+            continue;
+        }
+
+        dispatch(client, HTTP_EVENT_ON_FINISH, NULL, 0, NULL, NULL);
+        if (!client->config.keep_alive_enable) {
+            client->connected = false;
+            dispatch(client, HTTP_EVENT_DISCONNECTED, NULL, 0, NULL, NULL);
+        }
+        return ESP_OK;
+    }
+    return ESP_ERR_HTTP_MAX_REDIRECT;
+}
@@ -0,0 +1,59 @@
+// Stand-in server behind the host esp_http_client (include/esp_http_client.h)
+// Tests install a handler that answers each request. The client plays the answer back through the event handler of
+// the module under test: status, headers, the body in pieces and, unless the connection is cut, the finish event.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    const char* url;
+    const char* range;  // Request headers, NULL when not sent
+    const char* if_range;
+    const char* if_none_match;
+    const char* if_modified_since;
+} host_http_request_t;
+
+typedef struct {
+    int            status;  // 200 unless the handler sets it
+    const uint8_t* body;    // Has to stay valid until esp_http_client_perform returns
+    size_t         length;
+    bool           chunked;     // No Content-Length header, like chunked transfer encoding
+    size_t         piece_size;  // Largest piece of body per data event, 0 for the client buffer size
+    size_t         cut_after;   // Drop the connection after this many bytes of body, SIZE_MAX (default) for none
+    const char*    etag;        // Response headers, NULL to leave them out
+    const char*    last_modified;
+    const char*    location;
+    char           content_range[64];
+} host_http_response_t;
+
+typedef void (*host_http_handler_t)(const host_http_request_t* request, host_http_response_t* response, void* arg);
+
+void host_http_set_handler(host_http_handler_t handler, void* arg);
+
+// A file served the way a static file server does, with optional support for range requests
+typedef struct {
+    const uint8_t* data;
+    size_t         length;
+    const char*    etag;  // NULL to not send one
+    const char*    last_modified;
+    bool           ranges;  // Honour Range requests whose If-Range matches
+    bool           chunked;
+    size_t         piece_size;
+} host_http_file_t;
+
+// Answers 206 with the rest of the file for a range request the server can honour, 416 for a range past the end and
+// 200 with the whole file otherwise
+void host_http_serve_file(const host_http_request_t* request, const host_http_file_t* file,
+                          host_http_response_t* response);
+
+typedef struct {
+    unsigned requests;
+    unsigned range_requests;
+    unsigned cut;         // Responses whose connection was dropped
+    size_t   body_bytes;  // Body bytes delivered to the client
+} host_http_stats_t;
+
+host_http_stats_t host_http_stats(void);
+void              host_http_reset_stats(void);
@@ -0,0 +1,312 @@
+// Delta updates of AppFS executables (app_delta.c) with patches made by tools/app_delta.py
+// The Makefile builds delta_app.c at two revisions and creates a patch between them with the tool. Applying that
+// patch to the old executable in the in-memory AppFS has to produce the new one, also when the download is cut.
+// Damaged and hand-made patches check that a patch never reads or writes out of bounds and that a failed update
+// leaves the installed executable alone, so the caller can fall back to downloading it in full.
+
+#include <openssl/evp.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_delta.h"
+#include "appfs.h"
+#include "host_appfs.h"
+#include "host_test.h"
+#include "http_download.h"
+#include "http_server.h"
+
+#define URL          "https://example.com/app/delta.bin"
+#define SLUG         "app"
+#define NAME         "Delta stand-in"
+#define REVISION     2
+#define HEADER_SIZE  48
+#define COPY_SIZE    9
+#define INSERT_SIZE  5
+#define PATCH_MAGIC  "ADLT"
+#define SMALL_SIZE   1000
+
+typedef struct {
+    uint8_t* data;
+    size_t   length;
+} blob_t;
+
+static blob_t old_image;
+static blob_t new_image;
+static blob_t patch;
+
+typedef struct {
+    host_http_file_t file;
+    int              cuts_left;
+    uint32_t         random;
+} server_t;
+
+static server_t server;
+
+static blob_t read_file(const char* path) {
+    blob_t blob = {0};
+    FILE*  file = fopen(path, "rb");
+    if (file == NULL) return blob;
+    fseek(file, 0, SEEK_END);
+    blob.length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    blob.data = malloc(blob.length);
+    if (fread(blob.data, 1, blob.length, file) != blob.length) blob.length = 0;
+    fclose(file);
+    return blob;
+}
+
+static void handler(const host_http_request_t* request, host_http_response_t* response, void* arg) {
+    host_http_serve_file(request, &server.file, response);
+    if (server.cuts_left > 0 && response->length > 0) {
+        server.random       = server.random * 1664525 + 1013904223;
+        response->cut_after = (server.random >> 8) % response->length;
+        server.cuts_left--;
+    }
+}
+
+static void serve(const uint8_t* data, size_t length) {
+    server = (server_t){.file = {.data = data, .length = length, .etag = "\"patch\"", .piece_size = 1460}};
+    host_http_set_handler(handler, NULL);
+    host_http_reset_stats();
+}
+
+static void install_old(const uint8_t* data, size_t length) {
+    host_appfs_reset();
+    host_appfs_add(SLUG, NAME, REVISION - 1, data, length);
+}
+
+// Applies the patch that is being served, checking the patch download against expected when not NULL
+static esp_err_t apply(const uint8_t* expected) {
+    http_session_t session = http_session_begin(URL);
+    if (expected != NULL) http_session_set_expected_sha256(session, expected);
+    esp_err_t res = app_delta_install_from_http(session, URL, SLUG, NAME, REVISION);
+    http_session_end(session);
+    return res;
+}
+
+static bool installed_equals(const uint8_t* data, size_t length) {
+    size_t         installed_length = 0;
+    const uint8_t* installed        = host_appfs_contents(SLUG, &installed_length);
+    return installed != NULL && installed_length == length && memcmp(installed, data, length) == 0;
+}
+
+// Only the installed executable may be left, with its old contents
+static bool untouched(const uint8_t* data, size_t length) {
+    return host_appfs_count() == 1 && installed_equals(data, length);
+}
+
+static void put_u32(uint8_t* destination, uint32_t value) {
+    memcpy(destination, &value, sizeof(value));  // The host is little endian, like the patch format
+}
+
+static size_t put_header(uint8_t* destination, uint32_t old_size, const uint8_t* new_data, uint32_t new_size) {
+    memcpy(destination, PATCH_MAGIC, 4);
+    put_u32(destination + 4, old_size);
+    put_u32(destination + 8, new_size);
+    put_u32(destination + 12, 0);
+    EVP_Digest(new_data, new_size, destination + 16, NULL, EVP_sha256(), NULL);
+    return HEADER_SIZE;
+}
+
+static size_t put_copy(uint8_t* destination, uint32_t offset, uint32_t length) {
+    destination[0] = 'C';
+    put_u32(destination + 1, offset);
+    put_u32(destination + 5, length);
+    return COPY_SIZE;
+}
+
+// Offset of the first insert command of a patch, 0 when there is none
+static size_t first_insert(const blob_t* blob) {
+    size_t position = HEADER_SIZE;
+    while (position < blob->length) {
+        if (blob->data[position] == 'I') return position;
+        position += COPY_SIZE;
+    }
+    return 0;
+}
+
+static void test_round_trip(void) {
+    uint8_t digest[HTTP_SHA256_SIZE];
+    EVP_Digest(patch.data, patch.length, digest, NULL, EVP_sha256(), NULL);
+    install_old(old_image.data, old_image.length);
+    serve(patch.data, patch.length);
+    CHECK(apply(digest) == ESP_OK);
+    CHECK(host_appfs_count() == 1);
+    CHECK(installed_equals(new_image.data, new_image.length));
+
+    uint16_t    version = 0;
+    const char* title   = NULL;
+    appfsEntryInfoExt(appfsOpen(SLUG), NULL, &title, &version, NULL);
+    CHECK(version == REVISION && strcmp(title, NAME) == 0);
+    printf("  %zu byte patch for a %zu byte executable\n", patch.length, new_image.length);
+    CHECK(patch.length < new_image.length / 2);
+}
+
+// Every attempt after a cut starts over with a new AppFS file
+static void test_round_trip_interrupted(void) {
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        install_old(old_image.data, old_image.length);
+        serve(patch.data, patch.length);
+        server.cuts_left = 2;
+        server.random    = seed;
+        CHECK(apply(NULL) == ESP_OK);
+        CHECK(host_appfs_count() == 1 && installed_equals(new_image.data, new_image.length));
+    }
+}
+
+static void test_other_old_executable(void) {
+    uint8_t* other = malloc(old_image.length + 1);
+    memcpy(other, old_image.data, old_image.length);
+    other[old_image.length] = 0;
+    install_old(other, old_image.length + 1);
+    serve(patch.data, patch.length);
+    CHECK(apply(NULL) == ESP_ERR_INVALID_STATE);
+    CHECK(untouched(other, old_image.length + 1));
+    free(other);
+}
+
+// Copies have to stay within the old executable, including ranges whose end wraps around 32 bits
+static void test_copy_bounds(void) {
+    static const struct {
+        uint32_t offset;
+        uint32_t length;
+        bool     valid;
+    } copies[] = {
+        {0, SMALL_SIZE, true},
+        {SMALL_SIZE - 10, 10, true},
+        {SMALL_SIZE, 0, true},
+        {SMALL_SIZE - 10, 11, false},
+        {SMALL_SIZE + 1, 0, false},
+        {0xFFFFFFF0, 0x20, false},
+        {10, 0xFFFFFFFF, false},
+    };
+    uint8_t old_data[SMALL_SIZE];
+    for (size_t i = 0; i < sizeof(old_data); i++) {
+        old_data[i] = i * 7;
+    }
+
+    for (size_t i = 0; i < sizeof(copies) / sizeof(copies[0]); i++) {
+        // The copy produces the end of the new executable, it starts with the first byte of the old one
+        uint32_t length   = copies[i].valid ? copies[i].length : 10;
+        uint8_t  new_data[1 + SMALL_SIZE];
+        new_data[0] = old_data[0];
+        if (copies[i].valid) memcpy(&new_data[1], &old_data[copies[i].offset], length);
+
+        uint8_t data[HEADER_SIZE + 2 * COPY_SIZE];
+        size_t  size  = put_header(data, SMALL_SIZE, new_data, 1 + length);
+        size         += put_copy(&data[size], 0, 1);
+        size         += put_copy(&data[size], copies[i].offset, copies[i].length);
+
+        install_old(old_data, SMALL_SIZE);
+        serve(data, size);
+        esp_err_t res = apply(NULL);
+        if (copies[i].valid) {
+            CHECK(res == ESP_OK && installed_equals(new_data, 1 + length));
+        } else {
+            CHECK(res == ESP_ERR_INVALID_RESPONSE && untouched(old_data, SMALL_SIZE));
+        }
+    }
+}
+
+// A patch that produces more data than its header announces is rejected before anything is read or written
+static void test_output_bounds(void) {
+    uint8_t old_data[SMALL_SIZE] = {1};
+    uint8_t data[HEADER_SIZE + 2 * COPY_SIZE];
+    size_t  size  = put_header(data, SMALL_SIZE, old_data, 100);
+    size         += put_copy(&data[size], 0, 100);
+    size         += put_copy(&data[size], 0, 1);
+    install_old(old_data, SMALL_SIZE);
+    serve(data, size);
+    CHECK(apply(NULL) == ESP_ERR_INVALID_RESPONSE && untouched(old_data, SMALL_SIZE));
+
+    size = put_header(data, SMALL_SIZE, old_data, 100);
+    memcpy(&data[size], "I", 1);
+    put_u32(&data[size + 1], 0xFFFFFFFF);
+    serve(data, size + INSERT_SIZE);
+    CHECK(apply(NULL) == ESP_ERR_INVALID_RESPONSE && untouched(old_data, SMALL_SIZE));
+}
+
+// A patch that produces data other than its digest promises fails and the caller downloads the executable in full
+// over the same session
+static void test_digest_mismatch(void) {
+    blob_t damaged = {malloc(patch.length), patch.length};
+    size_t insert  = first_insert(&patch);
+    REQUIRE(insert > 0);
+
+    for (int variant = 0; variant < 2; variant++) {
+        memcpy(damaged.data, patch.data, patch.length);
+        if (variant == 0) {
+            damaged.data[16] ^= 0x01;  // Digest in the header
+        } else {
+            damaged.data[insert + INSERT_SIZE] ^= 0x80;  // Inserted data
+        }
+        install_old(old_image.data, old_image.length);
+        serve(damaged.data, damaged.length);
+
+        uint8_t        digest[HTTP_SHA256_SIZE];
+        http_session_t session = http_session_begin(URL);
+        EVP_Digest(damaged.data, damaged.length, digest, NULL, EVP_sha256(), NULL);
+        http_session_set_expected_sha256(session, digest);
+        CHECK(app_delta_install_from_http(session, URL, SLUG, NAME, REVISION) == ESP_ERR_INVALID_CRC);
+        CHECK(untouched(old_image.data, old_image.length));
+
+        uint8_t* data = NULL;
+        size_t   size = 0;
+        serve(new_image.data, new_image.length);
+        EVP_Digest(new_image.data, new_image.length, digest, NULL, EVP_sha256(), NULL);
+        http_session_set_expected_sha256(session, digest);
+        CHECK(http_session_download_ram(session, URL, &data, &size));
+        CHECK(size == new_image.length && memcmp(data, new_image.data, size) == 0);
+        free(data);
+        http_session_end(session);
+    }
+    free(damaged.data);
+}
+
+// The download of the patch itself does not match the digest the repository published for it
+static void test_patch_digest_mismatch(void) {
+    uint8_t digest[HTTP_SHA256_SIZE];
+    EVP_Digest(patch.data, patch.length, digest, NULL, EVP_sha256(), NULL);
+    digest[0] ^= 1;
+    install_old(old_image.data, old_image.length);
+    serve(patch.data, patch.length);
+    CHECK(apply(digest) != ESP_OK);
+    CHECK(untouched(old_image.data, old_image.length));
+}
+
+static void test_truncated_patch(void) {
+    static const size_t lengths[] = {0, 10, HEADER_SIZE, HEADER_SIZE + 3};
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        install_old(old_image.data, old_image.length);
+        serve(patch.data, lengths[i]);
+        CHECK(apply(NULL) != ESP_OK);
+        CHECK(untouched(old_image.data, old_image.length));
+    }
+    install_old(old_image.data, old_image.length);
+    serve(patch.data, patch.length - 1);
+    CHECK(apply(NULL) == ESP_ERR_INVALID_RESPONSE);
+    CHECK(untouched(old_image.data, old_image.length));
+}
+
+int main(void) {
+    old_image = read_file(DELTA_OLD);
+    new_image = read_file(DELTA_NEW);
+    patch     = read_file(DELTA_PATCH);
+    REQUIRE(old_image.length > 0 && new_image.length > 0 && patch.length > HEADER_SIZE);
+    REQUIRE(memcmp(patch.data, PATCH_MAGIC, 4) == 0);
+
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_round_trip_interrupted);
+    RUN_TEST(test_other_old_executable);
+    RUN_TEST(test_copy_bounds);
+    RUN_TEST(test_output_bounds);
+    RUN_TEST(test_digest_mismatch);
+    RUN_TEST(test_patch_digest_mismatch);
+    RUN_TEST(test_truncated_patch);
+
+    host_appfs_reset();
+    free(old_image.data);
+    free(new_image.data);
+    free(patch.data);
+    return host_test_result();
+}
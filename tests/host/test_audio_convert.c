@@ -0,0 +1,220 @@
+// Sample rate converter (audio_convert.c)
+// Linear interpolation: every output frame has to lie on the line between the two input frames around its position,
+// also between full scale samples of opposite sign, where the product of their difference and the fraction used to
+// overflow and wrap the output around.
+// Windowed sinc: a sweep of sines has to come through the passband at its input level, with the images around
+// multiples of the input rate rejected.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "audio_convert.h"
+#include "host_test.h"
+
+#define INPUT_FRAMES  4096
+#define CHUNK_FRAMES  100  // Pushed at a time, not a multiple of anything the converter uses
+#define OUTPUT_FRAMES (INPUT_FRAMES * (AUDIO_CONVERT_MAX_RATE / AUDIO_CONVERT_MIN_RATE + 1))
+#define TOLERANCE     3    // Truncating the fraction to Q15 and the product
+
+#define SWEEP_AMPLITUDE   0.5
+#define SWEEP_SETTLE      1024   // Output frames skipped while the filter history fills
+#define SWEEP_OUTPUT      50000  // Settle time plus one second at the highest output rate of the sweep
+#define SWEEP_INPUT       60000  // The input behind it when converting down from 48000 Hz
+#define SWEEP_POINTS      9      // From 2 % to 34 % of the lower rate, where the sinc filter is still flat
+#define SWEEP_IMAGES      4      // Multiples of the input rate whose images are measured
+#define PASSBAND_DB       0.2    // Largest deviation from the input level in the passband
+#define IMAGE_DB          (-45)  // Highest image relative to the input level
+
+static int16_t input[INPUT_FRAMES * 2];
+static int16_t output[OUTPUT_FRAMES * 2];
+static int16_t sweep_input[SWEEP_INPUT * 2];
+static int16_t sweep_output[SWEEP_OUTPUT * 2];
+
+static uint32_t random_state = 12345;
+
+static int16_t random_sample(void) {
+    random_state = random_state * 1664525 + 1013904223;
+    return (int16_t)(random_state >> 16);
+}
+
+// Converts the complete input, returns the number of output frames
+static size_t convert(uint32_t input_rate, uint32_t output_rate) {
+    audio_format_t    format    = {.rate          = input_rate,
+                                   .channels      = 2,
+                                   .sample_format = AUDIO_SAMPLE_S16,
+                                   .resampler     = AUDIO_RESAMPLER_LINEAR};
+    audio_converter_t converter = audio_converter_create(&format, output_rate);
+    REQUIRE(converter != NULL);
+    size_t pushed   = 0;
+    size_t produced = 0;
+    while (pushed < INPUT_FRAMES) {
+        size_t frames  = INPUT_FRAMES - pushed < CHUNK_FRAMES ? INPUT_FRAMES - pushed : CHUNK_FRAMES;
+        size_t bytes   = audio_converter_push(converter, &input[pushed * 2], frames * 2 * sizeof(int16_t));
+        pushed        += bytes / (2 * sizeof(int16_t));
+        produced      += audio_converter_pull(converter, &output[produced * 2], OUTPUT_FRAMES - produced);
+    }
+    audio_converter_free(converter);
+    return produced;
+}
+
+// Largest distance of an output sample from the line between its input frames. The first input frame lands on
+// output frame 0, positions advance by the Q32.32 step the converter uses.
+static long worst_error(uint32_t input_rate, uint32_t output_rate, size_t produced) {
+    uint64_t step  = ((uint64_t)input_rate << 32) / output_rate;
+    long     worst = 0;
+    for (size_t n = 0; n < produced; n++) {
+        uint64_t position = n * step;
+        size_t   frame    = position >> 32;
+        if (frame + 1 >= INPUT_FRAMES) break;
+        double fraction = (double)(uint32_t)position / 4294967296.0;
+        for (int channel = 0; channel < 2; channel++) {
+            double a     = input[frame * 2 + channel];
+            double b     = input[(frame + 1) * 2 + channel];
+            long   error = labs(lround(a + (b - a) * fraction) - output[n * 2 + channel]);
+            if (error > worst) worst = error;
+        }
+    }
+    return worst;
+}
+
+static const uint32_t rates[][2] = {
+    {44100, 48000}, {22050, 44100}, {48000, 44100}, {8000, 96000}, {96000, 8000}, {11025, 44100},
+};
+
+static void check_rates(const char* signal) {
+    bool accurate = true;
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        size_t produced = convert(rates[i][0], rates[i][1]);
+        long   error    = worst_error(rates[i][0], rates[i][1], produced);
+        printf("  %s %5u -> %5u Hz: %zu frames, off by at most %ld\n", signal, rates[i][0], rates[i][1], produced,
+               error);
+        accurate = accurate && produced > 0 && error <= TOLERANCE;
+    }
+    CHECK(accurate);
+}
+
+// Full scale of alternating sign, the largest difference between neighbouring frames
+static void test_full_scale_alternating(void) {
+    for (int f = 0; f < INPUT_FRAMES; f++) {
+        input[f * 2]     = (f % 2 == 0) ? INT16_MAX : INT16_MIN;
+        input[f * 2 + 1] = (f % 2 == 0) ? INT16_MIN : INT16_MAX;
+    }
+    check_rates("alternating");
+}
+
+static void test_full_scale_random(void) {
+    for (int i = 0; i < INPUT_FRAMES * 2; i++) {
+        input[i] = random_sample();
+    }
+    check_rates("random     ");
+}
+
+// Converts a sine at `frequency` into sweep_output, SWEEP_SETTLE frames followed by one second at the output rate
+static void convert_sine(audio_resampler_t resampler, uint32_t input_rate, uint32_t output_rate, double frequency) {
+    size_t wanted = SWEEP_SETTLE + output_rate;
+    size_t frames = (size_t)((uint64_t)wanted * input_rate / output_rate) + CHUNK_FRAMES;
+    REQUIRE(frames <= SWEEP_INPUT && wanted <= SWEEP_OUTPUT);
+    for (size_t f = 0; f < frames; f++) {
+        int16_t sample = (int16_t)lrint(SWEEP_AMPLITUDE * 32767.0 * sin(2.0 * M_PI * frequency * f / input_rate));
+        sweep_input[f * 2]     = sample;
+        sweep_input[f * 2 + 1] = sample;
+    }
+
+    audio_format_t    format    = {.rate          = input_rate,
+                                   .channels      = 2,
+                                   .sample_format = AUDIO_SAMPLE_S16,
+                                   .resampler     = resampler};
+    audio_converter_t converter = audio_converter_create(&format, output_rate);
+    REQUIRE(converter != NULL);
+    size_t pushed   = 0;
+    size_t produced = 0;
+    while (produced < wanted && pushed < frames) {
+        size_t chunk  = frames - pushed < CHUNK_FRAMES ? frames - pushed : CHUNK_FRAMES;
+        size_t bytes  = audio_converter_push(converter, &sweep_input[pushed * 2], chunk * 2 * sizeof(int16_t));
+        pushed       += bytes / (2 * sizeof(int16_t));
+        produced     += audio_converter_pull(converter, &sweep_output[produced * 2], wanted - produced);
+    }
+    audio_converter_free(converter);
+    REQUIRE(produced == wanted);
+}
+
+// Level of `frequency` in the second after the settle time relative to the input level. Whole numbers of Hz land
+// on an exact bin of the one second window.
+static double level_db(uint32_t output_rate, double frequency) {
+    const int16_t* window = &sweep_output[SWEEP_SETTLE * 2];
+    double         coeff  = 2.0 * cos(2.0 * M_PI * frequency / output_rate);
+    double         s1 = 0, s2 = 0;
+    for (uint32_t f = 0; f < output_rate; f++) {
+        double s0 = window[f * 2] + coeff * s1 - s2;
+        s2        = s1;
+        s1        = s0;
+    }
+    double level = 2.0 * sqrt(s1 * s1 + s2 * s2 - coeff * s1 * s2) / output_rate / 32767.0;
+    return 20.0 * log10(level / SWEEP_AMPLITUDE + 1e-12);
+}
+
+// Highest image of `frequency` around the multiples of the input rate, folded into the output band
+static double worst_image_db(uint32_t input_rate, uint32_t output_rate, double frequency) {
+    double worst = -200;
+    for (int k = 1; k <= SWEEP_IMAGES; k++) {
+        double images[] = {k * (double)input_rate - frequency, k * (double)input_rate + frequency};
+        for (int i = 0; i < 2; i++) {
+            double image = fmod(images[i], output_rate);
+            if (image > output_rate / 2.0) image = output_rate - image;
+            if (image < 1 || fabs(image - frequency) < 1) continue;  // DC or on top of the tone itself
+            double level = level_db(output_rate, image);
+            if (level > worst) worst = level;
+        }
+    }
+    return worst;
+}
+
+static const uint32_t sweep_rates[][2] = {
+    {22050, 48000}, {44100, 48000}, {8000, 48000}, {48000, 44100},
+};
+
+static void test_sinc_sweep(void) {
+    bool flat     = true;
+    bool rejected = true;
+    for (size_t i = 0; i < sizeof(sweep_rates) / sizeof(sweep_rates[0]); i++) {
+        uint32_t input_rate  = sweep_rates[i][0];
+        uint32_t output_rate = sweep_rates[i][1];
+        double   lowest      = 0;
+        double   highest     = 0;
+        double   image       = -200;
+        uint32_t lower       = input_rate < output_rate ? input_rate : output_rate;
+        for (int point = 0; point < SWEEP_POINTS; point++) {
+            double frequency = round(lower * (0.02 + 0.04 * point));
+            convert_sine(AUDIO_RESAMPLER_SINC, input_rate, output_rate, frequency);
+            double level = level_db(output_rate, frequency);
+            double worst = worst_image_db(input_rate, output_rate, frequency);
+            lowest       = level < lowest ? level : lowest;
+            highest      = level > highest ? level : highest;
+            image        = worst > image ? worst : image;
+        }
+        printf("  %5u -> %5u Hz: passband %+.3f to %+.3f dB, images at most %.1f dB\n", input_rate, output_rate,
+               lowest, highest, image);
+        flat     = flat && lowest > -PASSBAND_DB && highest < PASSBAND_DB;
+        rejected = rejected && image < IMAGE_DB;
+    }
+    CHECK(flat);
+    CHECK(rejected);
+}
+
+// The same measurement has to see the images linear interpolation leaves, or the sinc sweep proves nothing
+static void test_linear_images_are_measured(void) {
+    double frequency = round(22050 * 0.34);
+    convert_sine(AUDIO_RESAMPLER_LINEAR, 22050, 48000, frequency);
+    double image = worst_image_db(22050, 48000, frequency);
+    printf("  linear 22050 -> 48000 Hz at %.0f Hz: images at %.1f dB\n", frequency, image);
+    CHECK(image > IMAGE_DB);
+}
+
+int main(void) {
+    RUN_TEST(test_full_scale_alternating);
+    RUN_TEST(test_full_scale_random);
+    RUN_TEST(test_sinc_sweep);
+    RUN_TEST(test_linear_images_are_measured);
+    return host_test_result();
+}
@@ -0,0 +1,198 @@
+// Mixer summing and limiter (audio_mix.c)
+// Checks that a mix below the threshold passes unchanged, that summed streams never exceed the threshold, that a
+// stream keeps its level when another one is added and that a sustained overload is limited with little distortion
+// compared to clipping it.
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+#include "audio_mix.h"
+#include "host_test.h"
+
+#define SAMPLE_RATE   44100
+#define CHUNK_FRAMES  256  // MIXER_CHUNK_FRAMES in audio_mixer.c
+#define CHUNK_SAMPLES (CHUNK_FRAMES * 2)
+
+// One second at 1 kHz puts the fundamental and every harmonic on an exact bin
+#define ANALYSIS_FRAMES SAMPLE_RATE
+#define SETTLE_CHUNKS   8
+#define TOTAL_CHUNKS    (SETTLE_CHUNKS + (ANALYSIS_FRAMES + CHUNK_FRAMES - 1) / CHUNK_FRAMES)
+#define TOTAL_FRAMES    (TOTAL_CHUNKS * CHUNK_FRAMES)
+#define HARMONICS       9
+
+static int16_t signal_a[TOTAL_FRAMES * 2];
+static int16_t signal_b[TOTAL_FRAMES * 2];
+static int16_t output[TOTAL_FRAMES * 2];
+
+static void make_sine(int16_t* out, double amplitude, double frequency) {
+    for (int f = 0; f < TOTAL_FRAMES; f++) {
+        int16_t sample = (int16_t)lrint(amplitude * 32767.0 * sin(2.0 * M_PI * frequency * f / SAMPLE_RATE));
+        out[f * 2]     = sample;
+        out[f * 2 + 1] = sample;
+    }
+}
+
+static uint32_t random_state = 12345;
+
+static int16_t random_sample(int16_t limit) {
+    random_state = random_state * 1664525 + 1013904223;
+    return (int16_t)((int32_t)(random_state >> 16) % (2 * limit + 1) - limit);
+}
+
+// Mixes `count` streams at `gain` through a fresh limiter, like the mixer task does chunk by chunk
+static void mix(const int16_t* const* streams, int count, int32_t gain) {
+    audio_limiter_t limiter;
+    audio_limiter_reset(&limiter);
+    int32_t accum[CHUNK_SAMPLES];
+    for (int chunk = 0; chunk < TOTAL_CHUNKS; chunk++) {
+        memset(accum, 0, sizeof(accum));
+        for (int stream = 0; stream < count; stream++) {
+            audio_mix_accumulate(accum, &streams[stream][chunk * CHUNK_SAMPLES], CHUNK_SAMPLES, gain);
+        }
+        audio_limiter_process(&limiter, accum, &output[chunk * CHUNK_SAMPLES], CHUNK_FRAMES);
+    }
+}
+
+// Amplitude of the left channel at `frequency` over the analysis window, in full scale
+static double level_at(const int16_t* samples, double frequency) {
+    const int16_t* window = &samples[SETTLE_CHUNKS * CHUNK_SAMPLES];
+    double         coeff  = 2.0 * cos(2.0 * M_PI * frequency / SAMPLE_RATE);
+    double         s1 = 0, s2 = 0;
+    for (int f = 0; f < ANALYSIS_FRAMES; f++) {
+        double s0 = window[f * 2] + coeff * s1 - s2;
+        s2        = s1;
+        s1        = s0;
+    }
+    double power = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+    return 2.0 * sqrt(power) / ANALYSIS_FRAMES / 32767.0;
+}
+
+static double thd(const int16_t* samples, double fundamental) {
+    double harmonics = 0;
+    for (int h = 2; h <= HARMONICS; h++) {
+        double level  = level_at(samples, fundamental * h);
+        harmonics    += level * level;
+    }
+    return sqrt(harmonics) / level_at(samples, fundamental);
+}
+
+static int16_t peak(const int16_t* samples, size_t count) {
+    int16_t result = 0;
+    for (size_t j = 0; j < count; j++) {
+        int16_t v = samples[j] < 0 ? -samples[j] : samples[j];
+        if (v > result) result = v;
+    }
+    return result;
+}
+
+static void test_passthrough_below_threshold(void) {
+    for (int j = 0; j < TOTAL_FRAMES * 2; j++) {
+        signal_a[j] = random_sample(AUDIO_LIMITER_THRESHOLD);
+    }
+    const int16_t* streams[] = {signal_a};
+    mix(streams, 1, AUDIO_MIX_GAIN_UNITY);
+    CHECK(memcmp(output, signal_a, sizeof(output)) == 0);
+}
+
+static void test_summed_streams_stay_below_threshold(void) {
+    static int16_t noise[4][TOTAL_FRAMES * 2];
+    const int16_t* streams[4];
+    for (int stream = 0; stream < 4; stream++) {
+        for (int j = 0; j < TOTAL_FRAMES * 2; j++) {
+            noise[stream][j] = random_sample(INT16_MAX);
+        }
+        streams[stream] = noise[stream];
+    }
+    for (int count = 1; count <= 4; count++) {
+        mix(streams, count, AUDIO_MIX_GAIN_UNITY);
+        CHECK(peak(output, TOTAL_FRAMES * 2) <= AUDIO_LIMITER_THRESHOLD);
+    }
+}
+
+static void test_gain_scales_stream(void) {
+    int16_t samples[CHUNK_SAMPLES];
+    int32_t accum[CHUNK_SAMPLES] = {0};
+    for (int j = 0; j < CHUNK_SAMPLES; j++) {
+        samples[j] = random_sample(INT16_MAX);
+    }
+    audio_mix_accumulate(accum, samples, CHUNK_SAMPLES, AUDIO_MIX_GAIN_UNITY / 2);
+    for (int j = 0; j < CHUNK_SAMPLES; j++) {
+        CHECK(accum[j] == samples[j] >> 1);
+    }
+    memset(accum, 0, sizeof(accum));
+    audio_mix_accumulate(accum, samples, CHUNK_SAMPLES, 0);
+    for (int j = 0; j < CHUNK_SAMPLES; j++) {
+        CHECK(accum[j] == 0);
+    }
+}
+
+// The mix is not divided by the number of streams, a second stream leaves the first one as loud as before
+static void test_second_stream_keeps_level(void) {
+    make_sine(signal_a, 0.4, 1000);
+    make_sine(signal_b, 0.4, 3100);
+    const int16_t* streams[] = {signal_a, signal_b};
+
+    mix(streams, 1, AUDIO_MIX_GAIN_UNITY);
+    double alone = level_at(output, 1000);
+    mix(streams, 2, AUDIO_MIX_GAIN_UNITY);
+    double together = level_at(output, 1000);
+    printf("  1 kHz level alone %.4f, with a second stream %.4f\n", alone, together);
+    CHECK(fabs(alone - 0.4) < 0.001);
+    CHECK(fabs(together - alone) < 0.001);
+}
+
+// Two streams at 0.9 full scale sum to 1.8, the limiter has to take out 6 dB for as long as they play
+static void test_sustained_overload_distortion(void) {
+    make_sine(signal_a, 0.9, 1000);
+    const int16_t* streams[] = {signal_a, signal_a};
+
+    static int16_t clipped[TOTAL_FRAMES * 2];
+    for (int j = 0; j < TOTAL_FRAMES * 2; j++) {
+        int32_t sum = 2 * signal_a[j];
+        clipped[j]  = sum > INT16_MAX ? INT16_MAX : sum < INT16_MIN ? INT16_MIN : (int16_t)sum;
+    }
+    mix(streams, 2, AUDIO_MIX_GAIN_UNITY);
+
+    double limited_thd = thd(output, 1000);
+    double clipped_thd = thd(clipped, 1000);
+    printf("  THD limited %.3f %%, clipped %.3f %%\n", limited_thd * 100, clipped_thd * 100);
+    CHECK(peak(output, TOTAL_FRAMES * 2) <= AUDIO_LIMITER_THRESHOLD);
+    CHECK(limited_thd < 0.01);
+    CHECK(limited_thd * 10 < clipped_thd);
+}
+
+// After a peak the gain climbs back by AUDIO_LIMITER_RELEASE_STEP per block until quiet input passes unchanged
+static void test_release_after_peak(void) {
+    audio_limiter_t limiter;
+    audio_limiter_reset(&limiter);
+    int32_t accum[CHUNK_SAMPLES];
+    int16_t out[CHUNK_SAMPLES];
+    for (int j = 0; j < CHUNK_SAMPLES; j++) {
+        accum[j] = 2 * INT16_MAX;
+    }
+    audio_limiter_process(&limiter, accum, out, CHUNK_FRAMES);
+    CHECK(limiter.gain < AUDIO_MIX_GAIN_UNITY / 2);
+
+    int  blocks   = (AUDIO_MIX_GAIN_UNITY - limiter.gain + AUDIO_LIMITER_RELEASE_STEP - 1) / AUDIO_LIMITER_RELEASE_STEP;
+    int  chunks   = (blocks * AUDIO_LIMITER_BLOCK_FRAMES + CHUNK_FRAMES - 1) / CHUNK_FRAMES;
+    bool restored = false;
+    for (int chunk = 0; chunk <= chunks && !restored; chunk++) {
+        for (int j = 0; j < CHUNK_SAMPLES; j++) {
+            accum[j] = 1000;
+        }
+        audio_limiter_process(&limiter, accum, out, CHUNK_FRAMES);
+        restored = limiter.gain == AUDIO_MIX_GAIN_UNITY;
+        CHECK(restored || chunk < chunks);
+    }
+    CHECK(out[CHUNK_SAMPLES - 1] == 1000);
+}
+
+int main(void) {
+    RUN_TEST(test_passthrough_below_threshold);
+    RUN_TEST(test_summed_streams_stay_below_threshold);
+    RUN_TEST(test_gain_scales_stream);
+    RUN_TEST(test_second_stream_keeps_level);
+    RUN_TEST(test_sustained_overload_distortion);
+    RUN_TEST(test_release_after_peak);
+    return host_test_result();
+}
@@ -0,0 +1,89 @@
+// Text measurement cache (gui_text.c) against the pax-gfx stand-in
+// Cached sizes have to be those pax_text_size returns for the same font, size and string, also for strings that share
+// a set of the cache, strings too long to be cached and characters outside printable ASCII.
+
+#include <stdio.h>
+#include <string.h>
+#include "gui_text.h"
+#include "host_pax.h"
+#include "host_test.h"
+#include "pax_gfx.h"
+
+static uint8_t          widths[0x80];
+static pax_font_range_t ranges[] = {{0x20, 0x7e, widths}, {0xa0, 0x11f, widths}};
+static const pax_font_t font_a   = {.name = "a", .n_ranges = 2, .ranges = ranges, .default_size = 16};
+static const pax_font_t font_b   = {.name = "b", .n_ranges = 1, .ranges = ranges, .default_size = 24};
+
+static bool same(pax_vec2f a, pax_vec2f b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+// Many more labels than entries, in two fonts and sizes, looked up in a few rounds
+static void test_sizes_match(void) {
+    gui_text_cache_clear();
+    bool matches = true;
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 4 * GUI_TEXT_CACHE_ENTRIES; i++) {
+            char label[32];
+            snprintf(label, sizeof(label), "Label %d%s", i, (i % 5 == 0) ? "\nsecond line" : "");
+            const pax_font_t* font   = (i % 2) ? &font_a : &font_b;
+            float             size   = (i % 3) ? 16 : 9;
+            pax_vec2f         cached = gui_text_size(font, size, label);
+            matches                  = matches && same(cached, pax_text_size(font, size, label));
+        }
+    }
+    CHECK(matches);
+}
+
+// The strings of a launcher frame stay cached while the cursor moves over the grid, even when some of them share a set
+static void test_frame_stays_cached(void) {
+    static const char* fixed[] = {"Launcher", "12:34", "87%", "WiFi", "Start", "Back", "Settings", "v1.4.0"};
+    char               labels[40][32];
+    for (size_t i = 0; i < 40; i++) {
+        snprintf(labels[i], sizeof(labels[i]), "Application %zu", i);
+    }
+
+    gui_text_cache_clear();
+    for (int frame = 0; frame < 80; frame++) {
+        if (frame == 40) {
+            host_pax_reset_stats();  // Every string has been measured once
+        }
+        for (size_t i = 0; i < 12; i++) {
+            gui_text_size(&font_a, 16, labels[(frame + i) % 40]);
+        }
+        for (size_t i = 0; i < sizeof(fixed) / sizeof(fixed[0]); i++) {
+            gui_text_size(&font_b, 16, fixed[i]);
+        }
+    }
+    size_t measures = host_pax_stats().measures;
+    CHECK(measures == 0);
+    printf("  %zu measures over 40 frames\n", measures);
+}
+
+static void test_long_and_unicode(void) {
+    gui_text_cache_clear();
+    char long_text[GUI_TEXT_CACHE_KEY_SIZE + 10];
+    memset(long_text, 'w', sizeof(long_text) - 1);
+    long_text[sizeof(long_text) - 1] = '\0';
+    CHECK(same(gui_text_size(&font_a, 16, long_text), pax_text_size(&font_a, 16, long_text)));
+    const char* unicode = "Caf\xc3\xa9 \xe2\x82\xac";
+    CHECK(same(gui_text_size(&font_a, 16, unicode), pax_text_size(&font_a, 16, unicode)));
+
+    bool matches = true;
+    for (int c = 1; c < 256; c++) {
+        char text[2] = {(char)c, '\0'};
+        matches      = matches && gui_text_char_width(&font_a, 16, (char)c) == pax_text_size(&font_a, 16, text).x;
+        matches      = matches && gui_text_char_width(&font_b, 24, (char)c) == pax_text_size(&font_b, 24, text).x;
+    }
+    CHECK(matches);
+}
+
+int main(void) {
+    for (size_t i = 0; i < sizeof(widths); i++) {
+        widths[i] = 3 + (i * 7) % 11;
+    }
+    RUN_TEST(test_sizes_match);
+    RUN_TEST(test_frame_stays_cached);
+    RUN_TEST(test_long_and_unicode);
+    return host_test_result();
+}
@@ -0,0 +1,342 @@
+// Streaming through the response cache (http_cache.c) into the repository projection (repository_projection.c)
+// The listing has to be projected while it arrives, from the server or replayed from the cache entry written on the
+// way, and come out the same every time: after a 304, after a dropped connection, when the server is unreachable and
+// when the listing is too large to be stored.
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bsp/device.h"
+#include "host_test.h"
+#include "http_cache.h"
+#include "http_server.h"
+#include "repository_projection.h"
+
+#define URL         "https://example.com/v1/projects?offset=0&amount=20"
+#define MAX_LISTING (256 * 1024)
+
+// Icon workers of the repository browser, together downloading three times what the cache holds
+#define ICON_WORKERS 4
+#define ICONS        16  // Per worker
+#define ICON_SIZE    (3 * 1024)
+
+typedef struct {
+    host_http_file_t file;
+    int              status;     // Answer with this status instead of the listing when not 0
+    size_t           cut_after;  // Drop the connection of the next response after this many bytes, 0 for none
+} server_t;
+
+static server_t server;
+static char     listing[MAX_LISTING];
+static size_t   listing_length;
+static uint8_t  icons[ICON_WORKERS * ICONS][ICON_SIZE];
+
+static void handler(const host_http_request_t* request, host_http_response_t* response, void* arg) {
+    if (server.status != 0) {
+        response->status = server.status;
+        return;
+    }
+    if (request->if_none_match != NULL && server.file.etag != NULL &&
+        strcmp(request->if_none_match, server.file.etag) == 0) {
+        response->status = 304;
+        return;
+    }
+    host_http_serve_file(request, &server.file, response);
+    if (server.cut_after > 0) {
+        response->cut_after = server.cut_after;
+        server.cut_after    = 0;
+    }
+}
+
+// A listing of count projects, every third one a plugin for this device
+static void generate(size_t count) {
+    size_t length = snprintf(listing, sizeof(listing), "[");
+    for (size_t i = 0; i < count; i++) {
+        length += snprintf(listing + length, sizeof(listing) - length,
+                           "%s{\"slug\":\"project-%zu\",\"project\":{\"name\":\"Project %zu\",\"version\":\"1.%zu\","
+                           "\"description\":\"A project that does something with the badge, number %zu\","
+                           "\"icon\":{\"32x32\":\"icon%zu.png\"},\"application\":[{\"type\":\"%s\","
+                           "\"targets\":[\"%s\"]}]}}",
+                           i > 0 ? "," : "", i, i, i, i, i, (i % 3 == 2) ? "plugin" : "appfs", HOST_DEVICE_NAME);
+        REQUIRE(length < sizeof(listing) - 1);
+    }
+    length         += snprintf(listing + length, sizeof(listing) - length, "]");
+    listing_length  = length;
+}
+
+static void serve(const char* etag) {
+    server = (server_t){
+        .file = {.data = (const uint8_t*)listing, .length = listing_length, .etag = etag, .piece_size = 700},
+    };
+    host_http_set_handler(handler, NULL);
+    host_http_reset_stats();
+}
+
+static void clear_cache(void) {
+    DIR* dir = opendir(HTTP_CACHE_INT_PATH);
+    if (dir == NULL) return;
+    struct dirent* dirent;
+    while ((dirent = readdir(dir)) != NULL) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s", HTTP_CACHE_INT_PATH, dirent->d_name);
+        if (dirent->d_name[0] != '.') unlink(path);
+    }
+    closedir(dir);
+}
+
+static size_t cache_files(void) {
+    DIR* dir = opendir(HTTP_CACHE_INT_PATH);
+    if (dir == NULL) return 0;
+    size_t         count = 0;
+    struct dirent* dirent;
+    while ((dirent = readdir(dir)) != NULL) {
+        count += dirent->d_name[0] != '.';
+    }
+    closedir(dir);
+    return count;
+}
+
+typedef struct {
+    http_stream_sink_t sink;  // Of the projection, wrapped to see what reaches it
+    size_t             begins;
+    size_t             largest_write;
+} spy_t;
+
+static bool spy_begin(size_t size, void* arg) {
+    spy_t* spy = arg;
+    spy->begins++;
+    return spy->sink.begin(size, spy->sink.arg);
+}
+
+static bool spy_write(const uint8_t* data, size_t length, size_t offset, void* arg) {
+    spy_t* spy = arg;
+    if (length > spy->largest_write) spy->largest_write = length;
+    return spy->sink.write(data, length, offset, spy->sink.arg);
+}
+
+static bool spy_end(bool success, void* arg) {
+    spy_t* spy = arg;
+    return spy->sink.end(success, spy->sink.arg);
+}
+
+// Loads the listing the way load_project_records does and checks the records against the generated listing
+static bool load(size_t expected_count, spy_t* spy) {
+    repository_projection_t* projection = malloc(sizeof(repository_projection_t));
+    REQUIRE(projection != NULL);
+    repository_projection_begin(projection);
+    *spy                    = (spy_t){.sink = repository_projection_sink(projection)};
+    http_stream_sink_t sink = {.begin = spy_begin, .write = spy_write, .end = spy_end, .arg = spy};
+    bool               downloaded = http_cache_download_stream(URL, &sink);
+    if (!downloaded) {
+        projection->failed = true;
+    }
+    repository_project_t* projects = NULL;
+    size_t                count    = 0;
+    bool                  success  = repository_projection_end(projection, &projects, &count);
+    bool                  entries  = projection->entries == expected_count;
+    free(projection);
+    if (!success) return false;
+
+    bool matches = entries && count == expected_count;
+    for (size_t i = 0; matches && i < count; i++) {
+        char slug[32];
+        snprintf(slug, sizeof(slug), "project-%zu", i);
+        matches = strcmp(projects[i].slug, slug) == 0 && projects[i].is_plugin == (i % 3 == 2);
+    }
+    repository_projection_free(projects, count);
+    return matches;
+}
+
+static http_cache_stats_t stats_since(const http_cache_stats_t* before) {
+    http_cache_stats_t now;
+    http_cache_get_stats(&now);
+    return (http_cache_stats_t){
+        .hits       = now.hits - before->hits,
+        .misses     = now.misses - before->misses,
+        .stale_hits = now.stale_hits - before->stale_hits,
+        .evictions  = now.evictions - before->evictions,
+    };
+}
+
+// Downloaded once, then replayed from the entry written while it streamed in
+static void test_revalidated(void) {
+    clear_cache();
+    generate(200);
+    serve("\"v1\"");
+    http_cache_stats_t before;
+    http_cache_get_stats(&before);
+    spy_t spy;
+
+    CHECK(load(200, &spy));
+    CHECK(cache_files() == 1);
+    CHECK(host_http_stats().body_bytes == listing_length);
+
+    CHECK(load(200, &spy));
+    http_cache_stats_t stats = stats_since(&before);
+    CHECK(stats.misses == 1 && stats.hits == 1);
+    CHECK(host_http_stats().body_bytes == listing_length);  // The second answer was a 304 without a body
+    // The entry is replayed in chunks, never as one buffer
+    CHECK(spy.largest_write > 0 && spy.largest_write <= 4096 && listing_length > 4096);
+}
+
+// A changed listing replaces the entry
+static void test_changed(void) {
+    clear_cache();
+    generate(50);
+    serve("\"v1\"");
+    spy_t spy;
+    CHECK(load(50, &spy));
+
+    generate(80);
+    serve("\"v2\"");
+    CHECK(load(80, &spy));
+    serve("\"v2\"");
+    CHECK(load(80, &spy));
+    CHECK(host_http_stats().body_bytes == 0 && cache_files() == 1);
+}
+
+// The first attempt is cut in the middle of an entry, the projection starts over with the retry
+static void test_dropped_connection(void) {
+    clear_cache();
+    generate(200);
+    serve("\"v1\"");
+    server.cut_after = listing_length / 2;
+    spy_t spy;
+    CHECK(load(200, &spy));
+    CHECK(spy.begins == 2 && host_http_stats().cut == 1);
+
+    // The entry holds the complete listing, not the part of the first attempt
+    serve("\"v1\"");
+    CHECK(load(200, &spy));
+    CHECK(host_http_stats().body_bytes == 0);
+}
+
+// An unreachable server and a listing that does not parse both fall back to the stored copy
+static void test_stale(void) {
+    clear_cache();
+    generate(120);
+    serve("\"v1\"");
+    spy_t spy;
+    CHECK(load(120, &spy));
+
+    http_cache_stats_t before;
+    http_cache_get_stats(&before);
+    server.status = 503;
+    CHECK(load(120, &spy));
+
+    static const char broken[] = "[{\"slug\":\"project-0\",\"project\":{\"name\":";
+    serve("\"v2\"");
+    server.file.data   = (const uint8_t*)broken;
+    server.file.length = strlen(broken);
+    CHECK(load(120, &spy));
+    http_cache_stats_t stats = stats_since(&before);
+    CHECK(stats.stale_hits == 2 && stats.misses == 0);
+}
+
+// Without a stored copy a failed download fails the load and leaves no entry behind
+static void test_failure(void) {
+    clear_cache();
+    generate(20);
+    serve("\"v1\"");
+    server.status = 500;
+    spy_t spy;
+    CHECK(!load(20, &spy));
+    CHECK(cache_files() == 0);
+}
+
+// Listings larger than the cache and responses without validators are projected but not stored
+static void test_not_stored(void) {
+    clear_cache();
+    generate(1000);
+    REQUIRE(listing_length > CONFIG_HTTP_CACHE_SIZE * 1024);
+    serve("\"v1\"");
+    spy_t spy;
+    CHECK(load(1000, &spy));
+    CHECK(cache_files() == 0);
+
+    generate(20);
+    serve(NULL);
+    CHECK(load(20, &spy));
+    CHECK(cache_files() == 0);
+}
+
+// Serves /icons/icon<n>.png, every byte of icon n is n
+static void icon_handler(const host_http_request_t* request, host_http_response_t* response, void* arg) {
+    const char* name  = strstr(request->url, "/icons/icon");
+    int         index = (name != NULL) ? atoi(name + strlen("/icons/icon")) : -1;
+    if (index < 0 || index >= ICON_WORKERS * ICONS) {
+        response->status = 404;
+        return;
+    }
+    if (request->if_none_match != NULL && strcmp(request->if_none_match, "\"v1\"") == 0) {
+        response->status = 304;
+        return;
+    }
+    host_http_file_t file = {.data = icons[index], .length = ICON_SIZE, .etag = "\"v1\""};
+    host_http_serve_file(request, &file, response);
+}
+
+// Downloads the icons of one worker twice, returns the number of downloads that failed or got another icon
+static void* icon_worker(void* arg) {
+    size_t first    = (uintptr_t)arg * ICONS;
+    size_t failures = 0;
+    for (int round = 0; round < 2; round++) {
+        for (size_t i = first; i < first + ICONS; i++) {
+            char url[64];
+            snprintf(url, sizeof(url), "https://example.com/icons/icon%zu.png", i);
+            uint8_t* data = NULL;
+            size_t   size = 0;
+            bool     ok   = http_cache_download(url, &data, &size);
+            failures     += !ok || size != ICON_SIZE || data[0] != (uint8_t)i || data[ICON_SIZE - 1] != (uint8_t)i;
+            free(data);
+        }
+    }
+    return (void*)(uintptr_t)failures;
+}
+
+// Workers downloading at the same time, storing and evicting entries while the others read theirs, each get their
+// own icons and every download is counted once
+static void test_concurrent(void) {
+    clear_cache();
+    for (size_t i = 0; i < ICON_WORKERS * ICONS; i++) {
+        memset(icons[i], (uint8_t)i, ICON_SIZE);
+    }
+    host_http_set_handler(icon_handler, NULL);
+    http_cache_stats_t before;
+    http_cache_get_stats(&before);
+
+    pthread_t workers[ICON_WORKERS];
+    for (uintptr_t i = 0; i < ICON_WORKERS; i++) {
+        REQUIRE(pthread_create(&workers[i], NULL, icon_worker, (void*)i) == 0);
+    }
+    size_t failures = 0;
+    for (size_t i = 0; i < ICON_WORKERS; i++) {
+        void* result;
+        pthread_join(workers[i], &result);
+        failures += (uintptr_t)result;
+    }
+    CHECK(failures == 0);
+
+    http_cache_stats_t stats = stats_since(&before);
+    CHECK(stats.hits + stats.misses == ICON_WORKERS * ICONS * 2 && stats.stale_hits == 0);
+    CHECK(stats.evictions > 0 && cache_files() * ICON_SIZE <= CONFIG_HTTP_CACHE_SIZE * 1024);
+}
+
+int main(void) {
+    mkdir(HTTP_CACHE_INT_PATH, 0755);
+    http_cache_init();
+    RUN_TEST(test_revalidated);
+    RUN_TEST(test_changed);
+    RUN_TEST(test_dropped_connection);
+    RUN_TEST(test_stale);
+    RUN_TEST(test_failure);
+    RUN_TEST(test_not_stored);
+    RUN_TEST(test_concurrent);
+    clear_cache();
+    return host_test_result();
+}
@@ -0,0 +1,285 @@
+// HTTP downloads (http_download.c) against the stand-in server
+// Every download function is run with fixed-length and chunked bodies, and with answers that are not the file:
+// error statuses, a redirect with a body of its own and a not-modified answer to a conditional request.
+
+#include <openssl/evp.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "host_test.h"
+#include "http_download.h"
+#include "http_server.h"
+
+#define URL        "https://example.com/file.bin"
+#define OTHER_URL  "https://cdn.example.com/file.bin"
+#define FILE_SIZE  (100 * 1024 + 123)  // Larger than the initial RAM buffer, not a multiple of any piece size
+#define ERROR_PAGE "<html><body>Not here</body></html>"
+
+static uint8_t file_data[FILE_SIZE];
+static uint8_t file_digest[HTTP_SHA256_SIZE];
+static char    directory[] = "/tmp/http_download_XXXXXX";
+static char    path[64];
+
+typedef struct {
+    host_http_file_t file;
+    int              status;  // Answer with this status and an error page instead of the file when not 0
+    bool             redirect;
+} server_t;
+
+static server_t server;
+
+static void handler(const host_http_request_t* request, host_http_response_t* response, void* arg) {
+    if (server.redirect && strcmp(request->url, URL) == 0) {
+        response->status   = 302;
+        response->location = OTHER_URL;
+        response->body     = (const uint8_t*)ERROR_PAGE;
+        response->length   = strlen(ERROR_PAGE);
+        return;
+    }
+    if (server.status != 0) {
+        response->status  = server.status;
+        response->body    = (const uint8_t*)ERROR_PAGE;
+        response->length  = strlen(ERROR_PAGE);
+        response->chunked = server.file.chunked;
+        return;
+    }
+    if (request->if_none_match != NULL && strcmp(request->if_none_match, server.file.etag) == 0) {
+        response->status = 304;
+        return;
+    }
+    host_http_serve_file(request, &server.file, response);
+}
+
+static void serve(bool chunked, int status) {
+    server = (server_t){
+        .file   = {.data = file_data, .length = FILE_SIZE, .etag = "\"v1\"", .chunked = chunked, .piece_size = 1000},
+        .status = status,
+    };
+    host_http_set_handler(handler, NULL);
+    host_http_reset_stats();
+}
+
+// Records what a stream sink receives
+typedef struct {
+    int      begins;
+    int      ends;
+    bool     success;
+    size_t   size;
+    size_t   received;
+    bool     in_order;
+    uint8_t* data;
+} sink_record_t;
+
+static bool sink_begin(size_t size, void* arg) {
+    sink_record_t* record = arg;
+    record->begins++;
+    record->size     = size;
+    record->received = 0;
+    return true;
+}
+
+static bool sink_write(const uint8_t* data, size_t length, size_t offset, void* arg) {
+    sink_record_t* record = arg;
+    if (offset != record->received || offset + length > FILE_SIZE) {
+        record->in_order = false;
+        return false;
+    }
+    memcpy(record->data + offset, data, length);
+    record->received += length;
+    return true;
+}
+
+static bool sink_end(bool success, void* arg) {
+    sink_record_t* record = arg;
+    record->ends++;
+    record->success = success;
+    return true;
+}
+
+static bool file_matches(const char* file_path) {
+    FILE* file = fopen(file_path, "rb");
+    if (file == NULL) return false;
+    uint8_t* contents = malloc(FILE_SIZE + 1);
+    size_t   length   = fread(contents, 1, FILE_SIZE + 1, file);
+    fclose(file);
+    bool matches = length == FILE_SIZE && memcmp(contents, file_data, FILE_SIZE) == 0;
+    free(contents);
+    return matches;
+}
+
+static bool file_exists(const char* file_path) {
+    struct stat st;
+    return stat(file_path, &st) == 0;
+}
+
+static void check_digest(http_session_t session) {
+    uint8_t digest[HTTP_SHA256_SIZE];
+    CHECK(http_session_get_sha256(session, digest));
+    CHECK(memcmp(digest, file_digest, HTTP_SHA256_SIZE) == 0);
+}
+
+static void test_download_ram(void) {
+    for (int chunked = 0; chunked <= 1; chunked++) {
+        serve(chunked, 0);
+        http_session_t session = http_session_begin(URL);
+        uint8_t*       data    = NULL;
+        size_t         size    = 0;
+        CHECK(http_session_download_ram(session, URL, &data, &size));
+        CHECK(size == FILE_SIZE);
+        CHECK(data != NULL && memcmp(data, file_data, FILE_SIZE) == 0);
+        check_digest(session);
+        free(data);
+        http_session_end(session);
+    }
+}
+
+static void test_download_file(void) {
+    for (int chunked = 0; chunked <= 1; chunked++) {
+        serve(chunked, 0);
+        http_session_t session = http_session_begin(URL);
+        CHECK(http_session_download_file(session, URL, path));
+        CHECK(file_matches(path));
+        check_digest(session);
+        http_session_end(session);
+        unlink(path);
+    }
+}
+
+static void test_download_stream(void) {
+    static uint8_t received[FILE_SIZE];
+    for (int chunked = 0; chunked <= 1; chunked++) {
+        serve(chunked, 0);
+        sink_record_t      record  = {.in_order = true, .data = received};
+        http_stream_sink_t sink    = {.begin = sink_begin, .write = sink_write, .end = sink_end, .arg = &record};
+        http_session_t     session = http_session_begin(URL);
+        CHECK(http_session_download_stream(session, URL, &sink));
+        CHECK(record.begins == 1 && record.ends == 1 && record.success && record.in_order);
+        CHECK(record.size == (chunked ? 0 : FILE_SIZE));
+        CHECK(record.received == FILE_SIZE && memcmp(received, file_data, FILE_SIZE) == 0);
+        check_digest(session);
+        http_session_end(session);
+    }
+}
+
+// The body of an error response must not reach a sink, a sink starting is what replaces an installed app
+static void test_error_status(void) {
+    static const int statuses[] = {404, 500, 206};
+    static uint8_t   received[FILE_SIZE];
+    for (size_t i = 0; i < sizeof(statuses) / sizeof(statuses[0]); i++) {
+        for (int chunked = 0; chunked <= 1; chunked++) {
+            serve(chunked, statuses[i]);
+            http_session_t session = http_session_begin(URL);
+
+            sink_record_t      record = {.in_order = true, .data = received};
+            http_stream_sink_t sink   = {.begin = sink_begin, .write = sink_write, .end = sink_end, .arg = &record};
+            CHECK(!http_session_download_stream(session, URL, &sink));
+            CHECK(record.begins == 0 && record.ends == 0 && record.received == 0);
+
+            uint8_t* data = NULL;
+            size_t   size = 0;
+            CHECK(!http_session_download_ram(session, URL, &data, &size));
+            CHECK(data == NULL);
+
+            CHECK(!http_session_download_file(session, URL, path));
+            CHECK(!file_exists(path));
+
+            CHECK(!http_session_get_sha256(session, (uint8_t[HTTP_SHA256_SIZE]){0}));
+            http_session_end(session);
+        }
+    }
+}
+
+// The client follows the redirect by itself and passes the body of the redirect to the event handler first
+static void test_redirect_body_skipped(void) {
+    static uint8_t received[FILE_SIZE];
+    for (int chunked = 0; chunked <= 1; chunked++) {
+        serve(chunked, 0);
+        server.redirect        = true;
+        http_session_t session = http_session_begin(URL);
+
+        uint8_t* data = NULL;
+        size_t   size = 0;
+        CHECK(http_session_download_ram(session, URL, &data, &size));
+        CHECK(size == FILE_SIZE && data != NULL && memcmp(data, file_data, FILE_SIZE) == 0);
+        free(data);
+
+        sink_record_t      record = {.in_order = true, .data = received};
+        http_stream_sink_t sink   = {.begin = sink_begin, .write = sink_write, .end = sink_end, .arg = &record};
+        CHECK(http_session_download_stream(session, URL, &sink));
+        CHECK(record.begins == 1 && record.received == FILE_SIZE && record.in_order);
+        CHECK(record.size == (chunked ? 0 : FILE_SIZE));
+
+        CHECK(http_session_download_file(session, URL, path));
+        CHECK(file_matches(path));
+        check_digest(session);
+        unlink(path);
+        http_session_end(session);
+    }
+}
+
+static void test_not_modified(void) {
+    serve(false, 0);
+    http_session_t    session    = http_session_begin(URL);
+    http_validators_t validators = {0};
+    uint8_t*          data       = NULL;
+    size_t            size       = 0;
+    bool              not_modified;
+    CHECK(http_session_download_ram_conditional(session, URL, &validators, &data, &size, &not_modified));
+    CHECK(!not_modified && size == FILE_SIZE && strcmp(validators.etag, "\"v1\"") == 0);
+    free(data);
+
+    data = NULL;
+    CHECK(http_session_download_ram_conditional(session, URL, &validators, &data, &size, &not_modified));
+    CHECK(not_modified && data == NULL && size == 0);
+    http_session_end(session);
+}
+
+static void test_expected_digest(void) {
+    static uint8_t received[FILE_SIZE];
+    serve(true, 0);
+    http_session_t session = http_session_begin(URL);
+    uint8_t        wrong[HTTP_SHA256_SIZE];
+    memcpy(wrong, file_digest, HTTP_SHA256_SIZE);
+    wrong[0] ^= 1;
+
+    http_session_set_expected_sha256(session, wrong);
+    sink_record_t      record = {.in_order = true, .data = received};
+    http_stream_sink_t sink   = {.begin = sink_begin, .write = sink_write, .end = sink_end, .arg = &record};
+    CHECK(!http_session_download_stream(session, URL, &sink));
+    CHECK(record.ends == 1 && !record.success);
+
+    http_session_set_expected_sha256(session, wrong);
+    CHECK(!http_session_download_file(session, URL, path));
+    CHECK(!file_exists(path));
+
+    http_session_set_expected_sha256(session, file_digest);
+    uint8_t* data = NULL;
+    size_t   size = 0;
+    CHECK(http_session_download_ram(session, URL, &data, &size));
+    free(data);
+    http_session_end(session);
+}
+
+int main(void) {
+    uint32_t state = 7;
+    for (size_t i = 0; i < FILE_SIZE; i++) {
+        state        = state * 1664525 + 1013904223;
+        file_data[i] = state >> 24;
+    }
+    EVP_Digest(file_data, FILE_SIZE, file_digest, NULL, EVP_sha256(), NULL);
+    REQUIRE(mkdtemp(directory) != NULL);
+    snprintf(path, sizeof(path), "%s/file.bin", directory);
+
+    RUN_TEST(test_download_ram);
+    RUN_TEST(test_download_file);
+    RUN_TEST(test_download_stream);
+    RUN_TEST(test_error_status);
+    RUN_TEST(test_redirect_body_skipped);
+    RUN_TEST(test_not_modified);
+    RUN_TEST(test_expected_digest);
+
+    rmdir(directory);
+    return host_test_result();
+}
@@ -0,0 +1,266 @@
+// Resuming interrupted HTTP downloads (http_download.c) against a flaky stand-in server
+// The server drops the connection at random points of the first attempts of every download. A download that can
+// be resumed (range support, a strong validator and a known size) has to continue exactly where the previous attempt
+// stopped, any other has to start over, and either way the result has to be the file with its digest.
+
+#include <openssl/evp.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "host_test.h"
+#include "http_download.h"
+#include "http_server.h"
+
+#define URL           "https://example.com/file.bin"
+#define FILE_SIZE     (64 * 1024 + 17)
+#define ITERATIONS    40  // Random cut positions per combination
+#define LAST_MODIFIED "Wed, 21 Oct 2015 07:28:00 GMT"
+
+typedef enum {
+    MODE_RAM,
+    MODE_FILE,
+    MODE_STREAM,
+} mode_t_;
+
+typedef enum {
+    VALIDATOR_STRONG_ETAG,
+    VALIDATOR_WEAK_ETAG,
+    VALIDATOR_LAST_MODIFIED,
+    VALIDATOR_NONE,
+} validator_t;
+
+static const char* mode_names[]      = {"ram", "file", "stream"};
+static const char* validator_names[] = {"strong ETag", "weak ETag", "Last-Modified", "no validator"};
+
+static uint8_t file_data[FILE_SIZE];
+static uint8_t file_digest[HTTP_SHA256_SIZE];
+static uint8_t other_data[FILE_SIZE / 2];  // A newer, shorter version of the file
+static char    directory[] = "/tmp/http_resume_XXXXXX";
+static char    path[64];
+
+typedef struct {
+    host_http_file_t file;
+    int              cuts_left;          // Responses still to be cut short
+    uint32_t         random;             // State of the generator picking the cut positions
+    size_t           cut_from;           // Earliest cut position
+    size_t           cut_offsets[3];     // Body bytes delivered before each cut
+    int              cuts;               // Responses cut so far
+    bool             replace_after_cut;  // Serve other_data with a new ETag after the first cut
+    bool             wrong_length;       // Answer range requests with one byte less than the rest of the file
+} flaky_server_t;
+
+static flaky_server_t server;
+
+static uint32_t next_random(void) {
+    server.random = server.random * 1664525 + 1013904223;
+    return server.random >> 8;
+}
+
+static void handler(const host_http_request_t* request, host_http_response_t* response, void* arg) {
+    host_http_serve_file(request, &server.file, response);
+    if (server.wrong_length && response->status == 206) {
+        response->length--;
+    }
+    if (server.cuts_left > 0 && response->length > server.cut_from) {
+        // Anywhere from before the first byte up to just before the last
+        response->cut_after = server.cut_from + next_random() % (response->length - server.cut_from);
+        server.cut_offsets[server.cuts++] = response->cut_after;
+        server.cuts_left--;
+        if (server.replace_after_cut) {
+            server.file.data   = other_data;
+            server.file.length = sizeof(other_data);
+            server.file.etag   = "\"v2\"";
+        }
+    }
+}
+
+static void serve(validator_t validator, bool ranges, bool chunked, int cuts, uint32_t seed) {
+    static const char* etags[] = {"\"v1\"", "W/\"v1\"", NULL, NULL};
+    memset(&server, 0, sizeof(server));
+    server.file.data          = file_data;
+    server.file.length        = FILE_SIZE;
+    server.file.etag          = etags[validator];
+    server.file.last_modified = validator == VALIDATOR_LAST_MODIFIED ? LAST_MODIFIED : NULL;
+    server.file.ranges        = ranges;
+    server.file.chunked       = chunked;
+    server.file.piece_size    = 700;
+    server.cuts_left          = cuts;
+    server.random             = seed;
+    host_http_set_handler(handler, NULL);
+    host_http_reset_stats();
+}
+
+typedef struct {
+    uint8_t* data;
+    size_t   received;
+    bool     committed;
+} sink_state_t;
+
+static bool sink_begin(size_t size, void* arg) {
+    ((sink_state_t*)arg)->received = 0;
+    return true;
+}
+
+static bool sink_write(const uint8_t* data, size_t length, size_t offset, void* arg) {
+    sink_state_t* state = arg;
+    if (offset != state->received || offset + length > FILE_SIZE) return false;
+    memcpy(state->data + offset, data, length);
+    state->received += length;
+    return true;
+}
+
+static bool sink_end(bool success, void* arg) {
+    sink_state_t* state = arg;
+    state->committed    = success;
+    return true;
+}
+
+static bool file_equals(const char* file_path, const uint8_t* expected, size_t length) {
+    FILE* file = fopen(file_path, "rb");
+    if (file == NULL) return false;
+    uint8_t* contents = malloc(FILE_SIZE + 1);
+    size_t   read     = fread(contents, 1, FILE_SIZE + 1, file);
+    fclose(file);
+    bool equal = read == length && memcmp(contents, expected, length) == 0;
+    free(contents);
+    return equal;
+}
+
+// Runs one download in the given mode, returns whether it succeeded with the right data and digest
+static bool download(mode_t_ mode) {
+    static uint8_t received[FILE_SIZE];
+    http_session_t session = http_session_begin(URL);
+    bool           correct = false;
+    switch (mode) {
+        case MODE_RAM: {
+            uint8_t* data = NULL;
+            size_t   size = 0;
+            correct       = http_session_download_ram(session, URL, &data, &size) && size == FILE_SIZE &&
+                      memcmp(data, file_data, FILE_SIZE) == 0;
+            free(data);
+            break;
+        }
+        case MODE_FILE:
+            correct = http_session_download_file(session, URL, path) && file_equals(path, file_data, FILE_SIZE);
+            unlink(path);
+            break;
+        case MODE_STREAM: {
+            sink_state_t       state = {.data = received};
+            http_stream_sink_t sink  = {.begin = sink_begin, .write = sink_write, .end = sink_end, .arg = &state};
+            correct = http_session_download_stream(session, URL, &sink) && state.committed &&
+                      state.received == FILE_SIZE && memcmp(received, file_data, FILE_SIZE) == 0;
+            break;
+        }
+    }
+    uint8_t digest[HTTP_SHA256_SIZE];
+    correct = correct && http_session_get_sha256(session, digest) &&
+              memcmp(digest, file_digest, HTTP_SHA256_SIZE) == 0;
+    http_session_end(session);
+    return correct;
+}
+
+// Two cuts at random positions, the third attempt completes. Only fixed-length RAM and file downloads with range
+// support and a strong validator resume, and then not a single byte is transferred twice.
+static void test_random_cuts(void) {
+    for (int mode = MODE_RAM; mode <= MODE_STREAM; mode++) {
+        for (int validator = VALIDATOR_STRONG_ETAG; validator <= VALIDATOR_NONE; validator++) {
+            for (int variant = 0; variant < 3; variant++) {
+                bool ranges  = variant != 1;
+                bool chunked = variant == 2;
+                bool resumable =
+                    mode != MODE_STREAM && ranges && !chunked &&
+                    (validator == VALIDATOR_STRONG_ETAG || validator == VALIDATOR_LAST_MODIFIED);
+                bool asks_range = mode != MODE_STREAM && !chunked &&
+                                  (validator == VALIDATOR_STRONG_ETAG || validator == VALIDATOR_LAST_MODIFIED);
+
+                int failures = 0;
+                for (uint32_t seed = 1; seed <= ITERATIONS; seed++) {
+                    serve(validator, ranges, chunked, 2, seed * 2654435761u);
+                    bool              correct  = download(mode);
+                    host_http_stats_t stats    = host_http_stats();
+                    size_t            resumes  = (server.cut_offsets[0] > 0) + (server.cut_offsets[1] > 0);
+                    size_t            expected = FILE_SIZE + server.cut_offsets[0] + server.cut_offsets[1];
+                    if (!correct || stats.requests != 3 || stats.cut != 2 ||
+                        (resumable && stats.body_bytes != FILE_SIZE) || (!resumable && stats.body_bytes != expected) ||
+                        (asks_range && stats.range_requests != resumes) || (!asks_range && stats.range_requests != 0)) {
+                        failures++;
+                    }
+                }
+                if (failures > 0) {
+                    fprintf(stderr, "%s download, %s, %s: %d of %d failed\n", mode_names[mode],
+                            validator_names[validator],
+                            chunked ? "chunked" : ranges ? "ranges" : "no range support", failures, ITERATIONS);
+                }
+                CHECK(failures == 0);
+            }
+        }
+    }
+}
+
+// Three cuts use up every attempt, nothing may be left behind
+static void test_every_attempt_cut(void) {
+    for (int mode = MODE_RAM; mode <= MODE_STREAM; mode++) {
+        serve(VALIDATOR_STRONG_ETAG, true, false, 3, 99);
+        CHECK(!download(mode));
+        struct stat st;
+        CHECK(stat(path, &st) != 0);
+    }
+}
+
+// The file changes on the server between attempts. If-Range no longer matches, the server sends the new, shorter
+// version in full over the partial old one and the file has to end where the new version ends.
+static void test_restart_truncates_file(void) {
+    uint8_t other_digest[HTTP_SHA256_SIZE];
+    EVP_Digest(other_data, sizeof(other_data), other_digest, NULL, EVP_sha256(), NULL);
+
+    for (uint32_t seed = 1; seed <= ITERATIONS; seed++) {
+        serve(VALIDATOR_STRONG_ETAG, true, false, 1, seed * 40503u);
+        server.replace_after_cut = true;
+        server.cut_from          = sizeof(other_data) + 1;  // The partial old file is longer than the new version
+        http_session_t session = http_session_begin(URL);
+        bool           success = http_session_download_file(session, URL, path);
+        uint8_t        digest[HTTP_SHA256_SIZE];
+        CHECK(success);
+        CHECK(file_equals(path, other_data, sizeof(other_data)));
+        CHECK(http_session_get_sha256(session, digest) && memcmp(digest, other_digest, HTTP_SHA256_SIZE) == 0);
+        CHECK(host_http_stats().range_requests == 1);
+        http_session_end(session);
+        unlink(path);
+    }
+}
+
+// A 206 whose length does not add up to the original size is not spliced onto the partial data
+static void test_resumed_length_mismatch(void) {
+    for (int mode = MODE_RAM; mode <= MODE_FILE; mode++) {
+        serve(VALIDATOR_STRONG_ETAG, true, false, 1, 12345);
+        server.wrong_length = true;
+        CHECK(!download(mode));
+        CHECK(server.cut_offsets[0] == 0 || host_http_stats().range_requests == 2);
+        struct stat st;
+        CHECK(stat(path, &st) != 0);
+    }
+}
+
+int main(void) {
+    uint32_t state = 3;
+    for (size_t i = 0; i < FILE_SIZE; i++) {
+        state        = state * 1664525 + 1013904223;
+        file_data[i] = state >> 24;
+    }
+    for (size_t i = 0; i < sizeof(other_data); i++) {
+        other_data[i] = ~file_data[i];
+    }
+    EVP_Digest(file_data, FILE_SIZE, file_digest, NULL, EVP_sha256(), NULL);
+    REQUIRE(mkdtemp(directory) != NULL);
+    snprintf(path, sizeof(path), "%s/file.bin", directory);
+
+    RUN_TEST(test_random_cuts);
+    RUN_TEST(test_every_attempt_cut);
+    RUN_TEST(test_restart_truncates_file);
+    RUN_TEST(test_resumed_length_mismatch);
+
+    rmdir(directory);
+    return host_test_result();
+}
@@ -0,0 +1,160 @@
+// Radio system protocol client (radio_system_protocol_client.c) against the loopback radio
+// The loopback answers requests that arrive together in reverse order, so every check that runs more than one
+// request at a time also checks that responses are matched to their requests by sequence number.
+
+#include <pthread.h>
+#include <string.h>
+#include "host_test.h"
+#include "radio_system_protocol_client.h"
+
+#define BATCH_SIZE      (RADIO_SYSTEM_PROTOCOL_WINDOW_SIZE * 3 + 1)
+#define CALLER_THREADS  8
+#define CALLER_REQUESTS 50
+
+typedef struct {
+    radio_system_protocol_header_t      header;
+    radio_system_protocol_information_t information;
+} __attribute__((packed)) information_packet_t;
+
+static void test_get_information(void) {
+    radio_system_protocol_information_t information = {0};
+    CHECK(radio_system_protocol_get_information(&information) == ESP_OK);
+    CHECK(strcmp(information.firmware_name, "loopback") == 0);
+    CHECK(radio_system_protocol_get_information(NULL) == ESP_ERR_INVALID_ARG);
+}
+
+static void test_configuration(void) {
+    radio_system_protocol_configuration_t configuration = {.board_revision = 3, .country_code = {'N', 'L'}};
+    radio_system_protocol_information_t   information   = {0};
+    CHECK(radio_system_protocol_set_configuration(&configuration) == ESP_OK);
+    CHECK(radio_system_protocol_get_information(&information) == ESP_OK);
+    CHECK(information.board_revision == 3);
+    CHECK(memcmp(information.country_code, "NL", 2) == 0);
+
+    // Set and read back in one batch, the information has to reflect the new configuration
+    configuration = (radio_system_protocol_configuration_t){.board_revision = 5, .country_code = {'D', 'E'}};
+    memset(&information, 0, sizeof(information));
+    CHECK(radio_system_protocol_apply_configuration(&configuration, &information) == ESP_OK);
+    CHECK(information.board_revision == 5);
+    CHECK(memcmp(information.country_code, "DE", 2) == 0);
+}
+
+// More transfers than fit in the window, alternating two request types
+static void test_batch_larger_than_window(void) {
+    static uint8_t                   requests[BATCH_SIZE][sizeof(information_packet_t)];
+    static uint8_t                   responses[BATCH_SIZE][512];
+    radio_system_protocol_transfer_t transfers[BATCH_SIZE];
+    for (size_t i = 0; i < BATCH_SIZE; i++) {
+        memset(requests[i], 0, sizeof(requests[i]));
+        radio_system_protocol_header_t* header = (radio_system_protocol_header_t*)requests[i];
+        header->type = i % 2 ? RADIO_SYSTEM_PROTOCOL_TYPE_NVS_LIST : RADIO_SYSTEM_PROTOCOL_TYPE_GET_INFORMATION;
+        transfers[i] = (radio_system_protocol_transfer_t){
+            .request             = requests[i],
+            .request_length      = sizeof(requests[i]),
+            .response            = responses[i],
+            .max_response_length = sizeof(responses[i]),
+        };
+    }
+    CHECK(radio_system_protocol_transaction_batch(transfers, BATCH_SIZE) == ESP_OK);
+
+    uint32_t previous = 0;
+    for (size_t i = 0; i < BATCH_SIZE; i++) {
+        const radio_system_protocol_header_t* request  = (const radio_system_protocol_header_t*)requests[i];
+        const radio_system_protocol_header_t* response = (const radio_system_protocol_header_t*)responses[i];
+        CHECK(transfers[i].result == ESP_OK);
+        CHECK(transfers[i].response_length >= sizeof(radio_system_protocol_header_t));
+        CHECK(response->sequence_number == request->sequence_number);
+        CHECK(response->type == request->type);
+        CHECK(i == 0 || request->sequence_number == previous + 1);
+        previous = request->sequence_number;
+    }
+    CHECK(radio_system_protocol_transaction_batch(NULL, 0) == ESP_OK);
+    CHECK(radio_system_protocol_transaction_batch(NULL, 1) == ESP_ERR_INVALID_ARG);
+}
+
+// A failing transfer is reported on its own, the others in the batch still complete
+static void test_batch_partial_failure(void) {
+    information_packet_t             requests[3]  = {0};
+    information_packet_t             responses[3] = {0};
+    radio_system_protocol_transfer_t transfers[3];
+    for (size_t i = 0; i < 3; i++) {
+        requests[i].header.type = RADIO_SYSTEM_PROTOCOL_TYPE_GET_INFORMATION;
+        transfers[i]            = (radio_system_protocol_transfer_t){
+            .request             = (uint8_t*)&requests[i],
+            .request_length      = sizeof(requests[i]),
+            .response            = (uint8_t*)&responses[i],
+            .max_response_length = sizeof(responses[i]),
+        };
+    }
+    transfers[1].max_response_length = sizeof(radio_system_protocol_header_t);  // Too small for the information
+    transfers[2].request_length      = sizeof(radio_system_protocol_header_t) - 1;
+
+    CHECK(radio_system_protocol_transaction_batch(transfers, 3) != ESP_OK);
+    CHECK(transfers[0].result == ESP_OK);
+    CHECK(strcmp(responses[0].information.firmware_name, "loopback") == 0);
+    CHECK(transfers[1].result == ESP_ERR_INVALID_SIZE);
+    CHECK(transfers[2].result == ESP_ERR_INVALID_SIZE);
+
+    // Every slot of the window was handed back
+    CHECK(radio_system_protocol_transaction_batch(transfers, 1) == ESP_OK);
+}
+
+static void test_nack(void) {
+    // The loopback radio does not implement reading NVS
+    uint8_t value[sizeof(radio_system_protocol_nvs_value_t) + 16] = {0};
+    CHECK(radio_system_protocol_nvs_read("namespace", "key", RADIO_SYSTEM_PROTOCOL_NVS_VALUE_TYPE_UINT8,
+                                         (radio_system_protocol_nvs_value_t*)value, sizeof(value)) == ESP_FAIL);
+
+    radio_system_protocol_nvs_entry_t entries[4];
+    uint32_t                          count = 1;
+    CHECK(radio_system_protocol_nvs_list("namespace", NULL, RADIO_SYSTEM_PROTOCOL_NVS_VALUE_TYPE_ANY, 0, entries, 4,
+                                         &count) == ESP_OK);
+    CHECK(count == 0);
+}
+
+static void* caller(void* arg) {
+    int failures = 0;
+    for (int i = 0; i < CALLER_REQUESTS; i++) {
+        radio_system_protocol_information_t information = {0};
+        radio_system_protocol_nvs_entry_t   entries[2];
+        uint32_t                            count = 0;
+        if (radio_system_protocol_get_information(&information) != ESP_OK ||
+            strcmp(information.firmware_name, "loopback") != 0) {
+            failures++;
+        }
+        if (radio_system_protocol_nvs_list("namespace", NULL, RADIO_SYSTEM_PROTOCOL_NVS_VALUE_TYPE_ANY, 0, entries, 2,
+                                           &count) != ESP_OK) {
+            failures++;
+        }
+    }
+    *(int*)arg = failures;
+    return NULL;
+}
+
+// More callers than window slots, each with a request of its own in flight
+static void test_concurrent_callers(void) {
+    pthread_t threads[CALLER_THREADS];
+    int       failures[CALLER_THREADS] = {0};
+    for (int i = 0; i < CALLER_THREADS; i++) {
+        REQUIRE(pthread_create(&threads[i], NULL, caller, &failures[i]) == 0);
+    }
+    for (int i = 0; i < CALLER_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        CHECK(failures[i] == 0);
+    }
+}
+
+int main(void) {
+    radio_system_protocol_information_t information;
+    REQUIRE(radio_system_protocol_get_information(&information) == ESP_ERR_INVALID_STATE);
+    REQUIRE(radio_system_protocol_init() == ESP_OK);
+    REQUIRE(radio_system_protocol_init() == ESP_OK);
+
+    RUN_TEST(test_get_information);
+    RUN_TEST(test_configuration);
+    RUN_TEST(test_batch_larger_than_window);
+    RUN_TEST(test_batch_partial_failure);
+    RUN_TEST(test_nack);
+    RUN_TEST(test_concurrent_callers);
+    return host_test_result();
+}
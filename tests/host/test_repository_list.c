@@ -0,0 +1,210 @@
+// Filtered window over the repository project listing (repository_list.c)
+// load_project_records is replaced by a listing generated in memory. The window has to hold only the projects of its
+// view, in full pages even when they are sparse, keep every one of them reachable in both directions and keep its
+// paging straight when the server sends entries that cannot be projected. A cursor moved through the listing the way
+// the repository menu moves it must never make the window go back and forth.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "repository_client.h"
+#include "repository_list.h"
+
+#define WINDOW_MARGIN 4  // Like the repository menu
+
+typedef struct {
+    size_t   entries;
+    unsigned plugin_every;   // Every n-th entry is a plugin, 0 for none
+    unsigned invalid_every;  // Every n-th entry has no name and is skipped by the projection, 0 for none
+    unsigned requests;
+} listing_t;
+
+static listing_t listing;
+
+static bool is_plugin(size_t entry) {
+    return listing.plugin_every != 0 && entry % listing.plugin_every == listing.plugin_every - 1;
+}
+
+static bool is_valid(size_t entry) {
+    return listing.invalid_every == 0 || entry % listing.invalid_every != listing.invalid_every - 1;
+}
+
+bool load_project_records(const char* base_url, const char* category, uint32_t offset, uint32_t amount,
+                          repository_project_t** out_projects, size_t* out_count, size_t* out_entries) {
+    listing.requests++;
+    size_t end  = (offset + amount < listing.entries) ? offset + amount : listing.entries;
+    size_t sent = (offset < end) ? end - offset : 0;
+
+    repository_project_t* projects = calloc(sent > 0 ? sent : 1, sizeof(repository_project_t));
+    size_t                count    = 0;
+    for (size_t entry = offset; entry < end; entry++) {
+        if (!is_valid(entry)) continue;
+        snprintf(projects[count].slug, sizeof(projects[count].slug), "project-%zu", entry);
+        snprintf(projects[count].name, sizeof(projects[count].name), "Project %zu", entry);
+        projects[count].is_plugin   = is_plugin(entry);
+        projects[count].inline_icon = (entry % 3 == 0) ? strdup("iVBORw0KGgo=") : NULL;
+        count++;
+    }
+    *out_projects = projects;
+    *out_count    = count;
+    if (out_entries != NULL) *out_entries = sent;
+    return true;
+}
+
+static void generate(size_t entries, unsigned plugin_every, unsigned invalid_every) {
+    listing = (listing_t){.entries = entries, .plugin_every = plugin_every, .invalid_every = invalid_every};
+}
+
+// Entry numbers of the projects the view holds, in listing order
+static size_t expected_projects(bool plugins, size_t* out) {
+    size_t count = 0;
+    for (size_t entry = 0; entry < listing.entries; entry++) {
+        if (is_valid(entry) && is_plugin(entry) == plugins) out[count++] = entry;
+    }
+    return count;
+}
+
+static size_t entry_of(const repository_project_t* project) {
+    return strtoul(project->slug + strlen("project-"), NULL, 10);
+}
+
+// Checks the window against the expected projects: only matching projects, consecutive indices, full pages
+static bool window_valid(repository_list_t* list, const size_t* expected, size_t expected_count) {
+    uint32_t first = repository_list_first(list);
+    size_t   count = repository_list_count(list);
+    if (first + count > expected_count) return false;
+    for (size_t i = 0; i < count; i++) {
+        repository_project_t* project = repository_list_get(list, first + i);
+        if (project == NULL || project->is_plugin != list->plugins || entry_of(project) != expected[first + i]) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < list->page_count; i++) {
+        size_t page_count = list->pages[i].count;
+        bool   last_page  = (i == list->page_count - 1) && list->end_reached;
+        if (page_count >= 2 * REPOSITORY_LIST_PAGE_SIZE || (page_count < REPOSITORY_LIST_PAGE_SIZE && !last_page)) {
+            return false;
+        }
+    }
+    return list->page_count <= REPOSITORY_LIST_WINDOW_PAGES;
+}
+
+typedef struct {
+    unsigned next;
+    unsigned previous;
+    unsigned reversals;  // Moves of the window against the direction of the cursor
+} moves_t;
+
+// update_window of the repository menu, for a cursor at index moving in the given direction
+static void move_window(repository_list_t* list, uint32_t index, int direction, moves_t* moves) {
+    bool moved = false;
+    while (repository_list_first(list) + repository_list_count(list) - index <= WINDOW_MARGIN &&
+           repository_list_has_next(list) && repository_list_load_next(list)) {
+        moves->next++;
+        moves->reversals += direction < 0;
+        moved             = true;
+    }
+    if (moved) return;
+    while (index - repository_list_first(list) < WINDOW_MARGIN && repository_list_has_previous(list) &&
+           repository_list_load_previous(list)) {
+        moves->previous++;
+        moves->reversals += direction > 0;
+    }
+}
+
+// Walks the cursor over the complete view and back, every project has to be resident when the cursor is on it
+static void walk(bool plugins) {
+    size_t* expected = malloc(sizeof(size_t) * listing.entries);
+    size_t  count    = expected_projects(plugins, expected);
+
+    repository_list_t list = {0};
+    REQUIRE(repository_list_open(&list, "https://example.com", NULL, plugins));
+    moves_t moves = {0};
+    move_window(&list, 0, 1, &moves);
+    CHECK(window_valid(&list, expected, count));
+
+    bool reachable = true;
+    bool valid     = true;
+    for (uint32_t index = 0; index < count; index++) {
+        move_window(&list, index, 1, &moves);
+        reachable = reachable && repository_list_get(&list, index) != NULL;
+        valid     = valid && window_valid(&list, expected, count);
+    }
+    unsigned forward_requests = listing.requests;
+    for (uint32_t index = count; index-- > 0;) {
+        move_window(&list, index, -1, &moves);
+        reachable = reachable && repository_list_get(&list, index) != NULL;
+        valid     = valid && window_valid(&list, expected, count);
+    }
+    CHECK(reachable);
+    CHECK(valid);
+    CHECK(moves.reversals == 0);
+    // Walking forward fetches every part of the listing once
+    CHECK(forward_requests <= listing.entries / REPOSITORY_LIST_PAGE_SIZE + 2);
+    printf("  %zu entries, %zu %s: %u requests forward, %u in total, window moved %u/%u times\n", listing.entries,
+           count, plugins ? "plugins" : "applications", forward_requests, listing.requests, moves.next,
+           moves.previous);
+    repository_list_close(&list);
+    free(expected);
+}
+
+static void test_dense_view(void) {
+    generate(1000, 37, 0);
+    walk(false);
+}
+
+// 27 plugins between 973 applications, the window used to hold only the few in its 60 entries of the listing
+static void test_sparse_view(void) {
+    generate(1000, 37, 0);
+    walk(true);
+}
+
+// Entries without a name are not projected but still count for the offset of the next request
+static void test_skipped_entries(void) {
+    generate(500, 3, 11);
+    walk(false);
+    generate(500, 3, 11);
+    walk(true);
+}
+
+static void test_empty_view(void) {
+    generate(200, 0, 0);
+    repository_list_t list = {0};
+    REQUIRE(repository_list_open(&list, "https://example.com", NULL, true));
+    CHECK(repository_list_count(&list) == 0);
+    CHECK(!repository_list_has_next(&list) && !repository_list_has_previous(&list));
+    CHECK(!repository_list_load_next(&list));
+    CHECK(listing.requests == 200 / REPOSITORY_LIST_PAGE_SIZE + 1);
+    repository_list_close(&list);
+}
+
+// Fewer plugins than a page: all of them are in the first page and nothing is fetched afterwards
+static void test_view_smaller_than_page(void) {
+    generate(300, 100, 0);
+    size_t expected[300];
+    size_t count = expected_projects(true, expected);
+    REQUIRE(count == 3);
+
+    repository_list_t list = {0};
+    REQUIRE(repository_list_open(&list, "https://example.com", NULL, true));
+    unsigned requests = listing.requests;
+    moves_t  moves    = {0};
+    for (uint32_t index = 0; index < count; index++) {
+        move_window(&list, index, 1, &moves);
+        move_window(&list, index, -1, &moves);
+    }
+    CHECK(window_valid(&list, expected, count) && repository_list_count(&list) == count);
+    CHECK(listing.requests == requests && moves.next == 0 && moves.previous == 0);
+    repository_list_close(&list);
+}
+
+int main(void) {
+    RUN_TEST(test_dense_view);
+    RUN_TEST(test_sparse_view);
+    RUN_TEST(test_skipped_entries);
+    RUN_TEST(test_empty_view);
+    RUN_TEST(test_view_smaller_than_page);
+    return host_test_result();
+}
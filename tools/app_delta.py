@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+
+# Copyright 2025 Nicolai Electronics
+# SPDX-License-Identifier: MIT
+
+"""Creates delta patches for AppFS executables, in the format applied by main/app_delta.c.
+
+A patch rebuilds the new executable from the old one with copy commands, for data that is found in the old
+executable, and insert commands carrying the data that is not. All integers are little endian:
+
+  header:  uint32 magic "ADLT", uint32 old size, uint32 new size, uint32 reserved (0), uint8[32] SHA-256 of the
+           new executable
+  copy:    'C', uint32 offset in the old executable, uint32 length
+  insert:  'I', uint32 length, followed by length bytes of new data
+
+Usage: app_delta.py OLD NEW PATCH
+
+The SHA-256 of the patch, which the repository publishes next to it, is printed on success.
+"""
+
+import hashlib
+import struct
+import sys
+
+MAGIC = 0x544C4441  # "ADLT"
+HEADER = struct.Struct("<IIII32s")
+COPY = struct.Struct("<cII")
+INSERT = struct.Struct("<cI")
+
+BLOCK = 32  # Length of the blocks of the old executable that are looked up in the new one
+MIN_COPY = BLOCK  # Shorter matches cost more as a copy command than they save
+MAX_SIZE = 0xFFFFFFFF
+
+
+def index_blocks(old):
+    """Maps every block of the old executable at a multiple of BLOCK to its first offset."""
+    index = {}
+    for offset in range(0, len(old) - BLOCK + 1, BLOCK):
+        index.setdefault(old[offset : offset + BLOCK], offset)
+    return index
+
+
+def commands(old, new):
+    """Yields (offset, length) for copies and (None, data) for inserts that rebuild new from old."""
+    index = index_blocks(old)
+    position = 0
+    pending = 0  # Start of the new data not yet covered by a command
+    while position + BLOCK <= len(new):
+        match = index.get(new[position : position + BLOCK])
+        if match is None:
+            position += 1
+            continue
+
+        # Grow the match in both directions, backwards only over data that would otherwise be inserted
+        start, source = position, match
+        while start > pending and source > 0 and new[start - 1] == old[source - 1]:
+            start -= 1
+            source -= 1
+        end, source_end = position + BLOCK, match + BLOCK
+        while end < len(new) and source_end < len(old) and new[end] == old[source_end]:
+            end += 1
+            source_end += 1
+        if end - start < MIN_COPY:
+            position += 1
+            continue
+
+        if start > pending:
+            yield None, new[pending:start]
+        yield source, end - start
+        position = pending = end
+    if pending < len(new):
+        yield None, new[pending:]
+
+
+def make_patch(old, new):
+    if len(old) > MAX_SIZE or len(new) > MAX_SIZE:
+        raise ValueError("executables larger than 4 GiB can not be patched")
+    if len(new) == 0:
+        raise ValueError("the new executable is empty")
+
+    patch = bytearray(HEADER.pack(MAGIC, len(old), len(new), 0, hashlib.sha256(new).digest()))
+    for offset, data in commands(old, new):
+        if offset is None:
+            patch += INSERT.pack(b"I", len(data))
+            patch += data
+        else:
+            patch += COPY.pack(b"C", offset, data)
+    return bytes(patch)
+
+
+def apply_patch(old, patch):
+    """Rebuilds the new executable, used to check a patch before it is written."""
+    magic, old_size, new_size, _, digest = HEADER.unpack_from(patch, 0)
+    if magic != MAGIC or old_size != len(old):
+        raise ValueError("patch does not apply")
+    new = bytearray()
+    position = HEADER.size
+    while position < len(patch):
+        if patch[position : position + 1] == b"C":
+            _, offset, length = COPY.unpack_from(patch, position)
+            new += old[offset : offset + length]
+            position += COPY.size
+        else:
+            _, length = INSERT.unpack_from(patch, position)
+            position += INSERT.size
+            new += patch[position : position + length]
+            position += length
+    if len(new) != new_size or hashlib.sha256(new).digest() != digest:
+        raise ValueError("patch does not rebuild the new executable")
+    return bytes(new)
+
+
+def main(argv):
+    if len(argv) != 4:
+        sys.stderr.write(__doc__)
+        return 1
+    with open(argv[1], "rb") as f:
+        old = f.read()
+    with open(argv[2], "rb") as f:
+        new = f.read()
+
+    try:
+        patch = make_patch(old, new)
+        apply_patch(old, patch)
+    except ValueError as e:
+        sys.stderr.write("{}: {}\n".format(argv[0], e))
+        return 1
+
+    with open(argv[3], "wb") as f:
+        f.write(patch)
+    sys.stderr.write("{} byte patch for a {} byte executable\n".format(len(patch), len(new)))
+    print(hashlib.sha256(patch).hexdigest())
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -62,8 +62,9 @@ int asp_plugin_should_stop(void* ctx) { return 0; }
 int asp_plugin_menu_add_item(const char* label, void* icon, void* callback, void* user_data) { return 0; }
 void asp_plugin_menu_remove_item(int item_id) {}
 
-// Lifecycle events flow through the input event queue (see asp/input.h and
-// ASP_INPUT_ACTION_TYPE_* in tanmatsu_plugin.h) — no separate event API.
+// Event API
+int asp_plugin_event_register(void* ctx, unsigned int event_mask, void* handler, void* arg) { return 0; }
+void asp_plugin_event_unregister(int handler_id) {}
 
 // Network API
 int asp_net_is_connected(int* out_connected) { return 0; }